@@ -62,9 +62,96 @@ DEEGEN_DEFINE_LIB_FUNC(base_assert)
 //     "setpause": sets arg as the new value for the pause of the collector (see §2.10). Returns the previous value for pause.
 //     "setstepmul": sets arg as the new value for the step multiplier of the collector (see §2.10). Returns the previous value for step.
 //
+// TODO: we currently do not have GC, so "collect" and "step" throw a not-implemented error (rather than silently doing nothing,
+// which would hide the fact that no memory is ever reclaimed), and "stop" and "restart" only toggle a flag.
+// The other options are fully functional: "count" reports the heap usage, and the tuning parameters are recorded in the VM.
+//
 DEEGEN_DEFINE_LIB_FUNC(base_collectgarbage)
 {
-    ThrowError("Library function 'collectgarbage' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+
+    const char* opt = "collect";
+    size_t optLen = 7;
+    char optBuf[std::max(x_default_tostring_buffersize_double, x_default_tostring_buffersize_int)];
+    if (numArgs > 0 && !GetArg(0).Is<tNil>())
+    {
+        TValue tvOpt = GetArg(0);
+        if (tvOpt.Is<tString>())
+        {
+            opt = reinterpret_cast<char*>(TranslateToRawPointer(tvOpt.As<tString>()->m_string));
+            optLen = tvOpt.As<tString>()->m_length;
+        }
+        else if (tvOpt.Is<tDouble>())
+        {
+            optLen = static_cast<size_t>(StringifyDoubleUsingDefaultLuaFormattingOptions(optBuf, tvOpt.As<tDouble>()) - optBuf);
+            opt = optBuf;
+        }
+        else if (tvOpt.Is<tInt32>())
+        {
+            optLen = static_cast<size_t>(StringifyInt32UsingDefaultLuaFormattingOptions(optBuf, tvOpt.As<tInt32>()) - optBuf);
+            opt = optBuf;
+        }
+        else
+        {
+            ThrowError("bad argument #1 to 'collectgarbage' (string expected)");
+        }
+    }
+
+    int32_t arg = 0;
+    if (numArgs > 1 && !GetArg(1).Is<tNil>())
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(1));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #2 to 'collectgarbage' (number expected)");
+        }
+        arg = static_cast<int32_t>(val);
+    }
+
+    std::string_view optSv(opt, optLen);
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    if (optSv == "collect")
+    {
+        ThrowError("Library function 'collectgarbage' is not implemented yet for option 'collect'!");
+    }
+    else if (optSv == "count")
+    {
+        Return(TValue::Create<tDouble>(static_cast<double>(vm->GetTotalHeapUsageInBytes()) / 1024));
+    }
+    else if (optSv == "step")
+    {
+        ThrowError("Library function 'collectgarbage' is not implemented yet for option 'step'!");
+    }
+    else if (optSv == "stop")
+    {
+        vm->SetGcStopped(true);
+        Return(TValue::Create<tDouble>(0));
+    }
+    else if (optSv == "restart")
+    {
+        vm->SetGcStopped(false);
+        Return(TValue::Create<tDouble>(0));
+    }
+    else if (optSv == "setpause")
+    {
+        Return(TValue::Create<tDouble>(vm->SetGcPause(arg)));
+    }
+    else if (optSv == "setstepmul")
+    {
+        Return(TValue::Create<tDouble>(vm->SetGcStepMul(arg)));
+    }
+    else
+    {
+        constexpr std::string_view x_errPrefix = "bad argument #1 to 'collectgarbage' (invalid option '";
+        constexpr std::string_view x_errSuffix = "')";
+        std::pair<const void*, size_t> pieces[3] = {
+            std::make_pair(x_errPrefix.data(), x_errPrefix.length()),
+            std::make_pair(opt, optLen),
+            std::make_pair(x_errSuffix.data(), x_errSuffix.length())
+        };
+        HeapPtr<HeapString> errMsg = vm->CreateStringObjectFromConcatenation(pieces, std::size(pieces)).As();
+        ThrowError(TValue::Create<tString>(errMsg));
+    }
 }
 
 DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(base_dofile_continuation)
@@ -480,7 +567,7 @@ DEEGEN_DEFINE_LIB_FUNC(base_next)
     TValue key;
     if (GetNumArgs() >= 2)
     {
-        key = GetArg(1);
+        key = VM_InternIfLazilyInternedString(GetArg(1));
     }
     else
     {
@@ -553,10 +640,21 @@ static bool WARN_UNUSED HasNoExoticToStringMetamethodForStringType(VM* vm)
     return hiddenClass.m_value == vm->m_initialHiddenClassOfMetatableForString.m_value;
 }
 
+// Print "<typeName>: <address>" in the same format as the default 'tostring'
+//
+static void PrintPointerToStdout(VM* vm, const char* typeName, void* p)
+{
+    constexpr size_t x_maxLen = 64;
+    char* buf = vm->ReserveStdoutBuffer(x_maxLen);
+    int len = snprintf(buf, x_maxLen, "%s: %p", typeName, p);
+    assert(len > 0 && static_cast<size_t>(len) < x_maxLen);
+    vm->CommitStdoutBuffer(buf, static_cast<size_t>(len));
+}
+
 // This function may only be called if both the 'IsGlobalToStringFunctionUnchanged' check and
 // the 'HasNoExoticToStringMetamethodForStringType' check have passed.
 //
-static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
+static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, TValue tv)
 {
     if (tv.Is<tDouble>())
     {
@@ -564,10 +662,7 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
         {
             return false;
         }
-        double dbl = tv.As<tDouble>();
-        char buf[x_default_tostring_buffersize_double];
-        StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, dbl);
-        fprintf(fp, "%s", buf);
+        vm->WriteNumberToStdout(tv.As<tDouble>());
         return true;
     }
 
@@ -580,7 +675,7 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
             {
                 return false;
             }
-            fprintf(fp, "nil");
+            vm->WriteToStdout("nil", 3);
         }
         else
         {
@@ -589,7 +684,14 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
             {
                 return false;
             }
-            fprintf(fp, "%s", (miv.GetBooleanValue() ? "true" : "false"));
+            if (miv.GetBooleanValue())
+            {
+                vm->WriteToStdout("true", 4);
+            }
+            else
+            {
+                vm->WriteToStdout("false", 5);
+            }
         }
         return true;
     }
@@ -600,7 +702,7 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
     if (ty == HeapEntityType::String)
     {
         HeapString* hs = reinterpret_cast<HeapString*>(p);
-        fwrite(hs->m_string, sizeof(char), hs->m_length /*length*/, fp);
+        vm->WriteToStdout(hs->m_string, hs->m_length);
         return true;
     }
 
@@ -610,7 +712,7 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
         {
             return false;
         }
-        fprintf(fp, "function: %p", static_cast<void*>(p));
+        PrintPointerToStdout(vm, "function", p);
         return true;
     }
 
@@ -620,16 +722,18 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
         {
             return false;
         }
-        fprintf(fp, "thread: %p", static_cast<void*>(p));
+        PrintPointerToStdout(vm, "thread", p);
         return true;
     }
 
     if (ty == HeapEntityType::Userdata)
     {
-        // TODO: support userdata
-        //
-        assert(false && "unimplemented");
-        __builtin_unreachable();
+        if (TCGet(tv.As<tUserdata>()->m_metatable).m_value != 0)
+        {
+            return false;
+        }
+        PrintPointerToStdout(vm, "userdata", p);
+        return true;
     }
 
     assert(ty == HeapEntityType::Table);
@@ -639,7 +743,7 @@ static bool WARN_UNUSED TryPrintUsingFastPath(VM* vm, FILE* fp, TValue tv)
     {
         return false;
     }
-    fprintf(fp, "table: %p", static_cast<void*>(p));
+    PrintPointerToStdout(vm, "table", p);
     return true;
 }
 
@@ -651,7 +755,6 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(base_print_continuation)
     }
 
     VM* vm = VM::GetActiveVMForCurrentThread();
-    FILE* fp = vm->GetStdout();
 
     TValue valueToPrint = GetReturnValuesBegin()[0];
     // Print the value returned from the 'tostring' function
@@ -660,14 +763,11 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(base_print_continuation)
     if (valueToPrint.Is<tString>())
     {
         HeapString* hs = TranslateToRawPointer(vm, valueToPrint.As<tString>());
-        fwrite(hs->m_string, sizeof(char), hs->m_length /*length*/, fp);
+        vm->WriteToStdout(hs->m_string, hs->m_length);
     }
     else if (valueToPrint.Is<tDouble>())
     {
-        double dbl = valueToPrint.As<tDouble>();
-        char buf[x_default_tostring_buffersize_double];
-        StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, dbl);
-        fprintf(fp, "%s", buf);
+        vm->WriteNumberToStdout(valueToPrint.As<tDouble>());
     }
     else
     {
@@ -685,11 +785,11 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(base_print_continuation)
     assert(0 < curElementToPrint && curElementToPrint <= numElementsToPrint);
     if (curElementToPrint == numElementsToPrint)
     {
-        fprintf(fp, "\n");
+        vm->WriteCharToStdout('\n');
         Return();
     }
 
-    fprintf(fp, "\t");
+    vm->WriteCharToStdout('\t');
 
     // Having returned from a call (which can do anything), we need to re-validate the fast path conditions.
     // However, we should not lookup the global 'tostring' again. Instead we should retrieve its cached value
@@ -707,17 +807,17 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(base_print_continuation)
 
     while (curElementToPrint < numElementsToPrint)
     {
-        if (unlikely(!TryPrintUsingFastPath(vm, fp, sb[curElementToPrint])))
+        if (unlikely(!TryPrintUsingFastPath(vm, sb[curElementToPrint])))
         {
             goto make_call_slowpath;
         }
         curElementToPrint++;
         if (curElementToPrint < numElementsToPrint)
         {
-            fprintf(fp, "\t");
+            vm->WriteCharToStdout('\t');
         }
     }
-    fprintf(fp, "\n");
+    vm->WriteCharToStdout('\n');
     Return();
 
 make_call_slowpath:
@@ -763,12 +863,11 @@ make_call_slowpath:
 DEEGEN_DEFINE_LIB_FUNC(base_print)
 {
     VM* vm = VM::GetActiveVMForCurrentThread();
-    FILE* fp = vm->GetStdout();
 
     size_t numArgs = GetNumArgs();
     if (numArgs == 0)
     {
-        fprintf(fp, "\n");
+        vm->WriteCharToStdout('\n');
         Return();
     }
 
@@ -788,15 +887,15 @@ DEEGEN_DEFINE_LIB_FUNC(base_print)
     {
         if (cur > 0)
         {
-            fprintf(fp, "\t");
+            vm->WriteCharToStdout('\t');
         }
-        if (unlikely(!TryPrintUsingFastPath(vm, fp, GetArg(cur))))
+        if (unlikely(!TryPrintUsingFastPath(vm, GetArg(cur))))
         {
             goto make_call_slowpath;
         }
         cur++;
     }
-    fprintf(fp, "\n");
+    vm->WriteCharToStdout('\n');
     Return();
 
 make_call_slowpath:
@@ -857,7 +956,7 @@ DEEGEN_DEFINE_LIB_FUNC(base_rawequal)
     }
     else
     {
-        result = (lhs.m_value == rhs.m_value);
+        result = (VM_InternIfLazilyInternedString(lhs).m_value == VM_InternIfLazilyInternedString(rhs).m_value);
     }
     Return(TValue::Create<tBool>(result));
 }
@@ -913,6 +1012,7 @@ DEEGEN_DEFINE_LIB_FUNC(base_rawget)
     }
     else if (index.Is<tHeapEntity>())
     {
+        index = VM_InternIfLazilyInternedString(index);
         GetByIdICInfo icInfo;
         TableObject::PrepareGetById(tableObj, UserHeapPointer<void> { index.As<tHeapEntity>() }, icInfo /*out*/);
         result = TableObject::GetById(tableObj, index.As<tHeapEntity>(), icInfo);
@@ -984,6 +1084,7 @@ DEEGEN_DEFINE_LIB_FUNC(base_rawset)
     }
     else if (index.Is<tHeapEntity>())
     {
+        index = VM_InternIfLazilyInternedString(index);
         PutByIdICInfo icInfo;
         TableObject::PreparePutById(tableObj, UserHeapPointer<void> { index.As<tHeapEntity>() }, icInfo /*out*/);
         TableObject::PutById(tableObj, index.As<tHeapEntity>(), newValue, icInfo);
@@ -1312,11 +1413,8 @@ static TValue WARN_UNUSED LuaDefaultStringifyValue(VM* vm, TValue value)
         }
         else
         {
-            // TODO: support userdata
-            //
             assert(p->m_type == HeapEntityType::Userdata);
-            assert(false && "unimplemented");
-            __builtin_unreachable();
+            sprintf(buf, "userdata: %p", static_cast<void*>(p));
         }
 
         return TValue::Create<tString>(vm->CreateStringObjectFromRawCString(buf));
@@ -1569,9 +1667,12 @@ DEEGEN_DEFINE_LIB_FUNC(base_unpack)
 // gcinfo ()
 // Returns two results: the number of Kbytes of dynamic memory that Lua is using and the current garbage collector threshold (also in Kbytes).
 //
+// Note that despite what the description above says, Lua 5.1 only returns the first value, so we do the same.
+//
 DEEGEN_DEFINE_LIB_FUNC(base_gcinfo)
 {
-    ThrowError("Library function 'gcinfo' is not implemented yet!");
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    Return(TValue::Create<tDouble>(static_cast<double>(vm->GetTotalHeapUsageInBytes() >> 10)));
 }
 
 // newproxy -- undocumented feature, removed in 5.2
@@ -52,11 +52,14 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(coro_finish)
         // Note that we also need to pad nils to x_minNilFillReturnValues, as required by our internal call scheme.
         // However, since we know that the incoming return values also follows this scheme, it's sufficient to memcpy at least that many elements.
         //
-        // TODO: we need to check for stack overflow here once we implement resizable stack
+        // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
         //
         dstStackBase[0] = TValue::Create<tBool>(true);
         MoveArgumentsForCoroutine(dstStackBase + 1, retStart, std::max(numRets, static_cast<size_t>(x_minNilFillReturnValues) - 1));
 
+        // The return values have been moved out, so the stack of the dead coroutine can be recycled now
+        //
+        currentCoro->ReleaseStack(VM::GetActiveVMForCurrentThread());
         CoroSwitch(targetCoro, dstStackBase, numRets + 1);
     }
     else
@@ -64,10 +67,11 @@ DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(coro_finish)
         assert(dstHdr->m_numVariadicArguments == 1);
         // For coroutine.wrap, we should simply store all the return values
         //
-        // TODO: we need to check for stack overflow here once we implement resizable stack
+        // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
         //
         MoveArgumentsForCoroutine(dstStackBase, retStart, std::max(numRets, static_cast<size_t>(x_minNilFillReturnValues)));
 
+        currentCoro->ReleaseStack(VM::GetActiveVMForCurrentThread());
         CoroSwitch(targetCoro, dstStackBase, numRets);
     }
 }
@@ -182,7 +186,7 @@ DEEGEN_DEFINE_LIB_FUNC(coroutine_resume)
         currentCoro->m_suspendPointStackBase = GetStackBase();
 
         // Set up the arguments passed to the resumed coroutine
-        // TODO: we need to check for stack overflow here once we implement resizable stack
+        // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
         //
         TValue* dstStackBase = targetCoro->m_suspendPointStackBase;
         size_t numArgsToPass = GetNumArgs() - 1;
@@ -320,7 +324,7 @@ DEEGEN_DEFINE_LIB_FUNC(coroutine_wrap_call)
     currentCoro->m_suspendPointStackBase = GetStackBase();
 
     // Set up the arguments passed to the resumed coroutine
-    // TODO: we need to check for stack overflow here once we implement resizable stack
+    // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
     //
     TValue* dstStackBase = targetCoro->m_suspendPointStackBase;
     size_t numArgsToPass = GetNumArgs();
@@ -405,7 +409,7 @@ DEEGEN_DEFINE_LIB_FUNC(coroutine_yield)
         // For coroutine.resume, we should store 'true' plus all return values
         // Note that we also need to pad nils to x_minNilFillReturnValues, as required by our internal call scheme.
         //
-        // TODO: we need to check for stack overflow here once we implement resizable stack
+        // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
         //
         dstStackBase[0] = TValue::Create<tBool>(true);
         MoveArgumentsForCoroutine(dstStackBase + 1, sb, numArgs);
@@ -422,7 +426,7 @@ DEEGEN_DEFINE_LIB_FUNC(coroutine_yield)
         assert(dstHdr->m_numVariadicArguments == 1);
         // For coroutine.wrap, we should simply store all the return values
         //
-        // TODO: we need to check for stack overflow here once we implement resizable stack
+        // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
         //
         MoveArgumentsForCoroutine(dstStackBase, sb, numArgs);
         // Pad x_minNilFillReturnValues nils
@@ -1,156 +1,542 @@
 #include "deegen_api.h"
 #include "runtime_utils.h"
 
-// io.close -- https://www.lua.org/manual/5.1/manual.html#pdf-io.close
+// The file handles are userdata objects whose payload is a LuaFileHandle (see runtime_utils.h)
 //
-// io.close ([file])
-// Equivalent to file:close(). Without a file, closes the default output file.
+// Reading is done directly from the internal buffer of the file handle:
+// lines are split with memchr and the strings are created straight from the buffer,
+// and read("*a") on a large regular file maps the file into memory instead of reading it through the buffer.
 //
-DEEGEN_DEFINE_LIB_FUNC(io_close)
+
+static TValue WARN_UNUSED MakeStringValue(VM* vm, const char* str)
 {
-    ThrowError("Library function 'io.close' is not implemented yet!");
+    return TValue::Create<tString>(vm->CreateStringObjectFromRawString(str, static_cast<uint32_t>(strlen(str))).As());
 }
 
-// io.flush -- https://www.lua.org/manual/5.1/manual.html#pdf-io.flush
+// Note that the library functions below must not hold objects with non-trivial destructors (e.g., std::string),
+// since Return and ThrowError never return. Such objects are only used inside the helper functions.
 //
-// io.flush ()
-// Equivalent to file:flush over the default output file.
+
+// Returns the error message "<prefix>: <strerror(err)>", or just "<strerror(err)>" if 'prefix' is empty
 //
-DEEGEN_DEFINE_LIB_FUNC(io_flush)
+static TValue WARN_UNUSED MakeErrnoMessage(VM* vm, std::string_view prefix, int err)
 {
-    ThrowError("Library function 'io.flush' is not implemented yet!");
+    const char* errstr = strerror(err);
+    if (prefix.empty())
+    {
+        return MakeStringValue(vm, errstr);
+    }
+    std::string msg = std::string(prefix) + ": " + errstr;
+    return TValue::Create<tString>(vm->CreateStringObjectFromRawString(msg.data(), static_cast<uint32_t>(msg.length())).As());
 }
 
-// io.input -- https://www.lua.org/manual/5.1/manual.html#pdf-io.input
+// Returns the error message for failing to open a file in io.input, io.output and io.lines
 //
-// io.input ([file])
-// When called with a file name, it opens the named file (in text mode), and sets its handle as the default input file.
-// When called with a file handle, it simply sets this file handle as the default input file.
-// When called without parameters, it returns the current default input file.
+static TValue WARN_UNUSED MakeOpenFileErrorMessage(VM* vm, const char* funcName, std::string_view filename, int err)
+{
+    std::string msg = std::string("bad argument #1 to '") + funcName + "' (" + std::string(filename) + ": " + strerror(err) + ")";
+    return TValue::Create<tString>(vm->CreateStringObjectFromRawString(msg.data(), static_cast<uint32_t>(msg.length())).As());
+}
+
+static std::string_view WARN_UNUSED GetStringViewFromHeapString(HeapPtr<HeapString> hs)
+{
+    return std::string_view(reinterpret_cast<const char*>(TranslateToRawPointer(hs->m_string)), hs->m_length);
+}
+
+static TValue WARN_UNUSED GetDefaultFileValue(VM* vm, bool isOutput)
+{
+    return TValue::CreatePointer(isOutput ? vm->m_ioDefaultOutputFile : vm->m_ioDefaultInputFile);
+}
+
+// Parse a Lua file mode string (the same format as C fopen) into open(2) flags
+// Return false if the mode is invalid
 //
-// In case of errors this function raises the error, instead of returning an error code.
+static bool WARN_UNUSED ParseFileOpenMode(std::string_view mode, int& flags /*out*/)
+{
+    if (mode.empty())
+    {
+        return false;
+    }
+    // The first character may be followed by any number of 'b' and at most one '+', in any order ("r+b", "rb+", etc)
+    //
+    bool isUpdate = false;
+    for (size_t i = 1; i < mode.length(); i++)
+    {
+        if (mode[i] == '+' && !isUpdate)
+        {
+            isUpdate = true;
+        }
+        else if (mode[i] != 'b')
+        {
+            return false;
+        }
+    }
+    switch (mode[0])
+    {
+    case 'r': flags = isUpdate ? O_RDWR : O_RDONLY; break;
+    case 'w': flags = (isUpdate ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC; break;
+    case 'a': flags = (isUpdate ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND; break;
+    default: return false;
+    }
+    flags |= O_CLOEXEC;
+    return true;
+}
+
+// Return -1 and set errno on failure
 //
-DEEGEN_DEFINE_LIB_FUNC(io_input)
+static int WARN_UNUSED OpenFileDescriptor(std::string_view filename, int flags)
 {
-    ThrowError("Library function 'io.input' is not implemented yet!");
+    std::string filenameStr(filename);
+    while (true)
+    {
+        int fd = open(filenameStr.c_str(), flags, 0666);
+        if (fd < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        return fd;
+    }
 }
 
-// 'buf' must be 'limit + 1' bytes long
-// If -1 is returned, it means 'limit' bytes have been read but end-of-line is still not reached.
-// If -2 is returned, it means the file hit EOF without reading in any bytes
-// Otherwise, returns the length of the line, minus the '\n' if it exists.
+// Read a line from the buffer without the trailing '\n'
+// Return nil at end of file
 //
-static size_t WARN_UNUSED TryReadLineOnce(FILE* fp, char* buf, size_t limit)
+static TValue WARN_UNUSED ReadLine(VM* vm, LuaFileHandle* fh, bool& ioError /*out*/)
 {
-    // Set up a sentry value so we know if 'fgets' read exactly 'limit' bytes
+    // The number of bytes at the start of the buffered input known to not contain '\n', so that refills do not rescan them
     //
-    buf[limit] = 1;
+    uint32_t numScanned = 0;
+    while (true)
+    {
+        uint32_t numAvail = fh->GetNumBufferedBytes();
+        char* begin = fh->GetBufferedBytes();
+        if (numScanned < numAvail)
+        {
+            char* nl = reinterpret_cast<char*>(memchr(begin + numScanned, '\n', numAvail - numScanned));
+            if (likely(nl != nullptr))
+            {
+                uint32_t len = static_cast<uint32_t>(nl - begin);
+                TValue result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(begin, len).As());
+                fh->ConsumeBufferedBytes(len + 1);
+                return result;
+            }
+            numScanned = numAvail;
+        }
 
-    // Let fgets read at most 'limit' bytes and append the '\0'
+        ssize_t numRead = fh->FillBuffer();
+        if (numRead <= 0)
+        {
+            // End of file (or error). The last line may not end with '\n'.
+            //
+            numAvail = fh->GetNumBufferedBytes();
+            if (numAvail == 0)
+            {
+                ioError = (numRead < 0);
+                return TValue::Create<tNil>();
+            }
+            TValue result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(fh->GetBufferedBytes(), numAvail).As());
+            fh->ConsumeBufferedBytes(numAvail);
+            return result;
+        }
+    }
+}
+
+// Read the rest of the file. Never returns nil.
+//
+static TValue WARN_UNUSED ReadAll(VM* vm, LuaFileHandle* fh, bool& ioError /*out*/)
+{
+    // For a large regular file, map the rest of the file and create the string from the mapping directly,
+    // which avoids growing the buffer to the size of the file and copying the file content twice
     //
-    char* fgetsRet = fgets(buf, static_cast<int>(limit + 1), fp);
-    if (unlikely(fgetsRet == nullptr))
+    constexpr int64_t x_minSizeToMmap = 1 << 20;
+    struct stat st;
+    if (fstat(fh->m_fd, &st) == 0 && S_ISREG(st.st_mode))
     {
-        // EOF without any bytes read, or error. For error just treat it as EOF for now.
-        //
-        return static_cast<size_t>(-2);
+        off_t pos = lseek(fh->m_fd, 0, SEEK_CUR);
+        uint32_t numBuffered = fh->GetNumBufferedBytes();
+        if (pos >= 0 && st.st_size - pos >= x_minSizeToMmap &&
+            st.st_size - pos + numBuffered < static_cast<int64_t>(std::numeric_limits<uint32_t>::max()))
+        {
+            off_t mapBegin = pos & ~static_cast<off_t>(VM::x_pageSize - 1);
+            size_t mapLen = static_cast<size_t>(st.st_size - mapBegin);
+            void* map = mmap(nullptr, mapLen, PROT_READ, MAP_PRIVATE, fh->m_fd, mapBegin);
+            if (map != MAP_FAILED)
+            {
+                std::ignore = madvise(map, mapLen, MADV_SEQUENTIAL);
+                std::pair<const void*, size_t> pieces[2] = {
+                    std::make_pair(fh->GetBufferedBytes(), static_cast<size_t>(numBuffered)),
+                    std::make_pair(reinterpret_cast<const char*>(map) + (pos - mapBegin), static_cast<size_t>(st.st_size - pos))
+                };
+                TValue result = TValue::Create<tString>(vm->CreateStringObjectFromConcatenation(pieces, 2).As());
+                munmap(map, mapLen);
+                fh->ConsumeBufferedBytes(numBuffered);
+                std::ignore = lseek(fh->m_fd, st.st_size, SEEK_SET);
+                return result;
+            }
+        }
     }
 
-    // If our sentry value 1 is not overwritten, it means 'fgets' stopped short before reading 'x_internalBufferSize' characters.
-    // So a newline (or EOF) must have been encountered. We can quit now.
-    //
-    if (buf[limit] != '\0')
+    ssize_t numRead;
+    while ((numRead = fh->FillBuffer()) > 0) { }
+    ioError = (numRead < 0);
+    uint32_t numAvail = fh->GetNumBufferedBytes();
+    TValue result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(fh->GetBufferedBytes(), numAvail).As());
+    fh->ConsumeBufferedBytes(numAvail);
+    return result;
+}
+
+// Read at most 'n' bytes. Return nil at end of file.
+// If n == 0, return the empty string, or nil at end of file.
+//
+static TValue WARN_UNUSED ReadChars(VM* vm, LuaFileHandle* fh, size_t n, bool& ioError /*out*/)
+{
+    n = std::min(n, static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+    while (fh->GetNumBufferedBytes() < std::max(n, static_cast<size_t>(1)))
     {
-        size_t len = strlen(buf);
-        assert(len < limit);
-        if (len >= 1 && buf[len - 1] == '\n')
+        ssize_t numRead = fh->FillBuffer();
+        if (numRead <= 0)
         {
-            len--;
+            ioError = (numRead < 0);
+            break;
         }
-        return len;
     }
+    uint32_t numAvail = fh->GetNumBufferedBytes();
+    if (numAvail == 0)
+    {
+        return TValue::Create<tNil>();
+    }
+    uint32_t len = static_cast<uint32_t>(std::min(n, static_cast<size_t>(numAvail)));
+    TValue result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(fh->GetBufferedBytes(), len).As());
+    fh->ConsumeBufferedBytes(len);
+    return result;
+}
 
-    // Now we know fgets has read exactly 'limit' characters.
-    //
-    if (buf[limit - 1] == '\n')
+// Read a number (in the format accepted by the Lua parser), return nil on failure
+// Like fscanf in the reference implementation, the characters that look like part of a number are consumed even if they fail to parse
+//
+static TValue WARN_UNUSED ReadNumber(LuaFileHandle* fh, bool& ioError /*out*/)
+{
+    auto peek = [&]() -> int
     {
-        // The line (including '\n') happens to have exactly 'limit' bytes.
-        //
-        return limit - 1;
+        if (fh->GetNumBufferedBytes() == 0)
+        {
+            ssize_t numRead = fh->FillBuffer();
+            if (numRead <= 0)
+            {
+                ioError |= (numRead < 0);
+                return -1;
+            }
+        }
+        return static_cast<unsigned char>(fh->GetBufferedBytes()[0]);
+    };
+
+    int c = peek();
+    while (c != -1 && isspace(c))
+    {
+        fh->ConsumeBufferedBytes(1);
+        c = peek();
     }
 
-    // The line might have more to read.
-    // (Note that it is possible that we have reached EOF here and the file doesn't end with a newline,
-    // but we won't know until we call fgets again).
-    //
-    return static_cast<size_t>(-1);
+    constexpr size_t x_maxNumberLength = 200;
+    char buf[x_maxNumberLength];
+    size_t len = 0;
+    auto accept = [&]() -> bool
+    {
+        if (len == x_maxNumberLength)
+        {
+            return false;
+        }
+        buf[len++] = static_cast<char>(c);
+        fh->ConsumeBufferedBytes(1);
+        c = peek();
+        return true;
+    };
+
+    if (c == '+' || c == '-')
+    {
+        std::ignore = accept();
+    }
+    bool isHex = false;
+    if (c == '0')
+    {
+        std::ignore = accept();
+        if (c == 'x' || c == 'X')
+        {
+            std::ignore = accept();
+            isHex = true;
+        }
+    }
+    while (c != -1 && (isHex ? isxdigit(c) : isdigit(c) || c == '.') && accept()) { }
+    if (c == '.' && isHex)
+    {
+        std::ignore = accept();
+        while (c != -1 && isxdigit(c) && accept()) { }
+    }
+    if (c != -1 && tolower(c) == (isHex ? 'p' : 'e'))
+    {
+        std::ignore = accept();
+        if (c == '+' || c == '-')
+        {
+            std::ignore = accept();
+        }
+        while (c != -1 && isdigit(c) && accept()) { }
+    }
+
+    StrScanResult ssr = TryConvertStringToDoubleWithLuaSemantics(buf, len);
+    if (ssr.fmt != StrScanFmt::STRSCAN_NUM)
+    {
+        return TValue::Create<tNil>();
+    }
+    return TValue::Create<tDouble>(ssr.d);
 }
 
-static HeapPtr<HeapString> NO_INLINE ReadLinesSlowPath(FILE* fp, VM* vm, char* firstChunk, size_t firstChunkLen)
+struct ReadWithFormatsResult
 {
-    // Just use a vector for simplicity now
+    size_t m_numResults;
+    // The ordinal of the invalid format, or -1 if all formats are valid
     //
-    std::vector<std::pair<const void*, size_t>> chunkList;
-    chunkList.push_back(std::make_pair(firstChunk, firstChunkLen));
+    size_t m_badFormatOrd;
+    bool m_ioError;
+};
 
-    constexpr size_t x_chunkSize = 65280;
-    while (true)
+// Implements file:read(...)
+// The results are stored to 'out'. The result for format 'i' is only stored after format 'i' is read, so 'out' may alias 'formats'.
+//
+static ReadWithFormatsResult WARN_UNUSED ReadWithFormats(VM* vm, LuaFileHandle* fh, TValue* formats, size_t numFormats, TValue* out)
+{
+    ReadWithFormatsResult r { .m_numResults = 0, .m_badFormatOrd = static_cast<size_t>(-1), .m_ioError = false };
+    if (!fh->IsReadable())
     {
-        char* buf = new char[x_chunkSize + 1];
-        size_t len = TryReadLineOnce(fp, buf, x_chunkSize);
-        if (len == static_cast<size_t>(-2))
+        errno = EBADF;
+        r.m_ioError = true;
+        return r;
+    }
+    if (!fh->PrepareForRead())
+    {
+        r.m_ioError = true;
+        return r;
+    }
+
+    if (numFormats == 0)
+    {
+        out[0] = ReadLine(vm, fh, r.m_ioError /*out*/);
+        r.m_numResults = 1;
+        return r;
+    }
+
+    for (size_t i = 0; i < numFormats; i++)
+    {
+        TValue fmt = formats[i];
+        TValue result;
+        if (fmt.Is<tDouble>())
         {
-            // It means we reached EOF and the file did not end with a newline, we are done.
-            // We didn't read in anything useful in this iteration.
+            // ReadChars clamps the count to INT32_MAX anyway, and clamping first avoids the UB of converting a huge or infinite double
+            // Note that NaN fails the 'n > 0' check
             //
-            chunkList.push_back(std::make_pair(buf, 0));
-            break;
+            double n = fmt.As<tDouble>();
+            size_t count = (n > 0) ? static_cast<size_t>(std::min(n, static_cast<double>(std::numeric_limits<int32_t>::max()))) : 0;
+            result = ReadChars(vm, fh, count, r.m_ioError /*out*/);
         }
-        if (len == static_cast<size_t>(-1))
+        else if (fmt.Is<tString>())
         {
-            // We read in full x_chunkSize bytes but still may have more to read.
-            //
-            chunkList.push_back(std::make_pair(buf, x_chunkSize));
-            continue;
+            HeapPtr<HeapString> hs = fmt.As<tString>();
+            if (hs->m_length < 2 || hs->m_string[0] != static_cast<uint8_t>('*'))
+            {
+                r.m_badFormatOrd = i;
+                return r;
+            }
+            switch (hs->m_string[1])
+            {
+            case 'l': result = ReadLine(vm, fh, r.m_ioError /*out*/); break;
+            case 'a': result = ReadAll(vm, fh, r.m_ioError /*out*/); break;
+            case 'n': result = ReadNumber(fh, r.m_ioError /*out*/); break;
+            default:
+            {
+                r.m_badFormatOrd = i;
+                return r;
+            }
+            }   /*switch*/
+        }
+        else
+        {
+            r.m_badFormatOrd = i;
+            return r;
         }
 
-        assert(len < x_chunkSize);
-        // We found a newline or EOF, we are done.
-        //
-        chunkList.push_back(std::make_pair(buf, len));
-        break;
+        out[i] = result;
+        r.m_numResults = i + 1;
+        if (result.Is<tNil>() || r.m_ioError)
+        {
+            break;
+        }
     }
+    return r;
+}
 
-    HeapPtr<HeapString> result = vm->CreateStringObjectFromConcatenation(chunkList.data(), chunkList.size()).As();
+// Implements file:write(...)
+// Return the ordinal of the first argument that is not a string or number, or -1 if all arguments are valid
+//
+static size_t WARN_UNUSED WriteValues(VM* vm, LuaFileHandle* fh, TValue* args, size_t numArgs, bool& success /*out*/)
+{
+    success = true;
+    for (size_t i = 0; i < numArgs; i++)
+    {
+        TValue val = args[i];
+        if (val.Is<tDouble>())
+        {
+            success = fh->WriteNumber(vm, val.As<tDouble>());
+        }
+        else if (val.Is<tString>())
+        {
+            HeapString* hs = TranslateToRawPointer(vm, val.As<tString>());
+            success = fh->Write(vm, hs->m_string, hs->m_length);
+        }
+        else
+        {
+            return i;
+        }
+        if (unlikely(!success))
+        {
+            break;
+        }
+    }
+    return static_cast<size_t>(-1);
+}
 
-    // The first element in 'chunkList' is the internal buffer, we must not free it. Free everything else.
-    //
-    for (size_t i = 1; i < chunkList.size(); i++)
+static TValue WARN_UNUSED CreateLinesIterator(VM* vm, TValue file)
+{
+    HeapPtr<FunctionObject> iter = FunctionObject::CreateCFunc(vm, vm->GetLibFnProto<VM::LibFnProto::IoFileLinesIter>(), 1 /*numUpvalues*/).As();
+    TCSet(iter->m_upvalues[0], file);
+    return TValue::Create<tFunction>(iter);
+}
+
+// io.close -- https://www.lua.org/manual/5.1/manual.html#pdf-io.close
+//
+// io.close ([file])
+// Equivalent to file:close(). Without a file, closes the default output file.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_close)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    TValue file = (GetNumArgs() > 0) ? GetArg(0) : GetDefaultFileValue(vm, true /*isOutput*/);
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, file);
+    if (unlikely(fh == nullptr))
     {
-        char* ptr = const_cast<char*>(reinterpret_cast<const char*>(chunkList[i].first));
-        delete [] ptr;
+        ThrowError("bad argument #1 to 'close' (FILE* expected)");
     }
+    if (unlikely(fh->m_isClosed))
+    {
+        ThrowError("attempt to use a closed file");
+    }
+    if (fh->IsStandardStream())
+    {
+        Return(TValue::Create<tNil>(), MakeStringValue(vm, "cannot close standard file"));
+    }
+    if (unlikely(!fh->Close(vm)))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tBool>(true));
+}
 
-    return result;
+// io.flush -- https://www.lua.org/manual/5.1/manual.html#pdf-io.flush
+//
+// io.flush ()
+// Equivalent to file:flush over the default output file.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_flush)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, GetDefaultFileValue(vm, true /*isOutput*/));
+    assert(fh != nullptr);
+    if (unlikely(fh->m_isClosed))
+    {
+        ThrowError("attempt to use a closed file");
+    }
+    if (unlikely(!fh->Flush(vm)))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tBool>(true));
+}
+
+// io.input -- https://www.lua.org/manual/5.1/manual.html#pdf-io.input
+//
+// io.input ([file])
+// When called with a file name, it opens the named file (in text mode), and sets its handle as the default input file.
+// When called with a file handle, it simply sets this file handle as the default input file.
+// When called without parameters, it returns the current default input file.
+//
+// In case of errors this function raises the error, instead of returning an error code.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_input)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    if (GetNumArgs() > 0 && !GetArg(0).Is<tNil>())
+    {
+        TValue arg = GetArg(0);
+        if (arg.Is<tString>())
+        {
+            std::string_view filename = GetStringViewFromHeapString(arg.As<tString>());
+            int fd = OpenFileDescriptor(filename, O_RDONLY | O_CLOEXEC);
+            if (unlikely(fd < 0))
+            {
+                ThrowError(MakeOpenFileErrorMessage(vm, "input", filename, errno));
+            }
+            vm->m_ioDefaultInputFile = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Regular, fd);
+        }
+        else
+        {
+            LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, arg);
+            if (unlikely(fh == nullptr))
+            {
+                ThrowError("bad argument #1 to 'input' (FILE* expected)");
+            }
+            if (unlikely(fh->m_isClosed))
+            {
+                ThrowError("attempt to use a closed file");
+            }
+            vm->m_ioDefaultInputFile = arg.As<tUserdata>();
+        }
+    }
+    Return(GetDefaultFileValue(vm, false /*isOutput*/));
 }
 
 DEEGEN_DEFINE_LIB_FUNC(io_lines_iter)
 {
     VM* vm = VM::GetActiveVMForCurrentThread();
-    constexpr size_t x_internalBufferSize = 8192;
-    char internalBuf[x_internalBufferSize + 1];
-    size_t len = TryReadLineOnce(stdin, internalBuf, x_internalBufferSize);
-    if (len == static_cast<size_t>(-2))
+    HeapPtr<FunctionObject> func = GetStackFrameHeader()->m_func;
+    assert(func->m_numUpvalues == 1);
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, TCGet(func->m_upvalues[0]));
+    assert(fh != nullptr);
+    if (unlikely(fh->m_isClosed))
     {
-        Return(TValue::Create<tNil>());
+        ThrowError("file is already closed");
     }
-    if (len != static_cast<size_t>(-1))
+
+    bool ioError = false;
+    TValue result;
+    if (unlikely(!fh->IsReadable() || !fh->PrepareForRead()))
+    {
+        if (!fh->IsReadable()) { errno = EBADF; }
+        ioError = true;
+    }
+    else
     {
-        assert(len < x_internalBufferSize);
-        Return(TValue::Create<tString>(vm->CreateStringObjectFromRawString(internalBuf, static_cast<uint32_t>(len)).As()));
+        result = ReadLine(vm, fh, ioError /*out*/);
     }
-    HeapPtr<HeapString> result = ReadLinesSlowPath(stdin, vm, internalBuf, x_internalBufferSize);
-    Return(TValue::Create<tString>(result));
+
+    if (unlikely(ioError))
+    {
+        ThrowError(MakeErrnoMessage(vm, "", errno));
+    }
+    if (result.Is<tNil>() && fh->m_closeAtEof)
+    {
+        std::ignore = fh->Close(vm);
+    }
+    Return(result);
 }
 
 // io.lines -- https://www.lua.org/manual/5.1/manual.html#pdf-io.lines
@@ -165,16 +551,35 @@ DEEGEN_DEFINE_LIB_FUNC(io_lines_iter)
 // The call io.lines() (with no file name) is equivalent to io.input():lines(); that is, it iterates over the lines of the
 // default input file. In this case it does not close the file when the loop ends.
 //
-// TODO: This is a makeshift implementation. This is not standard conforming.
-// Currently we are always read from stdin and does not support file input.
-//
 DEEGEN_DEFINE_LIB_FUNC(io_lines)
 {
-    if (GetNumArgs() > 0 && !GetArg(0).Is<tNil>())
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    if (GetNumArgs() == 0 || GetArg(0).Is<tNil>())
+    {
+        TValue file = GetDefaultFileValue(vm, false /*isOutput*/);
+        LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, file);
+        assert(fh != nullptr);
+        if (unlikely(fh->m_isClosed))
+        {
+            ThrowError("attempt to use a closed file");
+        }
+        Return(CreateLinesIterator(vm, file));
+    }
+
+    TValue arg = GetArg(0);
+    if (unlikely(!arg.Is<tString>()))
+    {
+        ThrowError("bad argument #1 to 'lines' (string expected)");
+    }
+    std::string_view filename = GetStringViewFromHeapString(arg.As<tString>());
+    int fd = OpenFileDescriptor(filename, O_RDONLY | O_CLOEXEC);
+    if (unlikely(fd < 0))
     {
-        ThrowError("Library function 'io.lines' with file input is not implemented yet!");
+        ThrowError(MakeOpenFileErrorMessage(vm, "lines", filename, errno));
     }
-    Return(VM_GetLibFunctionObject<VM::LibFn::IoLinesIter>());
+    HeapPtr<HeapCDataObject> file = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Regular, fd);
+    TranslateToRawPointer(vm, file)->GetPayload<LuaFileHandle>()->m_closeAtEof = true;
+    Return(CreateLinesIterator(vm, TValue::Create<tUserdata>(file)));
 }
 
 // io.open -- https://www.lua.org/manual/5.1/manual.html#pdf-io.open
@@ -195,7 +600,41 @@ DEEGEN_DEFINE_LIB_FUNC(io_lines)
 //
 DEEGEN_DEFINE_LIB_FUNC(io_open)
 {
-    ThrowError("Library function 'io.open' is not implemented yet!");
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    if (unlikely(GetNumArgs() == 0 || !GetArg(0).Is<tString>()))
+    {
+        ThrowError("bad argument #1 to 'open' (string expected)");
+    }
+    std::string_view filename = GetStringViewFromHeapString(GetArg(0).As<tString>());
+    std::string_view mode = "r";
+    if (GetNumArgs() > 1 && !GetArg(1).Is<tNil>())
+    {
+        if (unlikely(!GetArg(1).Is<tString>()))
+        {
+            ThrowError("bad argument #2 to 'open' (string expected)");
+        }
+        mode = GetStringViewFromHeapString(GetArg(1).As<tString>());
+    }
+
+    int flags;
+    int fd;
+    if (unlikely(!ParseFileOpenMode(mode, flags /*out*/)))
+    {
+        // Same as what fopen would do in the reference implementation
+        //
+        errno = EINVAL;
+        fd = -1;
+    }
+    else
+    {
+        fd = OpenFileDescriptor(filename, flags);
+    }
+    if (unlikely(fd < 0))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, filename, err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tUserdata>(LuaFileHandle::Create(vm, LuaFileHandle::Kind::Regular, fd)));
 }
 
 // io.output -- https://www.lua.org/manual/5.1/manual.html#pdf-io.output
@@ -205,7 +644,35 @@ DEEGEN_DEFINE_LIB_FUNC(io_open)
 //
 DEEGEN_DEFINE_LIB_FUNC(io_output)
 {
-    ThrowError("Library function 'io.output' is not implemented yet!");
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    if (GetNumArgs() > 0 && !GetArg(0).Is<tNil>())
+    {
+        TValue arg = GetArg(0);
+        if (arg.Is<tString>())
+        {
+            std::string_view filename = GetStringViewFromHeapString(arg.As<tString>());
+            int fd = OpenFileDescriptor(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+            if (unlikely(fd < 0))
+            {
+                ThrowError(MakeOpenFileErrorMessage(vm, "output", filename, errno));
+            }
+            vm->m_ioDefaultOutputFile = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Regular, fd);
+        }
+        else
+        {
+            LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, arg);
+            if (unlikely(fh == nullptr))
+            {
+                ThrowError("bad argument #1 to 'output' (FILE* expected)");
+            }
+            if (unlikely(fh->m_isClosed))
+            {
+                ThrowError("attempt to use a closed file");
+            }
+            vm->m_ioDefaultOutputFile = arg.As<tUserdata>();
+        }
+    }
+    Return(GetDefaultFileValue(vm, true /*isOutput*/));
 }
 
 // io.popen -- https://www.lua.org/manual/5.1/manual.html#pdf-io.popen
@@ -228,7 +695,24 @@ DEEGEN_DEFINE_LIB_FUNC(io_popen)
 //
 DEEGEN_DEFINE_LIB_FUNC(io_read)
 {
-    ThrowError("Library function 'io.read' is not implemented yet!");
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, GetDefaultFileValue(vm, false /*isOutput*/));
+    assert(fh != nullptr);
+    if (unlikely(fh->m_isClosed))
+    {
+        ThrowError("attempt to use a closed file");
+    }
+    ReadWithFormatsResult res = ReadWithFormats(vm, fh, GetStackBase(), GetNumArgs(), GetStackBase() /*out*/);
+    if (unlikely(res.m_badFormatOrd != static_cast<size_t>(-1)))
+    {
+        ThrowError("bad argument to 'read' (invalid format)");
+    }
+    if (unlikely(res.m_ioError))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    ReturnValueRange(GetStackBase(), res.m_numResults);
 }
 
 // io.tmpfile -- https://www.lua.org/manual/5.1/manual.html#pdf-io.tmpfile
@@ -238,7 +722,18 @@ DEEGEN_DEFINE_LIB_FUNC(io_read)
 //
 DEEGEN_DEFINE_LIB_FUNC(io_tmpfile)
 {
-    ThrowError("Library function 'io.tmpfile' is not implemented yet!");
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    // The file is unlinked right away, so it is removed when the file is closed, even if the program crashes
+    //
+    char filename[] = "/tmp/lua_XXXXXX";
+    int fd = mkostemp(filename, O_CLOEXEC);
+    if (unlikely(fd < 0))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    std::ignore = unlink(filename);
+    Return(TValue::Create<tUserdata>(LuaFileHandle::Create(vm, LuaFileHandle::Kind::Regular, fd)));
 }
 
 // io.type -- https://www.lua.org/manual/5.1/manual.html#pdf-io.type
@@ -249,7 +744,17 @@ DEEGEN_DEFINE_LIB_FUNC(io_tmpfile)
 //
 DEEGEN_DEFINE_LIB_FUNC(io_type)
 {
-    ThrowError("Library function 'io.type' is not implemented yet!");
+    if (unlikely(GetNumArgs() == 0))
+    {
+        ThrowError("bad argument #1 to 'type' (value expected)");
+    }
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, GetArg(0));
+    if (fh == nullptr)
+    {
+        Return(TValue::Create<tNil>());
+    }
+    Return(MakeStringValue(vm, fh->m_isClosed ? "closed file" : "file"));
 }
 
 // io.write -- https://www.lua.org/manual/5.1/manual.html#pdf-io.write
@@ -257,51 +762,305 @@ DEEGEN_DEFINE_LIB_FUNC(io_type)
 // io.write (···)
 // Equivalent to io.output():write.
 //
-// TODO: This is a makeshift implementation. This is not standard conforming.
-// Currently we are always printing to stdout.
-//
 DEEGEN_DEFINE_LIB_FUNC(io_write)
 {
     VM* vm = VM::GetActiveVMForCurrentThread();
-    FILE* fp = vm->GetStdout();
-    size_t numElementsToPrint = GetNumArgs();
-    bool success = true;
-    for (uint32_t i = 0; i < numElementsToPrint; i++)
-    {
-        TValue val = GetArg(i);
-#if 0
-        if (val.Is<tInt32>())
+    LuaFileHandle* fh = LuaFileHandle::TryGetFromValue(vm, GetDefaultFileValue(vm, true /*isOutput*/));
+    assert(fh != nullptr);
+    if (unlikely(fh->m_isClosed))
+    {
+        ThrowError("attempt to use a closed file");
+    }
+    bool success;
+    size_t badArgOrd = WriteValues(vm, fh, GetStackBase(), GetNumArgs(), success /*out*/);
+    if (unlikely(badArgOrd != static_cast<size_t>(-1)))
+    {
+        // TODO: make error message consistent with Lua
+        ThrowError("bad argument to 'write' (string expected)");
+    }
+    if (likely(success))
+    {
+        Return(TValue::Create<tBool>(true));
+    }
+    else
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+}
+
+// The methods of the file handles, which are stored in the metatable of the file handles.
+// The file handle is always the first argument.
+//
+// Returns the file handle, or nullptr if the first argument is not an open file handle,
+// in which case 'errMsg' is set to the error to throw
+//
+static LuaFileHandle* WARN_UNUSED GetFileHandleForMethodCall(VM* vm, TValue* args, size_t numArgs, const char*& errMsg /*out*/)
+{
+    LuaFileHandle* fh = (numArgs > 0) ? LuaFileHandle::TryGetFromValue(vm, args[0]) : nullptr;
+    if (unlikely(fh == nullptr))
+    {
+        errMsg = "bad argument #1 (FILE* expected)";
+        return nullptr;
+    }
+    if (unlikely(fh->m_isClosed))
+    {
+        errMsg = "attempt to use a closed file";
+        return nullptr;
+    }
+    return fh;
+}
+
+// file:close -- https://www.lua.org/manual/5.1/manual.html#pdf-file:close
+//
+// file:close ()
+// Closes file. Note that files are automatically closed when their handles are garbage collected, but that takes an
+// unpredictable amount of time to happen.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_close)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    if (fh->IsStandardStream())
+    {
+        Return(TValue::Create<tNil>(), MakeStringValue(vm, "cannot close standard file"));
+    }
+    if (unlikely(!fh->Close(vm)))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tBool>(true));
+}
+
+// file:flush -- https://www.lua.org/manual/5.1/manual.html#pdf-file:flush
+//
+// file:flush ()
+// Saves any written data to file.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_flush)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    if (unlikely(!fh->Flush(vm)))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tBool>(true));
+}
+
+// file:lines -- https://www.lua.org/manual/5.1/manual.html#pdf-file:lines
+//
+// file:lines ()
+// Returns an iterator function that, each time it is called, returns a new line from the file. Therefore, the construction
+//     for line in file:lines() do body end
+// will iterate over all lines of the file. (Unlike io.lines, this function does not close the file when the loop ends.)
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_lines)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    Return(CreateLinesIterator(vm, GetArg(0)));
+}
+
+// file:read -- https://www.lua.org/manual/5.1/manual.html#pdf-file:read
+//
+// file:read (···)
+// Reads the file file, according to the given formats, which specify what to read. For each format, the function returns a
+// string (or a number) with the characters read, or nil if it cannot read data with the specified format. When called without
+// formats, it uses a default format that reads the entire next line.
+//
+// The available formats are
+//     "*n": reads a number; this is the only format that returns a number instead of a string.
+//     "*a": reads the whole file, starting at the current position. On end of file, it returns the empty string.
+//     "*l": reads the next line (skipping the end of line), returning nil on end of file. This is the default format.
+//     number: reads a string with up to this number of characters, returning nil on end of file. If number is zero, it reads
+//             nothing and returns an empty string, or nil on end of file.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_read)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    ReadWithFormatsResult res = ReadWithFormats(vm, fh, GetStackBase() + 1, GetNumArgs() - 1, GetStackBase() /*out*/);
+    if (unlikely(res.m_badFormatOrd != static_cast<size_t>(-1)))
+    {
+        ThrowError("bad argument to 'read' (invalid format)");
+    }
+    if (unlikely(res.m_ioError))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    ReturnValueRange(GetStackBase(), res.m_numResults);
+}
+
+// file:seek -- https://www.lua.org/manual/5.1/manual.html#pdf-file:seek
+//
+// file:seek ([whence] [, offset])
+// Sets and gets the file position, measured from the beginning of the file, to the position given by offset plus a base specified
+// by the string whence, as follows:
+//     "set": base is position 0 (beginning of the file);
+//     "cur": base is current position;
+//     "end": base is end of file;
+// In case of success, function seek returns the final file position, measured in bytes from the beginning of the file. If this
+// function fails, it returns nil, plus a string describing the error.
+//
+// The default value for whence is "cur", and for offset is 0.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_seek)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+
+    int whence = SEEK_CUR;
+    if (GetNumArgs() > 1 && !GetArg(1).Is<tNil>())
+    {
+        TValue tvWhence = GetArg(1);
+        if (unlikely(!tvWhence.Is<tString>()))
         {
-            char buf[x_default_tostring_buffersize_int];
-            char* bufEnd = StringifyInt32UsingDefaultLuaFormattingOptions(buf /*out*/, val.As<tInt32>());
-            size_t len = static_cast<size_t>(bufEnd - buf);
-            size_t written = fwrite(buf, 1, len, fp);
-            if (unlikely(len != written)) { success = false; break; }
+            ThrowError("bad argument #1 to 'seek' (string expected)");
         }
+        std::string_view s = GetStringViewFromHeapString(tvWhence.As<tString>());
+        if (s == "set") { whence = SEEK_SET; }
+        else if (s == "cur") { whence = SEEK_CUR; }
+        else if (s == "end") { whence = SEEK_END; }
         else
-#endif
-        if (val.Is<tDouble>())
         {
-            double dbl = val.As<tDouble>();
-            char buf[x_default_tostring_buffersize_double];
-            char* bufEnd = StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, dbl);
-            size_t len = static_cast<size_t>(bufEnd - buf);
-            size_t written = fwrite(buf, 1, len, fp);
-            if (unlikely(len != written)) { success = false; break; }
+            ThrowError("bad argument #1 to 'seek' (invalid option)");
         }
-        else if (val.Is<tString>())
+    }
+
+    int64_t offset = 0;
+    if (GetNumArgs() > 2 && !GetArg(2).Is<tNil>())
+    {
+        TValue tvOffset = GetArg(2);
+        if (unlikely(!tvOffset.Is<tDouble>()))
         {
-            HeapString* hs = TranslateToRawPointer(vm, val.As<tString>());
-            size_t written = fwrite(hs->m_string, sizeof(char), hs->m_length /*length*/, fp);
-            if (unlikely(hs->m_length != written)) { success = false; break; }
+            ThrowError("bad argument #2 to 'seek' (number expected)");
         }
-        else
+        // Converting a NaN or a double outside the range of int64_t is UB, and no file offset can be that large anyway,
+        // so fail the same way as lseek fails on an invalid offset
+        //
+        double offsetDouble = tvOffset.As<tDouble>();
+        if (unlikely(!(offsetDouble >= -9223372036854775808.0 && offsetDouble < 9223372036854775808.0)))
         {
-            // TODO: make error message consistent with Lua
-            ThrowError("bad argument to 'write' (string expected)");
+            Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", EINVAL), TValue::Create<tDouble>(EINVAL));
         }
+        offset = static_cast<int64_t>(offsetDouble);
     }
 
+    int64_t pos = fh->Seek(vm, whence, offset);
+    if (unlikely(pos < 0))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tDouble>(static_cast<double>(pos)));
+}
+
+// file:setvbuf -- https://www.lua.org/manual/5.1/manual.html#pdf-file:setvbuf
+//
+// file:setvbuf (mode [, size])
+// Sets the buffering mode for an output file. There are three available modes:
+//     "no": no buffering; the result of any output operation appears immediately.
+//     "full": full buffering; output operation is performed only when the buffer is full (or when you explicitly flush the file).
+//     "line": line buffering; output is buffered until a newline is output or there is any input from some special files
+//             (such as a terminal device).
+// For the last two cases, size specifies the size of the buffer, in bytes. The default is an appropriate size.
+//
+// The size is ignored: the internal buffer of the file handle is always used.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_setvbuf)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    if (unlikely(GetNumArgs() < 2 || !GetArg(1).Is<tString>()))
+    {
+        ThrowError("bad argument #1 to 'setvbuf' (string expected)");
+    }
+    std::string_view mode = GetStringViewFromHeapString(GetArg(1).As<tString>());
+    LuaFileHandle::BufferMode bufferMode;
+    if (mode == "no") { bufferMode = LuaFileHandle::BufferMode::No; }
+    else if (mode == "full") { bufferMode = LuaFileHandle::BufferMode::Full; }
+    else if (mode == "line") { bufferMode = LuaFileHandle::BufferMode::Line; }
+    else
+    {
+        ThrowError("bad argument #1 to 'setvbuf' (invalid option)");
+    }
+
+    bool success = fh->Flush(vm);
+    fh->m_bufferMode = bufferMode;
+    if (fh->m_kind == LuaFileHandle::Kind::Stdout)
+    {
+        vm->SetStdoutBufferMode((bufferMode == LuaFileHandle::BufferMode::No) ? VM::StdoutBufferMode::No :
+                                ((bufferMode == LuaFileHandle::BufferMode::Line) ? VM::StdoutBufferMode::Line : VM::StdoutBufferMode::Full));
+    }
+    if (fh->m_kind == LuaFileHandle::Kind::Stdout || fh->m_kind == LuaFileHandle::Kind::Stderr)
+    {
+        FILE* fp = (fh->m_kind == LuaFileHandle::Kind::Stdout) ? vm->GetStdout() : vm->GetStderr();
+        int stdioMode = (bufferMode == LuaFileHandle::BufferMode::No) ? _IONBF : ((bufferMode == LuaFileHandle::BufferMode::Line) ? _IOLBF : _IOFBF);
+        success = success && (setvbuf(fp, nullptr, stdioMode, BUFSIZ) == 0);
+    }
+    if (unlikely(!success))
+    {
+        int err = errno;
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+    Return(TValue::Create<tBool>(true));
+}
+
+// file:write -- https://www.lua.org/manual/5.1/manual.html#pdf-file:write
+//
+// file:write (···)
+// Writes the value of each of its arguments to the file. The arguments must be strings or numbers. To write other values, use
+// tostring or string.format before write.
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_write)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    const char* errMsg;
+    LuaFileHandle* fh = GetFileHandleForMethodCall(vm, GetStackBase(), GetNumArgs(), errMsg /*out*/);
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError(errMsg);
+    }
+    bool success;
+    size_t badArgOrd = WriteValues(vm, fh, GetStackBase() + 1, GetNumArgs() - 1, success /*out*/);
+    if (unlikely(badArgOrd != static_cast<size_t>(-1)))
+    {
+        ThrowError("bad argument to 'write' (string expected)");
+    }
     if (likely(success))
     {
         Return(TValue::Create<tBool>(true));
@@ -309,10 +1068,27 @@ DEEGEN_DEFINE_LIB_FUNC(io_write)
     else
     {
         int err = errno;
-        const char* errstr = strerror(err);
-        TValue tvErrStr = TValue::CreatePointer(vm->CreateStringObjectFromRawString(errstr, static_cast<uint32_t>(strlen(errstr))));
-        Return(TValue::Create<tNil>(), tvErrStr, TValue::Create<tDouble>(err));
+        Return(TValue::Create<tNil>(), MakeErrnoMessage(vm, "", err), TValue::Create<tDouble>(err));
+    }
+}
+
+// The __tostring metamethod of the file handles
+//
+DEEGEN_DEFINE_LIB_FUNC(io_file_tostring)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    LuaFileHandle* fh = (GetNumArgs() > 0) ? LuaFileHandle::TryGetFromValue(vm, GetArg(0)) : nullptr;
+    if (unlikely(fh == nullptr))
+    {
+        ThrowError("bad argument #1 to 'tostring' (FILE* expected)");
+    }
+    if (fh->m_isClosed)
+    {
+        Return(MakeStringValue(vm, "file (closed)"));
     }
+    char buf[100];
+    snprintf(buf, sizeof(buf), "file (%p)", static_cast<void*>(TranslateToRawPointer(vm, GetArg(0).As<tUserdata>())));
+    Return(MakeStringValue(vm, buf));
 }
 
 DEEGEN_END_LIB_FUNC_DEFINITIONS
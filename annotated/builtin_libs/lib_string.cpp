@@ -2,6 +2,519 @@
 #include "lualib_tonumber_util.h"
 #include "runtime_utils.h"
 #include "lj_strfmt.h"
+#include "lualib_pattern_matcher.h"
+#include "bytecode_serializer.h"
+
+// Get the string object for a string argument, converting a number to a string as Lua does.
+// Returns false if the argument is neither a string nor a number.
+//
+static bool WARN_UNUSED TryGetStringObjectFromArg(VM* vm, TValue tv, HeapPtr<HeapString>& result /*out*/)
+{
+    if (likely(tv.Is<tString>()))
+    {
+        result = tv.As<tString>();
+        return true;
+    }
+    char buf[std::max(x_default_tostring_buffersize_double, x_default_tostring_buffersize_int)];
+    char* bufEnd;
+    if (tv.Is<tDouble>())
+    {
+        bufEnd = StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, tv.As<tDouble>());
+    }
+    else if (tv.Is<tInt32>())
+    {
+        bufEnd = StringifyInt32UsingDefaultLuaFormattingOptions(buf /*out*/, tv.As<tInt32>());
+    }
+    else
+    {
+        return false;
+    }
+    result = vm->CreateStringObjectFromRawString(buf, static_cast<uint32_t>(bufEnd - buf)).As();
+    return true;
+}
+
+static const char* WARN_UNUSED GetTypeNameForErrorMessage(TValue tv)
+{
+    if (tv.Is<tDouble>() || tv.Is<tInt32>())
+    {
+        return "number";
+    }
+    if (tv.Is<tMIV>())
+    {
+        return tv.Is<tNil>() ? "nil" : "boolean";
+    }
+    assert(tv.Is<tHeapEntity>());
+    switch (tv.GetHeapEntityType())
+    {
+    case HeapEntityType::String: return "string";
+    case HeapEntityType::Function: return "function";
+    case HeapEntityType::Table: return "table";
+    case HeapEntityType::Thread: return "thread";
+    default: return "userdata";
+    }
+}
+
+static void AppendToStringStream(SimpleTempStringStream& ss, const void* data, size_t len)
+{
+    char* ptr = ss.Reserve(len);
+    memcpy(ptr, data, len);
+    ss.Update(ptr + len);
+}
+
+static void AppendNumberToStringStream(SimpleTempStringStream& ss, double value)
+{
+    char* ptr = ss.Reserve(x_default_tostring_buffersize_double);
+    ss.Update(StringifyDoubleUsingDefaultLuaFormattingOptions(ptr /*out*/, value));
+}
+
+// The common implementation of string.find (isFind = true) and string.match (isFind = false)
+// The results are written to 'out', and 'numResults' is 0 if there is no match.
+//
+static LuaPatternError WARN_UNUSED StringFindOrMatchImpl(VM* vm, HeapPtr<HeapString> str, HeapPtr<HeapString> pattern, int64_t init, bool isFind, bool isPlain, TValue* out /*out*/, size_t& numResults /*out*/)
+{
+    HeapString* hs = TranslateToRawPointer(vm, str);
+    const char* s = reinterpret_cast<const char*>(hs->m_string);
+    int64_t len = static_cast<int64_t>(hs->m_length);
+
+    // Note that Lua 5.1 starts the search at the end of the string if 'init' is beyond it
+    //
+    if (init < 0) { init += len + 1; }
+    init = std::min(std::max(init - 1, static_cast<int64_t>(0)), len);
+
+    numResults = 0;
+    if (isFind && isPlain)
+    {
+        HeapString* ps = TranslateToRawPointer(vm, pattern);
+        const void* res = memmem(s + init, static_cast<size_t>(len - init), ps->m_string, ps->m_length);
+        if (res != nullptr)
+        {
+            int64_t offset = reinterpret_cast<const char*>(res) - s;
+            out[0] = TValue::Create<tDouble>(static_cast<double>(offset + 1));
+            out[1] = TValue::Create<tDouble>(static_cast<double>(offset + ps->m_length));
+            numResults = 2;
+        }
+        return LuaPatternError::NoError;
+    }
+
+    CompiledLuaPattern* cp = LuaPatternCache::Get(vm, pattern, true /*caretIsAnchor*/);
+    if (unlikely(cp->m_compileError != LuaPatternError::NoError))
+    {
+        return cp->m_compileError;
+    }
+
+    LuaPatternMatcher matcher(cp, s, static_cast<size_t>(len));
+    const char* matchEnd;
+    const char* matchBegin = matcher.Find(s + init, matchEnd /*out*/);
+    if (matchBegin == nullptr)
+    {
+        return matcher.m_error;
+    }
+
+    if (isFind)
+    {
+        out[0] = TValue::Create<tDouble>(static_cast<double>(matchBegin - s + 1));
+        out[1] = TValue::Create<tDouble>(static_cast<double>(matchEnd - s));
+        for (uint32_t i = 0; i < matcher.m_level; i++)
+        {
+            out[2 + i] = matcher.GetCapture(vm, i, matchBegin, matchEnd);
+        }
+        numResults = 2 + matcher.m_level;
+    }
+    else
+    {
+        uint32_t n = matcher.GetNumResultValues();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            out[i] = matcher.GetCapture(vm, i, matchBegin, matchEnd);
+        }
+        numResults = n;
+    }
+    return matcher.m_error;
+}
+
+// The state of a string.gsub call
+// For a function or table replacement, the user program may throw or yield in the middle of the gsub, so the state is
+// stored into the stack frame before every call (see GsubPutStateToStack), and only lives in C++ between two calls.
+//
+struct LuaGsubState
+{
+    SimpleTempStringStream m_output;
+    // The offset where the search for the next match starts
+    //
+    uint32_t m_srcPos;
+    // The match being replaced
+    //
+    uint32_t m_matchBegin;
+    uint32_t m_matchEnd;
+    bool m_isAnchored;
+    bool m_isFinished;
+    int64_t m_numMatches;
+    int64_t m_maxMatches;
+};
+
+enum class GsubStepResult
+{
+    Done,
+    // A function must be called to get the replacement value of the current match
+    //
+    NeedCall,
+    Error
+};
+
+// Append the replacement for the current match given by a replacement string, in which '%0' to '%9' refers to the captures
+//
+static bool WARN_UNUSED GsubAppendStringReplacement(LuaGsubState* state, LuaPatternMatcher& matcher, HeapString* repl, const char* matchBegin, const char* matchEnd)
+{
+    const char* r = reinterpret_cast<const char*>(repl->m_string);
+    const char* rEnd = r + repl->m_length;
+    while (r < rEnd)
+    {
+        const char* esc = reinterpret_cast<const char*>(memchr(r, '%', static_cast<size_t>(rEnd - r)));
+        if (esc == nullptr)
+        {
+            AppendToStringStream(state->m_output, r, static_cast<size_t>(rEnd - r));
+            break;
+        }
+        AppendToStringStream(state->m_output, r, static_cast<size_t>(esc - r));
+        // As in Lua 5.1, a '%' at the end of the replacement string escapes the terminating '\0'
+        //
+        char c = *(esc + 1);
+        r = std::min(esc + 2, rEnd);
+        if (!isdigit(static_cast<unsigned char>(c)))
+        {
+            AppendToStringStream(state->m_output, &c, 1);
+            continue;
+        }
+        const char* capBegin;
+        size_t capLen;
+        uint32_t capOrd = (c == '0') ? 0 : static_cast<uint32_t>(c - '1');
+        if (c == '0')
+        {
+            capBegin = matchBegin;
+            capLen = static_cast<size_t>(matchEnd - matchBegin);
+        }
+        else if (!matcher.GetCaptureBytes(capOrd, matchBegin, matchEnd, capBegin /*out*/, capLen /*out*/))
+        {
+            return false;
+        }
+        if (capBegin == nullptr)
+        {
+            AppendNumberToStringStream(state->m_output, static_cast<double>(capLen));
+        }
+        else
+        {
+            AppendToStringStream(state->m_output, capBegin, capLen);
+        }
+    }
+    return true;
+}
+
+// Append the replacement for the current match given by the value from the replacement table or function
+//
+static bool WARN_UNUSED GsubAppendReplacementValue(LuaGsubState* state, const char* src, TValue value, TValue& errMsg /*out*/)
+{
+    if (!value.IsTruthy())
+    {
+        // Keep the original match
+        //
+        AppendToStringStream(state->m_output, src + state->m_matchBegin, state->m_matchEnd - state->m_matchBegin);
+    }
+    else if (value.Is<tString>())
+    {
+        HeapPtr<HeapString> hs = value.As<tString>();
+        AppendToStringStream(state->m_output, TranslateToRawPointer(hs->m_string), hs->m_length);
+    }
+    else if (value.Is<tDouble>())
+    {
+        AppendNumberToStringStream(state->m_output, value.As<tDouble>());
+    }
+    else if (value.Is<tInt32>())
+    {
+        AppendNumberToStringStream(state->m_output, value.As<tInt32>());
+    }
+    else
+    {
+        char msg[100];
+        snprintf(msg, 100, "invalid replacement value (a %s)", GetTypeNameForErrorMessage(value));
+        errMsg = MakeErrorMessage(msg);
+        return false;
+    }
+    return true;
+}
+
+static void GsubAdvancePastMatch(LuaGsubState* state, const char* src, uint32_t srcLen)
+{
+    if (state->m_matchEnd > state->m_matchBegin)
+    {
+        state->m_srcPos = state->m_matchEnd;
+    }
+    else if (state->m_matchBegin < srcLen)
+    {
+        // An empty match, copy one character and continue after it
+        //
+        AppendToStringStream(state->m_output, src + state->m_matchBegin, 1);
+        state->m_srcPos = state->m_matchBegin + 1;
+    }
+    else
+    {
+        state->m_srcPos = srcLen;
+        state->m_isFinished = true;
+    }
+    if (state->m_isAnchored)
+    {
+        state->m_isFinished = true;
+    }
+}
+
+// The stack frame layout of string.gsub when the replacement is a function or a table
+//
+// Slot 0: the string
+// Slot 1: the pattern
+// Slot 2: the replacement
+// Slot 3-8: the scalar fields of LuaGsubState
+// Slot 9: h (int32), the number of output pieces
+// Slot [10, 10 + h): the output produced so far, as a stack of strings. Similar to luaL_Buffer in official Lua,
+//     every piece is longer than the piece above it, so h is O(log(output length)) and each byte is copied O(log) times.
+// The call frame for the replacement function (or '__index' metamethod) starts right after the output pieces.
+//
+constexpr size_t x_gsubSlotForString = 0;
+constexpr size_t x_gsubSlotForPattern = 1;
+constexpr size_t x_gsubSlotForRepl = 2;
+constexpr size_t x_gsubSlotForSrcPos = 3;
+constexpr size_t x_gsubSlotForMatchBegin = 4;
+constexpr size_t x_gsubSlotForMatchEnd = 5;
+constexpr size_t x_gsubSlotForNumMatches = 6;
+constexpr size_t x_gsubSlotForMaxMatches = 7;
+constexpr size_t x_gsubSlotForIsFinished = 8;
+constexpr size_t x_gsubSlotForNumPieces = 9;
+constexpr size_t x_gsubSlotForPieces = 10;
+
+static TValue* WARN_UNUSED GsubGetCallFrame(TValue* sb)
+{
+    assert(sb[x_gsubSlotForNumPieces].Is<tInt32>() && sb[x_gsubSlotForNumPieces].As<tInt32>() >= 0);
+    return sb + x_gsubSlotForPieces + static_cast<size_t>(sb[x_gsubSlotForNumPieces].As<tInt32>());
+}
+
+// Move the content of 'state->m_output' to the output pieces in the stack frame
+//
+static void GsubFlushOutputToStack(VM* vm, LuaGsubState* state, TValue* sb)
+{
+    if (state->m_output.Len() > 0)
+    {
+        TValue* pieces = sb + x_gsubSlotForPieces;
+        int32_t h = sb[x_gsubSlotForNumPieces].As<tInt32>();
+        pieces[h] = TValue::Create<tString>(vm->CreateStringObjectFromRawString(state->m_output.Begin(), static_cast<uint32_t>(state->m_output.Len())).As());
+        h++;
+        while (h >= 2 && pieces[h - 2].As<tString>()->m_length <= pieces[h - 1].As<tString>()->m_length)
+        {
+            pieces[h - 2] = TValue::Create<tString>(vm->CreateStringObjectFromConcatenation(pieces + h - 2, 2 /*len*/).As());
+            h--;
+        }
+        sb[x_gsubSlotForNumPieces] = TValue::Create<tInt32>(h);
+    }
+    state->m_output.Destroy();
+    state->m_output.Clear();
+}
+
+// Store 'state' into the stack frame. After this, 'state' holds no resource and can be discarded.
+//
+static void GsubPutStateToStack(VM* vm, LuaGsubState* state, TValue* sb)
+{
+    GsubFlushOutputToStack(vm, state, sb);
+    sb[x_gsubSlotForSrcPos] = TValue::Create<tDouble>(state->m_srcPos);
+    sb[x_gsubSlotForMatchBegin] = TValue::Create<tDouble>(state->m_matchBegin);
+    sb[x_gsubSlotForMatchEnd] = TValue::Create<tDouble>(state->m_matchEnd);
+    sb[x_gsubSlotForNumMatches] = TValue::Create<tDouble>(static_cast<double>(state->m_numMatches));
+    sb[x_gsubSlotForMaxMatches] = TValue::Create<tDouble>(static_cast<double>(state->m_maxMatches));
+    sb[x_gsubSlotForIsFinished] = TValue::Create<tBool>(state->m_isFinished);
+}
+
+static void GsubGetStateFromStack(TValue* sb, LuaGsubState* state /*out*/)
+{
+    assert(state->m_output.Len() == 0);
+    state->m_srcPos = static_cast<uint32_t>(sb[x_gsubSlotForSrcPos].As<tDouble>());
+    state->m_matchBegin = static_cast<uint32_t>(sb[x_gsubSlotForMatchBegin].As<tDouble>());
+    state->m_matchEnd = static_cast<uint32_t>(sb[x_gsubSlotForMatchEnd].As<tDouble>());
+    state->m_numMatches = static_cast<int64_t>(sb[x_gsubSlotForNumMatches].As<tDouble>());
+    state->m_maxMatches = static_cast<int64_t>(sb[x_gsubSlotForMaxMatches].As<tDouble>());
+    state->m_isFinished = sb[x_gsubSlotForIsFinished].As<tBool>();
+}
+
+// Continue the string.gsub from 'state->m_srcPos' until it is done or a function needs to be called.
+// In the latter case, the state is stored into the stack frame 'sb', and the function and its arguments are written to
+// the call frame given by GsubGetCallFrame. 'sb' may be nullptr if the replacement is a string.
+//
+static GsubStepResult WARN_UNUSED GsubRun(VM* vm, LuaGsubState* state, HeapPtr<HeapString> str, HeapPtr<HeapString> pattern, TValue repl, TValue* sb, size_t& numCallArgs /*out*/, TValue& errMsg /*out*/)
+{
+    CompiledLuaPattern* cp = LuaPatternCache::Get(vm, pattern, true /*caretIsAnchor*/);
+    if (unlikely(cp->m_compileError != LuaPatternError::NoError))
+    {
+        errMsg = MakeErrorMessage(GetLuaPatternErrorMessage(cp->m_compileError));
+        return GsubStepResult::Error;
+    }
+    state->m_isAnchored = cp->m_isAnchored;
+
+    HeapString* hs = TranslateToRawPointer(vm, str);
+    const char* src = reinterpret_cast<const char*>(hs->m_string);
+    uint32_t srcLen = hs->m_length;
+    LuaPatternMatcher matcher(cp, src, srcLen);
+
+    while (!state->m_isFinished && state->m_numMatches < state->m_maxMatches)
+    {
+        const char* cur = src + state->m_srcPos;
+        const char* matchEnd;
+        const char* matchBegin = matcher.Find(cur, matchEnd /*out*/);
+        if (matchBegin == nullptr)
+        {
+            if (unlikely(matcher.m_error != LuaPatternError::NoError))
+            {
+                errMsg = MakeErrorMessage(GetLuaPatternErrorMessage(matcher.m_error));
+                return GsubStepResult::Error;
+            }
+            break;
+        }
+
+        AppendToStringStream(state->m_output, cur, static_cast<size_t>(matchBegin - cur));
+        state->m_numMatches++;
+        state->m_matchBegin = static_cast<uint32_t>(matchBegin - src);
+        state->m_matchEnd = static_cast<uint32_t>(matchEnd - src);
+
+        if (repl.Is<tString>())
+        {
+            if (unlikely(!GsubAppendStringReplacement(state, matcher, TranslateToRawPointer(vm, repl.As<tString>()), matchBegin, matchEnd)))
+            {
+                errMsg = MakeErrorMessage(GetLuaPatternErrorMessage(matcher.m_error));
+                return GsubStepResult::Error;
+            }
+        }
+        else if (repl.Is<tFunction>())
+        {
+            GsubPutStateToStack(vm, state, sb);
+            TValue* callFrame = GsubGetCallFrame(sb);
+            uint32_t n = matcher.GetNumResultValues();
+            callFrame[0] = repl;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                callFrame[x_numSlotsForStackFrameHeader + i] = matcher.GetCapture(vm, i, matchBegin, matchEnd);
+            }
+            if (unlikely(matcher.m_error != LuaPatternError::NoError))
+            {
+                errMsg = MakeErrorMessage(GetLuaPatternErrorMessage(matcher.m_error));
+                return GsubStepResult::Error;
+            }
+            numCallArgs = n;
+            return GsubStepResult::NeedCall;
+        }
+        else
+        {
+            assert(repl.Is<tTable>());
+            TValue key = matcher.GetCapture(vm, 0, matchBegin, matchEnd);
+            if (unlikely(matcher.m_error != LuaPatternError::NoError))
+            {
+                errMsg = MakeErrorMessage(GetLuaPatternErrorMessage(matcher.m_error));
+                return GsubStepResult::Error;
+            }
+
+            // Index the table with the '__index' metamethod semantics
+            //
+            TValue base = repl;
+            TValue value = TValue::Create<tNil>();
+            for (size_t depth = 0; ; depth++)
+            {
+                if (unlikely(depth >= 100))
+                {
+                    errMsg = MakeErrorMessage("loop in gettable");
+                    return GsubStepResult::Error;
+                }
+                TValue metamethod;
+                if (likely(base.Is<tTable>()))
+                {
+                    HeapPtr<TableObject> tab = base.As<tTable>();
+                    if (key.Is<tDouble>())
+                    {
+                        GetByIntegerIndexICInfo icInfo;
+                        TableObject::PrepareGetByIntegerIndex(tab, icInfo /*out*/);
+                        value = TableObject::GetByDoubleVal(tab, key.As<tDouble>(), icInfo);
+                    }
+                    else
+                    {
+                        GetByIdICInfo icInfo;
+                        TableObject::PrepareGetById(tab, UserHeapPointer<void> { key.As<tHeapEntity>() }, icInfo /*out*/);
+                        value = TableObject::GetById(tab, key.As<tHeapEntity>(), icInfo);
+                    }
+                    if (!value.Is<tNil>())
+                    {
+                        break;
+                    }
+                    metamethod = GetMetamethodForValue(base, LuaMetamethodKind::Index);
+                    if (metamethod.Is<tNil>())
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    metamethod = GetMetamethodForValue(base, LuaMetamethodKind::Index);
+                    if (unlikely(metamethod.Is<tNil>()))
+                    {
+                        char msg[100];
+                        snprintf(msg, 100, "attempt to index a %s value", GetTypeNameForErrorMessage(base));
+                        errMsg = MakeErrorMessage(msg);
+                        return GsubStepResult::Error;
+                    }
+                }
+                if (metamethod.Is<tFunction>())
+                {
+                    GsubPutStateToStack(vm, state, sb);
+                    TValue* callFrame = GsubGetCallFrame(sb);
+                    callFrame[0] = metamethod;
+                    callFrame[x_numSlotsForStackFrameHeader] = base;
+                    callFrame[x_numSlotsForStackFrameHeader + 1] = key;
+                    numCallArgs = 2;
+                    return GsubStepResult::NeedCall;
+                }
+                base = metamethod;
+            }
+            if (unlikely(!GsubAppendReplacementValue(state, src, value, errMsg /*out*/)))
+            {
+                return GsubStepResult::Error;
+            }
+        }
+        GsubAdvancePastMatch(state, src, srcLen);
+    }
+
+    AppendToStringStream(state->m_output, src + state->m_srcPos, srcLen - state->m_srcPos);
+    return GsubStepResult::Done;
+}
+
+// Create the result string, and release the resource held by 'state'
+// 'sb' is the stack frame holding the output pieces, or nullptr if the replacement is a string
+//
+static TValue WARN_UNUSED GsubCreateResultString(VM* vm, LuaGsubState* state, HeapPtr<HeapString> str, TValue* sb)
+{
+    if (state->m_numMatches == 0)
+    {
+        state->m_output.Destroy();
+        return TValue::Create<tString>(str);
+    }
+    if (sb == nullptr)
+    {
+        TValue result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(state->m_output.Begin(), static_cast<uint32_t>(state->m_output.Len())).As());
+        state->m_output.Destroy();
+        return result;
+    }
+    GsubFlushOutputToStack(vm, state, sb);
+    int32_t h = sb[x_gsubSlotForNumPieces].As<tInt32>();
+    if (h == 0)
+    {
+        return TValue::Create<tString>(vm->m_emptyString);
+    }
+    if (h == 1)
+    {
+        return sb[x_gsubSlotForPieces];
+    }
+    return TValue::Create<tString>(vm->CreateStringObjectFromConcatenation(sb + x_gsubSlotForPieces, static_cast<size_t>(h)).As());
+}
 
 // string.byte -- https://www.lua.org/manual/5.1/manual.html#pdf-string.byte
 //
@@ -145,9 +658,33 @@ DEEGEN_DEFINE_LIB_FUNC(string_char)
 // Returns a string containing a binary representation of the given function, so that a later loadstring on this string returns a copy
 // of the function. function must be a Lua function without upvalues.
 //
+// The binary chunk can be loaded by load, loadstring and loadfile. It is only valid for the same build of the engine.
+//
 DEEGEN_DEFINE_LIB_FUNC(string_dump)
 {
-    ThrowError("Library function 'string.dump' is not implemented yet!");
+    if (unlikely(GetNumArgs() < 1))
+    {
+        ThrowError("bad argument #1 to 'dump' (function expected, got no value)");
+    }
+    if (unlikely(!GetArg(0).Is<tFunction>()))
+    {
+        ThrowError("bad argument #1 to 'dump' (function expected)");
+    }
+
+    HeapPtr<FunctionObject> func = GetArg(0).As<tFunction>();
+    ExecutableCode* ec = TranslateToRawPointer(TCGet(func->m_executable).As());
+    if (unlikely(!ec->IsBytecodeFunction()))
+    {
+        ThrowError("unable to dump given function");
+    }
+
+    UnlinkedCodeBlock* ucb = static_cast<CodeBlock*>(ec)->m_owner;
+    HeapPtr<HeapString> res;
+    if (unlikely(!TryDumpUnlinkedCodeBlockTree(VM::GetActiveVMForCurrentThread(), ucb, res /*out*/)))
+    {
+        ThrowError("unable to dump given function");
+    }
+    Return(TValue::Create<tString>(res));
 }
 
 // string.find -- https://www.lua.org/manual/5.1/manual.html#pdf-string.find
@@ -163,7 +700,48 @@ DEEGEN_DEFINE_LIB_FUNC(string_dump)
 //
 DEEGEN_DEFINE_LIB_FUNC(string_find)
 {
-    ThrowError("Library function 'string.find' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs < 2))
+    {
+        ThrowError(numArgs == 0 ? "bad argument #1 to 'find' (string expected, got no value)" : "bad argument #2 to 'find' (string expected, got no value)");
+    }
+
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    HeapPtr<HeapString> str;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(0), str /*out*/)))
+    {
+        ThrowError("bad argument #1 to 'find' (string expected)");
+    }
+    HeapPtr<HeapString> pattern;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(1), pattern /*out*/)))
+    {
+        ThrowError("bad argument #2 to 'find' (string expected)");
+    }
+
+    int64_t init = 1;
+    if (numArgs >= 3 && !GetArg(2).Is<tNil>())
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(2));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #3 to 'find' (number expected)");
+        }
+        init = static_cast<int64_t>(val);
+    }
+    bool isPlain = (numArgs >= 4 && GetArg(3).IsTruthy());
+
+    TValue* sb = GetStackBase();
+    size_t numResults;
+    LuaPatternError err = StringFindOrMatchImpl(vm, str, pattern, init, true /*isFind*/, isPlain, sb /*out*/, numResults /*out*/);
+    if (unlikely(err != LuaPatternError::NoError))
+    {
+        ThrowError(GetLuaPatternErrorMessage(err));
+    }
+    if (numResults == 0)
+    {
+        Return(TValue::Create<tNil>());
+    }
+    ReturnValueRange(sb, numResults);
 }
 
 // string.format -- https://www.lua.org/manual/5.1/manual.html#pdf-string.format
@@ -246,7 +824,92 @@ DEEGEN_DEFINE_LIB_FUNC(string_format)
 //
 DEEGEN_DEFINE_LIB_FUNC(string_gmatch)
 {
-    ThrowError("Library function 'string.gmatch' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs < 2))
+    {
+        ThrowError(numArgs == 0 ? "bad argument #1 to 'gmatch' (string expected, got no value)" : "bad argument #2 to 'gmatch' (string expected, got no value)");
+    }
+
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    HeapPtr<HeapString> str;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(0), str /*out*/)))
+    {
+        ThrowError("bad argument #1 to 'gmatch' (string expected)");
+    }
+    HeapPtr<HeapString> pattern;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(1), pattern /*out*/)))
+    {
+        ThrowError("bad argument #2 to 'gmatch' (string expected)");
+    }
+
+    // The iterator holds the string, the pattern and the offset where the next search starts
+    //
+    HeapPtr<FunctionObject> iter = FunctionObject::CreateCFunc(vm, vm->GetLibFnProto<VM::LibFnProto::StringGmatchIter>(), 3 /*numUpvalues*/).As();
+    TCSet(iter->m_upvalues[0], TValue::Create<tString>(str));
+    TCSet(iter->m_upvalues[1], TValue::Create<tString>(pattern));
+    TCSet(iter->m_upvalues[2], TValue::Create<tDouble>(0));
+    Return(TValue::Create<tFunction>(iter));
+}
+
+// The iterator function returned by string.gmatch
+//
+DEEGEN_DEFINE_LIB_FUNC(string_gmatch_iter)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    HeapPtr<FunctionObject> func = GetStackFrameHeader()->m_func;
+    assert(func->m_numUpvalues == 3);
+    HeapPtr<HeapString> str = TCGet(func->m_upvalues[0]).As<tString>();
+    HeapPtr<HeapString> pattern = TCGet(func->m_upvalues[1]).As<tString>();
+    uint32_t pos = static_cast<uint32_t>(TCGet(func->m_upvalues[2]).As<tDouble>());
+
+    HeapString* hs = TranslateToRawPointer(vm, str);
+    if (pos > hs->m_length)
+    {
+        Return();
+    }
+
+    // As in Lua 5.1, a '^' at the start of the pattern is not an anchor for gmatch
+    //
+    CompiledLuaPattern* cp = LuaPatternCache::Get(vm, pattern, false /*caretIsAnchor*/);
+    if (unlikely(cp->m_compileError != LuaPatternError::NoError))
+    {
+        ThrowError(GetLuaPatternErrorMessage(cp->m_compileError));
+    }
+
+    const char* src = reinterpret_cast<const char*>(hs->m_string);
+    LuaPatternMatcher matcher(cp, src, hs->m_length);
+    const char* matchEnd;
+    const char* matchBegin = matcher.Find(src + pos, matchEnd /*out*/);
+    if (matchBegin == nullptr)
+    {
+        if (unlikely(matcher.m_error != LuaPatternError::NoError))
+        {
+            ThrowError(GetLuaPatternErrorMessage(matcher.m_error));
+        }
+        TCSet(func->m_upvalues[2], TValue::Create<tDouble>(static_cast<double>(hs->m_length + 1)));
+        Return();
+    }
+
+    // For an empty match, the next search starts one character later
+    //
+    uint32_t newPos = static_cast<uint32_t>(matchEnd - src);
+    if (matchEnd == matchBegin)
+    {
+        newPos++;
+    }
+    TCSet(func->m_upvalues[2], TValue::Create<tDouble>(static_cast<double>(newPos)));
+
+    TValue* sb = GetStackBase();
+    uint32_t numResults = matcher.GetNumResultValues();
+    for (uint32_t i = 0; i < numResults; i++)
+    {
+        sb[i] = matcher.GetCapture(vm, i, matchBegin, matchEnd);
+    }
+    if (unlikely(matcher.m_error != LuaPatternError::NoError))
+    {
+        ThrowError(GetLuaPatternErrorMessage(matcher.m_error));
+    }
+    ReturnValueRange(sb, numResults);
 }
 
 // string.gsub -- https://www.lua.org/manual/5.1/manual.html#pdf-string.gsub
@@ -292,9 +955,164 @@ DEEGEN_DEFINE_LIB_FUNC(string_gmatch)
 //     x = string.gsub("$name-$version.tar.gz", "%$(%w+)", t)
 //     --> x="lua-5.1.tar.gz"
 //
+// Called when the replacement function (or an '__index' function of the replacement table) returns
+//
+DEEGEN_DEFINE_LIB_FUNC_CONTINUATION(string_gsub_continuation)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    TValue* sb = GetStackBase();
+    HeapPtr<HeapString> str = sb[x_gsubSlotForString].As<tString>();
+    HeapPtr<HeapString> pattern = sb[x_gsubSlotForPattern].As<tString>();
+    TValue repl = sb[x_gsubSlotForRepl];
+    TValue value = (GetNumReturnValues() > 0) ? GetReturnValuesBegin()[0] : TValue::Create<tNil>();
+
+    TValue result;
+    TValue numMatches;
+    size_t numCallArgs = 0;
+    TValue errMsg;
+    GsubStepResult res;
+    {
+        LuaGsubState state;
+        GsubGetStateFromStack(sb, &state /*out*/);
+
+        HeapString* hs = TranslateToRawPointer(vm, str);
+        const char* src = reinterpret_cast<const char*>(hs->m_string);
+        if (unlikely(!GsubAppendReplacementValue(&state, src, value, errMsg /*out*/)))
+        {
+            state.m_output.Destroy();
+            res = GsubStepResult::Error;
+        }
+        else
+        {
+            GsubAdvancePastMatch(&state, src, hs->m_length);
+            res = GsubRun(vm, &state, str, pattern, repl, sb, numCallArgs /*out*/, errMsg /*out*/);
+            if (res == GsubStepResult::Error)
+            {
+                state.m_output.Destroy();
+            }
+            else if (res == GsubStepResult::Done)
+            {
+                result = GsubCreateResultString(vm, &state, str, sb);
+                numMatches = TValue::Create<tDouble>(static_cast<double>(state.m_numMatches));
+            }
+        }
+    }
+
+    if (res == GsubStepResult::NeedCall)
+    {
+        MakeInPlaceCall(GsubGetCallFrame(sb) + x_numSlotsForStackFrameHeader, numCallArgs, DEEGEN_LIB_FUNC_RETURN_CONTINUATION(string_gsub_continuation));
+    }
+    if (unlikely(res == GsubStepResult::Error))
+    {
+        ThrowError(errMsg);
+    }
+    Return(result, numMatches);
+}
+
 DEEGEN_DEFINE_LIB_FUNC(string_gsub)
 {
-    ThrowError("Library function 'string.gsub' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs < 2))
+    {
+        ThrowError(numArgs == 0 ? "bad argument #1 to 'gsub' (string expected, got no value)" : "bad argument #2 to 'gsub' (string expected, got no value)");
+    }
+
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    HeapPtr<HeapString> str;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(0), str /*out*/)))
+    {
+        ThrowError("bad argument #1 to 'gsub' (string expected)");
+    }
+    HeapPtr<HeapString> pattern;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(1), pattern /*out*/)))
+    {
+        ThrowError("bad argument #2 to 'gsub' (string expected)");
+    }
+
+    int64_t maxMatches = static_cast<int64_t>(str->m_length) + 1;
+    if (numArgs >= 4 && !GetArg(3).Is<tNil>())
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(3));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #4 to 'gsub' (number expected)");
+        }
+        maxMatches = static_cast<int64_t>(val);
+    }
+
+    TValue repl = (numArgs >= 3) ? GetArg(2) : TValue::Create<tNil>();
+    if (repl.Is<tDouble>() || repl.Is<tInt32>())
+    {
+        HeapPtr<HeapString> replStr;
+        std::ignore = TryGetStringObjectFromArg(vm, repl, replStr /*out*/);
+        repl = TValue::Create<tString>(replStr);
+    }
+
+    TValue errMsg;
+    size_t numCallArgs;
+    if (repl.Is<tString>())
+    {
+        // The replacement never calls into the user program, so the whole gsub runs here
+        //
+        LuaGsubState state;
+        state.m_srcPos = 0;
+        state.m_isFinished = false;
+        state.m_numMatches = 0;
+        state.m_maxMatches = maxMatches;
+        GsubStepResult res = GsubRun(vm, &state, str, pattern, repl, nullptr /*sb*/, numCallArgs /*out*/, errMsg /*out*/);
+        if (unlikely(res == GsubStepResult::Error))
+        {
+            state.m_output.Destroy();
+            ThrowError(errMsg);
+        }
+        assert(res == GsubStepResult::Done);
+        TValue result = GsubCreateResultString(vm, &state, str, nullptr /*sb*/);
+        Return(result, TValue::Create<tDouble>(static_cast<double>(state.m_numMatches)));
+    }
+
+    if (unlikely(!repl.Is<tFunction>() && !repl.Is<tTable>()))
+    {
+        ThrowError("bad argument #3 to 'gsub' (string/function/table expected)");
+    }
+
+    TValue* sb = GetStackBase();
+    sb[x_gsubSlotForString] = TValue::Create<tString>(str);
+    sb[x_gsubSlotForPattern] = TValue::Create<tString>(pattern);
+    sb[x_gsubSlotForRepl] = repl;
+    sb[x_gsubSlotForNumPieces] = TValue::Create<tInt32>(0);
+
+    // 'state' must not hold any resource when we leave this scope, since MakeInPlaceCall, ThrowError and Return do not run destructors
+    //
+    TValue result;
+    TValue numMatches;
+    GsubStepResult res;
+    {
+        LuaGsubState state;
+        state.m_srcPos = 0;
+        state.m_isFinished = false;
+        state.m_numMatches = 0;
+        state.m_maxMatches = maxMatches;
+        res = GsubRun(vm, &state, str, pattern, repl, sb, numCallArgs /*out*/, errMsg /*out*/);
+        if (res == GsubStepResult::Error)
+        {
+            state.m_output.Destroy();
+        }
+        else if (res == GsubStepResult::Done)
+        {
+            result = GsubCreateResultString(vm, &state, str, sb);
+            numMatches = TValue::Create<tDouble>(static_cast<double>(state.m_numMatches));
+        }
+    }
+
+    if (res == GsubStepResult::NeedCall)
+    {
+        MakeInPlaceCall(GsubGetCallFrame(sb) + x_numSlotsForStackFrameHeader, numCallArgs, DEEGEN_LIB_FUNC_RETURN_CONTINUATION(string_gsub_continuation));
+    }
+    if (unlikely(res == GsubStepResult::Error))
+    {
+        ThrowError(errMsg);
+    }
+    Return(result, numMatches);
 }
 
 // string.len -- https://www.lua.org/manual/5.1/manual.html#pdf-string.len
@@ -490,7 +1308,47 @@ DEEGEN_DEFINE_LIB_FUNC(string_lower)
 //
 DEEGEN_DEFINE_LIB_FUNC(string_match)
 {
-    ThrowError("Library function 'string.match' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs < 2))
+    {
+        ThrowError(numArgs == 0 ? "bad argument #1 to 'match' (string expected, got no value)" : "bad argument #2 to 'match' (string expected, got no value)");
+    }
+
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    HeapPtr<HeapString> str;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(0), str /*out*/)))
+    {
+        ThrowError("bad argument #1 to 'match' (string expected)");
+    }
+    HeapPtr<HeapString> pattern;
+    if (unlikely(!TryGetStringObjectFromArg(vm, GetArg(1), pattern /*out*/)))
+    {
+        ThrowError("bad argument #2 to 'match' (string expected)");
+    }
+
+    int64_t init = 1;
+    if (numArgs >= 3 && !GetArg(2).Is<tNil>())
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(2));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #3 to 'match' (number expected)");
+        }
+        init = static_cast<int64_t>(val);
+    }
+
+    TValue* sb = GetStackBase();
+    size_t numResults;
+    LuaPatternError err = StringFindOrMatchImpl(vm, str, pattern, init, false /*isFind*/, false /*isPlain*/, sb /*out*/, numResults /*out*/);
+    if (unlikely(err != LuaPatternError::NoError))
+    {
+        ThrowError(GetLuaPatternErrorMessage(err));
+    }
+    if (numResults == 0)
+    {
+        Return(TValue::Create<tNil>());
+    }
+    ReturnValueRange(sb, numResults);
 }
 
 // string.rep -- https://www.lua.org/manual/5.1/manual.html#pdf-string.rep
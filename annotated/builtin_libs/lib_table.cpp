@@ -245,8 +245,9 @@ DEEGEN_DEFINE_LIB_FUNC(table_concat)
     }
 
     // Now, concat everything
+    // Long results are interned lazily, as they are often just written out and never used as a table key or compared
     //
-    HeapPtr<HeapString> result = vm->CreateStringObjectFromConcatenation(strings, numItems).As();
+    HeapPtr<HeapString> result = vm->CreateMaybeLazilyInternedStringFromConcatenation(strings, numItems).As();
 
     if (strings != internalStringBuffer)
     {
@@ -257,6 +258,32 @@ DEEGEN_DEFINE_LIB_FUNC(table_concat)
     Return(TValue::Create<tString>(result));
 }
 
+// Returns true if 'value' can be stored into the continuous vector storage of an array of type 'arrType' without
+// changing the array type, that is, the array is continuous, and 'value' is not nil and matches the array kind
+//
+static bool WARN_UNUSED LuaLibTableValueFitsContinuousArray(ArrayType arrType, TValue value)
+{
+    if (!arrType.IsContinuous())
+    {
+        return false;
+    }
+    switch (arrType.ArrayKind())
+    {
+    case ArrayType::Kind::Int32: return value.Is<tInt32>();
+    case ArrayType::Kind::Double: return value.Is<tDouble>();
+    case ArrayType::Kind::Any: return !value.Is<tNil>();
+    case ArrayType::Kind::NoButterflyArrayPart: return false;
+    }
+    __builtin_unreachable();
+}
+
+static TValue WARN_UNUSED LuaLibTableRawGetByIntegerIndex(HeapPtr<TableObject> tab, int64_t index)
+{
+    GetByIntegerIndexICInfo info;
+    TableObject::PrepareGetByIntegerIndex(tab, info /*out*/);
+    return TableObject::GetByIntegerIndex(tab, index, info);
+}
+
 // table.insert -- https://www.lua.org/manual/5.1/manual.html#pdf-table.insert
 //
 // table.insert (table, [pos,] value)
@@ -264,9 +291,73 @@ DEEGEN_DEFINE_LIB_FUNC(table_concat)
 // The default value for pos is n+1, where n is the length of the table (see §2.5.5), so that a call table.insert(t,x)
 // inserts x at the end of table t.
 //
+// As in the reference implementation, the table is accessed with raw gets and puts.
+//
 DEEGEN_DEFINE_LIB_FUNC(table_insert)
 {
-    ThrowError("Library function 'table.insert' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs == 0))
+    {
+        ThrowError("bad argument #1 to 'insert' (table expected, got no value)");
+    }
+    if (unlikely(!GetArg(0).Is<tTable>()))
+    {
+        ThrowError("bad argument #1 to 'insert' (table expected)");
+    }
+    HeapPtr<TableObject> tab = GetArg(0).As<tTable>();
+
+    int64_t n = TableObject::GetTableLengthWithLuaSemantics(tab);
+    int64_t pos;
+    TValue value;
+    if (numArgs == 2)
+    {
+        pos = n + 1;
+        value = GetArg(1);
+    }
+    else if (numArgs == 3)
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(1));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #2 to 'insert' (number expected)");
+        }
+        pos = static_cast<int64_t>(val);
+        value = GetArg(2);
+    }
+    else
+    {
+        ThrowError("wrong number of arguments to 'insert'");
+    }
+
+    // Fast path: the array is continuous and has spare capacity, so the insertion is a shift of the tail by one slot
+    // (nothing to shift for an append), and the array type is unchanged
+    //
+    ArrayType arrType = TCGet(tab->m_arrayType);
+    if (likely(LuaLibTableValueFitsContinuousArray(arrType, value)))
+    {
+        ButterflyHeader* hdr = tab->m_butterfly->GetHeader();
+        assert(hdr->m_arrayLengthIfContinuous == n);
+        if (likely(1 <= pos && pos <= n + 1 && n < static_cast<int64_t>(hdr->m_arrayStorageCapacity)))
+        {
+            TValue* arr = reinterpret_cast<TValue*>(tab->m_butterfly);
+            if (pos <= n)
+            {
+                memmove(arr + pos + 1, arr + pos, sizeof(TValue) * static_cast<size_t>(n + 1 - pos));
+            }
+            arr[pos] = value;
+            hdr->m_arrayLengthIfContinuous = static_cast<int32_t>(n + 1);
+            Return();
+        }
+    }
+
+    // Slow path: shift the elements one by one, exactly as the reference implementation does
+    //
+    for (int64_t i = n + 1; i > pos; i--)
+    {
+        TableObject::RawPutByValIntegerIndex(tab, i, LuaLibTableRawGetByIntegerIndex(tab, i - 1));
+    }
+    TableObject::RawPutByValIntegerIndex(tab, pos, value);
+    Return();
 }
 
 // table.maxn -- https://www.lua.org/manual/5.1/manual.html#pdf-table.maxn
@@ -277,7 +368,43 @@ DEEGEN_DEFINE_LIB_FUNC(table_insert)
 //
 DEEGEN_DEFINE_LIB_FUNC(table_maxn)
 {
-    ThrowError("Library function 'table.maxn' is not implemented yet!");
+    if (unlikely(GetNumArgs() == 0))
+    {
+        ThrowError("bad argument #1 to 'maxn' (table expected, got no value)");
+    }
+    if (unlikely(!GetArg(0).Is<tTable>()))
+    {
+        ThrowError("bad argument #1 to 'maxn' (table expected)");
+    }
+    HeapPtr<TableObject> tab = GetArg(0).As<tTable>();
+
+    // A continuous array has no numeric key outside the vector storage, so no traversal is needed
+    //
+    auto [success, len] = TableObject::TryGetTableLengthWithLuaSemanticsFastPath(tab);
+    if (success)
+    {
+        Return(TValue::Create<tDouble>(static_cast<double>(len)));
+    }
+
+    double result = 0;
+    TableObjectIterator iter;
+    while (true)
+    {
+        TableObjectIterator::KeyValuePair kv = iter.Advance(tab);
+        if (kv.m_key.Is<tNil>())
+        {
+            break;
+        }
+        if (kv.m_key.Is<tDouble>())
+        {
+            result = std::max(result, kv.m_key.As<tDouble>());
+        }
+        else if (kv.m_key.Is<tInt32>())
+        {
+            result = std::max(result, static_cast<double>(kv.m_key.As<tInt32>()));
+        }
+    }
+    Return(TValue::Create<tDouble>(result));
 }
 
 // table.remove -- https://www.lua.org/manual/5.1/manual.html#pdf-table.remove
@@ -287,9 +414,61 @@ DEEGEN_DEFINE_LIB_FUNC(table_maxn)
 // Returns the value of the removed element. The default value for pos is n, where n is the length of the table,
 // so that a call table.remove(t) removes the last element of table t.
 //
+// As in the reference implementation, nothing is returned if pos is not in [1, n], and the table is accessed with raw gets and puts.
+//
 DEEGEN_DEFINE_LIB_FUNC(table_remove)
 {
-    ThrowError("Library function 'table.remove' is not implemented yet!");
+    size_t numArgs = GetNumArgs();
+    if (unlikely(numArgs == 0))
+    {
+        ThrowError("bad argument #1 to 'remove' (table expected, got no value)");
+    }
+    if (unlikely(!GetArg(0).Is<tTable>()))
+    {
+        ThrowError("bad argument #1 to 'remove' (table expected)");
+    }
+    HeapPtr<TableObject> tab = GetArg(0).As<tTable>();
+
+    int64_t n = TableObject::GetTableLengthWithLuaSemantics(tab);
+    int64_t pos = n;
+    if (numArgs >= 2 && !GetArg(1).Is<tNil>())
+    {
+        auto [success, val] = LuaLib_ToNumber(GetArg(1));
+        if (unlikely(!success))
+        {
+            ThrowError("bad argument #2 to 'remove' (number expected)");
+        }
+        pos = static_cast<int64_t>(val);
+    }
+
+    if (pos < 1 || pos > n)
+    {
+        Return();
+    }
+
+    // Fast path: the array is continuous, so the removal is a shift of the tail by one slot
+    // The vacated last slot must be set to nil to maintain the invariant of the continuous vector storage
+    //
+    ArrayType arrType = TCGet(tab->m_arrayType);
+    if (likely(arrType.IsContinuous()))
+    {
+        ButterflyHeader* hdr = tab->m_butterfly->GetHeader();
+        assert(hdr->m_arrayLengthIfContinuous == n);
+        TValue* arr = reinterpret_cast<TValue*>(tab->m_butterfly);
+        TValue result = arr[pos];
+        memmove(arr + pos, arr + pos + 1, sizeof(TValue) * static_cast<size_t>(n - pos));
+        arr[n] = TValue::Create<tNil>();
+        hdr->m_arrayLengthIfContinuous = static_cast<int32_t>(n - 1);
+        Return(result);
+    }
+
+    TValue result = LuaLibTableRawGetByIntegerIndex(tab, pos);
+    for (int64_t i = pos; i < n; i++)
+    {
+        TableObject::RawPutByValIntegerIndex(tab, i, LuaLibTableRawGetByIntegerIndex(tab, i + 1));
+    }
+    TableObject::RawPutByValIntegerIndex(tab, n, TValue::Create<tNil>());
+    Return(result);
 }
 
 // Check that the metatable for string has no __lt metamethod
@@ -313,51 +492,183 @@ static bool LuaLibCheckStringHasNoExoticLtMetamethod(VM* vm)
     }
 }
 
-static void LuaLibTableSortDoubleContinuousArrayNoMM(TValue* arr, size_t n)
+// Below this size, the sort kernels use comparison sorts, as the fixed cost of the radix sort (the histograms and the temporary buffer) dominates
+//
+constexpr size_t x_luaLibTableSortRadixSortThreshold = 256;
+
+// Map a double to an unsigned integer key, so that comparing the keys as unsigned integers gives the same order as comparing the doubles.
+// -0 and +0 get different keys, which is fine, since their relative order doesn't matter.
+//
+static uint64_t WARN_UNUSED ALWAYS_INLINE LuaLibTableSortGetRadixKeyForDouble(double value)
+{
+    uint64_t bits = cxx2a_bit_cast<uint64_t>(value);
+    return (bits & (1ULL << 63)) ? ~bits : (bits | (1ULL << 63));
+}
+
+static double WARN_UNUSED ALWAYS_INLINE LuaLibTableSortGetNumberValue(TValue tv)
+{
+    assert(tv.Is<tDouble>() || tv.Is<tInt32>());
+    return tv.Is<tDouble>() ? tv.As<tDouble>() : static_cast<double>(tv.As<tInt32>());
+}
+
+// LSD radix sort on the 64-bit key given by 'keyFn', one byte per pass
+// All 8 histograms are built in a single scan, and a pass is skipped if all keys have the same byte there (e.g., the high bytes of small integers).
+// 'tmp' must have space for 'n' elements.
+//
+template<typename T, typename KeyFn>
+static void LuaLibTableRadixSort(T* data, T* tmp, size_t n, const KeyFn& keyFn)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint32_t hist[8][256];
+    memset(hist, 0, sizeof(hist));
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t key = keyFn(data[i]);
+        for (size_t b = 0; b < 8; b++)
+        {
+            hist[b][(key >> (b * 8)) & 255]++;
+        }
+    }
+
+    T* src = data;
+    T* dst = tmp;
+    uint64_t firstKey = keyFn(data[0]);
+    for (size_t b = 0; b < 8; b++)
+    {
+        uint32_t* h = hist[b];
+        if (h[(firstKey >> (b * 8)) & 255] == n)
+        {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (size_t k = 0; k < 256; k++)
+        {
+            uint32_t cnt = h[k];
+            h[k] = offset;
+            offset += cnt;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            T item = src[i];
+            dst[h[(keyFn(item) >> (b * 8)) & 255]++] = item;
+        }
+        std::swap(src, dst);
+    }
+    if (src != data)
+    {
+        memcpy(data, src, sizeof(T) * n);
+    }
+}
+
+// Sort an array of doubles
+//
+static void LuaLibTableSortDoubles(TValue* data, size_t n)
 {
 #ifndef NDEBUG
-    for (size_t i = 1; i <= n; i++)
+    for (size_t i = 0; i < n; i++)
     {
-        assert(arr[i].Is<tDouble>());
+        assert(data[i].Is<tDouble>());
     }
 #endif
-    double* arrDbl = reinterpret_cast<double*>(arr);
-    std::sort(arrDbl + 1, arrDbl + n + 1);
+    TValue* tmp = nullptr;
+    if (n >= x_luaLibTableSortRadixSortThreshold)
+    {
+        tmp = new (std::nothrow) TValue[n];
+    }
+    if (tmp == nullptr)
+    {
+        double* dataDbl = reinterpret_cast<double*>(data);
+        std::sort(dataDbl, dataDbl + n);
+        return;
+    }
+    LuaLibTableRadixSort(data, tmp, n, [](TValue tv) ALWAYS_INLINE { return LuaLibTableSortGetRadixKeyForDouble(tv.As<tDouble>()); });
+    delete [] tmp;
 }
 
-static void LuaLibTableSortDoubleNonContinuousArrayNoMM(HeapPtr<TableObject> tab, size_t n)
+// Sort an array of numbers, where each element may be either a double or an int32
+// The elements are sorted by numeric value and keep their representations.
+//
+static void LuaLibTableSortNumbers(TValue* data, size_t n)
+{
+    auto getKey = [](TValue tv) ALWAYS_INLINE { return LuaLibTableSortGetRadixKeyForDouble(LuaLibTableSortGetNumberValue(tv)); };
+    TValue* tmp = nullptr;
+    if (n >= x_luaLibTableSortRadixSortThreshold)
+    {
+        tmp = new (std::nothrow) TValue[n];
+    }
+    if (tmp == nullptr)
+    {
+        std::sort(data, data + n, [](TValue lhs, TValue rhs) ALWAYS_INLINE { return LuaLibTableSortGetNumberValue(lhs) < LuaLibTableSortGetNumberValue(rhs); });
+        return;
+    }
+    LuaLibTableRadixSort(data, tmp, n, getKey);
+    delete [] tmp;
+}
+
+// To sort strings, each string is paired with its first 8 bytes, loaded as a big-endian integer (zero-padded for shorter strings).
+// Comparing these prefixes gives the same order as memcmp whenever they differ, so most comparisons are resolved without touching the string contents.
+//
+struct LuaLibTableSortStringWithPrefix
+{
+    uint64_t m_prefix;
+    TValue m_value;
+};
+
+static uint64_t WARN_UNUSED LuaLibTableSortGetStringPrefix(HeapString* hs)
+{
+    uint64_t prefix = 0;
+    memcpy(&prefix, hs->m_string, std::min(hs->m_length, static_cast<uint32_t>(sizeof(uint64_t))));
+    return __builtin_bswap64(prefix);
+}
+
+static bool LuaLibTableSortStringWithPrefixComparator(const LuaLibTableSortStringWithPrefix& lhs, const LuaLibTableSortStringWithPrefix& rhs)
+{
+    if (lhs.m_prefix != rhs.m_prefix)
+    {
+        return lhs.m_prefix < rhs.m_prefix;
+    }
+    HeapPtr<HeapString> lstr = lhs.m_value.As<tString>();
+    HeapPtr<HeapString> rstr = rhs.m_value.As<tString>();
+    if (lstr == rstr)
+    {
+        return false;
+    }
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    return TranslateToRawPointer(vm, lstr)->Compare(TranslateToRawPointer(vm, rstr)) < 0;
+}
+
+// Sort an array of strings
+//
+static void LuaLibTableSortStrings(TValue* data, size_t n)
 {
     constexpr size_t internalBufSize = 500;
-    double buf[internalBufSize];
-    double* ptr = nullptr;
+    LuaLibTableSortStringWithPrefix buf[internalBufSize];
+    LuaLibTableSortStringWithPrefix* ptr;
     if (n <= internalBufSize)
     {
         ptr = buf;
     }
     else
     {
-        ptr = new double[n];
+        ptr = new LuaLibTableSortStringWithPrefix[n];
     }
 
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    for (size_t i = 0; i < n; i++)
     {
-        GetByIntegerIndexICInfo info;
-        TableObject::PrepareGetByIntegerIndex(tab, info /*out*/);
-        for (uint32_t i = 1; i <= n; i++)
-        {
-            TValue tv = TableObject::GetByIntegerIndex(tab, i, info);
-            assert(tv.Is<tDouble>());
-            ptr[i - 1] = tv.As<tDouble>();
-        }
+        assert(data[i].Is<tString>());
+        ptr[i].m_prefix = LuaLibTableSortGetStringPrefix(TranslateToRawPointer(vm, data[i].As<tString>()));
+        ptr[i].m_value = data[i];
     }
 
-    std::sort(ptr, ptr + n);
+    // Use stable_sort because it generally produces less comparisons than std::sort (but at the cost of more iteration work).
+    // Comparisons that are not resolved by the prefix are the expensive part.
+    //
+    std::stable_sort(ptr, ptr + n, LuaLibTableSortStringWithPrefixComparator);
 
-    for (uint32_t i = 1; i <= n; i++)
+    for (size_t i = 0; i < n; i++)
     {
-        TValue val = TValue::Create<tDouble>(ptr[i - 1]);
-        // TODO: we could have done better here
-        //
-        TableObject::RawPutByValIntegerIndex(tab, i, val);
+        data[i] = ptr[i].m_value;
     }
 
     if (ptr != buf)
@@ -366,39 +677,103 @@ static void LuaLibTableSortDoubleNonContinuousArrayNoMM(HeapPtr<TableObject> tab
     }
 }
 
-static bool LuaLibTableSortStringComparator(TValue lhs, TValue rhs)
+enum class LuaLibTableSortElementKind
 {
-    assert(lhs.Is<tString>() && rhs.Is<tString>());
-    HeapPtr<HeapString> lstr = lhs.As<tString>();
-    HeapPtr<HeapString> rstr = rhs.As<tString>();
-    if (lstr == rstr)
+    // All elements are doubles
+    //
+    Double,
+    // All elements are numbers, some of which are int32
+    //
+    Number,
+    String,
+    // Anything else, which must go through the generic sort
+    //
+    Other
+};
+
+static LuaLibTableSortElementKind WARN_UNUSED LuaLibTableSortClassifyElements(TValue* data, size_t n)
+{
+    assert(n > 0);
+    if (data[0].Is<tString>())
     {
-        return false;
+        for (size_t i = 1; i < n; i++)
+        {
+            if (unlikely(!data[i].Is<tString>()))
+            {
+                return LuaLibTableSortElementKind::Other;
+            }
+        }
+        return LuaLibTableSortElementKind::String;
     }
-    VM* vm = VM::GetActiveVMForCurrentThread();
-    int cmpRes = TranslateToRawPointer(vm, lstr)->Compare(TranslateToRawPointer(vm, rstr));
-    return cmpRes < 0;
+
+    bool allDouble = true;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (likely(data[i].Is<tDouble>()))
+        {
+            continue;
+        }
+        if (unlikely(!data[i].Is<tInt32>()))
+        {
+            return LuaLibTableSortElementKind::Other;
+        }
+        allDouble = false;
+    }
+    return allDouble ? LuaLibTableSortElementKind::Double : LuaLibTableSortElementKind::Number;
 }
 
-static void LuaLibTableSortStringContinuousArrayNoMM(TValue* arr, size_t n)
+// Sort arr[1..n] in place, where 'arr' is the vector storage of the table and [1, n] fits in the vector storage capacity.
+// This works for continuous arrays as well as non-continuous arrays, as long as all the elements are non-nil (which the classification checks).
+// Returns false if the elements are not all numbers or all strings, or if a metamethod may be invoked, in which case nothing is changed.
+//
+static bool WARN_UNUSED LuaLibTableTrySortVectorStorageNoMM(VM* vm, TValue* arr, size_t n, LuaLibTableSortElementKind kind)
 {
-#ifndef NDEBUG
-    for (size_t i = 1; i <= n; i++)
+    switch (kind)
+    {
+    case LuaLibTableSortElementKind::Double:
     {
-        assert(arr[i].Is<tString>());
+        if (unlikely(vm->m_metatableForNumber.m_value != 0))
+        {
+            return false;
+        }
+        LuaLibTableSortDoubles(arr + 1, n);
+        return true;
     }
-#endif
-    // Use stable_sort because it generally produces less comparisons than std::sort (but at the cost of more iteration work).
-    // For string sorting, comparison is the expensive part.
-    //
-    std::stable_sort(arr + 1, arr + n + 1, LuaLibTableSortStringComparator);
+    case LuaLibTableSortElementKind::Number:
+    {
+        if (unlikely(vm->m_metatableForNumber.m_value != 0))
+        {
+            return false;
+        }
+        LuaLibTableSortNumbers(arr + 1, n);
+        return true;
+    }
+    case LuaLibTableSortElementKind::String:
+    {
+        if (unlikely(!LuaLibCheckStringHasNoExoticLtMetamethod(vm)))
+        {
+            return false;
+        }
+        LuaLibTableSortStrings(arr + 1, n);
+        return true;
+    }
+    case LuaLibTableSortElementKind::Other:
+    {
+        return false;
+    }
+    }
+    __builtin_unreachable();
 }
 
-static void LuaLibTableSortStringNonContinuousArrayNoMM(HeapPtr<TableObject> tab, size_t n)
+// Sort a table whose elements [1, n] do not all live in the vector storage (i.e., some are in the sparse map)
+// The elements are copied out, sorted, and written back one by one, as the sparse map part has to go through the generic put path anyway.
+// Returns false if the elements are not all numbers or all strings, or if a metamethod may be invoked, in which case nothing is changed.
+//
+static bool WARN_UNUSED LuaLibTableTrySortSparseArrayNoMM(VM* vm, HeapPtr<TableObject> tab, size_t n)
 {
     constexpr size_t internalBufSize = 500;
     TValue buf[internalBufSize];
-    TValue* ptr = nullptr;
+    TValue* ptr;
     if (n <= internalBufSize)
     {
         ptr = buf;
@@ -414,24 +789,45 @@ static void LuaLibTableSortStringNonContinuousArrayNoMM(HeapPtr<TableObject> tab
         for (uint32_t i = 1; i <= n; i++)
         {
             ptr[i - 1] = TableObject::GetByIntegerIndex(tab, i, info);
-            assert(ptr[i - 1].Is<tString>());
         }
     }
 
-    std::stable_sort(ptr, ptr + n, LuaLibTableSortStringComparator);
+    bool success;
+    LuaLibTableSortElementKind kind = LuaLibTableSortClassifyElements(ptr, n);
+    if (kind == LuaLibTableSortElementKind::Double || kind == LuaLibTableSortElementKind::Number)
+    {
+        success = (vm->m_metatableForNumber.m_value == 0);
+        if (success)
+        {
+            LuaLibTableSortNumbers(ptr, n);
+        }
+    }
+    else if (kind == LuaLibTableSortElementKind::String)
+    {
+        success = LuaLibCheckStringHasNoExoticLtMetamethod(vm);
+        if (success)
+        {
+            LuaLibTableSortStrings(ptr, n);
+        }
+    }
+    else
+    {
+        success = false;
+    }
 
-    for (uint32_t i = 1; i <= n; i++)
+    if (success)
     {
-        TValue val = ptr[i - 1];
-        // TODO: we could have done better here
-        //
-        TableObject::RawPutByValIntegerIndex(tab, i, val);
+        for (uint32_t i = 1; i <= n; i++)
+        {
+            TableObject::RawPutByValIntegerIndex(tab, i, ptr[i - 1]);
+        }
     }
 
     if (ptr != buf)
     {
         delete [] ptr;
     }
+    return success;
 }
 
 // Since we support truly fully-resumable VM, we support yielding from everywhere, including comparator functions and
@@ -1093,103 +1489,40 @@ no_usr_comparator:
 
         // No function, we should use the built-in less-than comparator
         //
-        // We implement fastpath for the good case: all values are double, or all values are string (and that
-        // no exotic __lt metamethod exists for the double/string type)
-        // In these cases, we can be certain that no metamethod will be called, so we can simply use std::sort
+        // We implement fastpath for the good case: all values are numbers, or all values are strings (and that
+        // no exotic __lt metamethod exists for the number/string type)
+        // In these cases, we can be certain that no metamethod will be called, so we can use a specialized sort kernel
         //
-        GetByIntegerIndexICInfo info;
-        TableObject::PrepareGetByIntegerIndex(tab, info /*out*/);
-        if (info.m_isContinuous)
+        ArrayType arrType = TCGet(tab->m_arrayType);
+        if (likely(arrType.ArrayKind() != ArrayType::Kind::NoButterflyArrayPart && n <= tab->m_butterfly->GetHeader()->m_arrayStorageCapacity))
         {
+            // All of [1, n] lives in the vector storage (this is always the case for a continuous array), so sort it in place
+            //
             TValue* arr = reinterpret_cast<TValue*>(tab->m_butterfly);
-            if (TCGet(tab->m_arrayType).ArrayKind() == ArrayType::Kind::Double)
+            LuaLibTableSortElementKind kind;
+            if (arrType.IsContinuous() && arrType.ArrayKind() == ArrayType::Kind::Double)
             {
-                if (unlikely(vm->m_metatableForNumber.m_value != 0))
-                {
-                    goto slowpath;
-                }
-                LuaLibTableSortDoubleContinuousArrayNoMM(arr, n);
-                Return();
+                kind = LuaLibTableSortElementKind::Double;
             }
-
-            if (arr[1].Is<tDouble>())
+            else
             {
-                if (unlikely(vm->m_metatableForNumber.m_value != 0))
-                {
-                    goto slowpath;
-                }
-                for (size_t i = 2; i <= n; i++)
-                {
-                    if (unlikely(!arr[i].Is<tDouble>()))
-                    {
-                        goto slowpath;
-                    }
-                }
-                LuaLibTableSortDoubleContinuousArrayNoMM(arr, n);
-                Return();
+                kind = LuaLibTableSortClassifyElements(arr + 1, n);
             }
-            else if (arr[1].Is<tString>())
+            if (LuaLibTableTrySortVectorStorageNoMM(vm, arr, n, kind))
             {
-                if (unlikely(!LuaLibCheckStringHasNoExoticLtMetamethod(vm)))
-                {
-                    goto slowpath;
-                }
-                for (size_t i = 2; i <= n; i++)
-                {
-                    if (unlikely(!arr[i].Is<tString>()))
-                    {
-                        goto slowpath;
-                    }
-                }
-                LuaLibTableSortStringContinuousArrayNoMM(arr, n);
                 Return();
             }
-            else
-            {
-                goto slowpath;
-            }
         }
         else
         {
-            TValue elementOne = TableObject::GetByIntegerIndex(tab, 1, info);
-            if (elementOne.Is<tDouble>())
+            if (LuaLibTableTrySortSparseArrayNoMM(vm, tab, n))
             {
-                if (unlikely(vm->m_metatableForNumber.m_value != 0))
-                {
-                    goto slowpath;
-                }
-                for (uint32_t i = 2; i <= n; i++)
-                {
-                    if (unlikely(!TableObject::GetByIntegerIndex(tab, i, info).Is<tDouble>()))
-                    {
-                        goto slowpath;
-                    }
-                }
-                LuaLibTableSortDoubleNonContinuousArrayNoMM(tab, n);
-                Return();
-            }
-            else if (elementOne.Is<tString>())
-            {
-                if (unlikely(!LuaLibCheckStringHasNoExoticLtMetamethod(vm)))
-                {
-                    goto slowpath;
-                }
-                for (uint32_t i = 2; i <= n; i++)
-                {
-                    if (unlikely(!TableObject::GetByIntegerIndex(tab, i, info).Is<tString>()))
-                    {
-                        goto slowpath;
-                    }
-                }
-                LuaLibTableSortStringNonContinuousArrayNoMM(tab, n);
                 Return();
             }
-            else
-            {
-                goto slowpath;
-            }
         }
-slowpath:
+
+        // Slow path: use the generic sort, which may invoke metamethods
+        //
         TValue* sb = GetStackBase();
         QuickSortStateMachine qsm = QuickSortStateMachine::Init(sb, tab, static_cast<int32_t>(n));
         QuickSortStateMachine::Result action = qsm.InitialAdvance();
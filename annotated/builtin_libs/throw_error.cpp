@@ -149,7 +149,11 @@ DEEGEN_DEFINE_LIB_FUNC(DeegenInternal_ThrowTValueErrorImpl)
             //
             // TODO: make the output message and behavior consistent with Lua in this case
             //
-            FILE* fp = VM::GetActiveVMForCurrentThread()->GetStderr();
+            // Make the output produced so far visible before reporting the error and exiting
+            //
+            VM* vm = VM::GetActiveVMForCurrentThread();
+            std::ignore = vm->FlushStdout();
+            FILE* fp = vm->GetStderr();
             fprintf(fp, "Uncaught error: ");
             PrintTValue(fp, errorObject);
             fprintf(fp, "\n");
@@ -184,7 +188,7 @@ DEEGEN_DEFINE_LIB_FUNC(DeegenInternal_ThrowTValueErrorImpl)
             // We should simply make coroutine.resume return 'false' plus the error object.
             // Note that we also need to pad nils to x_minNilFillReturnValues, as required by our internal call scheme.
             //
-            // TODO: we need to check for stack overflow here once we implement resizable stack
+            // The destination stack grows on demand (see CoroutineRuntimeContext::HandleStackFault)
             //
             dstStackBase[0] = TValue::Create<tBool>(false);
             dstStackBase[1] = errorObject;
@@ -193,6 +197,9 @@ DEEGEN_DEFINE_LIB_FUNC(DeegenInternal_ThrowTValueErrorImpl)
                 dstStackBase[i] = TValue::Create<tNil>();
             }
 
+            // Nothing on the stack of the dead coroutine is needed any more, so it can be recycled now
+            //
+            currentCoro->ReleaseStack(VM::GetActiveVMForCurrentThread());
             CoroSwitch(parentCoro, dstStackBase, 2 /*numArgs*/);
         }
         else
@@ -217,6 +224,7 @@ DEEGEN_DEFINE_LIB_FUNC(DeegenInternal_ThrowTValueErrorImpl)
             TValue* newStackBase = reinterpret_cast<TValue*>(newHdr + 1);
             newStackBase[0] = errorObject;
 
+            currentCoro->ReleaseStack(VM::GetActiveVMForCurrentThread());
             CoroSwitch(parentCoro, newStackBase, 1 /*numArgs*/);
         }
     }
@@ -55,6 +55,9 @@ inline std::optional<HeapPtr<HeapString>> WARN_UNUSED TryGetStringOrConvertNumbe
 // Until the loop ends or it encounters an expression where a metamethod call is needed.
 // Returns the final value if the loop ends, or the value pair for the metamethod call.
 //
+// The slots in [0, startOffset + 1] except the one that needs the metamethod call may be clobbered:
+// base[startOffset + 1] is either the last operand (which the caller overwrites anyway) or the lhs of the last metamethod call.
+//
 inline ScanForMetamethodCallResult WARN_UNUSED ScanForMetamethodCall(TValue* base, int32_t startOffset, TValue curValue)
 {
     assert(startOffset >= 0);
@@ -70,36 +73,56 @@ inline ScanForMetamethodCallResult WARN_UNUSED ScanForMetamethodCall(TValue* bas
         };
     }
 
-    // This is tricky: curString and curValue are out of sync at the beginning of the loop (curValue might be number while curString must be string),
-    // but are always kept in sync in every later iteration (see end of the loop below), and the return inside the loop returns 'curValue'.
-    // This is required, because if no concatenation happens before metamethod call,
-    // the metamethod should see the original parameter, not the coerced-to-string parameter.
+    // Find all the operands on the left that can be concatenated without metamethod call, and concatenate them in one go.
+    // The intermediate results are not observable, so this is equivalent to concatenating them one by one from right to left,
+    // but avoids creating (and hashing) one intermediate string per operand.
+    //
+    // Long results are not hashed at all: they are interned lazily when first used as a table key or compared,
+    // so building a long string by repeated concatenation does not rehash the intermediate results.
     //
-    HeapPtr<HeapString> curString = optStr.value();
-    while (startOffset >= 0)
+    int32_t endOffset = startOffset;
+    while (endOffset >= 0)
     {
-        std::optional<HeapPtr<HeapString>> lhs = TryGetStringOrConvertNumberToString(base[startOffset]);
+        std::optional<HeapPtr<HeapString>> lhs = TryGetStringOrConvertNumberToString(base[endOffset]);
         if (!lhs)
         {
-            return {
-                .m_exhausted = false,
-                .m_endOffset = startOffset - 1,
-                .m_lhsValue = base[startOffset],
-                .m_rhsValue = curValue
-            };
+            break;
         }
+        base[endOffset] = TValue::Create<tString>(lhs.value());
+        endOffset--;
+    }
 
-        startOffset--;
-        TValue tmp[2];
-        tmp[0] = TValue::Create<tString>(lhs.value());
-        tmp[1] = TValue::Create<tString>(curString);
-        curString = VM::GetActiveVMForCurrentThread()->CreateStringObjectFromConcatenation(tmp, 2 /*len*/).As();
-        curValue = TValue::Create<tString>(curString);
+    if (endOffset == startOffset)
+    {
+        // No concatenation happens before the metamethod call, so the metamethod should see the original parameter,
+        // not the coerced-to-string parameter
+        //
+        return {
+            .m_exhausted = false,
+            .m_endOffset = startOffset - 1,
+            .m_lhsValue = base[startOffset],
+            .m_rhsValue = curValue
+        };
+    }
+
+    base[startOffset + 1] = TValue::Create<tString>(optStr.value());
+    TValue* concatStart = base + endOffset + 1;
+    size_t concatLen = static_cast<size_t>(startOffset - endOffset + 1);
+    TValue result = TValue::Create<tString>(VM::GetActiveVMForCurrentThread()->CreateMaybeLazilyInternedStringFromConcatenation(concatStart, concatLen).As());
+
+    if (endOffset < 0)
+    {
+        return {
+            .m_exhausted = true,
+            .m_lhsValue = result
+        };
     }
 
     return {
-        .m_exhausted = true,
-        .m_lhsValue = curValue
+        .m_exhausted = false,
+        .m_endOffset = endOffset - 1,
+        .m_lhsValue = base[endOffset],
+        .m_rhsValue = result
     };
 }
 
@@ -142,7 +165,7 @@ inline std::pair<bool, TValue> WARN_UNUSED NO_INLINE TryConcatFastPath(TValue* b
             }
         }
 
-        TValue result = TValue::Create<tString>(vm->CreateStringObjectFromConcatenation(base, num).As());
+        TValue result = TValue::Create<tString>(vm->CreateMaybeLazilyInternedStringFromConcatenation(base, num).As());
         return std::make_pair(true, result);
     }
     else
@@ -63,6 +63,17 @@ void NO_RETURN EqualityOperationImpl(TValue lhs, TValue rhs)
     assert(!lhs.Is<tInt32>() && "unimplemented");
     assert(!rhs.Is<tInt32>() && "unimplemented");
 
+    if (unlikely(lhs.Is<tString>() && rhs.Is<tString>()))
+    {
+        // Interned strings are equal iff they are the same object, but long strings created by concatenation
+        // are interned lazily, so they must be interned before they can be compared
+        //
+        TValue lhsInterned = VM_InternIfLazilyInternedString(lhs);
+        TValue rhsInterned = VM_InternIfLazilyInternedString(rhs);
+        result = (lhsInterned.m_value == rhsInterned.m_value) ^ compareForNotEqual;
+        goto end;
+    }
+
     if (likely(lhs.Is<tTable>() && rhs.Is<tTable>()))
     {
         // Consider metamethod call
@@ -113,15 +113,23 @@ static void NO_RETURN TableGetByIdImpl(TValue base, TValue tvIndex)
                 return std::make_pair(TValue(), ResKind::NotTable);
             }
 
+            // Once the IC is full, every execution comes here, so use the VM-wide megamorphic property cache
+            //
             GetByIdICInfo c_info;
-            TableObject::PrepareGetById(heapEntity, UserHeapPointer<HeapString> { index }, c_info /*out*/);
+            if (ic->IsMegamorphic())
+            {
+                TableObject::PrepareGetByIdForMegamorphicSite(heapEntity, UserHeapPointer<HeapString> { index }, c_info /*out*/);
+            }
+            else
+            {
+                TableObject::PrepareGetById(heapEntity, UserHeapPointer<HeapString> { index }, c_info /*out*/);
+            }
             ResKind c_resKind = c_info.m_mayHaveMetatable ? ResKind::MayHaveMetatable : ResKind::NoMetatable;
             switch (c_info.m_icKind)
             {
             case GetByIdICInfo::ICKind::UncachableDictionary:
             {
-                assert(false && "unimplemented");
-                __builtin_unreachable();
+                return std::make_pair(TableObject::GetById(heapEntity, index, c_info), c_resKind);
             }
             case GetByIdICInfo::ICKind::MustBeNil:
             {
@@ -86,6 +86,9 @@ static void NO_RETURN HandleNotInt64IndexSlowPath(TValue /*bc_base*/, TValue /*b
         TValue tvIndex; tvIndex.m_value = cxx2a_bit_cast<uint64_t>(tvIndexViewAsDouble);
         if (likely(tvIndex.Is<tHeapEntity>()))
         {
+            // Table keys are looked up by identity, so a lazily interned string key must be interned first
+            //
+            tvIndex = VM_InternIfLazilyInternedString(tvIndex);
             while (true)
             {
                 assert(base.Is<tTable>());
@@ -129,18 +129,27 @@ static void NO_RETURN TablePutByIdImpl(TValue base, TValue tvIndex, TValue value
                 return std::make_pair(TValue(), ResKind::NotTable);
             }
 
+            // Once the IC is full, every execution comes here, so use the VM-wide megamorphic property cache
+            //
             PutByIdICInfo c_info;
-            TableObject::PreparePutById(tableObj, UserHeapPointer<HeapString> { index } , c_info /*out*/);
+            if (ic->IsMegamorphic())
+            {
+                TableObject::PreparePutByIdForMegamorphicSite(tableObj, UserHeapPointer<HeapString> { index }, c_info /*out*/);
+            }
+            else
+            {
+                TableObject::PreparePutById(tableObj, UserHeapPointer<HeapString> { index } , c_info /*out*/);
+            }
 
             int32_t c_slot = c_info.m_slot;
             PutByIdICInfo::ICKind c_icKind = c_info.m_icKind;
 
             if (unlikely(!c_info.m_isInlineCacheable))
             {
-                // Currently since we don't have UncacheableDictionary, the only case for this is TransitionedToDictionaryMode
+                // The table is either transitioning to CacheableDictionary or is an UncacheableDictionary
                 //
-                assert(c_icKind == PutByIdICInfo::ICKind::TransitionedToDictionaryMode);
-                assert(!c_info.m_propertyExists);
+                assert(c_icKind == PutByIdICInfo::ICKind::TransitionedToDictionaryMode || c_icKind == PutByIdICInfo::ICKind::UncacheableDictionary);
+                AssertImp(c_icKind == PutByIdICInfo::ICKind::TransitionedToDictionaryMode, !c_info.m_propertyExists);
                 if (unlikely(TableObject::PutByIdNeedToCheckMetatable(tableObj, c_info)))
                 {
                     TValue mm = GetNewIndexMetamethodFromTableObject(tableObj);
@@ -149,7 +158,7 @@ static void NO_RETURN TablePutByIdImpl(TValue base, TValue tvIndex, TValue value
                         return std::make_pair(mm, ResKind::HandleMetamethod);
                     }
                 }
-                TableObject::PutByIdTransitionToDictionary(tableObj, index, valueToPut);
+                TableObject::PutById(tableObj, index, valueToPut, c_info);
                 return std::make_pair(TValue(), ResKind::NoMetamethod);
             }
 
@@ -207,6 +207,9 @@ double_index_handle_metamethod:
         UserHeapPointer<void> key;
         if (likely(tvIndex.Is<tHeapEntity>()))
         {
+            // Table keys are looked up by identity, so a lazily interned string key must be interned first
+            //
+            tvIndex = VM_InternIfLazilyInternedString(tvIndex);
             key = tvIndex.As<tHeapEntity>();
         }
         else
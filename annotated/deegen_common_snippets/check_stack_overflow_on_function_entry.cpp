@@ -0,0 +1,18 @@
+#include "force_release_build.h"
+
+#include "define_deegen_common_snippet.h"
+#include "runtime_utils.h"
+
+// Return true if the stack frame of the callee may end within the last x_stackOverflowReservedSlots slots of the stack,
+// in which case the function entry logic throws a stack overflow error
+//
+// The frame after the fixup of a variadic argument function ends before the variadic arguments plus a full frame, so this is an upper bound for all cases.
+//
+static bool DeegenSnippet_CheckStackOverflowOnFunctionEntry(CoroutineRuntimeContext* coroCtx, uint64_t* paramStart, uint64_t numProvidedParams, CodeBlock* cb)
+{
+    uint64_t* frameEnd = paramStart + numProvidedParams + x_numSlotsForStackFrameHeader + cb->m_stackFrameNumSlots;
+    uint64_t* limit = reinterpret_cast<uint64_t*>(coroCtx->m_stackBegin) + coroCtx->m_numStackSlots - CoroutineRuntimeContext::x_stackOverflowReservedSlots;
+    return frameEnd > limit;
+}
+
+DEFINE_DEEGEN_COMMON_SNIPPET("CheckStackOverflowOnFunctionEntry", DeegenSnippet_CheckStackOverflowOnFunctionEntry)
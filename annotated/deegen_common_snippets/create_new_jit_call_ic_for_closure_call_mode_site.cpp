@@ -3,9 +3,9 @@
 #include "define_deegen_common_snippet.h"
 #include "runtime_utils.h"
 
-static void* DeegenSnippet_CreateNewJitCallIcForClosureCallModeSite(JitCallInlineCacheSite* site, uint16_t dcIcTraitKind, TValue tv)
+static void* DeegenSnippet_CreateNewJitCallIcForClosureCallModeSite(JitCallInlineCacheSite* site, uint16_t dcIcTraitKind, TValue tv, void** jitDataSecAddr)
 {
-    return site->InsertInClosureCallMode(dcIcTraitKind, tv);
+    return site->InsertInClosureCallMode(dcIcTraitKind, tv, jitDataSecAddr);
 }
 
 DEFINE_DEEGEN_COMMON_SNIPPET("CreateNewJitCallIcForClosureCallModeSite", DeegenSnippet_CreateNewJitCallIcForClosureCallModeSite)
@@ -3,9 +3,9 @@
 #include "define_deegen_common_snippet.h"
 #include "drt/baseline_jit_codegen_helper.h"
 
-static void* DeegenSnippet_CreateNewJitGenericIc(JitGenericInlineCacheSite* site, uint16_t traitKind)
+static void* DeegenSnippet_CreateNewJitGenericIc(JitGenericInlineCacheSite* site, uint16_t traitKind, void** jitDataSecAddr)
 {
-    return site->Insert(traitKind);
+    return site->Insert(traitKind, jitDataSecAddr);
 }
 
 DEFINE_DEEGEN_COMMON_SNIPPET("CreateNewJitGenericIC", DeegenSnippet_CreateNewJitGenericIc)
@@ -0,0 +1,20 @@
+#include "force_release_build.h"
+
+#include "define_deegen_common_snippet.h"
+#include "runtime_utils.h"
+
+static void DeegenSnippet_UpdateValueProfile(uint64_t tv, void* profileAddr)
+{
+    // The SlowPathData stream is byte-packed, so the profile may be unaligned
+    //
+    TypeSpeculationMask oldMask = UnalignedLoad<TypeSpeculationMask>(profileAddr);
+    TypeSpeculationMask newMask = oldMask | GetTypeSpeculationMaskForValue(TValue { tv });
+    // Only write when the profile actually changes, so a stable profile never dirties the cache line
+    //
+    if (newMask != oldMask)
+    {
+        UnalignedStore<TypeSpeculationMask>(profileAddr, newMask);
+    }
+}
+
+DEFINE_DEEGEN_COMMON_SNIPPET("UpdateValueProfile", DeegenSnippet_UpdateValueProfile)
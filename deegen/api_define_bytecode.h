@@ -813,6 +813,19 @@ struct DeegenFrontendBytecodeDefinitionDescriptor
         m_isInterpreterTierUpPoint = value;
     }
 
+    // If this API is called with 'value' = true, the baseline JIT fast path records the type of each Slot operand into a value profile,
+    // which the DFG uses to decide what to speculate on.
+    // The profiling has overhead on every execution of the bytecode, so one should only add this property for bytecodes
+    // whose DFG lowering benefits from type speculation (arithmetic, comparison and table access).
+    //
+    // Currently no bytecode enables this: the DFG frontend does not build speculated edges from the profiles yet,
+    // and there is no point paying for the profiling in the baseline JIT fast path until it does.
+    //
+    consteval void EnableValueProfiling(bool value)
+    {
+        m_isValueProfilingEnabled = value;
+    }
+
     consteval OperandRef Op(std::string_view name)
     {
         ReleaseAssert(m_operandTypeListInitialized);
@@ -898,6 +911,7 @@ struct DeegenFrontendBytecodeDefinitionDescriptor
         , m_hasVariadicResOutput(false)
         , m_canPerformBranch(false)
         , m_isInterpreterTierUpPoint(false)
+        , m_isValueProfilingEnabled(false)
         , m_implementationFn(nullptr)
         , m_bcLevelDeclareReadsCalled(false)
         , m_numOperands(0)
@@ -919,6 +933,7 @@ struct DeegenFrontendBytecodeDefinitionDescriptor
     bool m_hasVariadicResOutput;
     bool m_canPerformBranch;
     bool m_isInterpreterTierUpPoint;
+    bool m_isValueProfilingEnabled;
     void* m_implementationFn;
     bool m_bcLevelDeclareReadsCalled;
     size_t m_numOperands;
@@ -12,6 +12,7 @@ template<typename ResType> ResType DeegenImpl_MakeIC_SetMainLambda(ICHandler* ic
 template<typename ResType> ResType DeegenImpl_MakeIC_MarkEffect(ICHandler* ic, const void* cp, const void* fpp);
 template<typename ResType> ResType DeegenImpl_MakeIC_MarkEffectValue(ICHandler* ic, const ResType& value);
 void DeegenImpl_MakeIC_SetUncacheableForThisExecution(ICHandler* ic);
+bool DeegenImpl_MakeIC_IsMegamorphic(ICHandler* ic);
 template<typename ICCaptureType, typename... Rest> void DeegenImpl_MakeIC_SpecializeIcEffect(bool isFullCoverage, const ICCaptureType* capture, Rest... values);
 void DeegenImpl_MakeIC_SetShouldFuseICIntoInterpreterOpcode(ICHandler* ic);
 template<typename ICCaptureType> void DeegenImpl_MakeIC_SpecifyIcCaptureValueRange(const ICCaptureType* capture, int64_t rangeLowInclusive, int64_t rangeHighInclusive);
@@ -78,6 +79,16 @@ struct ICHandler
         DeegenImpl_MakeIC_SetUncacheableForThisExecution(this);
     }
 
+    // Can only be used in the main lambda
+    // Returns true if the IC site has already reached the maximum number of IC entries, so the main lambda will run on
+    // every execution from now on, and Effect/EffectValue will not create new IC entries.
+    // Always returns false in the interpreter, since the interpreter IC holds one entry and replaces it on every miss.
+    //
+    bool WARN_UNUSED ALWAYS_INLINE IsMegamorphic()
+    {
+        return DeegenImpl_MakeIC_IsMegamorphic(this);
+    }
+
     // Can only be used in the main lambda.
     // At most one 'Effect' call may be executed in every possible execution path.
     // Creates an IC entry with the given lambda.
@@ -1738,6 +1738,12 @@ static AstInlineCache WARN_UNUSED AstInlineCacheParseOneUse(llvm::CallInst* orig
                         ReleaseAssert(callInst->getArgOperand(0) == r.m_bodyFn->getArg(r.m_bodyFnIcPtrArgOrd));
                         r.m_setUncacheableApiCalls.push_back(callInst);
                     }
+                    if (symName.find("DeegenImpl_MakeIC_IsMegamorphic(") != std::string::npos)
+                    {
+                        ReleaseAssert(callInst->arg_size() == 1);
+                        ReleaseAssert(callInst->getArgOperand(0) == r.m_bodyFn->getArg(r.m_bodyFnIcPtrArgOrd));
+                        r.m_isMegamorphicApiCalls.push_back(callInst);
+                    }
                 }
             }
         }
@@ -2370,6 +2376,16 @@ void AstInlineCache::DoLoweringForInterpreter()
         setUncacheableApiCall->eraseFromParent();
     }
 
+    // Lower the IsMegamorphic() APIs
+    // The interpreter IC only holds one entry and replaces it on every miss, so it is never megamorphic
+    //
+    for (CallInst* isMegamorphicApiCall : m_isMegamorphicApiCalls)
+    {
+        ReleaseAssert(llvm_value_has_type<bool>(isMegamorphicApiCall));
+        isMegamorphicApiCall->replaceAllUsesWith(CreateLLVMConstantInt<bool>(ctx, false));
+        isMegamorphicApiCall->eraseFromParent();
+    }
+
     // Create the slow path logic, which should simply call the IC body
     //
     {
@@ -2400,6 +2416,17 @@ void AstInlineCache::DoLoweringForInterpreter()
 void AstInlineCache::DoTrivialLowering()
 {
     using namespace llvm;
+    LLVMContext& ctx = m_bodyFn->getContext();
+
+    // Lower the IsMegamorphic() APIs
+    // No IC will be created, so there is no IC site that could have reached its maximum number of entries
+    //
+    for (CallInst* isMegamorphicApiCall : m_isMegamorphicApiCalls)
+    {
+        ReleaseAssert(llvm_value_has_type<bool>(isMegamorphicApiCall));
+        isMegamorphicApiCall->replaceAllUsesWith(CreateLLVMConstantInt<bool>(ctx, false));
+        isMegamorphicApiCall->eraseFromParent();
+    }
 
     // Lower each Effect API in the IC body
     // No IC will be created, so it's sufficient to simply call the effect function
@@ -2836,6 +2863,24 @@ AstInlineCache::BaselineJitLLVMLoweringResult WARN_UNUSED AstInlineCache::DoLowe
         setUncacheableApiCall->eraseFromParent();
     }
 
+    // Lower the IsMegamorphic() APIs
+    // The IC site is megamorphic if it has reached the maximum number of IC entries, so no more IC will be created for it
+    // Note that for baseline JIT, the icPtr in the body function is actually the SlowPathData
+    //
+    for (CallInst* isMegamorphicApiCall : m_isMegamorphicApiCalls)
+    {
+        ReleaseAssert(llvm_value_has_type<bool>(isMegamorphicApiCall));
+        Value* slowPathData = m_bodyFn->getArg(m_bodyFnIcPtrArgOrd);
+        size_t offset = ifi->GetBytecodeDef()->GetBaselineJitSlowPathDataLayout()->m_genericICs.GetOffsetForSite(icUsageOrdInBytecode);
+        offset += offsetof_member_v<&JitGenericInlineCacheSite::m_numEntries>;
+        Value* numExistingIcAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), slowPathData,
+                                                                     { CreateLLVMConstantInt<uint64_t>(ctx, offset) }, "", isMegamorphicApiCall);
+        Value* numExistingIc = new LoadInst(llvm_type_of<uint8_t>(ctx), numExistingIcAddr, "", isMegamorphicApiCall);
+        Value* isMegamorphic = new ICmpInst(isMegamorphicApiCall, ICmpInst::ICMP_UGE, numExistingIc, CreateLLVMConstantInt<uint8_t>(ctx, SafeIntegerCast<uint8_t>(x_maxJitGenericInlineCacheEntries)));
+        isMegamorphicApiCall->replaceAllUsesWith(isMegamorphic);
+        isMegamorphicApiCall->eraseFromParent();
+    }
+
     // Lower the body function
     // Note that for baseline JIT, the icPtr in the body function is actually the SlowPathData
     //
@@ -2951,19 +2996,26 @@ AstInlineCache::BaselineJitLLVMLoweringResult WARN_UNUSED AstInlineCache::DoLowe
         Value* icKeyValI64 = castIcStateCaptureToI64(m_bodyFn->getArg(m_bodyFnIcKeyArgOrd), createIcLogicInsertionPt);
         ReleaseAssert(llvm_value_has_type<uint64_t>(icKeyValI64));
 
-        auto emitCallToCodegenFnImpl = [&](size_t icEffectGlobalOrd, bool isPopulatingInlineSlab, llvm::Value* jitDestAddr, Instruction* insertBefore)
+        auto emitCallToCodegenFnImpl = [&](size_t icEffectGlobalOrd,
+                                           bool isPopulatingInlineSlab,
+                                           llvm::Value* jitDestAddr,
+                                           llvm::Value* jitDataSecDestAddr,
+                                           Instruction* insertBefore)
         {
             ReleaseAssertIff(isPopulatingInlineSlab, jitDestAddr == nullptr);
+            ReleaseAssertIff(isPopulatingInlineSlab, jitDataSecDestAddr == nullptr);
 
             // Create the declaration for the codegen implementation function, and call it
             // The codegen implementation has the following prototype:
             //     void* dest: the address to populate JIT code
+            //     void* dataSecDest: the address to populate the IC data section, nullptr if the IC has no data section
             //     void* slowPathData: the SlowPathData for this bytecode
             //     uint64_t icKey: the IC Key casted as i64
             // followed by all the values in the IC state in i64
             //
             std::vector<Value*> cgFnArgs;
             cgFnArgs.push_back(isPopulatingInlineSlab ? ConstantPointerNull::get(PointerType::get(ctx, 0 /*addrSpace*/)) : jitDestAddr);
+            cgFnArgs.push_back(isPopulatingInlineSlab ? ConstantPointerNull::get(PointerType::get(ctx, 0 /*addrSpace*/)) : jitDataSecDestAddr);
             cgFnArgs.push_back(slowPathData);
             cgFnArgs.push_back(icKeyValI64);
             for (Value* val : icStateCaptureI64List)
@@ -3039,18 +3091,21 @@ AstInlineCache::BaselineJitLLVMLoweringResult WARN_UNUSED AstInlineCache::DoLowe
 
                 // Call GenericInlineCacheSite::Insert, which allocates space of the IC and do all the bookkeeping
                 //
+                AllocaInst* jitDataSecAddrAlloca = new AllocaInst(llvm_type_of<void*>(ctx), 0 /*addrSpace*/, "",
+                                                                  &*m_bodyFn->getEntryBlock().getFirstInsertionPt());
                 Constant* icEffectGlobalOrdCst = CreateLLVMConstantInt<uint16_t>(ctx, static_cast<uint16_t>(icEffectGlobalOrd));
-                Value* jitAddr = CreateCallToDeegenCommonSnippet(module, "CreateNewJitGenericIC", { icSite, icEffectGlobalOrdCst }, insPt);
+                Value* jitAddr = CreateCallToDeegenCommonSnippet(module, "CreateNewJitGenericIC", { icSite, icEffectGlobalOrdCst, jitDataSecAddrAlloca }, insPt);
                 ReleaseAssert(llvm_value_has_type<void*>(jitAddr));
+                Value* jitDataSecAddr = new LoadInst(llvm_type_of<void*>(ctx), jitDataSecAddrAlloca, "", insPt);
 
-                emitCallToCodegenFnImpl(icEffectGlobalOrd, false /*isPopulatingInlineSlab*/, jitAddr, insPt);
+                emitCallToCodegenFnImpl(icEffectGlobalOrd, false /*isPopulatingInlineSlab*/, jitAddr, jitDataSecAddr, insPt);
             }
 
             // Create logic for generating the inline slab
             //
             {
                 Instruction* insPt = BranchInst::Create(afterIcCreationBB /*dest*/, inlineSlabBB /*insertAtEnd*/);
-                emitCallToCodegenFnImpl(icEffectGlobalOrd, true /*isPopulatingInlineSlab*/, nullptr /*jitAddr*/, insPt);
+                emitCallToCodegenFnImpl(icEffectGlobalOrd, true /*isPopulatingInlineSlab*/, nullptr /*jitAddr*/, nullptr /*jitDataSecAddr*/, insPt);
             }
 
             r.m_effectPlaceholderDesc.push_back({
@@ -3337,31 +3392,20 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
     ReleaseAssertImp(isCodegenForInlineSlab, cgRes.m_dataSecPreFixupCode.size() == 0 && cgRes.m_dataSecAlignment == 1);
     ReleaseAssertImp(isCodegenForInlineSlab, cgRes.m_icPathPreFixupCode.size() == inlineSlabInfo.m_smcRegionLength);
 
-    // For simplicity, the IC logic currently always put its private data section right after the code section
+    // The private data section of the IC is allocated separately from the code, from the non-executable JIT data memory,
+    // so that the IC data is never executable. The runtime passes in its address as the second param.
     //
-    size_t dataSectionOffset;
     {
-        dataSectionOffset = cgRes.m_icPathPreFixupCode.size();
         size_t alignment = cgRes.m_dataSecAlignment;
         ReleaseAssert(alignment > 0);
         ReleaseAssert(alignment <= x_baselineJitMaxPossibleDataSectionAlignment);
         // Our codegen allocator allocates 16-byte-aligned memory, so the data section alignment must not exceed that
         //
         ReleaseAssert(alignment <= 16);
-        dataSectionOffset = (dataSectionOffset + alignment - 1) / alignment * alignment;
     }
 
-    std::vector<uint8_t> codeAndData;
-    {
-        codeAndData = cgRes.m_icPathPreFixupCode;
-        ReleaseAssert(dataSectionOffset >= codeAndData.size());
-        while (codeAndData.size() < dataSectionOffset)
-        {
-            codeAndData.push_back(0);
-        }
-        ReleaseAssert(codeAndData.size() == dataSectionOffset);
-        codeAndData.insert(codeAndData.end(), cgRes.m_dataSecPreFixupCode.begin(), cgRes.m_dataSecPreFixupCode.end());
-    }
+    const std::vector<uint8_t>& icCode = cgRes.m_icPathPreFixupCode;
+    const std::vector<uint8_t>& icData = cgRes.m_dataSecPreFixupCode;
 
     std::unique_ptr<Module> module = cgRes.GenerateCodegenLogicLLVMModule(ifi->GetModule());
 
@@ -3379,6 +3423,7 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
     //
     std::vector<Type*> cgFnArgTys;
     cgFnArgTys.push_back(llvm_type_of<void*>(ctx));     // jitAddr
+    cgFnArgTys.push_back(llvm_type_of<void*>(ctx));     // jitDataSecAddr
     cgFnArgTys.push_back(llvm_type_of<void*>(ctx));     // slowPathData
     cgFnArgTys.push_back(llvm_type_of<uint64_t>(ctx));  // icKey
     for (size_t i = 0; i < icInfo.m_numPlaceholders; i++)
@@ -3393,18 +3438,19 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
     cgFn->addFnAttr(Attribute::NoUnwind);
     CopyFunctionAttributes(cgFn /*dst*/, cgCodeFn /*src*/);
 
-    // For codegen inline slab logic, the passed in 'jitAddr' is always nullptr
+    // For codegen inline slab logic, the passed in 'jitAddr' and 'jitDataSecAddr' are always nullptr
     //
     if (!isCodegenForInlineSlab)
     {
         cgFn->addParamAttr(0, Attribute::NoAlias);
+        cgFn->addParamAttr(1, Attribute::NoAlias);
     }
 
-    cgFn->addParamAttr(1, Attribute::NoAlias);
+    cgFn->addParamAttr(2, Attribute::NoAlias);
 
     BasicBlock* bb = BasicBlock::Create(ctx, "", cgFn);
 
-    Value* slowPathData = cgFn->getArg(1);
+    Value* slowPathData = cgFn->getArg(2);
 
     Value* mainLogicFastPath = slowPathDataLayout->m_jitAddr.EmitGetValueLogic(slowPathData, bb);
 
@@ -3423,9 +3469,23 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
                                                         { CreateLLVMConstantInt<uint64_t>(ctx, inlineSlabInfo.m_smcRegionOffset) }, "", bb);
     }
 
-    Value* icKeyI64 = cgFn->getArg(2);
+    // The data section is nullptr if it is empty. In that case the data section codegen function writes nothing,
+    // and the IC code never references the data section, so it is fine to pass in a garbage address.
+    // The inline slab never has a data section (asserted above).
+    //
+    Value* destJitDataSecAddr = nullptr;
+    if (!isCodegenForInlineSlab && icData.size() > 0)
+    {
+        destJitDataSecAddr = cgFn->getArg(1);
+    }
+    else
+    {
+        destJitDataSecAddr = destJitAddr;
+    }
+
+    Value* icKeyI64 = cgFn->getArg(3);
     std::vector<Value*> inputPlaceholders;
-    for (size_t i = 3; i < cgFn->arg_size(); i++)
+    for (size_t i = 4; i < cgFn->arg_size(); i++)
     {
         inputPlaceholders.push_back(cgFn->getArg(static_cast<uint32_t>(i)));
     }
@@ -3473,8 +3533,6 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
     Value* mainLogicSlowPath = slowPathDataLayout->m_jitSlowPathAddr.EmitGetValueLogic(slowPathData, bb);
     headerArgsList.push_back(new PtrToIntInst(mainLogicSlowPath, llvm_type_of<uint64_t>(ctx), "", bb));
     headerArgsList.push_back(new PtrToIntInst(destJitAddr, llvm_type_of<uint64_t>(ctx), "", bb));
-    Value* destJitDataSecAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), destJitAddr,
-                                                                  { CreateLLVMConstantInt<uint64_t>(ctx, dataSectionOffset) }, "", bb);
     headerArgsList.push_back(new PtrToIntInst(destJitDataSecAddr, llvm_type_of<uint64_t>(ctx), "", bb));
     Value* mainLogicDataSec = slowPathDataLayout->m_jitDataSecAddr.EmitGetValueLogic(slowPathData, bb);
     headerArgsList.push_back(new PtrToIntInst(mainLogicDataSec, llvm_type_of<uint64_t>(ctx), "", bb));
@@ -3618,7 +3676,12 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
         validateArgs(cgDataFn);
     }
 
-    ReleaseAssertImp(isCodegenForInlineSlab, codeAndData.size() == inlineSlabInfo.m_smcRegionLength);
+    ReleaseAssertImp(isCodegenForInlineSlab, icCode.size() == inlineSlabInfo.m_smcRegionLength);
+
+    // The IC is written through the writable alias, while all the addresses in the code are computed from the JIT addresses
+    //
+    Value* destJitAddrAlias = EmitGetJitWritableAlias(destJitAddr, bb);
+    Value* destJitDataSecAddrAlias = EmitGetJitWritableAlias(destJitDataSecAddr, bb);
 
     // Memcpy the unrelocated code and data
     //
@@ -3627,7 +3690,11 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
         // If we are generating an outlined IC case, since the allocated region is always 16-byte aligned, it's safe to up-align to 8-byte
         //
         bool mustBeExact = isCodegenForInlineSlab;
-        EmitCopyLogicForBaselineJitCodeGen(module.get(), codeAndData, destJitAddr, "deegen_ic_pre_fixup_code_and_data", bb, mustBeExact);
+        EmitCopyLogicForBaselineJitCodeGen(module.get(), icCode, destJitAddrAlias, "deegen_ic_pre_fixup_code", bb, mustBeExact);
+        if (icData.size() > 0)
+        {
+            EmitCopyLogicForBaselineJitCodeGen(module.get(), icData, destJitDataSecAddrAlias, "deegen_ic_pre_fixup_data", bb);
+        }
     }
 
     // Create calls to patch the code section and data section
@@ -3641,8 +3708,8 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
         CallInst::Create(target, args, "", bb);
     };
 
-    emitPatchFnCall(cgCodeFn, destJitAddr);
-    emitPatchFnCall(cgDataFn, destJitDataSecAddr);
+    emitPatchFnCall(cgCodeFn, destJitAddrAlias);
+    emitPatchFnCall(cgDataFn, destJitDataSecAddrAlias);
 
     // Update SMC region to jump to the newly created IC case
     // We only (and must only) do this for the outlined IC case. If we are generating the inline slab, the patchable jump is already overwritten.
@@ -3682,7 +3749,8 @@ AstInlineCache::BaselineJitCodegenResult WARN_UNUSED AstInlineCache::CreateJitIc
     return {
         .m_module = std::move(module),
         .m_resultFnName = cgFnName,
-        .m_icSize = codeAndData.size(),
+        .m_icSize = icCode.size(),
+        .m_icDataSecSize = icData.size(),
         .m_disasmForAudit = disasmForAudit
     };
 }
@@ -3848,7 +3916,7 @@ AstInlineCache::BaselineJitFinalLoweringResult WARN_UNUSED AstInlineCache::DoLow
 
     size_t fallthroughPlaceholderOrd = DeegenPlaceholderUtils::FindFallthroughPlaceholderOrd(ifi->GetStencilRcDefinitions());
 
-    std::map<uint64_t /*globalOrd*/, uint64_t /*icSize*/> genericIcSizeMap;
+    std::map<uint64_t /*globalOrd*/, std::pair<uint64_t /*icSize*/, uint64_t /*icDataSecSize*/>> genericIcSizeMap;
     std::vector<std::string> genericIcAuditInfo;
     size_t globalIcTraitOrdBase = gbta.GetGenericIcEffectTraitBaseOrdinal(ifi->GetBytecodeDef()->GetBytecodeIdName());
     for (size_t icUsageOrd = 0; icUsageOrd < icAsmRes.size(); icUsageOrd++)
@@ -4256,7 +4324,7 @@ AstInlineCache::BaselineJitFinalLoweringResult WARN_UNUSED AstInlineCache::DoLow
             auditInfo += disAsmForAuditPfx + cgRes.m_disasmForAudit;
 
             ReleaseAssert(!genericIcSizeMap.count(icGlobalOrd));
-            genericIcSizeMap[icGlobalOrd] = cgRes.m_icSize;
+            genericIcSizeMap[icGlobalOrd] = std::make_pair(cgRes.m_icSize, cgRes.m_icDataSecSize);
         }
 
         auditInfo += inlineSlabAuditLog;
@@ -4280,7 +4348,8 @@ AstInlineCache::BaselineJitFinalLoweringResult WARN_UNUSED AstInlineCache::DoLow
     {
         finalRes.m_icTraitInfo.push_back({
             .m_ordInTraitTable = it.first,
-            .m_allocationLength = it.second
+            .m_allocationLength = it.second.first,
+            .m_dataSectionLength = it.second.second
         });
     }
 
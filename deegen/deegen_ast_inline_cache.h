@@ -187,6 +187,9 @@ public:
         std::unique_ptr<llvm::Module> m_module;
         std::string m_resultFnName;
         size_t m_icSize;
+        // The IC data section is allocated separately from the code, in non-executable memory
+        //
+        size_t m_icDataSecSize;
         std::string m_disasmForAudit;
     };
 
@@ -225,6 +228,9 @@ public:
         {
             size_t m_ordInTraitTable;
             size_t m_allocationLength;
+            // 0 if the IC has no data section
+            //
+            size_t m_dataSectionLength;
         };
 
         std::unique_ptr<llvm::Module> m_icBodyModule;
@@ -297,6 +303,7 @@ public:
     // The list of other misc API calls used in this IC
     //
     std::vector<llvm::CallInst*> m_setUncacheableApiCalls;
+    std::vector<llvm::CallInst*> m_isMegamorphicApiCalls;
 
     // This is populated by 'DoLoweringForInterpreter'
     // The IC state definition
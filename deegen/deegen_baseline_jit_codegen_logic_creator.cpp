@@ -392,6 +392,7 @@ DeegenBytecodeBaselineJitInfo WARN_UNUSED DeegenBytecodeBaselineJitInfo::Create(
         res.m_allCallIcTraitDescs.push_back({
             .m_ordInTraitTable = bcTraitAccessor.GetJitCallIcTraitOrd(bytecodeIdName, callIcCgRes.m_uniqueOrd, true /*isDirectCall*/),
             .m_allocationLength = callIcCgRes.m_dcIcSize,
+            .m_dataSectionLength = callIcCgRes.m_dcIcDataSecSize,
             .m_isDirectCall = true,
             .m_codePtrPatchRecords = callIcCgRes.m_dcIcCodePtrPatchRecords
         });
@@ -399,6 +400,7 @@ DeegenBytecodeBaselineJitInfo WARN_UNUSED DeegenBytecodeBaselineJitInfo::Create(
         res.m_allCallIcTraitDescs.push_back({
             .m_ordInTraitTable = bcTraitAccessor.GetJitCallIcTraitOrd(bytecodeIdName, callIcCgRes.m_uniqueOrd, false /*isDirectCall*/),
             .m_allocationLength = callIcCgRes.m_ccIcSize,
+            .m_dataSectionLength = callIcCgRes.m_ccIcDataSecSize,
             .m_isDirectCall = false,
             .m_codePtrPatchRecords = callIcCgRes.m_ccIcCodePtrPatchRecords
         });
@@ -723,10 +725,14 @@ DeegenBytecodeBaselineJitInfo WARN_UNUSED DeegenBytecodeBaselineJitInfo::Create(
     }
 
     // Create logic that copies the pre-fixup bytes for each section
+    // The bytes are written through the writable alias, while all the addresses in the code are computed from the JIT addresses
     //
-    EmitCopyLogicForBaselineJitCodeGen(module.get(), fastPath.m_code, fastPathBaseAddr, "deegen_fastpath_prefixup_code", entryBB /*insertAtEnd*/);
-    EmitCopyLogicForBaselineJitCodeGen(module.get(), slowPath.m_code, slowPathBaseAddr, "deegen_slowpath_prefixup_code", entryBB /*insertAtEnd*/);
-    EmitCopyLogicForBaselineJitCodeGen(module.get(), dataSec.m_code, dataSecBaseAddr, "deegen_datasec_prefixup_code", entryBB /*insertAtEnd*/);
+    Value* fastPathBaseAddrAlias = EmitGetJitWritableAlias(fastPathBaseAddr, entryBB);
+    Value* slowPathBaseAddrAlias = EmitGetJitWritableAlias(slowPathBaseAddr, entryBB);
+    Value* dataSecBaseAddrAlias = EmitGetJitWritableAlias(dataSecBaseAddr, entryBB);
+    EmitCopyLogicForBaselineJitCodeGen(module.get(), fastPath.m_code, fastPathBaseAddrAlias, "deegen_fastpath_prefixup_code", entryBB /*insertAtEnd*/);
+    EmitCopyLogicForBaselineJitCodeGen(module.get(), slowPath.m_code, slowPathBaseAddrAlias, "deegen_slowpath_prefixup_code", entryBB /*insertAtEnd*/);
+    EmitCopyLogicForBaselineJitCodeGen(module.get(), dataSec.m_code, dataSecBaseAddrAlias, "deegen_datasec_prefixup_code", entryBB /*insertAtEnd*/);
 
     // Emit calls to the patch logic
     //
@@ -791,9 +797,15 @@ DeegenBytecodeBaselineJitInfo WARN_UNUSED DeegenBytecodeBaselineJitInfo::Create(
             callee->addFnAttr(Attribute::AlwaysInline);
         };
 
-        emitPatchLogic(cgi.fastPathPatchFn, fastPathAddr);
-        emitPatchLogic(cgi.slowPathPatchFn, slowPathAddr);
-        emitPatchLogic(cgi.dataSecPatchFn, dataSecAddr);
+        auto getAliasAddr = [&](Value* aliasBase, size_t offset) WARN_UNUSED -> Value*
+        {
+            return GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), aliasBase,
+                                                     { CreateLLVMConstantInt<uint64_t>(ctx, offset) }, "", entryBB);
+        };
+
+        emitPatchLogic(cgi.fastPathPatchFn, getAliasAddr(fastPathBaseAddrAlias, cgi.offsetInFastPath));
+        emitPatchLogic(cgi.slowPathPatchFn, getAliasAddr(slowPathBaseAddrAlias, cgi.offsetInSlowPath));
+        emitPatchLogic(cgi.dataSecPatchFn, getAliasAddr(dataSecBaseAddrAlias, cgi.offsetInDataSec));
     }
 
     // Emit slowPathDataIndex (slowPathDataOffset and bytecodePtr32)
@@ -920,6 +932,20 @@ DeegenBytecodeBaselineJitInfo WARN_UNUSED DeegenBytecodeBaselineJitInfo::Create(
             totalFieldsWritten++;
         }
 
+        // Initialize all the value profiles to an empty type mask
+        //
+        if (slowPathDataLayout->m_valueProfiles.IsValid())
+        {
+            for (size_t i = 0; i < slowPathDataLayout->m_valueProfiles.GetNumProfiles(); i++)
+            {
+                size_t offset = slowPathDataLayout->m_valueProfiles.GetOffsetForProfile(i);
+                Value* addr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), slowPathData,
+                                                                { CreateLLVMConstantInt<uint64_t>(ctx, offset) }, "", entryBB);
+                new StoreInst(CreateLLVMConstantInt<TypeSpeculationMask>(ctx, x_typeSpeculationMaskFor<tBottom>), addr, false /*isVolatile*/, Align(1), entryBB);
+            }
+            totalFieldsWritten++;
+        }
+
         Constant* advanceOffset = CreateLLVMConstantInt<uint64_t>(ctx, bytecodeDef->GetBaselineJitSlowPathDataLength());
         advancedSlowPathData = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), slowPathData,
                                                                  { advanceOffset }, "", entryBB);
@@ -22,8 +22,11 @@ struct DeegenBytecodeBaselineJitInfo
     {
         size_t m_ordInTraitTable;
         size_t m_allocationLength;
+        // 0 if the IC has no data section
+        //
+        size_t m_dataSectionLength;
         bool m_isDirectCall;
-        std::vector<std::pair<size_t /*offset*/, bool /*is64*/>> m_codePtrPatchRecords;
+        std::vector<JitCallIcCodePtrPatchRecord> m_codePtrPatchRecords;
     };
 
     std::vector<CallIcTraitDesc> m_allCallIcTraitDescs;
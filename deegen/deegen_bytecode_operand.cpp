@@ -556,6 +556,7 @@ std::vector<std::vector<std::unique_ptr<BytecodeVariantDefinition>>> WARN_UNUSED
         bool hasTValueOutput = curDefReader.GetValue<&Desc::m_hasTValueOutput>();
         bool canPerformBranch = curDefReader.GetValue<&Desc::m_canPerformBranch>();
         bool isInterpreterToBaselineJitOsrEntryPoint = curDefReader.GetValue<&Desc::m_isInterpreterTierUpPoint>();
+        bool isValueProfilingEnabled = curDefReader.GetValue<&Desc::m_isValueProfilingEnabled>();
 
         size_t intrinsicOrd = curDefReader.GetValue<&Desc::m_intrinsicOrd>();
 
@@ -614,6 +615,7 @@ std::vector<std::vector<std::unique_ptr<BytecodeVariantDefinition>>> WARN_UNUSED
             def->m_bytecodeMayFallthroughToNextBytecodeDetermined = false;
             def->m_bytecodeMayMakeTailCallDetermined = false;
             def->m_isInterpreterToBaselineJitOsrEntryPoint = isInterpreterToBaselineJitOsrEntryPoint;
+            def->m_isValueProfilingEnabled = isValueProfilingEnabled;
             if (hasTValueOutput)
             {
                 def->m_outputOperand = std::make_unique<BcOpSlot>("output");
@@ -1077,6 +1079,7 @@ BytecodeVariantDefinition::BytecodeVariantDefinition(json& j)
     JSONCheckedGet(j, "num_total_generic_ic_effect_kinds", m_totalGenericIcEffectKinds);
 
     JSONCheckedGet(j, "is_interpreter_to_baseline_jit_osr_entry_point", m_isInterpreterToBaselineJitOsrEntryPoint);
+    JSONCheckedGet(j, "is_value_profiling_enabled", m_isValueProfilingEnabled);
     JSONCheckedGet(j, "rcw_info_funcs", m_rcwInfoFuncs);
 
     JSONCheckedGet(j, "bc_intrinsic_ord", m_bcIntrinsicOrd);
@@ -1155,6 +1158,7 @@ json WARN_UNUSED BytecodeVariantDefinition::SaveToJSON()
     j["num_total_generic_ic_effect_kinds"] = GetTotalGenericIcEffectKinds();
 
     j["is_interpreter_to_baseline_jit_osr_entry_point"] = m_isInterpreterToBaselineJitOsrEntryPoint;
+    j["is_value_profiling_enabled"] = m_isValueProfilingEnabled;
     j["rcw_info_funcs"] = m_rcwInfoFuncs;
 
     j["bc_intrinsic_ord"] = m_bcIntrinsicOrd;
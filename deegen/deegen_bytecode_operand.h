@@ -688,6 +688,7 @@ public:
         , m_bytecodeMayMakeTailCallDetermined(false)
         , m_bytecodeMayMakeTailCall(false)
         , m_isInterpreterToBaselineJitOsrEntryPoint(false)
+        , m_isValueProfilingEnabled(false)
         , m_bytecodeStructLength(static_cast<size_t>(-1))
         , m_baselineJitSlowPathData(nullptr)
         , m_dfgJitSlowPathData(nullptr)
@@ -990,6 +991,10 @@ public:
 
     bool m_isInterpreterToBaselineJitOsrEntryPoint;
 
+    // Whether the baseline JIT should record value profiles for the Slot operands of this bytecode
+    //
+    bool m_isValueProfilingEnabled;
+
 private:
     void AssignMetadataStructInfo(BytecodeMetadataStructBase::StructInfo info)
     {
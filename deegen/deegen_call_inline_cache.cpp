@@ -1504,8 +1504,9 @@ struct CreateCodegenCallIcLogicImplResult
 {
     std::unique_ptr<llvm::Module> m_module;
     std::string m_disasmForAudit;
-    std::vector<std::pair<size_t /*offset*/, bool /*is64*/>> m_codePtrPatchRecords;
+    std::vector<JitCallIcCodePtrPatchRecord> m_codePtrPatchRecords;
     size_t m_icSize;
+    size_t m_icDataSecSize;
     std::string m_resFnName;
 };
 
@@ -1513,13 +1514,14 @@ struct CreateCodegenCallIcLogicImplResult
 //
 // The function takes the following arguments:
 //    0 void* addr: the address to codegen the IC
-//    1 uint64_t slowPathDataOffset: the offset of slowPathData in SlowPathData stream
-//    2 uint64_t codeBlock32: the owning function's codeblock32
-//  3-5 uint64_t fastPathAddr/slowPathAddr/dataSecAddr: the owning stencil (not bytecode!)'s fast/slow/data section address
-//    6 uint64_t icMissAddr: where to transfer control if IC misses
-//  7-8 uint64_t cbHeapU32/codePtr: info of the cached call target
-//    9 uint64_t tv: the TValue to call, caller shall pass in undef for closure-call case
-//   10 uint64_t condBrDest: the condBr dest of the bytecode, caller shall pass in undef if not exists
+//    1 void* icDataSecAddr: the address to codegen the IC data section, nullptr if the IC has no data section
+//    2 uint64_t slowPathDataOffset: the offset of slowPathData in SlowPathData stream
+//    3 uint64_t codeBlock32: the owning function's codeblock32
+//  4-6 uint64_t fastPathAddr/slowPathAddr/dataSecAddr: the owning stencil (not bytecode!)'s fast/slow/data section address
+//    7 uint64_t icMissAddr: where to transfer control if IC misses
+//  8-9 uint64_t cbHeapU32/codePtr: info of the cached call target
+//   10 uint64_t tv: the TValue to call, caller shall pass in undef for closure-call case
+//   11 uint64_t condBrDest: the condBr dest of the bytecode, caller shall pass in undef if not exists
 //
 // followed by the standard vector of bytecode operand info.
 //
@@ -1564,31 +1566,20 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
                                                                      ifi->GetStencilRcDefinitions(),
                                                                      extraPlaceholderOrds);
 
-    // For simplicity, the stencil currently always put its private data section right after the code section
+    // The private data section of the IC is allocated separately from the code, from the non-executable JIT data memory,
+    // so that the IC data is never executable. The runtime passes in its address as the second param.
     //
-    size_t dataSectionOffset;
     {
-        dataSectionOffset = cgRes.m_icPathPreFixupCode.size();
         size_t alignment = cgRes.m_dataSecAlignment;
         ReleaseAssert(alignment > 0);
         ReleaseAssert(alignment <= x_baselineJitMaxPossibleDataSectionAlignment);
         // Our codegen allocator allocates 16-byte-aligned memory, so the data section alignment must not exceed that
         //
         ReleaseAssert(alignment <= 16);
-        dataSectionOffset = (dataSectionOffset + alignment - 1) / alignment * alignment;
     }
 
-    std::vector<uint8_t> codeAndData;
-    {
-        codeAndData = cgRes.m_icPathPreFixupCode;
-        ReleaseAssert(dataSectionOffset >= codeAndData.size());
-        while (codeAndData.size() < dataSectionOffset)
-        {
-            codeAndData.push_back(0);
-        }
-        ReleaseAssert(codeAndData.size() == dataSectionOffset);
-        codeAndData.insert(codeAndData.end(), cgRes.m_dataSecPreFixupCode.begin(), cgRes.m_dataSecPreFixupCode.end());
-    }
+    const std::vector<uint8_t>& icCode = cgRes.m_icPathPreFixupCode;
+    const std::vector<uint8_t>& icData = cgRes.m_dataSecPreFixupCode;
 
     std::string disasmForAudit;
     {
@@ -1629,6 +1620,7 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
     //
     std::vector<Type*> cgArgTys;
     cgArgTys.push_back(llvm_type_of<void*>(ctx));       // outputAddr
+    cgArgTys.push_back(llvm_type_of<void*>(ctx));       // icDataSecAddr
     cgArgTys.push_back(llvm_type_of<uint64_t>(ctx));    // slowPathDataOffset
     cgArgTys.push_back(llvm_type_of<uint64_t>(ctx));    // codeBlock32
     cgArgTys.push_back(llvm_type_of<uint64_t>(ctx));    // fastPathAddr
@@ -1664,23 +1656,24 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
     fn->setDSOLocal(true);
 
     fn->addParamAttr(0, Attribute::NoAlias);
+    fn->addParamAttr(1, Attribute::NoAlias);
 
     BasicBlock* entryBB = BasicBlock::Create(ctx, "", fn);
 
     Value* icCodeAddr = fn->getArg(0);
-    // Value* slowPathDataOffset = fn->getArg(1);
-    // Value* codeBlock32 = fn->getArg(2);
+    // Value* slowPathDataOffset = fn->getArg(2);
+    // Value* codeBlock32 = fn->getArg(3);
 
-    Value* fastPathAddrI64 = fn->getArg(3);
-    Value* slowPathAddrI64 = fn->getArg(4);
-    Value* dataSecAddrI64 = fn->getArg(5);
+    Value* fastPathAddrI64 = fn->getArg(4);
+    Value* slowPathAddrI64 = fn->getArg(5);
+    Value* dataSecAddrI64 = fn->getArg(6);
 
-    Value* icMissDest = fn->getArg(6);
-    Value* calleeCbU32 = fn->getArg(7);
-    Value* targetFnCodePtr = fn->getArg(8);
+    Value* icMissDest = fn->getArg(7);
+    Value* calleeCbU32 = fn->getArg(8);
+    Value* targetFnCodePtr = fn->getArg(9);
 
-    Value* calledFnTValue = fn->getArg(9);
-    Value* condBrDest = fn->getArg(10);
+    Value* calledFnTValue = fn->getArg(10);
+    Value* condBrDest = fn->getArg(11);
 
     auto getExtraPlaceholderValue = [&](size_t placeholderOrd) WARN_UNUSED -> Value*
     {
@@ -1722,8 +1715,11 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
     }
 
     Value* icCodeAddrI64 = new PtrToIntInst(icCodeAddr, llvm_type_of<uint64_t>(ctx), "", entryBB);
-    Value* icDataAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), icCodeAddr,
-                                                          { CreateLLVMConstantInt<uint64_t>(ctx, dataSectionOffset) }, "", entryBB);
+
+    // The data section address is nullptr if it is empty. In that case the data section codegen function writes nothing,
+    // and the IC code never references the data section, so it is fine to use a garbage address.
+    //
+    Value* icDataAddr = (icData.size() > 0) ? fn->getArg(1) : icCodeAddr;
 
     Value* icDataAddrI64 = new PtrToIntInst(icDataAddr, llvm_type_of<uint64_t>(ctx), "", entryBB);
 
@@ -1765,7 +1761,16 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
         return args;
     };
 
-    EmitCopyLogicForBaselineJitCodeGen(module.get(), codeAndData, icCodeAddr, "deegen_ic_pre_fixup_code_and_data", entryBB);
+    // The IC is written through the writable alias, while all the addresses in the code are computed from the JIT addresses
+    //
+    Value* icCodeAddrAlias = EmitGetJitWritableAlias(icCodeAddr, entryBB);
+    Value* icDataAddrAlias = EmitGetJitWritableAlias(icDataAddr, entryBB);
+
+    EmitCopyLogicForBaselineJitCodeGen(module.get(), icCode, icCodeAddrAlias, "deegen_ic_pre_fixup_code", entryBB);
+    if (icData.size() > 0)
+    {
+        EmitCopyLogicForBaselineJitCodeGen(module.get(), icData, icDataAddrAlias, "deegen_ic_pre_fixup_data", entryBB);
+    }
 
     auto emitPatchFnCall = [&](Function* target, Value* dstAddr)
     {
@@ -1774,8 +1779,8 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
         CallInst::Create(target, args, "", entryBB);
     };
 
-    emitPatchFnCall(cgCodeFn, icCodeAddr);
-    emitPatchFnCall(cgDataFn, icDataAddr);
+    emitPatchFnCall(cgCodeFn, icCodeAddrAlias);
+    emitPatchFnCall(cgDataFn, icDataAddrAlias);
 
     ReturnInst::Create(ctx, nullptr, entryBB);
 
@@ -1802,9 +1807,10 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
 
     RunLLVMOptimizePass(module.get());
 
-    std::vector<std::pair<size_t /*offset*/, bool /*is64*/>> codePtrPatchRecords;
-    auto scanRelocationListForCodePtrPatches = [&](const std::vector<RelocationRecord>& rlist, size_t baseOffset)
+    std::vector<JitCallIcCodePtrPatchRecord> codePtrPatchRecords;
+    auto scanRelocationListForCodePtrPatches = [&](const std::vector<RelocationRecord>& rlist, bool isDataSection, size_t sectionLength)
     {
+        std::vector<JitCallIcCodePtrPatchRecord> list;
         for (const RelocationRecord& rr : rlist)
         {
             if (rr.m_symKind == RelocationRecord::SymKind::StencilHole)
@@ -1812,28 +1818,35 @@ static CreateCodegenCallIcLogicImplResult WARN_UNUSED CreateCodegenCallIcLogicIm
                 if (rr.m_stencilHoleOrd == CP_PLACEHOLDER_CALL_IC_CALLEE_CODE_PTR)
                 {
                     bool is64 = (rr.m_relocationType == ELF::R_X86_64_64);
-                    codePtrPatchRecords.push_back(std::make_pair(baseOffset + rr.m_offset, is64));
+                    list.push_back({
+                        .m_offset = rr.m_offset,
+                        .m_is64 = is64,
+                        .m_isInDataSection = isDataSection
+                    });
                 }
             }
         }
-    };
 
-    scanRelocationListForCodePtrPatches(stencil.m_icPathRelos, 0 /*baseOffset*/);
-    scanRelocationListForCodePtrPatches(stencil.m_privateDataObject.m_relocations, dataSectionOffset /*baseOffset*/);
+        std::sort(list.begin(), list.end(), [](const JitCallIcCodePtrPatchRecord& lhs, const JitCallIcCodePtrPatchRecord& rhs) { return lhs.m_offset < rhs.m_offset; });
 
-    std::sort(codePtrPatchRecords.begin(), codePtrPatchRecords.end());
+        for (size_t i = 0; i + 1 < list.size(); i++)
+        {
+            ReleaseAssert(list[i].m_offset + (list[i].m_is64 ? 8 : 4) <= list[i + 1].m_offset);
+        }
+        ReleaseAssertImp(list.size() > 0, list.back().m_offset + (list.back().m_is64 ? 8 : 4) <= sectionLength);
 
-    for (size_t i = 0; i + 1 < codePtrPatchRecords.size(); i++)
-    {
-        ReleaseAssert(codePtrPatchRecords[i].first + (codePtrPatchRecords[i].second ? 8 : 4) <= codePtrPatchRecords[i + 1].first);
-    }
-    ReleaseAssertImp(codePtrPatchRecords.size() > 0, codePtrPatchRecords.back().first + (codePtrPatchRecords.back().second ? 8 : 4) <= codeAndData.size());
+        codePtrPatchRecords.insert(codePtrPatchRecords.end(), list.begin(), list.end());
+    };
+
+    scanRelocationListForCodePtrPatches(stencil.m_icPathRelos, false /*isDataSection*/, icCode.size());
+    scanRelocationListForCodePtrPatches(stencil.m_privateDataObject.m_relocations, true /*isDataSection*/, icData.size());
 
     return {
         .m_module = std::move(module),
         .m_disasmForAudit = disasmForAudit,
         .m_codePtrPatchRecords = codePtrPatchRecords,
-        .m_icSize = RoundUpToMultipleOf<8>(codeAndData.size()),
+        .m_icSize = RoundUpToMultipleOf<8>(icCode.size()),
+        .m_icDataSecSize = icData.size(),
         .m_resFnName = resFnName
     };
 }
@@ -1971,6 +1984,10 @@ static CreateCodegenCallIcRepatchSmcRegionImplResult WARN_UNUSED CreateRepatchCa
 
     Value* fastPathAddrI64 = new PtrToIntInst(fastPathAddr, llvm_type_of<uint64_t>(ctx), "", entryBB);
 
+    // The SMC region is written through the writable alias of the fast path
+    //
+    Value* fastPathAddrAlias = EmitGetJitWritableAlias(fastPathAddr, entryBB);
+
     // Copy pre-fixup code to SMC region
     //
     {
@@ -1982,7 +1999,7 @@ static CreateCodegenCallIcRepatchSmcRegionImplResult WARN_UNUSED CreateRepatchCa
         }
         ReleaseAssert(smcRegionPreFixupCode.size() == smcRegionSize);
 
-        Value* dstAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), fastPathAddr,
+        Value* dstAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), fastPathAddrAlias,
                                                            { CreateLLVMConstantInt<uint64_t>(ctx, smcRegionOffset) }, "", entryBB);
 
         // The memcpy must not clobber anything after, so mustBeExact is true
@@ -1998,7 +2015,7 @@ static CreateCodegenCallIcRepatchSmcRegionImplResult WARN_UNUSED CreateRepatchCa
     auto buildArgVector = [&](Function* target) WARN_UNUSED -> std::vector<Value*>
     {
         std::vector<Value*> args;
-        args.push_back(fastPathAddr);
+        args.push_back(fastPathAddrAlias);
         args.push_back(fastPathAddrI64);
         args.push_back(slowPathAddrI64);
         args.push_back(UndefValue::get(llvm_type_of<uint64_t>(ctx)));
@@ -2245,6 +2262,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
     BasicBlock* entryBB = BasicBlock::Create(ctx, "", fn);
     AllocaInst* transitedToCCModeAlloca = new AllocaInst(llvm_type_of<uint8_t>(ctx), 0 /*addrSpace*/, "", entryBB);
     AllocaInst* jitAddrAlloca = new AllocaInst(llvm_type_of<void*>(ctx), 0 /*addrSpace*/, "", entryBB);
+    AllocaInst* jitDataSecAddrAlloca = new AllocaInst(llvm_type_of<void*>(ctx), 0 /*addrSpace*/, "", entryBB);
 
     new StoreInst(CreateLLVMConstantInt<uint8_t>(ctx, 0), transitedToCCModeAlloca, entryBB);
 
@@ -2361,6 +2379,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
 
     auto emitCallToIcCodegenFn = [&](Function* target,
                                      Value* outputAddr,
+                                     Value* outputDataSecAddr,
                                      Value* icMissAddr,
                                      Value* calleeCbU32,
                                      Value* codePtr,
@@ -2370,6 +2389,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
     {
         std::vector<Value*> args;
         args.push_back(outputAddr);
+        args.push_back(outputDataSecAddr);
         args.push_back(slowPathDataOffset);
         args.push_back(baselineCodeBlock32);
         args.push_back(fastPathAddrI64);
@@ -2413,7 +2433,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
     //
     {
         CallInst* dcJitAddr = CreateCallToDeegenCommonSnippet(module.get(), "CreateNewJitCallIcForDirectCallModeSite",
-                                                              { icSite, dcIcTraitOrd, targetTv, transitedToCCModeAlloca }, dcBB);
+                                                              { icSite, dcIcTraitOrd, targetTv, transitedToCCModeAlloca, jitDataSecAddrAlloca }, dcBB);
         ReleaseAssert(llvm_value_has_type<void*>(dcJitAddr));
 
         new StoreInst(dcJitAddr, jitAddrAlloca, dcBB);
@@ -2452,8 +2472,10 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
                                                                                                                          baselineCodeBlock32,
                                                                                                                          insertIcDcModeBB /*insertAtEnd*/);
         Value* condBrDest = getCondBrDestU64(insertIcDcModeBB);
+        Value* dcJitDataSecAddr = new LoadInst(llvm_type_of<void*>(ctx), jitDataSecAddrAlloca, "", insertIcDcModeBB);
         emitCallToIcCodegenFn(dcCgFn,
                               dcJitAddr /*outputAddr*/,
+                              dcJitDataSecAddr /*outputDataSecAddr*/,
                               icMissAddrI64,
                               calleeCbU32,
                               codePtrU64,
@@ -2520,7 +2542,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
     //
     {
         CallInst* ccJitAddr = CreateCallToDeegenCommonSnippet(module.get(), "CreateNewJitCallIcForClosureCallModeSite",
-                                                              { icSite, dcIcTraitOrd, targetTv }, prepareInsertIcCcModeBB);
+                                                              { icSite, dcIcTraitOrd, targetTv, jitDataSecAddrAlloca }, prepareInsertIcCcModeBB);
         ReleaseAssert(llvm_value_has_type<void*>(ccJitAddr));
 
         new StoreInst(ccJitAddr, jitAddrAlloca, prepareInsertIcCcModeBB);
@@ -2531,6 +2553,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
     //
     {
         Value* jitAddr = new LoadInst(llvm_type_of<void*>(ctx), jitAddrAlloca, "", insertIcCcModeBB);
+        Value* jitDataSecAddr = new LoadInst(llvm_type_of<void*>(ctx), jitDataSecAddrAlloca, "", insertIcCcModeBB);
 
         Value* patchableJmpEndAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), fastPathAddrOfOwningStencil,
                                                                        { CreateLLVMConstantInt<uint64_t>(ctx, smcRegionOffset + smcRegionLength) }, "", insertIcCcModeBB);
@@ -2554,6 +2577,7 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
 
         emitCallToIcCodegenFn(ccCgFn,
                               jitAddr /*outputAddr*/,
+                              jitDataSecAddr /*outputDataSecAddr*/,
                               icMissAddrI64,
                               calleeCbU32,
                               codePtrU64,
@@ -2624,19 +2648,24 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
 
         disasmForAudit += smcRes.m_disasmForAudit;
 
-        disasmForAudit += "# Direct-call IC code length = " + std::to_string(dcRes.m_icSize) + "\n";
+        auto dumpPatchRecord = [&](const JitCallIcCodePtrPatchRecord& item)
+        {
+            disasmForAudit += std::string("#     ") + (item.m_isInDataSection ? "data section " : "") + "offset = " + std::to_string(item.m_offset) + (item.m_is64 ? " (64-bit)\n" : " (32-bit)\n");
+        };
+
+        disasmForAudit += "# Direct-call IC code length = " + std::to_string(dcRes.m_icSize) + ", data section length = " + std::to_string(dcRes.m_icDataSecSize) + "\n";
         disasmForAudit += "# Direct-call IC CodePtr patch records:\n";
         for (auto& item : dcRes.m_codePtrPatchRecords)
         {
-            disasmForAudit += std::string("#     offset = ") + std::to_string(item.first) + (item.second ? " (64-bit)\n" : " (32-bit)\n");
+            dumpPatchRecord(item);
         }
         disasmForAudit += "\n";
 
-        disasmForAudit += "# Closure-call IC code length = " + std::to_string(ccRes.m_icSize) + "\n";
+        disasmForAudit += "# Closure-call IC code length = " + std::to_string(ccRes.m_icSize) + ", data section length = " + std::to_string(ccRes.m_icDataSecSize) + "\n";
         disasmForAudit += "# Closure-call IC CodePtr patch records:\n";
         for (auto& item : ccRes.m_codePtrPatchRecords)
         {
-            disasmForAudit += std::string("#     offset = ") + std::to_string(item.first) + (item.second ? " (64-bit)\n" : " (32-bit)\n");
+            dumpPatchRecord(item);
         }
         disasmForAudit += "\n";
     }
@@ -2648,6 +2677,8 @@ DeegenCallIcLogicCreator::BaselineJitCodegenResult WARN_UNUSED DeegenCallIcLogic
         .m_ccIcCodePtrPatchRecords = ccRes.m_codePtrPatchRecords,
         .m_dcIcSize = dcRes.m_icSize,
         .m_ccIcSize = ccRes.m_icSize,
+        .m_dcIcDataSecSize = dcRes.m_icDataSecSize,
+        .m_ccIcDataSecSize = ccRes.m_icDataSecSize,
         .m_disasmForAudit = disasmForAudit,
         .m_uniqueOrd = icInfo.m_uniqueOrd
     };
@@ -15,6 +15,17 @@ class InterpreterBytecodeImplCreator;
 class DeegenBytecodeImplCreatorBase;
 class BaselineJitImplCreator;
 
+// Describes one value in the baseline JIT call IC that must be updated when the codePtr of the cached target changes
+// The 32/64-bit value at 'icAddr + m_offset' (or 'icDataSecAddr + m_offset' if 'm_isInDataSection') shall be patched
+// by adding (newCodePtr - oldCodePtr).
+//
+struct JitCallIcCodePtrPatchRecord
+{
+    size_t m_offset;
+    bool m_is64;
+    bool m_isInDataSection;
+};
+
 class InterpreterCallIcMetadata
 {
 public:
@@ -221,19 +232,21 @@ struct DeegenCallIcLogicCreator
         std::string m_resultFnName;
 
         // Describes how to modify the codePtr for this IC, which is needed for tiering-up or code invalidation
-        // Each item is a pair <offset, is64>, meaning the 32/64-bit value at address 'icAddr + offset' shall be patched
-        // by adding (newCodePtr - oldCodePtr).
         //
-        std::vector<std::pair<size_t /*offset*/, bool /*is64*/>> m_dcIcCodePtrPatchRecords;
-        std::vector<std::pair<size_t /*offset*/, bool /*is64*/>> m_ccIcCodePtrPatchRecords;
+        std::vector<JitCallIcCodePtrPatchRecord> m_dcIcCodePtrPatchRecords;
+        std::vector<JitCallIcCodePtrPatchRecord> m_ccIcCodePtrPatchRecords;
 
         // The JIT code size of this IC in bytes
-        // Note that for simplicity, currently we always put the data section (if exists) right after the code section,
-        // so there is only one size which accounts for everything.
         //
         size_t m_dcIcSize;
         size_t m_ccIcSize;
 
+        // The data section size of this IC in bytes, 0 if the IC has no data section
+        // The data section is allocated separately from the code, in non-executable memory
+        //
+        size_t m_dcIcDataSecSize;
+        size_t m_ccIcDataSecSize;
+
         // Human-readable disassembly for audit purpose, note that it's inaccurate as all runtime constants are missing
         //
         std::string m_disasmForAudit;
@@ -2,6 +2,7 @@
 #include "deegen_interpreter_function_interface.h"
 #include "deegen_bytecode_operand.h"
 #include "deegen_ast_return.h"
+#include "deegen_ast_throw_error.h"
 #include "deegen_options.h"
 #include "invoke_clang_helper.h"
 #include "tvalue.h"
@@ -249,6 +250,39 @@ void DeegenFunctionEntryLogicCreator::Run(llvm::LLVMContext& ctx)
     ReleaseAssert(llvm_value_has_type<void*>(calleeCodeBlock));
     calleeCodeBlock->setName("calleeCodeBlock");
 
+    // Throw a catchable stack overflow error if the stack frame of the callee may run into the end of the coroutine stack
+    // The error is thrown as if it were thrown by the callee, whose call frame header has been set up by the caller.
+    //
+    {
+        Value* isStackOverflow = CreateCallToDeegenCommonSnippet(module.get(), "CheckStackOverflowOnFunctionEntry", { coroutineCtx, preFixupStackBase, numArgs, calleeCodeBlock }, normalBB);
+        ReleaseAssert(llvm_value_has_type<bool>(isStackOverflow));
+        Function* expectIntrin = Intrinsic::getDeclaration(module.get(), Intrinsic::expect, { Type::getInt1Ty(ctx) });
+        isStackOverflow = CallInst::Create(expectIntrin, { isStackOverflow, CreateLLVMConstantInt<bool>(ctx, false) }, "", normalBB);
+
+        BasicBlock* stackOverflowBB = BasicBlock::Create(ctx, "", func);
+        BasicBlock* noStackOverflowBB = BasicBlock::Create(ctx, "", func);
+        BranchInst::Create(stackOverflowBB, noStackOverflowBB, isStackOverflow, normalBB);
+
+        Constant* errMsg = ConstantDataArray::getString(ctx, "stack overflow");
+        GlobalVariable* errMsgGv = new GlobalVariable(*module.get(), errMsg->getType(), true /*isConstant*/, GlobalValue::PrivateLinkage, errMsg);
+        errMsgGv->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+        Value* errMsgAsU64 = new PtrToIntInst(errMsgGv, llvm_type_of<uint64_t>(ctx), "", stackOverflowBB);
+
+        UnreachableInst* dummyInst = new UnreachableInst(ctx, stackOverflowBB);
+
+        InterpreterFunctionInterface::CreateDispatchToCallee(
+            GetThrowCStringErrorDispatchTargetFunction(module.get()),
+            coroutineCtx,
+            preFixupStackBase,
+            UndefValue::get(llvm_type_of<HeapPtr<void>>(ctx)),
+            errMsgAsU64 /*numArgs repurposed as errorObj*/,
+            UndefValue::get(llvm_type_of<uint64_t>(ctx)),
+            dummyInst /*insertBefore*/);
+
+        dummyInst->eraseFromParent();
+        normalBB = noStackOverflowBB;
+    }
+
     Value* bytecodePtr = nullptr;
     if (m_tier == DeegenEngineTier::Interpreter)
     {
@@ -513,11 +547,17 @@ void DeegenFunctionEntryLogicCreator::GenerateBaselineJitStencil(std::unique_ptr
 
     BasicBlock* bb = BasicBlock::Create(ctx, "", patchFn);
 
+    // The code is written through the writable alias, while all the addresses in the code are computed from the JIT addresses
+    //
+    Value* fastPathAddrAlias = EmitGetJitWritableAlias(fastPathAddr, bb);
+    Value* slowPathAddrAlias = EmitGetJitWritableAlias(slowPathAddr, bb);
+    Value* dataSecAddrAlias = EmitGetJitWritableAlias(dataSecAddr, bb);
+
     // Note that we don't have to align the data section pointer since it is at offset 0 and must already be aligned
     //
-    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_fastPathPreFixupCode, fastPathAddr, "deegen_fastpath_prefixup_code", bb /*insertAtEnd*/);
-    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_slowPathPreFixupCode, slowPathAddr, "deegen_slowpath_prefixup_code", bb /*insertAtEnd*/);
-    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_dataSecPreFixupCode, dataSecAddr, "deegen_datasec_prefixup_code", bb /*insertAtEnd*/);
+    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_fastPathPreFixupCode, fastPathAddrAlias, "deegen_fastpath_prefixup_code", bb /*insertAtEnd*/);
+    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_slowPathPreFixupCode, slowPathAddrAlias, "deegen_slowpath_prefixup_code", bb /*insertAtEnd*/);
+    EmitCopyLogicForBaselineJitCodeGen(cgMod.get(), cgRes.m_dataSecPreFixupCode, dataSecAddrAlias, "deegen_datasec_prefixup_code", bb /*insertAtEnd*/);
 
     Value* fastPathAddrI64 = new PtrToIntInst(fastPathAddr, llvm_type_of<uint64_t>(ctx), "", bb);
     Value* slowPathAddrI64 = new PtrToIntInst(slowPathAddr, llvm_type_of<uint64_t>(ctx), "", bb);
@@ -542,9 +582,9 @@ void DeegenFunctionEntryLogicCreator::GenerateBaselineJitStencil(std::unique_ptr
         ReleaseAssert(args.size() == x_numExpectedArgsInPatchFn);
         CallInst::Create(target, args, "", bb);
     };
-    callPatchFn(fastPathPatchFn, fastPathAddr);
-    callPatchFn(slowPathPatchFn, slowPathAddr);
-    callPatchFn(dataSecPatchFn, dataSecAddr);
+    callPatchFn(fastPathPatchFn, fastPathAddrAlias);
+    callPatchFn(slowPathPatchFn, slowPathAddrAlias);
+    callPatchFn(dataSecPatchFn, dataSecAddrAlias);
 
     ReturnInst::Create(ctx, nullptr, bb);
 
@@ -463,6 +463,34 @@ void JitImplCreatorBase::CreateWrapperFunction()
         ReleaseAssert(ord == opcodeValues.size() && ord == usageValues.size());
     }
 
+    // For the baseline JIT fast path, record the type of each profiled operand into its value profile in the SlowPathData
+    //
+    if (IsBaselineJIT() && m_processKind == BytecodeIrComponentKind::Main && !IsJitSlowPath())
+    {
+        JitSlowPathDataValueProfileArray& valueProfiles = m_bytecodeDef->GetBaselineJitSlowPathDataLayout()->m_valueProfiles;
+        if (valueProfiles.IsValid())
+        {
+            Value* slowPathDataOffset = GetSlowPathDataOffsetFromJitFastPath(currentBlock);
+            Value* jitCodeBlock = GetJitCodeBlock();
+            ReleaseAssert(llvm_value_has_type<void*>(jitCodeBlock));
+            Value* slowPathData = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), jitCodeBlock, { slowPathDataOffset }, "", currentBlock);
+
+            const std::vector<size_t>& profiledOperandOrds = valueProfiles.GetProfiledOperandOrds();
+            for (size_t i = 0; i < profiledOperandOrds.size(); i++)
+            {
+                size_t operandOrd = profiledOperandOrds[i];
+                ReleaseAssert(operandOrd < usageValues.size());
+                Value* tv = usageValues[operandOrd];
+                ReleaseAssert(llvm_value_has_type<uint64_t>(tv));
+
+                size_t offset = valueProfiles.GetOffsetForProfile(i);
+                Value* profileAddr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), slowPathData,
+                                                                       { CreateLLVMConstantInt<uint64_t>(ctx, offset) }, "", currentBlock);
+                CreateCallToDeegenCommonSnippet(GetModule(), "UpdateValueProfile", { tv, profileAddr }, currentBlock);
+            }
+        }
+    }
+
     if (m_processKind == BytecodeIrComponentKind::SlowPath)
     {
         std::vector<Value*> extraArgs = AstSlowPath::CreateCallArgsInSlowPathWrapperFunction(static_cast<uint32_t>(usageValues.size()), m_impl, currentBlock);
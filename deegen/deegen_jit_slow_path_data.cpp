@@ -189,6 +189,7 @@ JitSlowPathDataJitAddress JitSlowPathDataLayoutBase::GetFallthroughJitAddress()
 //     Call IC sites, if exists
 //     jitSlowPathAddr and jitDataSecAddr, if generic IC sites exist
 //     Generic IC sites, if exist
+//     Value profiles of the TValue operands, if any operand is profiled
 //
 void BaselineJitSlowPathDataLayout::ComputeLayout(BytecodeVariantDefinition* bvd)
 {
@@ -279,6 +280,31 @@ void BaselineJitSlowPathDataLayout::ComputeLayout(BytecodeVariantDefinition* bvd
         }
     }
 
+    // Reserve space for the value profile of each profiled operand
+    //
+    // Only bytecodes that opted in with EnableValueProfiling() are profiled, and we profile every Slot operand read by the fast path.
+    // Constant operands have statically known types, and the operands of a bytecode that makes calls are already profiled by the call IC.
+    // An elided Slot operand is not profiled, since the DFG decodes the local ordinal of a profile from the SlowPathData.
+    //
+    {
+        std::vector<size_t> profiledOperandOrds;
+        if (bvd->m_isValueProfilingEnabled && bvd->GetNumCallICsInJitTier() == 0)
+        {
+            for (auto& operand : bvd->m_list)
+            {
+                if (operand->GetKind() == BcOperandKind::Slot && !operand->IsElidedFromBytecodeStruct())
+                {
+                    profiledOperandOrds.push_back(operand->OperandOrdinal());
+                }
+            }
+        }
+        if (profiledOperandOrds.size() > 0)
+        {
+            m_valueProfiles.SetInfo(profiledOperandOrds);
+            assignOffsetAndAdvance(m_valueProfiles);
+        }
+    }
+
     m_totalLength = currentOffset;
     m_totalValidFields = totalValidFields;
 }
@@ -3,6 +3,7 @@
 #include "common_utils.h"
 #include "deegen_engine_tier.h"
 #include "misc_llvm_helper.h"
+#include "tvalue.h"
 
 namespace dast {
 
@@ -168,6 +169,38 @@ private:
     size_t m_sizePerSite;
 };
 
+// An array of value profiles in JIT SlowPathData, one for each profiled bytecode operand
+//
+// Each value profile is a TypeSpeculationMask, which the JIT fast path ORs with the type of the operand value every time the bytecode executes.
+// The higher tier reads the profiles to decide what to speculate on.
+//
+class JitSlowPathDataValueProfileArray final : public JitSlowPathDataFieldBase
+{
+public:
+    JitSlowPathDataValueProfileArray() = default;
+
+    void SetInfo(const std::vector<size_t>& profiledOperandOrds)
+    {
+        m_profiledOperandOrds = profiledOperandOrds;
+        SetFieldSize(profiledOperandOrds.size() * sizeof(TypeSpeculationMask));
+    }
+
+    size_t GetNumProfiles() { ReleaseAssert(IsValid()); return m_profiledOperandOrds.size(); }
+
+    // The bytecode operand ordinal that each profile records
+    //
+    const std::vector<size_t>& GetProfiledOperandOrds() { ReleaseAssert(IsValid()); return m_profiledOperandOrds; }
+
+    size_t GetOffsetForProfile(size_t profileOrd)
+    {
+        ReleaseAssert(profileOrd < GetNumProfiles());
+        return GetFieldOffset() + sizeof(TypeSpeculationMask) * profileOrd;
+    }
+
+private:
+    std::vector<size_t> m_profiledOperandOrds;
+};
+
 struct BaselineJitSlowPathDataLayout;
 struct DfgJitSlowPathDataLayout;
 
@@ -250,6 +283,10 @@ struct BaselineJitSlowPathDataLayout final : public JitSlowPathDataLayoutBase
     // as baseline JIT logic expects that.
     //
     JitSlowPathDataInt<uint32_t> m_condBrBcIndex;
+
+    // The value profiles of the TValue operands read by the JIT fast path, if any
+    //
+    JitSlowPathDataValueProfileArray m_valueProfiles;
 };
 
 // Describes a piece of SlowPathData in DFG JIT
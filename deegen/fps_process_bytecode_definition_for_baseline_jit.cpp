@@ -11,12 +11,29 @@
 #include "llvm_identical_function_merger.h"
 #include "deegen_global_bytecode_trait_accessor.h"
 #include "deegen_jit_slow_path_data.h"
+#include "misc_math_helper.h"
 
 using namespace dast;
 
 constexpr const char* x_baselineJitSlowPathSectionName = "deegen_baseline_jit_slow_path_section";
 constexpr const char* x_baselineJitCodegenFnSectionName = "deegen_baseline_jit_codegen_fn_section";
 
+// The IC data section is allocated from the JIT data memory, and the codegen may overwrite up to 7 bytes after it
+//
+static size_t WARN_UNUSED GetIcDataSectionAllocationStepping(size_t dataSectionLength)
+{
+    if (dataSectionLength == 0)
+    {
+        return x_jit_mem_alloc_stepping_none;
+    }
+    size_t allocLength = RoundUpToMultipleOf<8>(dataSectionLength);
+    ReleaseAssert(allocLength <= x_jit_mem_alloc_stepping_array[x_jit_mem_alloc_total_steppings - 1]);
+    size_t stepping = GetJitMemoryAllocatorSteppingFromSmallAllocationSize(allocLength);
+    ReleaseAssert(stepping < x_jit_mem_alloc_total_steppings);
+    ReleaseAssert(x_jit_mem_alloc_stepping_array[stepping] >= allocLength);
+    return stepping;
+}
+
 void FPS_ProcessBytecodeDefinitionForBaselineJit()
 {
     using namespace llvm;
@@ -140,7 +157,21 @@ void FPS_ProcessBytecodeDefinitionForBaselineJit()
                 callIcSiteOffsetInSlowPathData = 0;
             }
             ReleaseAssert(callIcSiteOffsetInSlowPathData <= 65535);
-            fprintf(hdrFp, "    .m_callIcSiteOffsetInSlowPathData = %llu\n", static_cast<unsigned long long>(callIcSiteOffsetInSlowPathData));
+            fprintf(hdrFp, "    .m_callIcSiteOffsetInSlowPathData = %llu,\n", static_cast<unsigned long long>(callIcSiteOffsetInSlowPathData));
+            size_t numGenericIcSites = res.m_bytecodeDef->GetNumGenericICsInJitTier();
+            ReleaseAssert(numGenericIcSites <= 255);
+            fprintf(hdrFp, "    .m_numGenericIcSites = %llu,\n", static_cast<unsigned long long>(numGenericIcSites));
+            size_t genericIcSiteOffsetInSlowPathData;
+            if (numGenericIcSites > 0)
+            {
+                genericIcSiteOffsetInSlowPathData = res.m_bytecodeDef->GetBaselineJitSlowPathDataLayout()->m_genericICs.GetOffsetForSite(0);
+            }
+            else
+            {
+                genericIcSiteOffsetInSlowPathData = 0;
+            }
+            ReleaseAssert(genericIcSiteOffsetInSlowPathData <= 255);
+            fprintf(hdrFp, "    .m_genericIcSiteOffsetInSlowPathData = %llu\n", static_cast<unsigned long long>(genericIcSiteOffsetInSlowPathData));
             fprintf(hdrFp, "};\n");
 
             for (size_t k = start; k < end; k++)
@@ -170,18 +201,21 @@ void FPS_ProcessBytecodeDefinitionForBaselineJit()
                 ReleaseAssert(icAllocationLengthStepping < x_jit_mem_alloc_total_steppings);
                 ReleaseAssert(x_jit_mem_alloc_stepping_array[icAllocationLengthStepping] >= icTrait.m_allocationLength);
                 fprintf(hdrFp, "    %llu,\n", static_cast<unsigned long long>(icAllocationLengthStepping));
+                fprintf(hdrFp, "    %llu /*dataAllocLengthStepping*/,\n", static_cast<unsigned long long>(GetIcDataSectionAllocationStepping(icTrait.m_dataSectionLength)));
                 fprintf(hdrFp, "    %s /*isDirectCallMode*/,\n", (icTrait.m_isDirectCall ? "true" : "false"));
                 fprintf(hdrFp, "    std::array<JitCallInlineCacheTraits::PatchRecord, %llu> {", static_cast<unsigned long long>(icTrait.m_codePtrPatchRecords.size()));
 
                 for (size_t i = 0; i < icTrait.m_codePtrPatchRecords.size(); i++)
                 {
-                    uint64_t offset = icTrait.m_codePtrPatchRecords[i].first;
-                    bool is64 = icTrait.m_codePtrPatchRecords[i].second;
+                    uint64_t offset = icTrait.m_codePtrPatchRecords[i].m_offset;
+                    bool is64 = icTrait.m_codePtrPatchRecords[i].m_is64;
+                    bool isInDataSection = icTrait.m_codePtrPatchRecords[i].m_isInDataSection;
                     ReleaseAssert(offset <= 65535);
                     if (i > 0) { fprintf(hdrFp, ","); }
                     fprintf(hdrFp, "\n        JitCallInlineCacheTraits::PatchRecord {\n");
                     fprintf(hdrFp, "            .m_offset = %llu,\n", static_cast<unsigned long long>(offset));
-                    fprintf(hdrFp, "            .m_is64 = %s\n", (is64 ? "true" : "false"));
+                    fprintf(hdrFp, "            .m_is64 = %s,\n", (is64 ? "true" : "false"));
+                    fprintf(hdrFp, "            .m_isInDataSection = %s\n", (isInDataSection ? "true" : "false"));
                     fprintf(hdrFp, "        }");
                 }
                 fprintf(hdrFp, "\n    });\n\n");
@@ -211,6 +245,19 @@ void FPS_ProcessBytecodeDefinitionForBaselineJit()
                 fprintf(hdrFp, "p->set(%llu, %llu);\n",
                         static_cast<unsigned long long>(icTrait.m_ordInTraitTable), static_cast<unsigned long long>(icAllocationLengthStepping));
             }
+            fprintf(hdrFp, "}\n};\n\n");
+
+            // The data section allocation length stepping table of generic IC
+            //
+            fprintf(hdrFp, "template<typename T> struct populate_baseline_jit_generic_ic_data_allocation_length_stepping_table_%s {\n", res.m_bytecodeDef->GetBytecodeIdName().c_str());
+            fprintf(hdrFp, "static consteval void run(T* p) {\n");
+            fprintf(hdrFp, "std::ignore = p;\n");
+            for (GenericIcTraitDesc& icTrait : icTraitList)
+            {
+                fprintf(hdrFp, "p->set(%llu, %llu);\n",
+                        static_cast<unsigned long long>(icTrait.m_ordInTraitTable),
+                        static_cast<unsigned long long>(GetIcDataSectionAllocationStepping(icTrait.m_dataSectionLength)));
+            }
             fprintf(hdrFp, "}\n};\n}\n\n");
         }
 
@@ -555,6 +602,41 @@ void FPS_GenerateDispatchTableAndBytecodeTraitTableForBaselineJit()
         fprintf(fp, "};\n\n");
     }
 
+    // Generate the JIT generic IC data section allocation length stepping table
+    //
+    {
+        size_t genericIcTraitTableLen = bcTraitAccessor.GetJitGenericIcEffectTraitTableLength();
+        fprintf(fp, "static constexpr auto deegen_generic_ic_data_alloc_stepping_trait_table_contents = constexpr_multipart_array_builder_helper<uint8_t, %llu\n",
+                static_cast<unsigned long long>(genericIcTraitTableLen));
+
+        for (size_t i = 0; i < numEntries; i++)
+        {
+            std::string opName = byOpMap.GetBytecode(i);
+            if (!byOpMap.IsFusedIcVariant(opName))
+            {
+                fprintf(fp, ", populate_baseline_jit_generic_ic_data_allocation_length_stepping_table_%s\n", opName.c_str());
+            }
+        }
+        fprintf(fp, ">::get();\n\n");
+
+        fprintf(fp, "extern \"C\" const uint8_t deegen_baseline_jit_generic_ic_data_allocation_stepping_table[%llu];\n",
+                static_cast<unsigned long long>(genericIcTraitTableLen));
+
+        fprintf(fp, "constexpr uint8_t deegen_baseline_jit_generic_ic_data_allocation_stepping_table[%llu] = {\n",
+                static_cast<unsigned long long>(genericIcTraitTableLen));
+
+        for (size_t i = 0; i < genericIcTraitTableLen; i++)
+        {
+            fprintf(fp, "deegen_generic_ic_data_alloc_stepping_trait_table_contents[%llu]", static_cast<unsigned long long>(i));
+            if (i + 1 < genericIcTraitTableLen)
+            {
+                fprintf(fp, ",");
+            }
+            fprintf(fp, "\n");
+        }
+        fprintf(fp, "};\n\n");
+    }
+
     std::unique_ptr<llvm::Module> helperLogicModule = GenerateBaselineJitHelperLogic(ctx);
     std::string asmFileContents = CompileLLVMModuleToAssemblyFile(helperLogicModule.get(), llvm::Reloc::Static, llvm::CodeModel::Small);
 
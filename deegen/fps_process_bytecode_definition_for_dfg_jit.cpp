@@ -38,6 +38,7 @@ void FPS_GenerateDfgSpecializedBytecodeInfo()
     fprintf(hdrFp, "#include \"drt/bytecode_builder.h\"\n");
 
     fprintf(hdrFp, "#include \"drt/dfg_bytecode_speculative_inlining_trait.h\"\n");
+    fprintf(hdrFp, "#include \"drt/dfg_value_profile.h\"\n");
     fprintf(hdrFp, "#include \"drt/constexpr_array_builder_helper.h\"\n");
     fprintf(hdrFp, "namespace dfg {\n");
 
@@ -110,6 +111,58 @@ void FPS_GenerateDfgSpecializedBytecodeInfo()
         }
         fprintf(hdrFp, "    }\n");
         fprintf(hdrFp, "};\n\n");
+
+        // Emit the value profile information, so the DFG frontend can locate the baseline JIT value profiles in the SlowPathData
+        //
+        size_t numValueProfiles = 0;
+        {
+            BaselineJitSlowPathDataLayout* slowPathDataLayout = bii.m_bytecodeDef->GetBaselineJitSlowPathDataLayout();
+            JitSlowPathDataValueProfileArray& valueProfiles = slowPathDataLayout->m_valueProfiles;
+            if (valueProfiles.IsValid())
+            {
+                numValueProfiles = valueProfiles.GetNumProfiles();
+                ReleaseAssert(numValueProfiles <= 255);
+                fprintf(hdrFp, "constexpr BytecodeValueProfileSite x_deegen_dfg_value_profile_sites_%s[%u] = {\n",
+                        bii.m_bytecodeDef->GetBytecodeIdName().c_str(), static_cast<unsigned int>(numValueProfiles));
+                const std::vector<size_t>& operandOrds = valueProfiles.GetProfiledOperandOrds();
+                for (size_t i = 0; i < numValueProfiles; i++)
+                {
+                    JitSlowPathDataBcOperand& slot = slowPathDataLayout->GetBytecodeOperand(operandOrds[i]);
+                    size_t profileOffset = valueProfiles.GetOffsetForProfile(i);
+                    size_t slotOffset = slot.GetFieldOffset();
+                    size_t slotWidth = slot.GetFieldSize();
+                    ReleaseAssert(profileOffset <= 65535 && slotOffset <= 65535);
+                    ReleaseAssert(slotWidth == 1 || slotWidth == 2);
+                    fprintf(hdrFp, "    BytecodeValueProfileSite { %u, %u, %u }%s\n",
+                            static_cast<unsigned int>(profileOffset),
+                            static_cast<unsigned int>(slotOffset),
+                            static_cast<unsigned int>(slotWidth),
+                            (i + 1 == numValueProfiles ? "" : ","));
+                }
+                fprintf(hdrFp, "};\n\n");
+            }
+        }
+
+        fprintf(hdrFp, "template<typename T>\n");
+        fprintf(hdrFp, "struct build_bytecode_value_profile_info_array_%s {\n", bii.m_bytecodeDef->GetBytecodeIdName().c_str());
+        fprintf(hdrFp, "    static consteval void run(T* impl) {\n");
+        if (numValueProfiles > 0)
+        {
+            fprintf(hdrFp, "        impl->set(%u, BytecodeValueProfileInfo(%u, x_deegen_dfg_value_profile_sites_%s));\n",
+                    static_cast<unsigned int>(absoluteOpcodeOrd),
+                    static_cast<unsigned int>(numValueProfiles),
+                    bii.m_bytecodeDef->GetBytecodeIdName().c_str());
+        }
+        else
+        {
+            fprintf(hdrFp, "        impl->set(%u, BytecodeValueProfileInfo(0, nullptr));\n", static_cast<unsigned int>(absoluteOpcodeOrd));
+        }
+        for (size_t k = absoluteOpcodeOrd + 1; k <= absoluteOpcodeOrd + numFusedIcVariants; k++)
+        {
+            fprintf(hdrFp, "        impl->set(%u, BytecodeValueProfileInfo());\n", static_cast<unsigned int>(k));
+        }
+        fprintf(hdrFp, "    }\n");
+        fprintf(hdrFp, "};\n\n");
     }
 
     fprintf(hdrFp, "} // namespace dfg\n");
@@ -1646,6 +1646,43 @@ inline int WARN_UNUSED StoiOrFail(const std::string& s)
     return res;
 }
 
+// The JIT code must always be written through its writable alias, which resides at a constant distance from the JIT code
+// (see JitMemoryProtectionMode in drt/jit_memory_allocator.h). The distance is stored in this global, and is 0 if the JIT
+// memory is not dual-mapped.
+//
+constexpr const char* x_jitWritableAliasDeltaSymbolName = "deegen_jit_writable_alias_delta";
+
+// Returns the writable alias (a void*) of JIT address 'jitAddr'
+//
+inline llvm::Value* WARN_UNUSED EmitGetJitWritableAlias(llvm::Value* jitAddr, llvm::BasicBlock* insertAtEnd)
+{
+    using namespace llvm;
+    LLVMContext& ctx = jitAddr->getContext();
+    ReleaseAssert(llvm_value_has_type<void*>(jitAddr));
+    ReleaseAssert(insertAtEnd->getParent() != nullptr);
+    Module* module = insertAtEnd->getParent()->getParent();
+    ReleaseAssert(module != nullptr);
+
+    GlobalVariable* gv = module->getGlobalVariable(x_jitWritableAliasDeltaSymbolName);
+    if (gv == nullptr)
+    {
+        ReleaseAssert(module->getNamedValue(x_jitWritableAliasDeltaSymbolName) == nullptr);
+        gv = new GlobalVariable(*module,
+                                llvm_type_of<uint64_t>(ctx) /*valueType*/,
+                                false /*isConstant*/,
+                                GlobalValue::ExternalLinkage,
+                                nullptr /*initializer*/,
+                                x_jitWritableAliasDeltaSymbolName /*name*/);
+        ReleaseAssert(gv->getName() == x_jitWritableAliasDeltaSymbolName);
+        gv->setAlignment(MaybeAlign(8));
+        gv->setDSOLocal(true);
+    }
+    ReleaseAssert(gv->getValueType() == llvm_type_of<uint64_t>(ctx));
+
+    Value* delta = new LoadInst(llvm_type_of<uint64_t>(ctx), gv, "", false /*isVolatile*/, Align(8), insertAtEnd);
+    return GetElementPtrInst::Create(llvm_type_of<uint8_t>(ctx), jitAddr, { delta }, "", insertAtEnd);
+}
+
 // Emit a memcpy_inline.
 // If 'mustBeExact' is false (which is the default!), this function will be allowed to overwrite at most 7 bytes (so that we can have less instructions)
 // The caller is responsible for accounting for the extra bytes when doing the allocation in such case.
@@ -1792,7 +1829,10 @@ struct X64PatchableJumpUtil
         Instruction* diff = CreateSub(newDest64, jmpEndAddr64);
         insertAtEnd->getInstList().push_back(diff);
         Value* diff32 = new TruncInst(diff, llvm_type_of<uint32_t>(ctx), "", insertAtEnd);
-        GetElementPtrInst* ptr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), jmpEndAddr,
+        // The jump is JIT code, so it must be written through the writable alias
+        //
+        Value* jmpEndAddrAlias = EmitGetJitWritableAlias(jmpEndAddr, insertAtEnd);
+        GetElementPtrInst* ptr = GetElementPtrInst::CreateInBounds(llvm_type_of<uint8_t>(ctx), jmpEndAddrAlias,
                                                                    { CreateLLVMConstantInt<uint64_t>(ctx, static_cast<uint64_t>(-4)) }, "", insertAtEnd);
         new StoreInst(diff32, ptr, false /*isVolatile*/, Align(1), insertAtEnd);
     }
@@ -1,7 +1,7 @@
 #include "baseline_jit_codegen_helper.h"
+#include "baseline_jit_compile_queue.h"
 #include "runtime_utils.h"
 #include "bytecode_builder.h"
-#include "temp_arena_allocator.h"
 
 // These tables are generated by Deegen
 //
@@ -9,6 +9,7 @@ extern "C" const BytecodeBaselineJitTraits deegen_baseline_jit_bytecode_trait_ta
 extern "C" const BaselineJitFunctionEntryLogicTraits deegen_baseline_jit_function_entry_logic_trait_table_nova[];
 extern "C" const BaselineJitFunctionEntryLogicTraits deegen_baseline_jit_function_entry_logic_trait_table_va[];
 extern "C" const uint8_t deegen_baseline_jit_generic_ic_jit_allocation_stepping_table[];
+extern "C" const uint8_t deegen_baseline_jit_generic_ic_data_allocation_stepping_table[];
 
 // The implementation of this function is generated by Deegen
 // Note that this function prototype is also hardcoded!
@@ -53,14 +54,39 @@ static BaselineJitFunctionEntryLogicTraits WARN_UNUSED ALWAYS_INLINE GetBaseline
 
 using BytecodeOpcodeTy = DeegenBytecodeBuilder::BytecodeBuilder::BytecodeOpcodeTy;
 
-BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
+// 'x_maxBytesCodegenFnMayOverwrite' bytes of NOP needs to be populated between the fast path code and
+// the slow path code sections to avoid breaking debugger disassembler
+//
+constexpr size_t x_maxBytesCodegenFnMayOverwrite = 7;
+
+BaselineJitCodegenJob* WARN_UNUSED deegen_baseline_jit_prepare_codegen(CodeBlock* cb, bool snapshotBytecode)
 {
     // Each CodeBlock should be codegen'ed only once.
     // Be extra careful to catch such bugs, as these will not show up as correctness issues but cause silent performance regressions.
     //
     ReleaseAssert(cb->m_baselineCodeBlock == nullptr);
+    assert(IsExecutionThread());
 
-    uint8_t* bytecodeStream = cb->GetBytecodeStream();
+    BaselineJitCodegenJob* job = new BaselineJitCodegenJob();
+    job->m_codeBlock = cb;
+
+    // If requested, take a snapshot of the bytecode stream (including the tail padding, which the codegen may read),
+    // so that the interpreter may continue to quicken the live bytecode stream while the codegen is running
+    //
+    if (snapshotBytecode)
+    {
+        size_t numWords = RoundUpToMultipleOf<8>(cb->m_bytecodeLengthIncludingTailPadding) / 8;
+        job->m_ownedBytecodeSnapshot = new uint64_t[numWords];
+        memcpy(job->m_ownedBytecodeSnapshot, cb->GetBytecodeStream(), cb->m_bytecodeLengthIncludingTailPadding);
+        job->m_bytecodeStream = reinterpret_cast<uint8_t*>(job->m_ownedBytecodeSnapshot);
+    }
+    else
+    {
+        job->m_ownedBytecodeSnapshot = nullptr;
+        job->m_bytecodeStream = cb->GetBytecodeStream();
+    }
+
+    uint8_t* bytecodeStream = job->m_bytecodeStream;
     uint8_t* bytecodeStreamEnd = bytecodeStream + cb->GetBytecodeLength();
 
     // Get the function entry logic trait based on the function prototype
@@ -101,26 +127,11 @@ BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
     }
 
     // Determine the layout of the generated code:
-    //     [ Data Section ] [ Fast Path ] [ Slow Path ]
+    //     [ Fast Path ] [ Slow Path ]
+    // The data section is allocated separately from the non-executable JIT data memory.
     // Note that however, the codegen may overwrite at most 7 more bytes after each section, so allocation must account for that.
     //
-    constexpr size_t x_maxBytesCodegenFnMayOverwrite = 7;
-    size_t fastPathSectionOffset = dataSectionCodeLen;
-    if (dataSectionCodeLen > 0)
-    {
-        // Only add the padding if the data section is not empty (it is often empty),
-        // since if the data section is empty, the codegen won't write anything at all so the padding is not needed.
-        // This way we don't waste 16 bytes if the data section is empty.
-        //
-        fastPathSectionOffset += x_maxBytesCodegenFnMayOverwrite;
-    }
-    // Make the function entry address 16-byte aligned
-    //
-    fastPathSectionOffset = RoundUpToMultipleOf<16>(fastPathSectionOffset);
-
-    // 'x_maxBytesCodegenFnMayOverwrite' bytes of NOP needs to be populated between the fast path code and
-    // the slow path code sections to avoid breaking debugger disassembler
-    //
+    size_t fastPathSectionOffset = 0;
     size_t fastPathSectionEnd = fastPathSectionOffset + fastPathCodeLen;
 
     size_t slowPathSectionOffset = fastPathSectionEnd + x_maxBytesCodegenFnMayOverwrite;
@@ -128,42 +139,84 @@ BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
 
     size_t totalJitRegionSize = slowPathSectionEnd + x_maxBytesCodegenFnMayOverwrite;
 
-    // TODO: right now the data section is also marked executable because we just use one mmap for simplicity..
-    //
     VM* vm = VM::GetActiveVMForCurrentThread();
     vm->IncrementNumTotalBaselineJitCompilations();
     JitMemoryAllocator* jitAlloc = vm->GetJITMemoryAlloc();
     void* regionVoidPtr = jitAlloc->AllocateGivenSize(totalJitRegionSize);
     assert(regionVoidPtr != nullptr);
 
-    uint8_t* dataSecPtr = reinterpret_cast<uint8_t*>(regionVoidPtr);
+    // The function entry address is the region start, so it is 16-byte aligned
+    //
+    uint8_t* fastPathSecPtr = reinterpret_cast<uint8_t*>(regionVoidPtr) + fastPathSectionOffset;
+    uint8_t* slowPathSecPtr = reinterpret_cast<uint8_t*>(regionVoidPtr) + slowPathSectionOffset;
+
+    // The data section is often empty, in which case the codegen won't write anything at all,
+    // so we don't allocate it, and just let the codegen use an arbitrary aligned address.
+    //
+    uint8_t* dataSecPtr;
+    void* dataSecAllocation;
+    if (dataSectionCodeLen > 0)
+    {
+        dataSecAllocation = vm->GetJITDataMemoryAlloc()->AllocateGivenSize(dataSectionCodeLen + x_maxBytesCodegenFnMayOverwrite);
+        dataSecPtr = reinterpret_cast<uint8_t*>(dataSecAllocation);
+    }
+    else
+    {
+        dataSecAllocation = nullptr;
+        dataSecPtr = fastPathSecPtr;
+    }
 
     // This is required in order for all the computations above about the data section size to hold
     //
     assert(reinterpret_cast<uintptr_t>(dataSecPtr) % x_baselineJitMaxPossibleDataSectionAlignment == 0);
 
-    uint8_t* fastPathSecPtr = dataSecPtr + fastPathSectionOffset;
-    uint8_t* slowPathSecPtr = dataSecPtr + slowPathSectionOffset;
-
-    uint8_t* fastPathSecTrueEnd = fastPathSecPtr + fastPathCodeLen;
-    uint8_t* slowPathSecTrueEnd = slowPathSecPtr + slowPathCodeLen;
-
     // Set up the BaselineCodeBlock
+    // Note that it is not linked to the CodeBlock until the install phase
     //
     BaselineCodeBlock* bcb = BaselineCodeBlock::Create(cb,
                                                        SafeIntegerCast<uint32_t>(numBytecodes),
                                                        SafeIntegerCast<uint32_t>(slowPathDataStreamLen),
                                                        fastPathSecPtr /*jitCodeEntry*/,
-                                                       dataSecPtr /*jitRegionStart*/,
-                                                       SafeIntegerCast<uint32_t>(totalJitRegionSize));
+                                                       regionVoidPtr /*jitRegionStart*/,
+                                                       SafeIntegerCast<uint32_t>(totalJitRegionSize),
+                                                       dataSecAllocation /*jitDataSecStart*/);
+
+    job->m_baselineCodeBlock = bcb;
+    job->m_fnPrologueInfo = fnPrologueInfo;
+    job->m_dataSecPtr = dataSecPtr;
+    job->m_fastPathSecPtr = fastPathSecPtr;
+    job->m_slowPathSecPtr = slowPathSecPtr;
+    job->m_fastPathCodeLen = fastPathCodeLen;
+    job->m_slowPathCodeLen = slowPathCodeLen;
+    job->m_dataSectionCodeLen = dataSectionCodeLen;
+    job->m_condBrLatePatchList = new BaselineJitCondBrLatePatchRecord[numLateCondBrPatches];
+    job->m_numLateCondBrPatches = numLateCondBrPatches;
+    job->m_slowPathDataStreamLen = slowPathDataStreamLen;
+    job->m_numBytecodes = numBytecodes;
+    return job;
+}
+
+void deegen_baseline_jit_run_codegen(BaselineJitCodegenJob* job)
+{
+    CodeBlock* cb = job->m_codeBlock;
+    BaselineCodeBlock* bcb = job->m_baselineCodeBlock;
+    BaselineJitFunctionEntryLogicTraits fnPrologueInfo = job->m_fnPrologueInfo;
+
+    uint8_t* bytecodeStream = job->m_bytecodeStream;
+    [[maybe_unused]] uint8_t* bytecodeStreamEnd = bytecodeStream + cb->GetBytecodeLength();
+
+    uint8_t* dataSecPtr = job->m_dataSecPtr;
+    uint8_t* fastPathSecPtr = job->m_fastPathSecPtr;
+    uint8_t* slowPathSecPtr = job->m_slowPathSecPtr;
+
+    uint8_t* fastPathSecTrueEnd = fastPathSecPtr + job->m_fastPathCodeLen;
+    uint8_t* slowPathSecTrueEnd = slowPathSecPtr + job->m_slowPathCodeLen;
 
     BaselineCodeBlock::SlowPathDataAndBytecodeOffset* slowPathDataIndexArray = bcb->m_sbIndex;
     uint8_t* slowPathDataStreamStart = bcb->GetSlowPathDataStreamStart();
 
-    // Allocate the temporary array for LateCondBrPatches
-    //
-    TempArenaAllocator alloc;
-    BaselineJitCondBrLatePatchRecord* condBrLatePatchList = alloc.AllocateArray<BaselineJitCondBrLatePatchRecord>(numLateCondBrPatches);
+    BaselineJitCondBrLatePatchRecord* condBrLatePatchList = job->m_condBrLatePatchList;
+    size_t numLateCondBrPatches = job->m_numLateCondBrPatches;
 
     // Emit the function entry logic
     //
@@ -201,15 +254,32 @@ BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
         //
         assert(ctl.m_actualJitFastPathEnd == fastPathSecTrueEnd);
         assert(ctl.m_actualJitSlowPathEnd == slowPathSecTrueEnd);
-        assert(ctl.m_actualJitDataSecEnd == dataSecPtr + dataSectionCodeLen);
+        assert(ctl.m_actualJitDataSecEnd == dataSecPtr + job->m_dataSectionCodeLen);
         assert(ctl.m_actualCondBrPatchesArrayEnd == condBrLatePatchList + numLateCondBrPatches);
-        assert(ctl.m_actualSlowPathDataEnd == slowPathDataStreamStart + slowPathDataStreamLen);
-        assert(ctl.m_actualSlowPathDataIndexArrayEnd == slowPathDataIndexArray + numBytecodes);
+        assert(ctl.m_actualSlowPathDataEnd == slowPathDataStreamStart + job->m_slowPathDataStreamLen);
+        assert(ctl.m_actualSlowPathDataIndexArrayEnd == slowPathDataIndexArray + job->m_numBytecodes);
         assert(ctl.m_actualBaselineCodeBlock32End == static_cast<uint64_t>(static_cast<uint32_t>(reinterpret_cast<uint64_t>(bcb))));
-        assert(ctl.m_actualSlowPathDataOffsetEnd = static_cast<uint64_t>(slowPathDataStreamStart + slowPathDataStreamLen - reinterpret_cast<uint8_t*>(bcb)));
+        assert(ctl.m_actualSlowPathDataOffsetEnd = static_cast<uint64_t>(slowPathDataStreamStart + job->m_slowPathDataStreamLen - reinterpret_cast<uint8_t*>(bcb)));
         assert(ctl.m_actualBytecodeStreamEnd == bytecodeStreamEnd);
     }
 
+    // If the codegen worked on a snapshot of the bytecode stream, the bytecode pointers recorded by the codegen point into the snapshot.
+    // The bytecode stream is position-independent, and the codegen only records the lower 32 bits of the bytecode pointers
+    // (in the SlowPathDataIndex array and the LateCondBrPatches), so rebase them to point into the live bytecode stream.
+    //
+    if (bytecodeStream != cb->GetBytecodeStream())
+    {
+        uint32_t delta = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(cb->GetBytecodeStream())) - static_cast<uint32_t>(reinterpret_cast<uintptr_t>(bytecodeStream));
+        for (size_t i = 0; i < job->m_numBytecodes; i++)
+        {
+            slowPathDataIndexArray[i].m_bytecodePtr32 += delta;
+        }
+        for (size_t i = 0; i < numLateCondBrPatches; i++)
+        {
+            condBrLatePatchList[i].m_dstBytecodePtrLow32bits += delta;
+        }
+    }
+
     // Sanity check that the SlowPathDataIndex array makes sense
     //
 #ifndef NDEBUG
@@ -296,9 +366,47 @@ BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
             }
         };
 
-        populateCodeGap(fastPathSecTrueEnd);
-        populateCodeGap(slowPathSecTrueEnd);
+        populateCodeGap(GetJitWritableAlias(fastPathSecTrueEnd));
+        populateCodeGap(GetJitWritableAlias(slowPathSecTrueEnd));
     }
+}
+
+static void DestroyBaselineJitCodegenJob(BaselineJitCodegenJob* job)
+{
+    delete [] job->m_condBrLatePatchList;
+    if (job->m_ownedBytecodeSnapshot != nullptr)
+    {
+        delete [] job->m_ownedBytecodeSnapshot;
+    }
+    delete job;
+}
+
+void deegen_baseline_jit_discard_codegen(VM* vm, BaselineJitCodegenJob* job)
+{
+    assert(IsExecutionThread());
+    BaselineCodeBlock* bcb = job->m_baselineCodeBlock;
+    assert(job->m_codeBlock->m_baselineCodeBlock != bcb);
+
+    // The JIT code has never been installed, so no IC entry can exist yet, and nothing can be referencing the JIT code
+    //
+    vm->GetJITMemoryAlloc()->Free(bcb->m_jitRegionStart);
+    if (bcb->m_jitDataSecStart != nullptr)
+    {
+        vm->GetJITDataMemoryAlloc()->Free(bcb->m_jitDataSecStart);
+    }
+    bcb->Free(vm);
+    DestroyBaselineJitCodegenJob(job);
+}
+
+BaselineCodeBlock* WARN_UNUSED deegen_baseline_jit_install_codegen(BaselineJitCodegenJob* job)
+{
+    assert(IsExecutionThread());
+    CodeBlock* cb = job->m_codeBlock;
+    BaselineCodeBlock* bcb = job->m_baselineCodeBlock;
+    DestroyBaselineJitCodegenJob(job);
+
+    TestAssert(cb->m_baselineCodeBlock == nullptr);
+    cb->m_baselineCodeBlock = bcb;
 
     // Update best entry point from interpreter code to baseline JIT code
     //
@@ -308,6 +416,13 @@ BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
     return bcb;
 }
 
+BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb)
+{
+    BaselineJitCodegenJob* job = deegen_baseline_jit_prepare_codegen(cb, false /*snapshotBytecode*/);
+    deegen_baseline_jit_run_codegen(job);
+    return deegen_baseline_jit_install_codegen(job);
+}
+
 JitGenericInlineCacheEntry* WARN_UNUSED JitGenericInlineCacheEntry::Create(VM* vm,
                                                                            SpdsPtr<JitGenericInlineCacheEntry> nextNode,
                                                                            uint16_t icTraitKind)
@@ -319,23 +434,148 @@ JitGenericInlineCacheEntry* WARN_UNUSED JitGenericInlineCacheEntry::Create(VM* v
     uint8_t allocationStepping = deegen_baseline_jit_generic_ic_jit_allocation_stepping_table[icTraitKind];
     entry->m_jitRegionLengthStepping = allocationStepping;
     entry->m_jitAddr = vm->GetJITMemoryAlloc()->AllocateGivenStepping(allocationStepping);
+    uint8_t dataAllocationStepping = deegen_baseline_jit_generic_ic_data_allocation_stepping_table[icTraitKind];
+    if (dataAllocationStepping == x_jit_mem_alloc_stepping_none)
+    {
+        entry->m_jitDataSecAddr = nullptr;
+    }
+    else
+    {
+        entry->m_jitDataSecAddr = vm->GetJITDataMemoryAlloc()->AllocateGivenStepping(dataAllocationStepping);
+    }
     return entry;
 }
 
-void* WARN_UNUSED JitGenericInlineCacheSite::Insert(uint16_t traitKind)
+void* WARN_UNUSED JitGenericInlineCacheSite::Insert(uint16_t traitKind, void** jitDataSecAddr /*out*/)
 {
     assert(m_numEntries < x_maxJitGenericInlineCacheEntries);
     VM* vm = VM::GetActiveVMForCurrentThread();
     JitGenericInlineCacheEntry* entry = JitGenericInlineCacheEntry::Create(vm, TCGet(m_linkedListHead), traitKind);
     TCSet(m_linkedListHead, SpdsPtr<JitGenericInlineCacheEntry> { entry });
     m_numEntries++;
+    *jitDataSecAddr = entry->m_jitDataSecAddr;
     return entry->m_jitAddr;
 }
 
+void JitGenericInlineCacheEntry::Destroy(VM* vm)
+{
+    vm->GetJITMemoryAlloc()->Free(m_jitAddr);
+    if (m_jitDataSecAddr != nullptr)
+    {
+        vm->GetJITDataMemoryAlloc()->Free(m_jitDataSecAddr);
+    }
+    vm->DeallocateSpdsRegionObject(this);
+}
+
+void JitGenericInlineCacheSite::DestroyAllEntries(VM* vm)
+{
+    SpdsPtr<JitGenericInlineCacheEntry> node = TCGet(m_linkedListHead);
+    while (!node.IsInvalidPtr())
+    {
+        JitGenericInlineCacheEntry* entry = TranslateToRawPointer(vm, node.AsPtr());
+        node = TCGet(entry->m_nextNode);
+        entry->Destroy(vm);
+    }
+    TCSet(m_linkedListHead, SpdsPtr<JitGenericInlineCacheEntry> { 0 });
+    m_numEntries = 0;
+}
+
+void deegen_baseline_jit_jettison_code(CodeBlock* cb)
+{
+    assert(IsExecutionThread());
+    BaselineCodeBlock* bcb = cb->m_baselineCodeBlock;
+    if (bcb == nullptr)
+    {
+        return;
+    }
+
+    // The DFG code is compiled from the baseline JIT profiles, so it must be jettisoned first
+    //
+    ReleaseAssert(cb->m_dfgCodeBlock == nullptr);
+
+    VM* vm = VM::GetActiveVMForCurrentThread();
+
+    // Redirect all the call ICs caching on this CodeBlock to the interpreter.
+    // The ICs themselves stay valid, since they cache on the function, not on the JIT code.
+    //
+    assert(cb->m_bestEntryPoint == bcb->m_jitCodeEntry);
+    cb->UpdateBestEntryPoint(cb->m_owner->GetInterpreterEntryPoint());
+
+    // Destroy all the IC entries owned by the IC sites in the SlowPathData.
+    // The SlowPathData of each bytecode starts with the opcode the JIT code was generated for,
+    // which tells us where the IC sites are, even if the bytecode has been quickened since then.
+    //
+    for (size_t bcIndex = 0; bcIndex < bcb->m_numBytecodes; bcIndex++)
+    {
+        uint8_t* slowPathData = bcb->GetSlowPathDataAtBytecodeIndex(bcIndex);
+        BytecodeOpcodeTy opcode = UnalignedLoad<BytecodeOpcodeTy>(slowPathData);
+        assert(opcode < DeegenBytecodeBuilder::BytecodeBuilder::GetTotalBytecodeKinds());
+        const BytecodeBaselineJitTraits& trait = deegen_baseline_jit_bytecode_trait_table[opcode];
+
+        for (size_t i = 0; i < trait.m_numCallIcSites; i++)
+        {
+            JitCallInlineCacheSite* site = reinterpret_cast<JitCallInlineCacheSite*>(slowPathData + trait.m_callIcSiteOffsetInSlowPathData + i * sizeof(JitCallInlineCacheSite));
+            site->DestroyAllEntries(vm);
+        }
+
+        for (size_t i = 0; i < trait.m_numGenericIcSites; i++)
+        {
+            JitGenericInlineCacheSite* site = reinterpret_cast<JitGenericInlineCacheSite*>(slowPathData + trait.m_genericIcSiteOffsetInSlowPathData + i * sizeof(JitGenericInlineCacheSite));
+            site->DestroyAllEntries(vm);
+        }
+    }
+
+    vm->GetJITMemoryAlloc()->Free(bcb->m_jitRegionStart);
+    if (bcb->m_jitDataSecStart != nullptr)
+    {
+        vm->GetJITDataMemoryAlloc()->Free(bcb->m_jitDataSecStart);
+    }
+
+    cb->m_baselineCodeBlock = nullptr;
+    cb->ResetInterpreterTierUpCounter(vm);
+
+    // Nothing refers to the BaselineCodeBlock now, so its system heap memory can be reused by the next tier-up
+    //
+    bcb->Free(vm);
+    vm->IncrementNumTotalBaselineJitJettisons();
+}
+
 BaselineCodeBlockAndEntryPoint NO_INLINE WARN_UNUSED deegen_prepare_tier_up_into_baseline_jit(HeapPtr<CodeBlock> cbHeapPtr)
 {
     CodeBlock* cb = TranslateToRawPointer(cbHeapPtr);
-    BaselineCodeBlock* bcb = deegen_baseline_jit_do_codegen(cb);
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    BaselineJitCompileQueue* compileQueue = vm->GetBaselineJitCompileQueue();
+    BaselineCodeBlock* bcb;
+    if (compileQueue == nullptr)
+    {
+        bcb = deegen_baseline_jit_do_codegen(cb);
+    }
+    else
+    {
+        BaselineJitCodegenJob* job = nullptr;
+        if (!compileQueue->HasJob(cb))
+        {
+            compileQueue->Enqueue(deegen_baseline_jit_prepare_codegen(cb, true /*snapshotBytecode*/));
+        }
+        else
+        {
+            job = compileQueue->TryTakeCompletedJob(cb);
+        }
+
+        if (job == nullptr)
+        {
+            // The codegen has not completed yet, keep executing this function in the interpreter,
+            // and check again after a while
+            //
+            cb->m_interpreterTierUpCounter = x_baselineJitBackgroundCompilePollInterval;
+            return {
+                .baselineCodeBlock = nullptr,
+                .entryPoint = cb->m_bestEntryPoint
+            };
+        }
+
+        bcb = deegen_baseline_jit_install_codegen(job);
+    }
     return {
         .baselineCodeBlock = bcb,
         .entryPoint = bcb->m_jitCodeEntry
@@ -357,7 +597,19 @@ BaselineCodeBlockAndEntryPoint NO_INLINE WARN_UNUSED deegen_prepare_osr_entry_in
     }
     else
     {
-        bcb = deegen_baseline_jit_do_codegen(cb);
+        // The OSR entry dispatches to the JIT code right away, so if there is a pending background compilation for
+        // this CodeBlock, we have no choice but to wait for it
+        //
+        VM* vm = VM::GetActiveVMForCurrentThread();
+        BaselineJitCompileQueue* compileQueue = vm->GetBaselineJitCompileQueue();
+        if (compileQueue != nullptr && compileQueue->HasJob(cb))
+        {
+            bcb = deegen_baseline_jit_install_codegen(compileQueue->WaitAndTakeJob(cb));
+        }
+        else
+        {
+            bcb = deegen_baseline_jit_do_codegen(cb);
+        }
     }
 
     size_t bytecodeIndex = bcb->GetBytecodeIndexFromBytecodePtr(curBytecode);
@@ -18,7 +18,10 @@ struct BytecodeBaselineJitTraits
     uint8_t m_numCondBrLatePatches;
     uint8_t m_numCallIcSites;
     uint16_t m_callIcSiteOffsetInSlowPathData;
-    uint16_t m_unused;
+    uint8_t m_numGenericIcSites;
+    // The generic IC sites come early in the SlowPathData, so one byte is enough (asserted at build time)
+    //
+    uint8_t m_genericIcSiteOffsetInSlowPathData;
 };
 // Make sure the size of this struct is a power of 2 to make addressing cheap
 //
@@ -50,6 +53,9 @@ enum class BaselineJitCondBrLatePatchKind : uint32_t
 
 struct BaselineJitCondBrLatePatchRecord
 {
+    // For Int32 and Int64, this is a JIT address, so the patch is written through its writable alias
+    // For SlowPathData, this is an address in the SlowPathData stream
+    //
     uint8_t* m_ptr;
     uint32_t m_dstBytecodePtrLow32bits;
     BaselineJitCondBrLatePatchKind m_patchKind;
@@ -60,7 +66,7 @@ struct BaselineJitCondBrLatePatchRecord
         {
         case BaselineJitCondBrLatePatchKind::Int32:
         {
-            UnalignedStore<uint32_t>(m_ptr, UnalignedLoad<uint32_t>(m_ptr) + static_cast<uint32_t>(jitAddr));
+            UnalignedStore<uint32_t>(GetJitWritableAlias(m_ptr), UnalignedLoad<uint32_t>(m_ptr) + static_cast<uint32_t>(jitAddr));
             break;
         }
         case BaselineJitCondBrLatePatchKind::SlowPathData:
@@ -71,7 +77,7 @@ struct BaselineJitCondBrLatePatchRecord
         }
         case BaselineJitCondBrLatePatchKind::Int64: [[unlikely]]
         {
-            UnalignedStore<uint64_t>(m_ptr, UnalignedLoad<uint64_t>(m_ptr) + jitAddr);
+            UnalignedStore<uint64_t>(GetJitWritableAlias(m_ptr), UnalignedLoad<uint64_t>(m_ptr) + jitAddr);
             break;
         }
         }   /* switch m_patchKind */
@@ -144,19 +150,23 @@ struct alignas(4) JitCallInlineCacheTraits
 {
     struct alignas(4) PatchRecord
     {
+        // The offset from the start of the code section, or from the start of the data section if 'm_isInDataSection'
+        //
         uint16_t m_offset;
         bool m_is64;
+        bool m_isInDataSection;
     };
     static_assert(sizeof(PatchRecord) == 4);
 
-    consteval JitCallInlineCacheTraits(uint8_t allocLengthStepping, bool isDirectCallMode, uint8_t numPatches)
+    consteval JitCallInlineCacheTraits(uint8_t allocLengthStepping, uint8_t dataAllocLengthStepping, bool isDirectCallMode, uint8_t numPatches)
         : m_jitCodeAllocationLengthStepping(allocLengthStepping)
         , m_isDirectCallMode(isDirectCallMode)
         , m_numCodePtrUpdatePatches(numPatches)
-        , m_unused(0)
+        , m_jitDataAllocationLengthStepping(dataAllocLengthStepping)
     {
         ReleaseAssert(numPatches > 0);
         ReleaseAssert(m_jitCodeAllocationLengthStepping < x_jit_mem_alloc_total_steppings);
+        ReleaseAssert(m_jitDataAllocationLengthStepping < x_jit_mem_alloc_total_steppings || m_jitDataAllocationLengthStepping == x_jit_mem_alloc_stepping_none);
     }
 
     // The allocation length stepping of the JIT code
@@ -168,7 +178,10 @@ struct alignas(4) JitCallInlineCacheTraits
     // Number of CodePtr update patches
     //
     uint8_t m_numCodePtrUpdatePatches;
-    uint8_t m_unused;
+    // The allocation length stepping of the data section, x_jit_mem_alloc_stepping_none if the IC has no data section
+    // The data section is allocated from the (non-executable) JIT data memory, separately from the code
+    //
+    uint8_t m_jitDataAllocationLengthStepping;
     PatchRecord m_codePtrPatchRecords[0];
 };
 static_assert(sizeof(JitCallInlineCacheTraits) == 4);
@@ -181,14 +194,16 @@ struct JitCallInlineCacheTraitsHolder final : public JitCallInlineCacheTraits
 
     using PatchRecord = JitCallInlineCacheTraits::PatchRecord;
 
-    consteval JitCallInlineCacheTraitsHolder(uint8_t allocLengthStepping, bool isDirectCallMode, std::array<PatchRecord, N> patches)
-        : JitCallInlineCacheTraits(allocLengthStepping, isDirectCallMode, static_cast<uint8_t>(N))
+    consteval JitCallInlineCacheTraitsHolder(uint8_t allocLengthStepping, uint8_t dataAllocLengthStepping, bool isDirectCallMode, std::array<PatchRecord, N> patches)
+        : JitCallInlineCacheTraits(allocLengthStepping, dataAllocLengthStepping, isDirectCallMode, static_cast<uint8_t>(N))
     {
         static_assert(offsetof_member_v<&JitCallInlineCacheTraitsHolder::m_recordsHolder> == offsetof_member_v<&JitCallInlineCacheTraits::m_codePtrPatchRecords>);
         for (size_t i = 0; i < N; i++)
         {
-            ReleaseAssert(patches[i].m_offset < x_jit_mem_alloc_stepping_array[allocLengthStepping]);
-            ReleaseAssert(patches[i].m_offset + (patches[i].m_is64 ? 8 : 4) <= x_jit_mem_alloc_stepping_array[allocLengthStepping]);
+            ReleaseAssertImp(patches[i].m_isInDataSection, dataAllocLengthStepping != x_jit_mem_alloc_stepping_none);
+            size_t sectionLen = x_jit_mem_alloc_stepping_array[patches[i].m_isInDataSection ? dataAllocLengthStepping : allocLengthStepping];
+            ReleaseAssert(patches[i].m_offset < sectionLen);
+            ReleaseAssert(patches[i].m_offset + (patches[i].m_is64 ? 8 : 4) <= sectionLen);
             m_recordsHolder[i] = patches[i];
         }
     }
@@ -212,14 +227,22 @@ public:
                                                           SpdsPtr<JitGenericInlineCacheEntry> nextNode,
                                                           uint16_t icTraitKind);
 
+    // Return the JIT code to the JIT memory allocator and free the entry
+    // Note that this function doesn't do anything about the singly-linked list anchored at the IC site
+    //
+    void Destroy(VM* vm);
+
     // The singly-linked list anchored at the callsite, 0 if last node
     //
     SpdsPtr<JitGenericInlineCacheEntry> m_nextNode;
     uint16_t m_traitKind;
     uint8_t m_jitRegionLengthStepping;
     void* m_jitAddr;
+    // The data section of the IC, allocated from the (non-executable) JIT data memory. nullptr if the IC has no data section
+    //
+    void* m_jitDataSecAddr;
 };
-static_assert(sizeof(JitGenericInlineCacheEntry) == 16);
+static_assert(sizeof(JitGenericInlineCacheEntry) == 24);
 
 // Describes an IC site
 // Must have an alignment of 1 since it resides in the SlowPathData stream
@@ -247,8 +270,14 @@ public:
     uint8_t m_isInlineSlabUsed;
 
     // May only be called if m_numEntries < x_maxJitGenericInlineCacheEntries
+    // Returns the JIT address of the IC code, and the address of its data section (nullptr if none) in 'jitDataSecAddr'
     //
-    void* WARN_UNUSED Insert(uint16_t traitKind);
+    void* WARN_UNUSED Insert(uint16_t traitKind, void** jitDataSecAddr /*out*/);
+
+    // Destroy all the IC entries owned by this site
+    // Note that the inline slab lives in the JIT fast path of the owning bytecode, so it is not reclaimed
+    //
+    void DestroyAllEntries(VM* vm);
 };
 static_assert(sizeof(JitGenericInlineCacheSite) == 6);
 
@@ -260,6 +289,64 @@ class BaselineCodeBlock;
 
 BaselineCodeBlock* NO_INLINE deegen_baseline_jit_do_codegen(CodeBlock* cb);
 
+// The baseline JIT compilation is split into three phases, so that the codegen itself may happen on a compiler thread:
+// (1) Prepare: compute the buffer sizes and allocate all the memory needed by codegen. Execution thread only.
+// (2) Run: emit the code into the buffers. This does not touch any VM state, so may happen on any thread.
+// (3) Install: make the CodeBlock use the JIT code. Execution thread only.
+//
+// Note that the interpreter may quicken the bytecode stream in-place at any time, and the quickened bytecode may have
+// a different JIT code length. So if the codegen is to happen on a compiler thread, the Prepare phase must take a
+// snapshot of the bytecode stream, and the codegen works on the snapshot instead of the live bytecode stream.
+//
+struct BaselineJitCodegenJob
+{
+    CodeBlock* m_codeBlock;
+    BaselineCodeBlock* m_baselineCodeBlock;
+    BaselineJitFunctionEntryLogicTraits m_fnPrologueInfo;
+
+    // The bytecode stream that the codegen should read from.
+    // Either the live bytecode stream in the CodeBlock, or a snapshot owned by this job
+    //
+    uint8_t* m_bytecodeStream;
+    uint64_t* m_ownedBytecodeSnapshot;
+
+    uint8_t* m_dataSecPtr;
+    uint8_t* m_fastPathSecPtr;
+    uint8_t* m_slowPathSecPtr;
+    size_t m_fastPathCodeLen;
+    size_t m_slowPathCodeLen;
+    size_t m_dataSectionCodeLen;
+
+    BaselineJitCondBrLatePatchRecord* m_condBrLatePatchList;
+    size_t m_numLateCondBrPatches;
+    size_t m_slowPathDataStreamLen;
+    size_t m_numBytecodes;
+};
+
+BaselineJitCodegenJob* WARN_UNUSED deegen_baseline_jit_prepare_codegen(CodeBlock* cb, bool snapshotBytecode);
+void deegen_baseline_jit_run_codegen(BaselineJitCodegenJob* job);
+
+// Destroys the job
+//
+BaselineCodeBlock* WARN_UNUSED deegen_baseline_jit_install_codegen(BaselineJitCodegenJob* job);
+
+// Destroys a job that will never be installed (e.g., background compilation is being turned off), and frees
+// everything it allocated: the JIT code region, the data section and the BaselineCodeBlock. Execution thread only.
+// The codegen must not be running.
+//
+void deegen_baseline_jit_discard_codegen(VM* vm, BaselineJitCodegenJob* job);
+
+// Throw away the baseline JIT code of 'cb' and return all the executable memory it owns to the JIT memory allocator:
+// the JIT code region, and the JIT code of all the call IC and generic IC entries owned by its IC sites.
+// The BaselineCodeBlock itself is put into the VM free list (see BaselineCodeBlock::Free).
+// All the interpreter and JIT call ICs that cache on 'cb' are redirected to the interpreter, and 'cb' will tier up again
+// if it becomes hot again. Does nothing if 'cb' has no baseline JIT code.
+//
+// The caller must make sure that no frame is executing the baseline JIT code of 'cb' (e.g., 'cb' is dead).
+// Note that nothing in the VM calls this yet: without a garbage collector, the VM never knows that a function is dead.
+//
+void deegen_baseline_jit_jettison_code(CodeBlock* cb);
+
 struct BaselineCodeBlockAndEntryPoint
 {
     // Member order hard-coded as we directly access it as (ptr, ptr) from LLVM
@@ -0,0 +1,118 @@
+#include "baseline_jit_compile_queue.h"
+#include "runtime_utils.h"
+
+BaselineJitCompileQueue::BaselineJitCompileQueue(VM* vm)
+    : m_vm(vm)
+    , m_shouldStop(false)
+{
+    m_compilerThread = std::thread([this]() { CompilerThreadMain(); });
+}
+
+BaselineJitCompileQueue::~BaselineJitCompileQueue()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_shouldStop = true;
+    }
+    m_hasNewJobCv.notify_one();
+    m_compilerThread.join();
+
+    for (auto& it : m_jobs)
+    {
+        deegen_baseline_jit_discard_codegen(m_vm, it.second.m_job);
+    }
+    m_jobs.clear();
+    m_waitList.clear();
+}
+
+void BaselineJitCompileQueue::Enqueue(BaselineJitCodegenJob* job)
+{
+    assert(IsExecutionThread());
+    CodeBlock* cb = job->m_codeBlock;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        TestAssert(!m_jobs.count(cb));
+        m_jobs[cb] = { .m_job = job, .m_isCompleted = false };
+        m_waitList.push_back(cb);
+    }
+    m_hasNewJobCv.notify_one();
+}
+
+bool WARN_UNUSED BaselineJitCompileQueue::HasJob(CodeBlock* cb)
+{
+    assert(IsExecutionThread());
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_jobs.count(cb);
+}
+
+BaselineJitCodegenJob* WARN_UNUSED BaselineJitCompileQueue::TryTakeCompletedJob(CodeBlock* cb)
+{
+    assert(IsExecutionThread());
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_jobs.find(cb);
+    TestAssert(it != m_jobs.end());
+    if (!it->second.m_isCompleted)
+    {
+        return nullptr;
+    }
+    BaselineJitCodegenJob* job = it->second.m_job;
+    m_jobs.erase(it);
+    return job;
+}
+
+BaselineJitCodegenJob* WARN_UNUSED BaselineJitCompileQueue::WaitAndTakeJob(CodeBlock* cb)
+{
+    assert(IsExecutionThread());
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto it = m_jobs.find(cb);
+    TestAssert(it != m_jobs.end());
+    m_jobCompletedCv.wait(lock, [&]() { return it->second.m_isCompleted; });
+    BaselineJitCodegenJob* job = it->second.m_job;
+    m_jobs.erase(it);
+    return job;
+}
+
+size_t WARN_UNUSED BaselineJitCompileQueue::GetNumJobs()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_jobs.size();
+}
+
+void BaselineJitCompileQueue::CompilerThreadMain()
+{
+    t_threadKind = CompilerThread;
+    // The codegen itself does not need the VM, but set up the segmentation register anyway,
+    // so that the assertions in the codegen that access the heap are able to work
+    //
+    m_vm->SetUpSegmentationRegister();
+
+    while (true)
+    {
+        BaselineJitCodegenJob* job;
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_hasNewJobCv.wait(lock, [&]() { return m_shouldStop || !m_waitList.empty(); });
+            if (m_shouldStop)
+            {
+                return;
+            }
+            CodeBlock* cb = m_waitList.front();
+            m_waitList.pop_front();
+            assert(m_jobs.count(cb) && !m_jobs[cb].m_isCompleted);
+            job = m_jobs[cb].m_job;
+        }
+
+        // The job is owned by the compiler thread until it is marked completed,
+        // so the codegen can run without holding the lock
+        //
+        deegen_baseline_jit_run_codegen(job);
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            auto it = m_jobs.find(job->m_codeBlock);
+            assert(it != m_jobs.end() && it->second.m_job == job);
+            it->second.m_isCompleted = true;
+        }
+        m_jobCompletedCv.notify_all();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "common.h"
+#include "baseline_jit_codegen_helper.h"
+
+#include <condition_variable>
+
+class VM;
+
+// When a CodeBlock with a pending background compilation is executed by the interpreter,
+// the interpreter tier-up counter is reset to this value, so we will check again for completion later
+//
+constexpr int64_t x_baselineJitBackgroundCompilePollInterval = 1000;
+
+// Runs the codegen phase of baseline JIT compilations on a dedicated compiler thread
+//
+// All the other phases (prepare and install) still happen on the execution thread, so the compiler thread never
+// touches any VM state except the buffers owned by the job. The execution thread polls for completed jobs when
+// the CodeBlock is tiered-up again, and only installs the JIT code at that point.
+//
+class BaselineJitCompileQueue
+{
+    MAKE_NONCOPYABLE(BaselineJitCompileQueue);
+    MAKE_NONMOVABLE(BaselineJitCompileQueue);
+
+public:
+    BaselineJitCompileQueue(VM* vm);
+
+    // Stops the compiler thread. All jobs not yet installed are discarded, and the memory they allocated is freed.
+    // Execution thread only.
+    //
+    ~BaselineJitCompileQueue();
+
+    // Execution thread only. 'cb' must not already have a job in the queue.
+    //
+    void Enqueue(BaselineJitCodegenJob* job);
+
+    // Execution thread only.
+    //
+    bool WARN_UNUSED HasJob(CodeBlock* cb);
+
+    // Execution thread only.
+    // If the job for 'cb' has completed, remove it from the queue and return it, otherwise return nullptr.
+    // 'cb' must have a job in the queue.
+    //
+    BaselineJitCodegenJob* WARN_UNUSED TryTakeCompletedJob(CodeBlock* cb);
+
+    // Execution thread only.
+    // Wait for the job for 'cb' to complete, then remove it from the queue and return it.
+    // 'cb' must have a job in the queue.
+    //
+    BaselineJitCodegenJob* WARN_UNUSED WaitAndTakeJob(CodeBlock* cb);
+
+    size_t WARN_UNUSED GetNumJobs();
+
+private:
+    struct JobState
+    {
+        BaselineJitCodegenJob* m_job;
+        bool m_isCompleted;
+    };
+
+    void CompilerThreadMain();
+
+    VM* m_vm;
+    std::mutex m_lock;
+    // Signaled when a new job is enqueued or the queue is being destroyed
+    //
+    std::condition_variable m_hasNewJobCv;
+    // Signaled when a job is completed
+    //
+    std::condition_variable m_jobCompletedCv;
+    // The jobs not yet picked up by the compiler thread, in FIFO order
+    //
+    std::deque<CodeBlock*> m_waitList;
+    // All the jobs that have not been taken by the execution thread
+    //
+    std::unordered_map<CodeBlock*, JobState> m_jobs;
+    bool m_shouldStop;
+    std::thread m_compilerThread;
+};
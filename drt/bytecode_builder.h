@@ -371,6 +371,30 @@ public:
         return x_numTotalVariants;
     }
 
+    // A fingerprint of the bytecode layout decided by deegen at build time: the opcode numbering, and the kind,
+    // length and operand offsets of every bytecode variant. A bytecode stream is only meaningful to builds with the same fingerprint.
+    //
+    static uint64_t WARN_UNUSED GetBytecodeLayoutFingerprint()
+    {
+        // FNV-1a over the layout tables
+        //
+        uint64_t h = 14695981039346656037ULL;
+        auto mix = [&](uint64_t value)
+        {
+            h = (h ^ value) * 1099511628211ULL;
+        };
+        mix(x_numTotalVariants);
+        for (size_t i = 0; i < x_numTotalVariants; i++)
+        {
+            mix(static_cast<uint64_t>(x_bcKindArray[i]));
+            mix(x_canonicalizedBcArray[i]);
+            mix(x_bcLengthArray[i]);
+            mix(x_bcOutputOperandOffsetArray[i]);
+            mix(x_bcBranchOperandOffsetArray[i]);
+        }
+        return h;
+    }
+
     BytecodeRWCInfo WARN_UNUSED GetDataFlowReadInfo(size_t bcPos)
     {
         assert(isDecodingMode);
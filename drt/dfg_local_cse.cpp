@@ -0,0 +1,165 @@
+#include "dfg_local_cse.h"
+#include "temp_arena_allocator.h"
+
+namespace dfg {
+
+namespace {
+
+struct LocalCsePassImpl
+{
+    // Identifies a location or a pure computation: the input SSA value and a node-specific param
+    //
+    using Key = std::tuple<Node*, uint16_t /*outputOrd*/, uint64_t /*param*/>;
+
+    LocalCsePassImpl(Graph* graph)
+        : m_graph(graph)
+        , m_immutableLoads(m_alloc)
+        , m_upvalueLoads(m_alloc)
+        , m_capturedVarLoads(m_alloc)
+        , m_pureNodes(m_alloc)
+        , m_checkedBounds(m_alloc)
+    { }
+
+    static Key WARN_UNUSED GetKey(Edge& e, uint64_t param)
+    {
+        return std::make_tuple(e.GetOperand(), e.GetOutputOrdinal(), param);
+    }
+
+    // Called when a node may write to any upvalue or captured variable
+    // Note that a captured variable may be the same Upvalue object as a function's upvalue, so they must be invalidated together
+    //
+    void InvalidateMutableLoads()
+    {
+        m_upvalueLoads.clear();
+        m_capturedVarLoads.clear();
+    }
+
+    // Replace 'node' by 'value' if 'value' is available, otherwise record 'node' as the new available value
+    //
+    template<typename MapTy>
+    void ReplaceOrRecord(MapTy& map, const Key& key, Node* node)
+    {
+        auto it = map.find(key);
+        if (it != map.end())
+        {
+            node->SetReplacement(it->second);
+            node->ConvertToNop();
+        }
+        else
+        {
+            map[key] = Value(node, 0 /*outputOrd*/);
+        }
+    }
+
+    void ProcessBasicBlock(BasicBlock* bb)
+    {
+        m_immutableLoads.clear();
+        m_pureNodes.clear();
+        m_checkedBounds.clear();
+        InvalidateMutableLoads();
+
+        for (Node* node : bb->m_nodes)
+        {
+            node->DoReplacementForInputs();
+
+            if (!node->IsBuiltinNodeKind())
+            {
+                InvalidateMutableLoads();
+                continue;
+            }
+
+            switch (node->GetNodeKind())
+            {
+            case NodeKind_GetUpvalue:
+            {
+                Node::UpvalueInfo& info = node->GetInfoForGetUpvalue();
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<1>(0), info.m_ordinal);
+                if (info.m_isImmutable)
+                {
+                    ReplaceOrRecord(m_immutableLoads, key, node);
+                }
+                else
+                {
+                    ReplaceOrRecord(m_upvalueLoads, key, node);
+                }
+                break;
+            }
+            case NodeKind_SetUpvalue:
+            {
+                InvalidateMutableLoads();
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<2>(0), node->GetNodeParamAsUInt64());
+                m_upvalueLoads[key] = node->GetInputEdgeForNodeWithFixedNumInputs<2>(1).GetValue();
+                break;
+            }
+            case NodeKind_GetCapturedVar:
+            {
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<1>(0), 0 /*param*/);
+                ReplaceOrRecord(m_capturedVarLoads, key, node);
+                break;
+            }
+            case NodeKind_SetCapturedVar:
+            {
+                InvalidateMutableLoads();
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<2>(0), 0 /*param*/);
+                m_capturedVarLoads[key] = node->GetInputEdgeForNodeWithFixedNumInputs<2>(1).GetValue();
+                break;
+            }
+            case NodeKind_U64SaturateSub:
+            {
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<1>(0), node->GetNodeParamAsUInt64());
+                ReplaceOrRecord(m_pureNodes, key, node);
+                break;
+            }
+            case NodeKind_CheckU64InBound:
+            {
+                Key key = GetKey(node->GetInputEdgeForNodeWithFixedNumInputs<1>(0), 0 /*param*/);
+                uint64_t bound = node->GetNodeParamAsUInt64();
+                auto it = m_checkedBounds.find(key);
+                if (it != m_checkedBounds.end() && it->second <= bound)
+                {
+                    node->ConvertToNop();
+                }
+                else
+                {
+                    m_checkedBounds[key] = bound;
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+            }   /*switch*/
+        }
+    }
+
+    void Run()
+    {
+        TestAssert(m_graph->IsBlockLocalSSAForm());
+        m_graph->ClearAllReplacements();
+        for (BasicBlock* bb : m_graph->m_blocks)
+        {
+            ProcessBasicBlock(bb);
+        }
+        m_graph->AssertReplacementIsComplete();
+        m_graph->ClearAllReplacements();
+    }
+
+    TempArenaAllocator m_alloc;
+    Graph* m_graph;
+    TempMap<Key, Value> m_immutableLoads;
+    TempMap<Key, Value> m_upvalueLoads;
+    TempMap<Key, Value> m_capturedVarLoads;
+    TempMap<Key, Value> m_pureNodes;
+    TempMap<Key, uint64_t> m_checkedBounds;
+};
+
+}   // anonymous namespace
+
+void RunLocalCommonSubexpressionEliminationPass(Graph* graph)
+{
+    LocalCsePassImpl pass(graph);
+    pass.Run();
+}
+
+}   // namespace dfg
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "dfg_node.h"
+
+namespace dfg {
+
+// Block-local common subexpression elimination and load forwarding for the built-in nodes:
+// 1. Immutable GetUpvalue of the same upvalue from the same function object is replaced by the earlier one.
+// 2. Mutable GetUpvalue and GetCapturedVar are replaced by the earlier load or the value written by the earlier store
+//    to the same location, as long as no node in between may write to an upvalue or a captured variable.
+// 3. Pure nodes (U64SaturateSub) with identical inputs and params are replaced by the earlier one.
+// 4. CheckU64InBound is removed if the same value has already been checked against a bound that is not larger.
+//
+// Guest language nodes are treated as opaque: they may write to any upvalue or captured variable.
+// The graph must be in block-local SSA form. This pass does not change the form of the graph.
+//
+// This pass is strictly block-local: all the availability information is dropped at the end of each basic block.
+// Global value numbering across basic blocks is not done, since in block-local SSA form no value flows across
+// basic blocks except through GetLocal/SetLocal, which are already forwarded by the SSA construction.
+// It needs a cross-block SSA form (and effect information for guest language nodes) first.
+//
+void RunLocalCommonSubexpressionEliminationPass(Graph* graph);
+
+}   // namespace dfg
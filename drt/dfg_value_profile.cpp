@@ -0,0 +1,57 @@
+#include "dfg_value_profile.h"
+#include "constexpr_array_builder_helper.h"
+#include "runtime_utils.h"
+#include "generated/deegen_dfg_jit_all_generated_info.h"
+
+namespace dfg {
+
+#define macro(e) , PP_CAT(build_bytecode_value_profile_info_array_, e)
+constexpr std::array<BytecodeValueProfileInfo, DeegenBytecodeBuilder::BytecodeDecoder::GetTotalBytecodeKinds()> x_dfgBytecodeValueProfileInfo =
+    constexpr_multipart_array_builder_helper<
+        BytecodeValueProfileInfo,
+        DeegenBytecodeBuilder::BytecodeDecoder::GetTotalBytecodeKinds()
+        PP_FOR_EACH(macro, GENERATED_ALL_BYTECODE_BUILDER_BYTECODE_VARIANT_NAMES)
+    >::get();
+#undef macro
+
+const BytecodeValueProfileInfo* ValueProfileReader::GetBytecodeValueProfileInfoArray()
+{
+    return x_dfgBytecodeValueProfileInfo.data();
+}
+
+TypeSpeculationMask WARN_UNUSED ValueProfileReader::GetObservedTypeForLocal(BaselineCodeBlock* bcb, size_t opcode, size_t bcIndex, size_t localOrd)
+{
+    TestAssert(opcode < x_dfgBytecodeValueProfileInfo.size());
+    const BytecodeValueProfileInfo& info = x_dfgBytecodeValueProfileInfo[opcode];
+    TestAssert(info.m_isInitialized);
+    if (bcb == nullptr || info.m_numProfiles == 0)
+    {
+        return x_typeSpeculationMaskFor<tTop>;
+    }
+
+    uint8_t* slowPathData = bcb->GetSlowPathDataAtBytecodeIndex(bcIndex);
+    bool found = false;
+    TypeSpeculationMask result = x_typeSpeculationMaskFor<tBottom>;
+    for (size_t i = 0; i < info.m_numProfiles; i++)
+    {
+        const BytecodeValueProfileSite& site = info.m_sites[i];
+        size_t slot;
+        if (site.m_slotWidth == 1)
+        {
+            slot = UnalignedLoad<uint8_t>(slowPathData + site.m_slotOffsetInSlowPathData);
+        }
+        else
+        {
+            TestAssert(site.m_slotWidth == 2);
+            slot = UnalignedLoad<uint16_t>(slowPathData + site.m_slotOffsetInSlowPathData);
+        }
+        if (slot == localOrd)
+        {
+            found = true;
+            result |= UnalignedLoad<TypeSpeculationMask>(slowPathData + site.m_profileOffsetInSlowPathData);
+        }
+    }
+    return found ? result : x_typeSpeculationMaskFor<tTop>;
+}
+
+}   // namespace dfg
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "common_utils.h"
+#include "tvalue.h"
+
+class BaselineCodeBlock;
+
+namespace dfg {
+
+// Describes one value profile in the baseline JIT SlowPathData of a bytecode kind
+//
+// The baseline JIT fast path ORs the type of the value in the profiled Slot operand into the profile every time the bytecode executes.
+//
+// These information are generated by Deegen
+//
+struct BytecodeValueProfileSite
+{
+    // The offset of the profile (a TypeSpeculationMask) in SlowPathData
+    //
+    uint16_t m_profileOffsetInSlowPathData;
+    // The offset and byte width of the profiled Slot operand in SlowPathData,
+    // so the local ordinal can be decoded from the SlowPathData alone
+    //
+    uint16_t m_slotOffsetInSlowPathData;
+    uint8_t m_slotWidth;
+};
+
+struct BytecodeValueProfileInfo
+{
+    constexpr BytecodeValueProfileInfo()
+        : m_isInitialized(false)
+        , m_numProfiles(0)
+        , m_sites(nullptr)
+    { }
+
+    constexpr BytecodeValueProfileInfo(uint8_t numProfiles, const BytecodeValueProfileSite* sites)
+        : m_isInitialized(true)
+        , m_numProfiles(numProfiles)
+        , m_sites(sites)
+    { }
+
+    // Whether the record has been properly populated, for assertion purpose only
+    //
+    bool m_isInitialized;
+
+    // The total number of value profiles in this bytecode
+    //
+    uint8_t m_numProfiles;
+
+    // An array of length m_numProfiles, or nullptr if the bytecode has no value profile
+    //
+    const BytecodeValueProfileSite* m_sites;
+};
+
+// Reads the value profiles collected by the baseline JIT
+//
+struct ValueProfileReader
+{
+    static const BytecodeValueProfileInfo* GetBytecodeValueProfileInfoArray();
+
+    // Returns the union of the types observed by the bytecode for the value of local 'localOrd'.
+    //
+    // Returns tTop if the bytecode does not profile that local (so nothing is known), and tBottom if the bytecode
+    // never executed in the baseline JIT (in which case the caller may want to speculate that it is not executed at all).
+    //
+    // 'bcb' may be nullptr if the function has not been compiled by the baseline JIT, in which case tTop is returned.
+    //
+    static TypeSpeculationMask WARN_UNUSED GetObservedTypeForLocal(BaselineCodeBlock* bcb, size_t opcode, size_t bcIndex, size_t localOrd);
+};
+
+}   // namespace dfg
@@ -2,6 +2,124 @@
 #include "misc_math_helper.h"
 #include "mmap_utils.h"
 
+#include <pthread.h>
+
+uint64_t deegen_jit_writable_alias_delta = 0;
+
+// All JIT memory is allocated with MAP_32BIT, so it resides in the first 2GB address space, and so do the JIT addresses
+//
+constexpr uint64_t x_jitAddressSpaceLimit = 1ULL << 31;
+
+static std::optional<JitMemoryProtectionMode> g_jitMemoryProtectionModeOverride;
+static bool g_jitMemoryProtectionModeDecided = false;
+
+// The JIT memory and its writable alias are MAP_SHARED mappings of memfds, so after fork() the child would share them with the parent.
+// Revoke the writable aliases in the child, so a JIT write from the child faults instead of silently modifying the parent's JIT code.
+// Note that the JIT code mappings are still shared, so the child still sees the code later emitted by the parent.
+//
+static void RevokeJitWritableAliasInForkedChild()
+{
+    void* r = mmap(reinterpret_cast<void*>(deegen_jit_writable_alias_delta), x_jitAddressSpaceLimit, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to revoke writable alias of JIT memory in forked child process");
+}
+
+static JitMemoryProtectionMode WARN_UNUSED DecideJitMemoryProtectionMode()
+{
+    JitMemoryProtectionMode mode = JitMemoryProtectionMode::ReadWriteExecute;
+    if (g_jitMemoryProtectionModeOverride.has_value())
+    {
+        mode = g_jitMemoryProtectionModeOverride.value();
+    }
+    else
+    {
+        const char* env = getenv("LJR_JIT_WX");
+        if (env != nullptr && strcmp(env, "1") == 0)
+        {
+            mode = JitMemoryProtectionMode::DualMappedWriteXorExecute;
+        }
+    }
+
+    if (mode == JitMemoryProtectionMode::DualMappedWriteXorExecute)
+    {
+        // Reserve (not allocate) a shadow of the whole JIT address space, so the writable alias of every JIT address
+        // is at the same distance from it. The dual-mapped ranges are carved out from the shadow with MAP_FIXED.
+        // The shadow is never freed since the generated code may hold the distance.
+        //
+        void* shadow = do_mmap_with_custom_alignment(JitMemoryPageHeaderBase::x_pageSize /*alignment*/,
+                                                     x_jitAddressSpaceLimit /*length*/,
+                                                     PROT_NONE,
+                                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+        deegen_jit_writable_alias_delta = reinterpret_cast<uint64_t>(shadow);
+        ReleaseAssert(deegen_jit_writable_alias_delta >= x_jitAddressSpaceLimit);
+        assert(deegen_jit_writable_alias_delta % JitMemoryPageHeaderBase::x_pageSize == 0);
+
+        int ret = pthread_atfork(nullptr /*prepare*/, nullptr /*parent*/, RevokeJitWritableAliasInForkedChild /*child*/);
+        VM_FAIL_IF(ret != 0, "Failed to register fork handler for JIT memory");
+    }
+    return mode;
+}
+
+JitMemoryProtectionMode WARN_UNUSED GetJitMemoryProtectionMode()
+{
+    static JitMemoryProtectionMode mode = []() {
+        JitMemoryProtectionMode res = DecideJitMemoryProtectionMode();
+        g_jitMemoryProtectionModeDecided = true;
+        return res;
+    }();
+    return mode;
+}
+
+void SetJitMemoryProtectionMode(JitMemoryProtectionMode mode)
+{
+    ReleaseAssert(!g_jitMemoryProtectionModeDecided && "the JIT memory protection mode can no longer be changed");
+    g_jitMemoryProtectionModeOverride = mode;
+}
+
+// Back the (already reserved) JIT address range [jitAddr, jitAddr + size) and its writable alias with a fresh memfd
+//
+static void MapJitMemoryWithWritableAlias(void* jitAddr, size_t size, int jitAddrProtFlags)
+{
+    assert(GetJitMemoryProtectionMode() == JitMemoryProtectionMode::DualMappedWriteXorExecute);
+    assert(reinterpret_cast<uint64_t>(jitAddr) % 4096 == 0 && size % 4096 == 0);
+    ReleaseAssert(reinterpret_cast<uint64_t>(jitAddr) + size <= x_jitAddressSpaceLimit);
+
+    int fd = memfd_create("ljr-jit", MFD_CLOEXEC);
+    VM_FAIL_WITH_ERRNO_IF(fd == -1, "Failed to create memfd for JIT memory of size %llu", static_cast<unsigned long long>(size));
+
+    int ret = ftruncate(fd, static_cast<off_t>(size));
+    VM_FAIL_WITH_ERRNO_IF(ret != 0, "Failed to resize memfd for JIT memory to size %llu", static_cast<unsigned long long>(size));
+
+    void* r = mmap(jitAddr, size, jitAddrProtFlags, MAP_SHARED | MAP_FIXED, fd, 0);
+    VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to map JIT memory of size %llu", static_cast<unsigned long long>(size));
+    assert(r == jitAddr);
+
+    void* alias = GetJitWritableAlias(jitAddr);
+    r = mmap(alias, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to map writable alias of JIT memory of size %llu", static_cast<unsigned long long>(size));
+    assert(r == alias);
+
+    // The mappings keep the memory alive
+    //
+    close(fd);
+}
+
+// Free the JIT address range [jitAddr, jitAddr + size) and its writable alias to OS
+//
+static void UnmapJitMemory(void* jitAddr, size_t size)
+{
+    do_munmap(jitAddr, size);
+    if (deegen_jit_writable_alias_delta != 0)
+    {
+        // Turn the writable alias back into a reservation, so the shadow range is never reused by anyone else
+        //
+        void* alias = GetJitWritableAlias(jitAddr);
+        void* r = mmap(alias, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to release writable alias of JIT memory of size %llu", static_cast<unsigned long long>(size));
+        assert(r == alias);
+    }
+}
+
 void JitMemoryLargeAllocationHeader::Destroy()
 {
     DoublyLink* next = m_link.next;
@@ -9,7 +127,7 @@ void JitMemoryLargeAllocationHeader::Destroy()
     next->prev = prev;
     prev->next = next;
     assert(reinterpret_cast<uint64_t>(this) % x_pageSize == 0);
-    do_munmap(this, GetSize());
+    UnmapJitMemory(GetJitAddressFromWritableAlias(this), GetSize());
 }
 
 JitMemoryPageHeader* WARN_UNUSED JitMemoryAllocator::AllocateUninitalizedPage()
@@ -22,6 +140,14 @@ JitMemoryPageHeader* WARN_UNUSED JitMemoryAllocator::AllocateUninitalizedPage()
         assert(m_reservedRangeCur % x_pageSize == 0);
         m_reservedRangeEnd = m_reservedRangeCur + x_reserveRangeSize;
 
+        // In dual-mapped mode, the whole range is backed by one memfd up front, so no syscall is needed for each page
+        // (the memfd is sparse, so the memory is only committed when a page is first written)
+        //
+        if (m_isDualMapped)
+        {
+            MapJitMemoryWithWritableAlias(reservedRange, x_reserveRangeSize, GetJitMemoryProtFlags());
+        }
+
         m_unmapList.push_back(reservedRange);
     }
 
@@ -30,13 +156,16 @@ JitMemoryPageHeader* WARN_UNUSED JitMemoryAllocator::AllocateUninitalizedPage()
     void* pageAddr = reinterpret_cast<void*>(m_reservedRangeCur);
     m_reservedRangeCur += x_pageSize;
 
-    void* r = mmap(pageAddr, x_pageSize, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_FIXED, -1, 0);
-    VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to allocate JIT memory of size %llu", static_cast<unsigned long long>(x_pageSize));
-    assert(pageAddr == r);
+    if (!m_isDualMapped)
+    {
+        void* r = mmap(pageAddr, x_pageSize, GetJitMemoryProtFlags(), MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_FIXED, -1, 0);
+        VM_FAIL_WITH_ERRNO_IF(r == MAP_FAILED, "Failed to allocate JIT memory of size %llu", static_cast<unsigned long long>(x_pageSize));
+        assert(pageAddr == r);
+    }
 
     m_totalOsMemoryUsage += x_pageSize;
 
-    return reinterpret_cast<JitMemoryPageHeader*>(pageAddr);
+    return reinterpret_cast<JitMemoryPageHeader*>(GetJitWritableAlias(pageAddr));
 }
 
 void* WARN_UNUSED JitMemoryAllocator::DoLargeAllocation(size_t size)
@@ -45,12 +174,24 @@ void* WARN_UNUSED JitMemoryAllocator::DoLargeAllocation(size_t size)
 
     size = RoundUpToMultipleOf<4096>(size + sizeof(JitMemoryLargeAllocationHeader));
 
-    void* ptrVoid = do_mmap_with_custom_alignment(x_pageSize /*alignment*/,
-                                                  size /*length*/,
-                                                  PROT_READ | PROT_WRITE | PROT_EXEC,
-                                                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_32BIT);
+    void* ptrVoid;
+    if (m_isDualMapped)
+    {
+        ptrVoid = do_mmap_with_custom_alignment(x_pageSize /*alignment*/,
+                                                size /*length*/,
+                                                PROT_NONE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_32BIT);
+        MapJitMemoryWithWritableAlias(ptrVoid, size, GetJitMemoryProtFlags());
+    }
+    else
+    {
+        ptrVoid = do_mmap_with_custom_alignment(x_pageSize /*alignment*/,
+                                                size /*length*/,
+                                                GetJitMemoryProtFlags(),
+                                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_32BIT);
+    }
 
-    JitMemoryLargeAllocationHeader* hdr = reinterpret_cast<JitMemoryLargeAllocationHeader*>(ptrVoid);
+    JitMemoryLargeAllocationHeader* hdr = reinterpret_cast<JitMemoryLargeAllocationHeader*>(GetJitWritableAlias(ptrVoid));
     hdr->Initialize(size, &m_laAnchor);
 
     m_totalUsedMemory += size;
@@ -58,7 +199,7 @@ void* WARN_UNUSED JitMemoryAllocator::DoLargeAllocation(size_t size)
 
     void* res = hdr->GetAllocatedObject();
     assert(reinterpret_cast<uint64_t>(res) % 16 == 0);
-    return res;
+    return GetJitAddressFromWritableAlias(res);
 }
 
 void JitMemoryAllocator::Shutdown()
@@ -66,7 +207,7 @@ void JitMemoryAllocator::Shutdown()
     while (m_laAnchor.next != &m_laAnchor)
     {
         JitMemoryLargeAllocationHeader* hdr = JitMemoryLargeAllocationHeader::GetFromLinkNode(m_laAnchor.next);
-        Free(hdr->GetAllocatedObject());
+        Free(GetJitAddressFromWritableAlias(hdr->GetAllocatedObject()));
     }
 
     assert(m_laAnchor.prev == &m_laAnchor);
@@ -75,7 +216,7 @@ void JitMemoryAllocator::Shutdown()
     m_totalOsMemoryUsage += m_reservedRangeEnd - m_reservedRangeCur;
     for (void* ptr : m_unmapList)
     {
-        do_munmap(ptr, x_reserveRangeSize);
+        UnmapJitMemory(ptr, x_reserveRangeSize);
         m_totalOsMemoryUsage -= x_reserveRangeSize;
     }
 
@@ -13,6 +13,51 @@
 // TODO: think about supporting ASLR later..
 //
 
+// How the JIT memory is protected. This is a process-wide setting, decided once before the first JIT memory allocation.
+//
+enum class JitMemoryProtectionMode : uint8_t
+{
+    // Every JIT page is mapped readable, writable and executable, so the JIT code is written in place
+    //
+    ReadWriteExecute,
+    // Every JIT page is backed by a memfd and mapped twice: the JIT address is readable and executable, and its writable alias
+    // (at a constant distance 'deegen_jit_writable_alias_delta' from the JIT address) is readable and writable.
+    // So no page is ever both writable and executable, and emitting code never needs an mprotect.
+    //
+    // Note that the memfd mappings are MAP_SHARED, so they stay shared with the parent in a child created by fork():
+    // a JIT write in either process would be visible to (and corrupt) the other. To prevent that, the child loses the
+    // writable aliases on fork (the whole alias range becomes PROT_NONE), so a child must not run the VM, and should only exec.
+    //
+    DualMappedWriteXorExecute
+};
+
+// The distance from a JIT address to its writable alias, 0 in ReadWriteExecute mode
+// This is also read by the generated baseline JIT codegen functions, which write all JIT code through the alias.
+//
+extern "C" uint64_t deegen_jit_writable_alias_delta;
+
+// Selected by environment variable LJR_JIT_WX=1 by default.
+//
+JitMemoryProtectionMode WARN_UNUSED GetJitMemoryProtectionMode();
+
+// Must be called before the first call to GetJitMemoryProtectionMode (which happens when the first JitMemoryAllocator is created)
+//
+void SetJitMemoryProtectionMode(JitMemoryProtectionMode mode);
+
+// Returns the address through which the JIT memory at 'jitAddr' should be written
+//
+template<typename T>
+T* WARN_UNUSED ALWAYS_INLINE GetJitWritableAlias(T* jitAddr)
+{
+    return reinterpret_cast<T*>(reinterpret_cast<uint64_t>(jitAddr) + deegen_jit_writable_alias_delta);
+}
+
+template<typename T>
+T* WARN_UNUSED ALWAYS_INLINE GetJitAddressFromWritableAlias(T* alias)
+{
+    return reinterpret_cast<T*>(reinterpret_cast<uint64_t>(alias) - deegen_jit_writable_alias_delta);
+}
+
 // The exponentially-growing stepping array for the segregated allocator
 //
 constexpr uint16_t x_jit_mem_alloc_stepping_array[] = {
@@ -38,6 +83,11 @@ constexpr uint16_t x_jit_mem_alloc_stepping_array[] = {
 
 constexpr size_t x_jit_mem_alloc_total_steppings = std::extent_v<decltype(x_jit_mem_alloc_stepping_array)>;
 
+// Used in place of a stepping value to denote that nothing needs to be allocated
+//
+constexpr uint8_t x_jit_mem_alloc_stepping_none = 255;
+static_assert(x_jit_mem_alloc_total_steppings < x_jit_mem_alloc_stepping_none);
+
 static_assert([]() {
     for (size_t i = 0; i < x_jit_mem_alloc_total_steppings; i++)
     {
@@ -82,6 +132,9 @@ class JitMemoryAllocator;
 // The header base class for segregated allocator memory pages or large allocator allocations
 // This always resides at a 16KB-boundary
 //
+// Note that the allocator only ever accesses the headers through the writable alias of the JIT memory,
+// so all the header pointers below are writable alias addresses.
+//
 struct JitMemoryPageHeaderBase
 {
     MAKE_NONCOPYABLE(JitMemoryPageHeaderBase);
@@ -271,7 +324,7 @@ public:
         assert(IsLargeAllocation() && AsLAHeader() == this);
     }
 
-    // Free underlying memory to OS
+    // Free underlying memory (both the JIT address range and its writable alias) to OS
     //
     void Destroy();
 
@@ -322,7 +375,11 @@ inline JitMemoryPageHeaderBase* WARN_UNUSED JitMemoryPageHeaderBase::Get(const v
 class JitMemoryAllocator
 {
 public:
-    JitMemoryAllocator()
+    // If 'isExecutable' is false, the memory is for data only and is never mapped executable
+    //
+    JitMemoryAllocator(bool isExecutable = true)
+        : m_isExecutable(isExecutable)
+        , m_isDualMapped(GetJitMemoryProtectionMode() == JitMemoryProtectionMode::DualMappedWriteXorExecute)
     {
         for (size_t i = 0; i < x_jit_mem_alloc_total_steppings; i++)
         {
@@ -342,6 +399,7 @@ public:
     }
 
     // Allocate a piece of memory with size x_jit_mem_alloc_stepping_array[wantedStepping]
+    // Returns the JIT address, use GetJitWritableAlias to get the address for writing
     // Directly responsible for 'm_totalUsedMemory' accounting
     //
     void* WARN_UNUSED AllocateGivenStepping(uint8_t wantedStepping)
@@ -367,7 +425,7 @@ public:
         m_totalUsedMemory += x_jit_mem_alloc_stepping_array[wantedStepping];
 
         assert(reinterpret_cast<uint64_t>(res) % 16 == 0);
-        return res;
+        return GetJitAddressFromWritableAlias(res);
     }
 
     // Allocate a piece of memory with size 'wantedSize'
@@ -389,8 +447,9 @@ public:
     // Free an allocated piece of memory
     // Directly responsible for 'm_totalUsedMemory' and 'm_totalOsMemoryUsage' accounting
     //
-    void Free(void* addr)
+    void Free(void* jitAddr)
     {
+        void* addr = GetJitWritableAlias(jitAddr);
         JitMemoryPageHeaderBase* hb = JitMemoryPageHeaderBase::Get(addr);
         if (unlikely(hb->IsLargeAllocation()))
         {
@@ -451,14 +510,33 @@ private:
     //
     void* WARN_UNUSED DoLargeAllocation(size_t size);
 
+    // Returns the writable alias of the page
     // Directly responsible for 'm_totalOsMemoryUsage' accounting
     //
     JitMemoryPageHeader* WARN_UNUSED AllocateUninitalizedPage();
 
+    int GetJitMemoryProtFlags()
+    {
+        if (m_isDualMapped)
+        {
+            return m_isExecutable ? (PROT_READ | PROT_EXEC) : PROT_READ;
+        }
+        else
+        {
+            return m_isExecutable ? (PROT_READ | PROT_WRITE | PROT_EXEC) : (PROT_READ | PROT_WRITE);
+        }
+    }
+
     // Deallocate everything and free all memory to OS.
     //
     void Shutdown();
 
+    bool m_isExecutable;
+
+    // Whether the memory is mapped in DualMappedWriteXorExecute mode
+    //
+    bool m_isDualMapped;
+
     JitMemoryPageHeader* m_freeList[x_jit_mem_alloc_total_steppings];
 
     // The current size of memory the user has used.
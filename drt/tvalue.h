@@ -865,6 +865,41 @@ std::string WARN_UNUSED DumpHumanReadableTypeSpeculationDefinitions();
 //
 std::string WARN_UNUSED DumpHumanReadableTypeSpeculation(TypeSpeculationMask mask, bool printMaskValue = false);
 
+// The leaf masks of the language-exposed heap object types are contiguous and in the same order as the HeapEntityType enum,
+// so the mask of a heap object can be computed from its HeapEntityType with a single shift
+//
+#define macro(hoi)                                                                                                              \
+    static_assert(x_typeSpeculationMaskFor<PP_CAT(t, HOI_ENUM_NAME(hoi))> ==                                                    \
+        (x_typeSpeculationMaskFor<tString> << static_cast<uint8_t>(HeapEntityType::HOI_ENUM_NAME(hoi))));
+PP_FOR_EACH(macro, LANGUAGE_EXPOSED_HEAP_OBJECT_INFO_LIST)
+#undef macro
+
+// Returns the leaf type speculation mask of a runtime value
+//
+// This is used by the value profiling logic in the JIT fast paths, so it is written to be cheap:
+// every boxing tag is checked at most once and no table lookup is needed.
+//
+inline TypeSpeculationMask WARN_UNUSED ALWAYS_INLINE GetTypeSpeculationMaskForValue(TValue v)
+{
+    if (v.IsInt32())
+    {
+        return x_typeSpeculationMaskFor<tInt32>;
+    }
+    if (v.IsDouble())
+    {
+        return v.IsDoubleNotNaN() ? x_typeSpeculationMaskFor<tDoubleNotNaN> : x_typeSpeculationMaskFor<tDoubleNaN>;
+    }
+    if (v.IsMIV())
+    {
+        return v.IsNil() ? x_typeSpeculationMaskFor<tNil> : x_typeSpeculationMaskFor<tBool>;
+    }
+    assert(v.IsPointer());
+    uint8_t ty = static_cast<uint8_t>(DeegenImpl_TValueGetPointerType(v));
+    TypeSpeculationMask res = x_typeSpeculationMaskFor<tString> << ty;
+    assert((res & x_typeSpeculationMaskFor<tHeapEntity>) == res && res != 0);
+    return res;
+}
+
 // Some utility logic and macros for typecheck strength reduction definitions
 //
 struct tvalue_typecheck_strength_reduction_rule
@@ -0,0 +1,45 @@
+-- Creates a large number of short-lived coroutines.
+-- Each coroutine yields once and then finishes, so the cost is dominated by
+-- coroutine creation and teardown rather than by switching between live coroutines.
+
+local n         = tonumber(arg and arg[1]) or 5e6
+
+-- cache these to avoid global environment lookups
+local create    = coroutine.create
+local resume    = coroutine.resume
+local yield     = coroutine.yield
+local wrap      = coroutine.wrap
+
+local body = function(a, b)
+  local c = yield(a + b)
+  return c * 2
+end
+
+local sum = 0
+for i = 1, n do
+  local co = create(body)
+  local ok, v = resume(co, i, 1)
+  sum = sum + v
+  ok, v = resume(co, i)
+  sum = sum + v
+end
+
+-- coroutine.wrap, where every 16th coroutine dies with an error
+local errbody = function(x)
+  if x % 16 == 0 then
+    error(x)
+  end
+  return x
+end
+
+local numErrors = 0
+for i = 1, n / 4 do
+  local ok, v = pcall(wrap(errbody), i)
+  if ok then
+    sum = sum + v
+  else
+    numErrors = numErrors + 1
+  end
+end
+
+io.write(sum, " ", numErrors, "\n")
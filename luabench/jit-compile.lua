@@ -0,0 +1,47 @@
+-- Compiles a large number of distinct functions.
+-- Each function is loaded from its own source string and then run just long enough to get
+-- compiled by the baseline JIT, so the cost is dominated by parsing and JIT codegen
+-- rather than by executing the compiled code.
+--
+-- Running this with LJR_JIT_WX=1 measures the compile-throughput cost of the W^X (dual-mapped) JIT memory mode.
+-- Parsing is a large part of the cost here. For a number that only contains the codegen, see 'luajitr --bench-baseline-jit-codegen'.
+
+local n         = tonumber(arg and arg[1]) or 20000
+
+-- cache these to avoid global environment lookups
+local loadstring = loadstring or load
+local concat    = table.concat
+local format    = string.format
+
+-- Build the source of the i-th function. The constants differ for every function, and the body mixes
+-- arithmetic, comparisons, table accesses and calls, so each function exercises a good variety of bytecodes and ICs.
+--
+local function makeSource(i)
+  local lines = {}
+  lines[#lines + 1] = "local t, f = ..."
+  lines[#lines + 1] = "return function(k)"
+  lines[#lines + 1] = "  local s = 0"
+  lines[#lines + 1] = "  for j = 1, k do"
+  for m = 1, 8 do
+    lines[#lines + 1] = format("    if j %% %d == %d then s = s + t.a * %d else s = s - f(j, %d) end", m + 1, i % (m + 1), i + m, m)
+    lines[#lines + 1] = format("    t.b = t.b + %d", (i * m) % 7)
+  end
+  lines[#lines + 1] = "  end"
+  lines[#lines + 1] = "  return s + t.b"
+  lines[#lines + 1] = "end"
+  return concat(lines, "\n")
+end
+
+local t = { a = 3, b = 0 }
+local f = function(x, y) return x % y end
+
+local sum = 0
+for i = 1, n do
+  local chunk = assert(loadstring(makeSource(i)))
+  local fn = chunk(t, f)
+  for r = 1, 8 do
+    sum = (sum + fn(16)) % 1000000007
+  end
+end
+
+io.write(sum, " ", t.b, "\n")
@@ -0,0 +1,30 @@
+-- There is no garbage collector yet, so the options that would run it throw
+print(pcall(collectgarbage))
+print(pcall(collectgarbage, "collect"))
+
+local c = collectgarbage("count")
+print(type(c), c > 0)
+
+local t = {}
+for i = 1, 10000 do
+	t[i] = { i, tostring(i) }
+end
+print(collectgarbage("count") > c, #t)
+
+print(pcall(collectgarbage, "step"))
+print(pcall(collectgarbage, "step", 100))
+print(collectgarbage("stop"))
+print(collectgarbage("restart"))
+
+print(collectgarbage("setpause", 150))
+print(collectgarbage("setpause", "200"))
+print(collectgarbage("setpause"))
+print(collectgarbage("setpause", 200))
+print(collectgarbage("setstepmul", 400))
+print(collectgarbage("setstepmul", 200))
+
+print(type(gcinfo()), gcinfo() >= 0)
+
+print(pcall(collectgarbage, "foo"))
+print((pcall(collectgarbage, "setpause", "abc")))
+print((pcall(collectgarbage, {})))
@@ -0,0 +1,45 @@
+-- Coroutine stacks grow on demand, so deep recursion works in both the root coroutine and other coroutines
+
+local function depth(n)
+  if n == 0 then return 0 end
+  return 1 + depth(n - 1)
+end
+
+print(depth(50000))
+
+local co = coroutine.wrap(function(n)
+  local r = depth(n)
+  r = r + coroutine.yield(r)
+  return depth(n * 2) + r
+end)
+print(co(30000))
+print(co(5))
+
+-- Many suspended coroutines, each with a small stack
+--
+local idle = {}
+for i = 1, 5000 do
+  idle[i] = coroutine.create(function(x)
+    local y = coroutine.yield(x)
+    return x + y + depth(100)
+  end)
+  coroutine.resume(idle[i], i)
+end
+local s = 0
+for i = 1, 5000 do
+  local ok, v = coroutine.resume(idle[i], 1)
+  s = s + v
+end
+print(s)
+
+-- Exhausting the reserved stack throws a catchable error instead of crashing
+--
+local function forever(n)
+  return 1 + forever(n + 1)
+end
+print(pcall(forever, 0))
+
+local co2 = coroutine.create(function() return forever(0) end)
+print(coroutine.resume(co2))
+print(coroutine.status(co2))
+print(depth(100))
@@ -0,0 +1,73 @@
+-- The stack of a coroutine is recycled once the coroutine is dead.
+-- Upvalues captured by a dead coroutine must stay intact after the stack is reused by other coroutines.
+
+local getters = {}
+local bad = 0
+for i = 1, 600 do
+  local co = coroutine.create(function(x)
+    local v = x * 10
+    getters[#getters + 1] = function() return v end
+    local y = coroutine.yield(v)
+    v = v + y
+    return v
+  end)
+  local ok1, a = coroutine.resume(co, i)
+  local ok2, b = coroutine.resume(co, 1)
+  if not ok1 or not ok2 or a ~= i * 10 or b ~= i * 10 + 1 or coroutine.status(co) ~= "dead" then
+    bad = bad + 1
+  end
+  local ok3 = coroutine.resume(co)
+  if ok3 then
+    bad = bad + 1
+  end
+end
+
+-- Coroutines that die with an error, resumed by coroutine.resume and coroutine.wrap
+--
+for i = 1, 600 do
+  local co = coroutine.create(function(x)
+    local w = x * 3
+    getters[#getters + 1] = function() return w end
+    error(w)
+  end)
+  local ok, e = coroutine.resume(co, i)
+  if ok or e ~= i * 3 then
+    bad = bad + 1
+  end
+  ok, e = pcall(coroutine.wrap(function(x)
+    local u = x
+    getters[#getters + 1] = function() return u end
+    error(u)
+  end), i)
+  if ok or e ~= i then
+    bad = bad + 1
+  end
+end
+
+-- Many coroutines alive at the same time, so that more stacks are released than the pool can hold
+--
+local live = {}
+for i = 1, 300 do
+  live[i] = coroutine.create(function(x)
+    local z = x
+    getters[#getters + 1] = function() return z end
+    z = z + coroutine.yield()
+    return z
+  end)
+  coroutine.resume(live[i], i)
+end
+local liveSum = 0
+for i = 1, 300 do
+  local ok, r = coroutine.resume(live[i], 1000)
+  liveSum = liveSum + r
+end
+
+local sum = 0
+for i = 1, #getters do
+  sum = sum + getters[i]()
+end
+
+print(bad)
+print(#getters)
+print(liveSum)
+print(sum)
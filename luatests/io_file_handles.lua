@@ -0,0 +1,113 @@
+-- io file handles
+print(io.type(io.stdout), io.type(42), io.type(nil))
+
+local f = assert(io.tmpfile())
+print(io.type(f), type(f), tostring(f):sub(1, 6))
+print(f:write("hello world\n", 12.5, "\n", "line3 no newline"))
+print(f:seek("set"))
+for l in f:lines() do
+    print("[" .. l .. "]")
+end
+
+f:seek("set")
+print(f:read("*l", "*n", "*l"))
+print(f:read(5))
+print(f:read("*a"))
+print(f:read("*a") == "", f:read("*l"), f:read(0))
+
+print(f:seek("set", 6))
+print(f:read(5))
+print(f:seek())
+print(f:seek("end"))
+
+-- Writing after reading must write at the position seen by the program, not at the end of the buffered input
+--
+f:seek("set")
+print(f:read(5))
+f:write("HELLO")
+f:seek("set")
+print(f:read("*l"))
+print(f:close())
+print(io.type(f), tostring(f))
+print((pcall(f.read, f)))
+
+-- A line much longer than the internal buffer
+--
+local g = io.tmpfile()
+local longLine = string.rep("x", 100000)
+g:write(longLine, "\n", "end\n")
+g:seek("set")
+local l = g:read("*l")
+print(#l, l == longLine)
+print(g:read("*l"))
+print(g:read("*l"))
+g:close()
+
+-- Many short lines
+--
+local h = io.tmpfile()
+for i = 1, 20000 do
+    h:write("line ", i, "\n")
+end
+h:seek("set")
+local cnt, last = 0, nil
+for l in h:lines() do
+    cnt = cnt + 1
+    last = l
+end
+print(cnt, last)
+h:close()
+
+-- read("*a") on a large file
+--
+local b = io.tmpfile()
+local chunk = string.rep("abcdefghij", 1000)
+for i = 1, 150 do
+    b:write(chunk)
+end
+b:write("END")
+b:seek("set")
+print(b:read(3))
+local all = b:read("*a")
+print(#all, all:sub(1, 7), all:sub(-5))
+print(b:read("*a") == "", b:read("*l"))
+b:close()
+
+-- Default input and output files
+--
+local o = io.tmpfile()
+io.output(o)
+io.write("redirected ", 1, "\n")
+io.output(io.stdout)
+o:seek("set")
+io.input(o)
+print(io.read("*l"))
+print(io.read("*l"))
+io.input(io.stdin)
+print(io.close(o))
+print(io.close(io.stdout))
+print(io.stdout:write("via stdout\n"))
+
+print(io.open("/nonexistent_dir/x.txt"))
+for line in io.lines("luatests/io_file_handles.lua") do
+    print(line)
+    break
+end
+
+-- The '+' of a mode may come before or after the 'b's
+--
+for _, mode in ipairs({ "rb+", "r+b", "wb+", "ab+", "r++", "rx" }) do
+    print(mode, io.open("/nonexistent_dir/x.txt", mode))
+end
+
+-- Counts and offsets that do not fit in an integer
+--
+local r = io.tmpfile()
+r:write("abc")
+r:seek("set")
+print(r:read(1 / 0))
+print(r:read(0 / 0))
+print(r:seek("set", 1e300))
+print(r:seek("set", 0 / 0))
+print(r:seek("cur"))
+r:close()
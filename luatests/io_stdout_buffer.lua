@@ -0,0 +1,22 @@
+io.write("a", 1, " ", 2.5, "\n")
+print("b", 3, nil, true, false)
+io.write(1e100, " ", 12345678901234, " ", -7, "\n")
+print(io.stdout:write("c"))
+
+print(io.stdout:setvbuf("no"))
+io.write("d")
+io.write("e\n")
+print(io.stdout:setvbuf("line"))
+io.write("f", 0.1, "\n")
+print(io.stdout:setvbuf("full"))
+print(io.flush())
+print(io.stdout:flush())
+
+local t = {}
+for i = 1, 1000 do t[#t + 1] = i end
+io.write(table.concat(t, ",", 990), "\n")
+for i = 1, 5 do io.write(i, i < 5 and " " or "\n") end
+
+-- The __tostring metamethod writes to stdout in the middle of a print
+local obj = setmetatable({}, { __tostring = function() io.write("<") return "obj" end })
+print(1, obj, 2)
@@ -0,0 +1,50 @@
+-- Long strings are hashed in full, so strings that only differ in one byte in the middle must still be distinct
+
+local parts = {}
+for i = 1, 2000 do parts[i] = string.char(97 + i % 26) end
+local base = table.concat(parts)
+local s = ""
+for i = 1, 20 do s = s .. base end
+local t = {}
+t[s] = 1
+local s2 = string.rep(base, 20)
+print(#s, s == s2, t[s2])
+
+local a = string.rep("x", 5000) .. "a" .. string.rep("x", 5000)
+local b = string.rep("x", 5000) .. "b" .. string.rep("x", 5000)
+t[a] = "A"
+t[b] = "B"
+print(a == b, t[a], t[b], #a)
+local c = string.rep("x", 5000) .. "a" .. string.rep("x", 5000)
+print(a == c, t[c])
+
+-- Long concatenation results are only interned when they are compared or used as a table key
+--
+local x = base .. base
+local y = base .. base
+print(x == y, x ~= y, rawequal(x, y), #x)
+local t2 = {}
+t2[x] = "first"
+t2[y] = "second"
+local n = 0
+for k, v in pairs(t2) do n = n + 1 end
+print(n, t2[x], rawget(t2, y), next(t2, x))
+print(x < y, x <= y, (x .. "z") > y)
+local tc = table.concat(parts, ",")
+local tc2 = table.concat(parts, ",")
+print(#tc, tc == tc2, ({ [tc] = 7 })[tc2])
+
+-- The operands on the right of a metamethod call are concatenated in one go
+--
+local obj = setmetatable({}, { __concat = function(x, y)
+  local xs = type(x) == "table" and "<T>" or x
+  local ys = type(y) == "table" and "<T>" or y
+  return xs .. "|" .. ys
+end })
+print("a" .. "b" .. obj .. "c" .. 1 .. 2.5 .. "d")
+
+-- If no concatenation happens before the metamethod call, the metamethod sees the original operand
+--
+local obj2 = setmetatable({}, { __concat = function(x, y) return type(y) end })
+print(obj2 .. 3)
+print(1 .. obj2 .. 3)
@@ -0,0 +1,83 @@
+-- Many differently shaped tables flowing through the same GetById / PutById sites,
+-- so the inline caches overflow and the sites go megamorphic
+
+local objs = {}
+for i = 1, 40 do
+	local o = {}
+	for j = 1, i % 10 do
+		o["f" .. j] = j
+	end
+	o.x = i
+	if i % 3 == 0 then
+		o.y = i * 2
+	end
+	objs[i] = o
+end
+
+local function getx(o) return o.x end
+local function gety(o) return o.y end
+local function setx(o, v) o.x = v end
+local function setz(o, v) o.z = v end
+
+local sum = 0
+for round = 1, 3 do
+	for i = 1, 40 do
+		sum = sum + getx(objs[i])
+	end
+end
+print(sum)
+
+local cnt = 0
+for i = 1, 40 do
+	if gety(objs[i]) ~= nil then
+		cnt = cnt + 1
+	end
+end
+print(cnt)
+
+for i = 1, 40 do
+	setx(objs[i], getx(objs[i]) * 10)
+end
+local s = 0
+for i = 1, 40 do
+	s = s + objs[i].x
+end
+print(s)
+
+-- Adding a new property through a megamorphic site
+--
+for i = 1, 40 do
+	setz(objs[i], i)
+end
+s = 0
+for i = 1, 40 do
+	s = s + objs[i].z + getx(objs[i])
+end
+print(s)
+
+-- A missing property must still fall back to the __index metamethod
+--
+local base = { w = 7 }
+local mt = { __index = base }
+local withMt = {}
+for i = 1, 12 do
+	local o = setmetatable({}, mt)
+	for j = 1, i do
+		o["g" .. j] = j
+	end
+	withMt[i] = o
+end
+
+local function getw(o) return o.w end
+s = 0
+for i = 1, 12 do
+	s = s + getw(withMt[i])
+end
+print(s)
+
+withMt[5].w = 100
+s = 0
+for i = 1, 12 do
+	s = s + getw(withMt[i])
+end
+print(s)
@@ -0,0 +1,57 @@
+-- Round-trip functions through string.dump and load them back
+
+local chunk = [[
+local t = { 10, 20, 30, x = "a", y = 1.5, [true] = "yes", [-1] = "neg", [2.5] = "frac", z = nil }
+local function counter(start)
+  local n = start
+  return function(step)
+    n = n + step
+    return n
+  end
+end
+local c = counter(t[2])
+c(5)
+return t[1] + t[3], t.x .. t[true] .. t[-1] .. t[2.5], t.y, c(1), t.z
+]]
+
+local f = assert(loadstring(chunk))
+local d = string.dump(f)
+print(type(d), string.sub(d, 1, 1) == "\027")
+
+local g = assert(loadstring(d))
+print(g())
+-- The loaded function can be called multiple times, and each call gets fresh tables and closures
+print(g())
+
+-- A function with arguments and varargs
+local function add(a, b, ...)
+  local s = a + b
+  for i = 1, select("#", ...) do
+    s = s + select(i, ...)
+  end
+  return s, "sum"
+end
+local add2 = assert(loadstring(string.dump(add)))
+print(add2(1, 2), add2(1, 2, 3, 4))
+
+-- load() with a reader function that returns the chunk in small pieces
+local pos = 1
+local g2 = assert(load(function()
+  local piece = string.sub(d, pos, pos + 6)
+  pos = pos + 7
+  return piece
+end))
+print(g2())
+
+-- Dump of a loaded function round-trips too
+print(assert(loadstring(string.dump(g)))())
+
+-- Functions with upvalues and C functions cannot be dumped
+local up = 1
+print(pcall(string.dump, function() return up end))
+print(pcall(string.dump, print))
+print(pcall(string.dump, 1))
+
+-- A truncated chunk fails to load
+local res, err = loadstring(string.sub(d, 1, #d - 3))
+print(res, type(err))
@@ -0,0 +1,78 @@
+print(string.find("hello world", "wor"))
+print(string.find("hello world", "o", 6))
+print(string.find("hello world", "l+"))
+print(string.find("a.b.c", ".", 1, true))
+print(string.find("a.b.c", "%."))
+print(string.find("hello", "xyz"))
+print(string.find("hello", ""))
+print(string.find("hello", "", 10))
+print(string.find("key = value", "(%w+)%s*=%s*(%w+)"))
+print(string.find("hello", "^h"))
+print(string.find("hello", "^e"))
+print(string.find("hello", "o$"))
+
+print(string.match("hello 123 world", "%d+"))
+print(string.match("key = value", "(%w+)%s*=%s*(%w+)"))
+print(string.match("hello", "()ll()"))
+print(string.match("  trim me  ", "^%s*(.-)%s*$"))
+print(string.match("[[nested]]", "%[(%b[])%]"))
+print(string.match("THE (quick) fox", "%f[%a]%a+"))
+print(string.match("abcabc", "(abc)%1"))
+print(string.match("x = 10", "[%a_][%w_]*"))
+print(string.match("2024-01-15", "(%d+)-(%d+)-(%d+)"))
+print(string.match("aaa", "a-b"))
+print(string.match("aaab", "a-b"))
+print(string.match("hello", "[^aeiou]+"))
+
+for w in string.gmatch("one two  three", "%a+") do
+  print(w)
+end
+for k, v in string.gmatch("a=1, b=2, c=3", "(%w+)=(%w+)") do
+  print(k, v)
+end
+local n = 0
+for _ in string.gmatch("abc", "") do
+  n = n + 1
+end
+print(n)
+
+print(string.gsub("hello world", "o", "0"))
+print(string.gsub("hello world", "o", "0", 1))
+print(string.gsub("hello world", "(%w+)", "<%1>"))
+print(string.gsub("hello", "", "-"))
+print(string.gsub("abc", "%w", "%0%0"))
+print(string.gsub("50%", "%%", " percent"))
+print(string.gsub("$name is $age", "%$(%w+)", { name = "Bob", age = 42 }))
+print(string.gsub("$name is $unknown", "%$(%w+)", { name = "Bob" }))
+print(string.gsub("1 2 3", "%d", function(d) return d * 2 end))
+print(string.gsub("a b c", "%a", function(c) if c == "b" then return false end return string.upper(c) end))
+print(string.gsub("hello", "^h", "H"))
+print(string.gsub("abc", "x", "y"))
+
+local t = setmetatable({}, { __index = function(_, k) return "[" .. k .. "]" end })
+print(string.gsub("x y", "%a", t))
+
+print((pcall(string.find, "abc", "[a")))
+print((pcall(string.find, "abc", "%")))
+print((pcall(string.match, "abc", "(a")))
+print((pcall(string.find, "abc", "x)")))
+print(select(2, pcall(string.match, "abc", "a)")))
+print((pcall(string.gsub, "abc", "a", true)))
+print((pcall(string.gsub, "abc", "a", function() return {} end)))
+print(string.gfind == string.gmatch)
+
+-- The replacement function may throw or yield in the middle of a gsub
+local errObj = {}
+local ok, e = pcall(string.gsub, "abc", "%a", function(c) if c == "b" then error(errObj) end return c end)
+print(ok, e == errObj)
+local co = coroutine.wrap(function()
+  return string.gsub("a1b2c3", "%d", function(d) coroutine.yield(d) return d * 10 end)
+end)
+print(co())
+print(co())
+print(co())
+print(co())
+
+local long = string.rep("ab", 5000)
+local r, n = string.gsub(long, "a", function() return "xyz" end)
+print(#r, n, r == string.rep("xyzb", 5000))
@@ -0,0 +1,85 @@
+local function dump(t, n)
+  local parts = {}
+  for i = 1, n do
+    parts[#parts + 1] = tostring(t[i])
+  end
+  print(#t, table.concat(parts, " "))
+end
+
+local t = {}
+for i = 1, 5 do
+  table.insert(t, i * 10)
+end
+dump(t, 5)
+table.insert(t, 1, 5)
+dump(t, 6)
+table.insert(t, 4, 25)
+dump(t, 7)
+table.insert(t, 8, 60)
+dump(t, 8)
+print(table.remove(t))
+dump(t, 7)
+print(table.remove(t, 1))
+dump(t, 6)
+print(table.remove(t, 3))
+dump(t, 5)
+print(table.remove(t, 10))
+print(select('#', table.remove(t, 10)))
+print(select('#', table.remove({})))
+
+local s = { "a", "b", "c" }
+table.insert(s, 2, "x")
+dump(s, 4)
+table.insert(s, 2, 1.5)
+dump(s, 5)
+print(table.remove(s, 1), table.remove(s, 1))
+dump(s, 3)
+
+-- Holes and sparse keys go through the generic path
+--
+local h = { 1, 2, 3 }
+h[2.5] = "f"
+table.insert(h, 2, 9)
+print(h[1], h[2], h[3], h[4], h[2.5])
+print(table.remove(h, 1), #h, h[1], h[2.5])
+local sp = {}
+sp[100] = "x"
+table.insert(sp, 50, "y")
+print(sp[50], sp[100])
+print(table.remove(sp, 1))
+
+-- Large arrays
+--
+local big = {}
+for i = 1, 1000 do
+  table.insert(big, i)
+end
+for i = 1, 500 do
+  table.insert(big, 1, -i)
+end
+local sum = 0
+for i = 1, #big do
+  sum = sum + big[i]
+end
+print(#big, big[1], big[500], big[501], big[1500], sum)
+while #big > 0 do
+  table.remove(big, 1)
+end
+print(#big, big[1])
+
+print(table.maxn({}))
+print(table.maxn({ 1, 2, 3 }))
+print(table.maxn({ 1, 2, nil, 4 }))
+local m = { 1, 2 }
+m[100] = 1
+m[2.5] = 1
+m[-7] = 1
+m.x = 1
+print(table.maxn(m))
+print(table.maxn({ [1.5] = true }))
+
+print((pcall(table.insert, {}, 1, 2, 3)))
+print((pcall(table.insert, 1, 2)))
+print((pcall(table.insert, {}, "x", 2)))
+print((pcall(table.remove, nil)))
+print((pcall(table.maxn, 1)))
@@ -0,0 +1,100 @@
+-- A deterministic pseudo-random generator, so the output does not depend on math.random
+--
+local seed = 12345
+local function rand(n)
+  seed = (seed * 16807) % 2147483647
+  return seed % n
+end
+
+local function isSorted(t, n)
+  for i = 2, n do
+    if t[i] < t[i - 1] then
+      return false
+    end
+  end
+  return true
+end
+
+local function sum(t, n)
+  local s = 0
+  for i = 1, n do
+    s = s + t[i]
+  end
+  return s
+end
+
+-- Numbers, large enough for the radix sort
+--
+local t = {}
+for i = 1, 5000 do
+  t[i] = rand(100000) - 50000 + rand(4) * 0.25
+end
+local before = sum(t, 5000)
+table.sort(t)
+print(#t, isSorted(t, 5000), sum(t, 5000) == before)
+
+local special = { 3, -1.5, 1/0, -1/0, 0, -2^53, 2^53, 1e-300, -1e-300, 7 }
+for i = 11, 300 do
+  special[i] = (i % 17) - 8
+end
+table.sort(special)
+print(special[1], special[2], special[300], special[299], isSorted(special, 300))
+
+-- Small arrays use the comparison sort
+--
+local small = { 5, 3, 9, 1, 7 }
+table.sort(small)
+print(table.concat(small, " "))
+
+-- Strings with long common prefixes and embedded zeros
+--
+local words = {}
+for i = 1, 1000 do
+  words[i] = "common_prefix_" .. string.char(97 + rand(26), 97 + rand(26)) .. rand(100)
+end
+words[1001] = "common_prefix_"
+words[1002] = "common"
+words[1003] = "common\0"
+words[1004] = "c"
+words[1005] = ""
+table.sort(words)
+print(words[1] == "", words[2], words[3] == "common", words[4] == "common\0", words[5], isSorted(words, 1005))
+
+local short = { "b", "ab", "a", "abc", "ba", "aa" }
+table.sort(short)
+print(table.concat(short, " "))
+
+-- A non-continuous array: the sparse key makes the array non-continuous, but [1, n] is still in the vector storage
+--
+local nc = {}
+for i = 1, 1000 do
+  nc[i] = rand(1000)
+end
+nc[1.5] = "x"
+table.sort(nc)
+print(#nc, isSorted(nc, 1000), nc[1.5])
+
+local ncs = { "d", "b", "c", "a" }
+ncs[0.5] = true
+table.sort(ncs)
+print(table.concat(ncs, " "), ncs[0.5])
+
+-- Elements filled from the back end up outside the vector storage
+--
+local back = {}
+for i = 600, 1, -1 do
+  back[i] = 601 - i
+end
+table.sort(back)
+print(#back, back[1], back[600], isSorted(back, 600))
+
+local backs = {}
+for i = 30, 1, -1 do
+  backs[i] = tostring(131 - i)
+end
+table.sort(backs)
+print(backs[1], backs[30], isSorted(backs, 30))
+
+-- Mixed values fall back to the generic sort
+--
+print((pcall(table.sort, { 1, "x", 2 })))
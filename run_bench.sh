@@ -55,6 +55,52 @@ run_bench() {
 	run_bench_once ./luajitr $FILE_PATH $@
 }
 
+# Same as run_bench, but with the JIT memory in W^X (dual-mapped) mode
+#
+run_bench_wx() {
+	echo "### wx-$1" >> benchmark.log
+	echo "Benchmark (W^X JIT memory): $@"
+	FILE_PATH="luabench/$1"
+	shift
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+	run_bench_once env LJR_JIT_WX=1 ./luajitr $FILE_PATH $@
+}
+
+# Time only the baseline JIT codegen of all the functions in a script, without running it (see --bench-baseline-jit-codegen).
+# This is run both with the default RWX JIT memory and with the W^X (dual-mapped) JIT memory, to measure the codegen cost of W^X mode.
+#
+run_codegen_bench_once() {
+	T=`taskset -c $TASKSET_PIN_CPU_CORE $@ 2> /dev/null`
+	RET_CODE=$?
+	if [ $RET_CODE -ne 0 ]; then
+		echo "[ERROR] Benchmark failed with return code ${RET_CODE}!"
+		echo "Benchmark command: $@"
+		echo "Exiting..."
+		exit
+	fi
+	echo $T >> benchmark.log
+	echo $T
+	sleep 3
+}
+
+run_codegen_bench() {
+	echo "### codegen-$1" >> benchmark.log
+	echo "Benchmark (baseline JIT codegen only): $@"
+	for i in 1 2 3 4 5 6 7; do
+		run_codegen_bench_once ./luajitr --bench-baseline-jit-codegen luabench/$1 $2
+	done
+	echo "### codegen-wx-$1" >> benchmark.log
+	echo "Benchmark (baseline JIT codegen only, W^X JIT memory): $@"
+	for i in 1 2 3 4 5 6 7; do
+		run_codegen_bench_once env LJR_JIT_WX=1 ./luajitr --bench-baseline-jit-codegen luabench/$1 $2
+	done
+}
+
 echo -n > benchmark.log
 
 run_bench array3d.lua 300 packed
@@ -63,12 +109,17 @@ run_bench binary-trees-name.lua 15
 run_bench bounce.lua 3000
 run_bench cd.lua
 run_bench chameneos.lua 1e7
+run_bench coroutine-churn.lua 5e6
 run_bench coroutine-ring.lua 2e7
 run_bench deltablue.lua
 run_bench fannkuch.lua 11
 run_bench fasta.lua 5e6
 run_bench fixpoint-fact.lua 1000
 run_bench havlak.lua
+run_bench jit-compile.lua 20000
+run_bench_wx jit-compile.lua 20000
+run_codegen_bench deltablue.lua 2000
+run_codegen_bench havlak.lua 2000
 run_bench heapsort.lua 1 3000000
 run_bench json.lua
 run_bench k-nucleotide.lua 5e6
@@ -0,0 +1,708 @@
+#include "bytecode_serializer.h"
+#include "vm.h"
+#include "bytecode_builder.h"
+
+enum class BinaryChunkConstantKind : uint8_t
+{
+    // A nil, boolean or number, stored as the raw TValue
+    //
+    RawValue,
+    String,
+    // An UnlinkedCodeBlock used by NewClosure, stored as the ordinal of the UnlinkedCodeBlock in the chunk
+    //
+    Function,
+    // A template table used by TableDup
+    //
+    TemplateTable
+};
+
+class BinaryChunkWriter
+{
+public:
+    template<typename T>
+    void Write(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* data, size_t length)
+    {
+        m_buf.append(reinterpret_cast<const char*>(data), length);
+    }
+
+    const std::string& GetBuffer() { return m_buf; }
+
+private:
+    std::string m_buf;
+};
+
+class BinaryChunkReader
+{
+public:
+    BinaryChunkReader(const uint8_t* data, size_t length)
+        : m_cur(data)
+        , m_end(data + length)
+        , m_failed(false)
+    { }
+
+    // Once the chunk turns out to be truncated, all further reads return zero
+    //
+    template<typename T>
+    T WARN_UNUSED Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T result;
+        const uint8_t* src = ReadBytes(sizeof(T));
+        if (src == nullptr)
+        {
+            memset(&result, 0, sizeof(T));
+        }
+        else
+        {
+            memcpy(&result, src, sizeof(T));
+        }
+        return result;
+    }
+
+    const uint8_t* WARN_UNUSED ReadBytes(size_t length)
+    {
+        if (m_failed || static_cast<size_t>(m_end - m_cur) < length)
+        {
+            m_failed = true;
+            return nullptr;
+        }
+        const uint8_t* result = m_cur;
+        m_cur += length;
+        return result;
+    }
+
+    bool IsFailed() { return m_failed; }
+    bool IsAtEnd() { return m_cur == m_end; }
+
+private:
+    const uint8_t* m_cur;
+    const uint8_t* m_end;
+    bool m_failed;
+};
+
+static constexpr uint32_t x_binaryChunkNoParent = static_cast<uint32_t>(-1);
+
+// Fingerprint of everything decided at build time that a binary chunk depends on: the deegen-generated bytecode layout,
+// the bytecode metadata struct layout, and the build flavor.
+// Unlike the git commit hash, this tells apart builds from different dirty trees, and still accepts chunks across
+// commits that did not change the bytecode.
+//
+static uint64_t WARN_UNUSED ComputeBinaryChunkBuildFingerprint()
+{
+    BinaryChunkWriter w;
+    w.Write<uint64_t>(DeegenBytecodeBuilder::BytecodeBuilder::GetBytecodeLayoutFingerprint());
+    w.Write<uint32_t>(static_cast<uint32_t>(x_num_bytecode_metadata_struct_kinds));
+    for (size_t i = 0; i < x_num_bytecode_metadata_struct_kinds; i++)
+    {
+        w.Write<uint32_t>(x_bytecode_metadata_struct_size_list[i]);
+        w.Write<uint32_t>(x_bytecode_metadata_struct_log_2_alignment_list[i]);
+    }
+    w.Write<uint32_t>(static_cast<uint32_t>(CodeBlock::GetTrailingArrayOffset()));
+    w.Write<uint8_t>(x_isTestBuild);
+    w.Write<uint8_t>(x_isDebugBuild);
+    return HashString(w.GetBuffer().data(), w.GetBuffer().length());
+}
+
+static void WriteBinaryChunkHeader(BinaryChunkWriter& w)
+{
+    w.WriteBytes(x_binaryChunkSignature, sizeof(x_binaryChunkSignature));
+    w.Write<uint32_t>(x_binaryChunkFormatVersion);
+    w.Write<uint64_t>(ComputeBinaryChunkBuildFingerprint());
+}
+
+static bool WARN_UNUSED CheckBinaryChunkHeader(BinaryChunkReader& r)
+{
+    const uint8_t* signature = r.ReadBytes(sizeof(x_binaryChunkSignature));
+    if (signature == nullptr || memcmp(signature, x_binaryChunkSignature, sizeof(x_binaryChunkSignature)) != 0)
+    {
+        return false;
+    }
+    if (r.Read<uint32_t>() != x_binaryChunkFormatVersion)
+    {
+        return false;
+    }
+    if (r.Read<uint64_t>() != ComputeBinaryChunkBuildFingerprint())
+    {
+        return false;
+    }
+    return !r.IsFailed();
+}
+
+// Collect 'ucb' and all functions nested in it in topological order (children first)
+//
+static void CollectUnlinkedCodeBlockTree(UnlinkedCodeBlock* ucb,
+                                         std::vector<UnlinkedCodeBlock*>& ucbList /*inout*/,
+                                         std::unordered_map<UnlinkedCodeBlock*, uint32_t>& ucbOrdMap /*inout*/)
+{
+    // The child UnlinkedCodeBlocks are only referenced by the NewClosure bytecodes, as raw pointers disguised as TValues
+    // in the constant table, so we have to decode the bytecode stream to find them.
+    //
+    CodeBlock* cb = ucb->m_defaultCodeBlock;
+    assert(cb != nullptr && cb->m_owner == ucb);
+    DeegenBytecodeBuilder::BytecodeDecoder decoder(cb);
+    size_t curPos = 0;
+    size_t endPos = cb->GetBytecodeLength();
+    while (curPos < endPos)
+    {
+        if (decoder.IsBytecodeIntrinsic<BytecodeIntrinsicInfo::CreateClosure>(curPos))
+        {
+            BytecodeIntrinsicInfo::CreateClosure info = decoder.GetBytecodeIntrinsicInfo<BytecodeIntrinsicInfo::CreateClosure>(curPos);
+            TestAssert(info.proto.IsConstant());
+            UnlinkedCodeBlock* childUcb = reinterpret_cast<UnlinkedCodeBlock*>(info.proto.AsConstant().m_value);
+            assert(childUcb != nullptr && childUcb->m_parent == ucb);
+            if (!ucbOrdMap.count(childUcb))
+            {
+                CollectUnlinkedCodeBlockTree(childUcb, ucbList /*inout*/, ucbOrdMap /*inout*/);
+            }
+        }
+        curPos = decoder.GetNextBytecodePosition(curPos);
+    }
+    assert(curPos == endPos);
+
+    assert(!ucbOrdMap.count(ucb));
+    ucbOrdMap[ucb] = static_cast<uint32_t>(ucbList.size());
+    ucbList.push_back(ucb);
+}
+
+// Write a constant that is not a function prototype or a table: nil, boolean, number or string
+//
+static bool WARN_UNUSED WriteScalarConstant(BinaryChunkWriter& w, TValue tv)
+{
+    if (tv.Is<tString>())
+    {
+        HeapString* s = TranslateToRawPointer(tv.As<tString>());
+        w.Write(BinaryChunkConstantKind::String);
+        w.Write<uint32_t>(s->m_length);
+        w.WriteBytes(s->m_string, s->m_length);
+        return true;
+    }
+    if (tv.IsPointer())
+    {
+        return false;
+    }
+    w.Write(BinaryChunkConstantKind::RawValue);
+    w.Write<uint64_t>(tv.m_value);
+    return true;
+}
+
+// Read the payload of a scalar constant, whose kind has already been read
+//
+static bool WARN_UNUSED ReadScalarConstantPayload(VM* vm, BinaryChunkReader& r, BinaryChunkConstantKind kind, TValue& result /*out*/)
+{
+    if (kind == BinaryChunkConstantKind::String)
+    {
+        uint32_t len = r.Read<uint32_t>();
+        const uint8_t* data = r.ReadBytes(len);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        result = TValue::Create<tString>(vm->CreateStringObjectFromRawString(data, len).As());
+        return true;
+    }
+    if (kind == BinaryChunkConstantKind::RawValue)
+    {
+        result.m_value = r.Read<uint64_t>();
+        // Do not let a binary chunk forge a heap pointer
+        //
+        return !r.IsFailed() && !result.IsPointer();
+    }
+    return false;
+}
+
+static bool WARN_UNUSED ReadScalarConstant(VM* vm, BinaryChunkReader& r, TValue& result /*out*/)
+{
+    BinaryChunkConstantKind kind = r.Read<BinaryChunkConstantKind>();
+    return ReadScalarConstantPayload(vm, r, kind, result /*out*/);
+}
+
+// A template table is stored as the recipe to re-create it the same way the parser did: create an empty table with
+// the same inline capacity and array part capacity, put the named properties in slot order, then put the indexed entries.
+// This reproduces the hidden class and butterfly shape, which the specialized TableDup variants chosen by the parser rely on.
+//
+// Note that for a table in Structure mode, a named property may be nil: the parser pre-inserts the keys that are only assigned
+// at runtime, so the slot exists in the Structure. So we walk the Structure slots instead of using the table iterator.
+//
+static bool WARN_UNUSED WriteTemplateTable(BinaryChunkWriter& w, HeapPtr<TableObject> tab)
+{
+    std::vector<std::pair<UserHeapPointer<void>, TValue>> namedProps;
+    std::vector<std::pair<double, TValue>> indexedProps;
+
+    HeapEntityType hcType = TCGet(tab->m_hiddenClass).As<SystemHeapGcObjectHeader>()->m_type;
+    uint32_t inlineCapacity;
+    if (hcType == HeapEntityType::Structure)
+    {
+        HeapPtr<Structure> structure = TCGet(tab->m_hiddenClass).As<Structure>();
+        inlineCapacity = structure->m_inlineNamedStorageCapacity;
+        for (uint32_t slot = 0; slot < structure->m_numSlots; slot++)
+        {
+            // A template table never has a metatable
+            //
+            if (Structure::IsSlotUsedByPolyMetatable(structure, slot))
+            {
+                return false;
+            }
+            UserHeapPointer<void> key = Structure::GetKeyForSlotOrdinal(structure, static_cast<uint8_t>(slot));
+            TValue value = TableObject::GetValueForSlot(tab, slot, structure->m_inlineNamedStorageCapacity);
+            namedProps.push_back(std::make_pair(key, value));
+        }
+    }
+    else if (hcType == HeapEntityType::CacheableDictionary)
+    {
+        inlineCapacity = TCGet(tab->m_hiddenClass).As<CacheableDictionary>()->m_inlineNamedStorageCapacity;
+    }
+    else
+    {
+        assert(hcType == HeapEntityType::UncacheableDictionary);
+        inlineCapacity = TCGet(tab->m_hiddenClass).As<UncacheableDictionary>()->m_inlineNamedStorageCapacity;
+    }
+
+    TableObjectIterator iter;
+    while (true)
+    {
+        TableObjectIterator::KeyValuePair kv = iter.Advance(tab);
+        if (kv.m_key.IsNil())
+        {
+            break;
+        }
+        if (kv.m_key.Is<tDouble>())
+        {
+            indexedProps.push_back(std::make_pair(kv.m_key.As<tDouble>(), kv.m_value));
+        }
+        else if (hcType != HeapEntityType::Structure)
+        {
+            UserHeapPointer<void> key;
+            if (kv.m_key.Is<tBool>())
+            {
+                key = VM_GetSpecialKeyForBoolean(kv.m_key.As<tBool>()).As<void>();
+            }
+            else
+            {
+                key = kv.m_key.AsPointer();
+            }
+            namedProps.push_back(std::make_pair(key, kv.m_value));
+        }
+    }
+
+    // Like the parser, put the non-integer keys first, then the integer keys in ascending order, to get a continuous array if possible
+    //
+    std::stable_sort(indexedProps.begin(), indexedProps.end(),
+                     [](const std::pair<double, TValue>& lhs, const std::pair<double, TValue>& rhs) -> bool
+                     {
+                         int64_t unused;
+                         bool lhsIsInt = TableObject::IsInt64Index(lhs.first, unused /*out*/);
+                         bool rhsIsInt = TableObject::IsInt64Index(rhs.first, unused /*out*/);
+                         if (lhsIsInt != rhsIsInt)
+                         {
+                             return rhsIsInt;
+                         }
+                         return lhsIsInt && lhs.first < rhs.first;
+                     });
+
+    uint32_t arrayCapacity = 0;
+    if (tab->m_butterfly != nullptr)
+    {
+        arrayCapacity = tab->m_butterfly->GetHeader()->m_arrayStorageCapacity;
+    }
+
+    w.Write(BinaryChunkConstantKind::TemplateTable);
+    w.Write<uint32_t>(inlineCapacity);
+    w.Write<uint32_t>(arrayCapacity);
+
+    w.Write<uint32_t>(static_cast<uint32_t>(namedProps.size()));
+    for (auto& it : namedProps)
+    {
+        UserHeapPointer<void> key = it.first;
+        if (key == VM_GetSpecialKeyForBoolean(false).As<void>() || key == VM_GetSpecialKeyForBoolean(true).As<void>())
+        {
+            bool boolKey = (key == VM_GetSpecialKeyForBoolean(true).As<void>());
+            w.Write(BinaryChunkConstantKind::RawValue);
+            w.Write<uint64_t>(TValue::Create<tBool>(boolKey).m_value);
+        }
+        else
+        {
+            TValue tvKey = TValue::CreatePointer(key);
+            if (!tvKey.Is<tString>())
+            {
+                return false;
+            }
+            if (!WriteScalarConstant(w, tvKey))
+            {
+                return false;
+            }
+        }
+        if (!WriteScalarConstant(w, it.second))
+        {
+            return false;
+        }
+    }
+
+    w.Write<uint32_t>(static_cast<uint32_t>(indexedProps.size()));
+    for (auto& it : indexedProps)
+    {
+        w.Write<double>(it.first);
+        if (!WriteScalarConstant(w, it.second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool WARN_UNUSED ReadTemplateTable(VM* vm, BinaryChunkReader& r, TValue& result /*out*/)
+{
+    uint32_t inlineCapacity = r.Read<uint32_t>();
+    uint32_t arrayCapacity = r.Read<uint32_t>();
+    if (r.IsFailed())
+    {
+        return false;
+    }
+
+    // TODO: we need to anchor this table
+    //
+    HeapPtr<TableObject> tab = TableObject::CreateEmptyTableObject(vm, inlineCapacity, arrayCapacity);
+
+    uint32_t numNamedProps = r.Read<uint32_t>();
+    for (uint32_t i = 0; i < numNamedProps; i++)
+    {
+        TValue key, value;
+        if (!ReadScalarConstant(vm, r, key /*out*/) || !ReadScalarConstant(vm, r, value /*out*/))
+        {
+            return false;
+        }
+        UserHeapPointer<void> propName;
+        if (key.Is<tBool>())
+        {
+            propName = VM_GetSpecialKeyForBoolean(key.As<tBool>()).As<void>();
+        }
+        else if (key.Is<tString>())
+        {
+            propName = key.AsPointer();
+        }
+        else
+        {
+            return false;
+        }
+        PutByIdICInfo icInfo;
+        TableObject::PreparePutById(tab, propName, icInfo /*out*/);
+        TableObject::PutById(tab, propName, value, icInfo);
+    }
+
+    uint32_t numIndexedProps = r.Read<uint32_t>();
+    for (uint32_t i = 0; i < numIndexedProps; i++)
+    {
+        double key = r.Read<double>();
+        TValue value;
+        if (!ReadScalarConstant(vm, r, value /*out*/) || IsNaN(key))
+        {
+            return false;
+        }
+        TableObject::RawPutByValDoubleIndex(tab, key, value);
+    }
+
+    if (r.IsFailed())
+    {
+        return false;
+    }
+    result = TValue::Create<tTable>(tab);
+    return true;
+}
+
+static bool WARN_UNUSED WriteUnlinkedCodeBlock(BinaryChunkWriter& w,
+                                               UnlinkedCodeBlock* ucb,
+                                               uint32_t parentOrd,
+                                               std::unordered_map<UnlinkedCodeBlock*, uint32_t>& ucbOrdMap)
+{
+    assert(ucb->m_uvFixUpCompleted && ucb->m_bytecodeBuilder == nullptr);
+
+    w.Write<uint32_t>(parentOrd);
+    w.Write<uint8_t>(ucb->m_hasVariadicArguments);
+    w.Write<uint32_t>(ucb->m_numFixedArguments);
+    w.Write<uint32_t>(ucb->m_stackFrameNumSlots);
+
+    w.Write<uint32_t>(ucb->m_numUpvalues);
+    for (uint32_t i = 0; i < ucb->m_numUpvalues; i++)
+    {
+        UpvalueMetadata& uv = ucb->m_upvalueInfo[i];
+        assert(uv.m_immutabilityFieldFinalized);
+        w.Write<uint8_t>(uv.m_isParentLocal);
+        w.Write<uint8_t>(uv.m_isImmutable);
+        w.Write<uint32_t>(uv.m_slot);
+    }
+
+    w.Write<uint32_t>(ucb->m_bytecodeLengthIncludingTailPadding);
+    w.WriteBytes(ucb->m_bytecode, ucb->m_bytecodeLengthIncludingTailPadding);
+
+    w.Write<uint32_t>(ucb->m_bytecodeMetadataLength);
+    w.WriteBytes(ucb->m_bytecodeMetadataUseCounts, sizeof(uint16_t) * x_num_bytecode_metadata_struct_kinds_);
+
+    w.Write<uint32_t>(ucb->m_cstTableLength);
+    for (uint32_t i = 0; i < ucb->m_cstTableLength; i++)
+    {
+        TValue tv; tv.m_value = ucb->m_cstTable[i];
+        auto it = ucbOrdMap.find(reinterpret_cast<UnlinkedCodeBlock*>(tv.m_value));
+        if (it != ucbOrdMap.end() && it->first->m_parent == ucb)
+        {
+            w.Write(BinaryChunkConstantKind::Function);
+            w.Write<uint32_t>(it->second);
+        }
+        else if (tv.Is<tTable>())
+        {
+            if (!WriteTemplateTable(w, tv.As<tTable>()))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (!WriteScalarConstant(w, tv))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Returns nullptr if the chunk is malformed
+//
+static UnlinkedCodeBlock* WARN_UNUSED ReadUnlinkedCodeBlock(VM* vm,
+                                                            BinaryChunkReader& r,
+                                                            HeapPtr<TableObject> globalObject,
+                                                            uint32_t ucbOrd,
+                                                            const std::vector<UnlinkedCodeBlock*>& ucbList,
+                                                            const std::vector<uint32_t>& parentOrdList,
+                                                            uint32_t& parentOrd /*out*/)
+{
+    UnlinkedCodeBlock* ucb = UnlinkedCodeBlock::Create(vm, globalObject);
+    ucb->m_bytecodeBuilder = nullptr;
+
+    bool success = false;
+    Auto(if (!success) ucb->Free(vm));
+
+    parentOrd = r.Read<uint32_t>();
+    ucb->m_hasVariadicArguments = r.Read<uint8_t>();
+    ucb->m_numFixedArguments = r.Read<uint32_t>();
+    ucb->m_stackFrameNumSlots = r.Read<uint32_t>();
+
+    uint32_t numUpvalues = r.Read<uint32_t>();
+    if (r.IsFailed() || numUpvalues > std::numeric_limits<uint8_t>::max())
+    {
+        return nullptr;
+    }
+    ucb->m_numUpvalues = numUpvalues;
+    ucb->m_upvalueInfo = new UpvalueMetadata[numUpvalues];
+    for (uint32_t i = 0; i < numUpvalues; i++)
+    {
+        UpvalueMetadata& uv = ucb->m_upvalueInfo[i];
+        DEBUG_ONLY(uv.m_immutabilityFieldFinalized = true;)
+        uv.m_isParentLocal = r.Read<uint8_t>();
+        uv.m_isImmutable = r.Read<uint8_t>();
+        uv.m_slot = r.Read<uint32_t>();
+    }
+
+    uint32_t bytecodeLength = r.Read<uint32_t>();
+    const uint8_t* bytecode = r.ReadBytes(bytecodeLength);
+    if (bytecode == nullptr || bytecodeLength < x_numExtraPaddingAtBytecodeStreamEnd)
+    {
+        return nullptr;
+    }
+    ucb->m_bytecode = new uint8_t[bytecodeLength];
+    memcpy(ucb->m_bytecode, bytecode, bytecodeLength);
+    ucb->m_bytecodeLengthIncludingTailPadding = bytecodeLength;
+
+    ucb->m_bytecodeMetadataLength = r.Read<uint32_t>();
+    const uint8_t* useCounts = r.ReadBytes(sizeof(uint16_t) * x_num_bytecode_metadata_struct_kinds_);
+    if (useCounts == nullptr || ucb->m_bytecodeMetadataLength % 8 != 0)
+    {
+        return nullptr;
+    }
+    memcpy(ucb->m_bytecodeMetadataUseCounts, useCounts, sizeof(uint16_t) * x_num_bytecode_metadata_struct_kinds_);
+
+    uint32_t cstTableLength = r.Read<uint32_t>();
+    if (r.IsFailed() || cstTableLength >= 0x7fff)
+    {
+        return nullptr;
+    }
+    ucb->m_cstTableLength = cstTableLength;
+    ucb->m_cstTable = new uint64_t[cstTableLength];
+    for (uint32_t i = 0; i < cstTableLength; i++)
+    {
+        TValue tv;
+        BinaryChunkConstantKind kind = r.Read<BinaryChunkConstantKind>();
+        if (kind == BinaryChunkConstantKind::Function)
+        {
+            // The children always come before the parent
+            //
+            uint32_t childOrd = r.Read<uint32_t>();
+            if (r.IsFailed() || childOrd >= ucbOrd || parentOrdList[childOrd] != ucbOrd)
+            {
+                return nullptr;
+            }
+            tv.m_value = reinterpret_cast<uint64_t>(ucbList[childOrd]);
+        }
+        else if (kind == BinaryChunkConstantKind::TemplateTable)
+        {
+            if (!ReadTemplateTable(vm, r, tv /*out*/))
+            {
+                return nullptr;
+            }
+        }
+        else
+        {
+            if (!ReadScalarConstantPayload(vm, r, kind, tv /*out*/))
+            {
+                return nullptr;
+            }
+        }
+        ucb->m_cstTable[i] = tv.m_value;
+    }
+
+    if (r.IsFailed())
+    {
+        return nullptr;
+    }
+    success = true;
+    return ucb;
+}
+
+static ParseResult WARN_UNUSED MakeBinaryChunkLoadError(VM* vm, const char* msg)
+{
+    return {
+        .m_scriptModule = nullptr,
+        .errMsg = TValue::Create<tString>(vm->CreateStringObjectFromRawCString(msg))
+    };
+}
+
+bool WARN_UNUSED TryDumpUnlinkedCodeBlockTree(VM* vm, UnlinkedCodeBlock* ucb, HeapPtr<HeapString>& result /*out*/)
+{
+    // The dumped function becomes the entry point of the loaded chunk, which has no way to bind upvalues
+    //
+    if (ucb->m_numUpvalues > 0)
+    {
+        return false;
+    }
+
+    std::vector<UnlinkedCodeBlock*> ucbList;
+    std::unordered_map<UnlinkedCodeBlock*, uint32_t> ucbOrdMap;
+    CollectUnlinkedCodeBlockTree(ucb, ucbList /*inout*/, ucbOrdMap /*inout*/);
+    assert(ucbList.size() > 0 && ucbList.back() == ucb);
+
+    BinaryChunkWriter w;
+    WriteBinaryChunkHeader(w);
+    w.Write<uint32_t>(static_cast<uint32_t>(ucbList.size()));
+    for (UnlinkedCodeBlock* u : ucbList)
+    {
+        uint32_t parentOrd = x_binaryChunkNoParent;
+        if (u != ucb)
+        {
+            assert(ucbOrdMap.count(u->m_parent) && ucbOrdMap[u->m_parent] > ucbOrdMap[u]);
+            parentOrd = ucbOrdMap[u->m_parent];
+        }
+        if (!WriteUnlinkedCodeBlock(w, u, parentOrd, ucbOrdMap))
+        {
+            return false;
+        }
+    }
+
+    const std::string& buf = w.GetBuffer();
+    if (buf.length() > std::numeric_limits<uint32_t>::max())
+    {
+        return false;
+    }
+    result = vm->CreateStringObjectFromRawString(buf.data(), static_cast<uint32_t>(buf.length())).As();
+    return true;
+}
+
+ParseResult WARN_UNUSED LoadBinaryChunk(CoroutineRuntimeContext* coroCtx, const uint8_t* data, size_t length)
+{
+    VM* vm = VM::GetActiveVMForCurrentThread();
+    BinaryChunkReader r(data, length);
+    if (!CheckBinaryChunkHeader(r))
+    {
+        return MakeBinaryChunkLoadError(vm, "bad header in precompiled chunk (it is either corrupted, or produced by a different build of the engine)");
+    }
+
+    uint32_t numUcbs = r.Read<uint32_t>();
+    if (r.IsFailed() || numUcbs == 0)
+    {
+        return MakeBinaryChunkLoadError(vm, "truncated precompiled chunk");
+    }
+
+    // TableNew bytecodes expect the initial Structure for their inline capacity stepping to have been created by the parser.
+    // We don't know which steppings are used without decoding all the bytecodes, so simply create all of them, there are only a few.
+    //
+    for (size_t stepping = 0; stepping < x_numInlineCapacitySteppings; stepping++)
+    {
+        std::ignore = Structure::GetInitialStructureForStepping(vm, static_cast<uint8_t>(stepping));
+    }
+
+    // On failure, free all the UnlinkedCodeBlocks read so far. Nothing else refers to them yet.
+    //
+    std::vector<UnlinkedCodeBlock*> ucbList;
+    bool success = false;
+    Auto(
+        if (!success)
+        {
+            for (UnlinkedCodeBlock* ucb : ucbList)
+            {
+                ucb->Free(vm);
+            }
+        }
+    );
+
+    std::vector<uint32_t> parentOrdList;
+    for (uint32_t ucbOrd = 0; ucbOrd < numUcbs; ucbOrd++)
+    {
+        uint32_t parentOrd;
+        UnlinkedCodeBlock* ucb = ReadUnlinkedCodeBlock(vm, r, coroCtx->m_globalObject.As(), ucbOrd, ucbList, parentOrdList, parentOrd /*out*/);
+        if (ucb == nullptr)
+        {
+            return MakeBinaryChunkLoadError(vm, "bad or truncated precompiled chunk");
+        }
+        bool isRoot = (ucbOrd == numUcbs - 1);
+        if (isRoot ? (parentOrd != x_binaryChunkNoParent || ucb->m_numUpvalues > 0) : (parentOrd <= ucbOrd || parentOrd >= numUcbs))
+        {
+            ucb->Free(vm);
+            return MakeBinaryChunkLoadError(vm, "bad or truncated precompiled chunk");
+        }
+        ucbList.push_back(ucb);
+        parentOrdList.push_back(parentOrd);
+    }
+    if (!r.IsAtEnd())
+    {
+        return MakeBinaryChunkLoadError(vm, "bad or truncated precompiled chunk");
+    }
+    success = true;
+
+    std::unique_ptr<ScriptModule> module = std::make_unique<ScriptModule>();
+    module->m_defaultGlobalObject = coroCtx->m_globalObject;
+    for (uint32_t ucbOrd = 0; ucbOrd < numUcbs; ucbOrd++)
+    {
+        UnlinkedCodeBlock* ucb = ucbList[ucbOrd];
+        uint32_t parentOrd = parentOrdList[ucbOrd];
+        ucb->m_parent = (parentOrd == x_binaryChunkNoParent) ? nullptr : ucbList[parentOrd];
+        ucb->m_uvFixUpCompleted = true;
+    }
+    // CodeBlock::Create may compile the function right away, so only do it after all the UnlinkedCodeBlocks are set up
+    //
+    for (UnlinkedCodeBlock* ucb : ucbList)
+    {
+        ucb->m_defaultCodeBlock = CodeBlock::Create(vm, ucb, coroCtx->m_globalObject);
+    }
+    module->m_unlinkedCodeBlocks = std::move(ucbList);
+
+    UnlinkedCodeBlock* chunkFn = module->m_unlinkedCodeBlocks.back();
+    UserHeapPointer<FunctionObject> entryPointFunc = FunctionObject::Create(vm, chunkFn->GetCodeBlock(coroCtx->m_globalObject));
+    module->m_defaultEntryPoint = entryPointFunc;
+    return {
+        .m_scriptModule = std::move(module),
+        .errMsg = TValue::Create<tNil>()
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.h"
+#include "runtime_utils.h"
+#include "lj_parser_wrapper.h"
+
+// Binary chunks (the output of string.dump) hold a tree of UnlinkedCodeBlocks in our own bytecode format,
+// so loading one skips the lexer and parser entirely.
+//
+// Layout (all integers are native-endian):
+//     [ header ] [ u32 #UnlinkedCodeBlocks ] [ UnlinkedCodeBlock ] * N
+//
+// The header is the signature, the format version, and a u64 fingerprint of the engine build.
+// The bytecode stream is stored verbatim, and it is only meaningful to builds with the same bytecode layout
+// (opcode numbering, operand layout and bytecode metadata layout are all decided by deegen at build time),
+// so the fingerprint is a hash of those layouts and the build flavor, and a chunk produced by a build with
+// a different fingerprint is rejected instead of being misinterpreted.
+//
+// The UnlinkedCodeBlocks are stored in topological order: every function comes before its parent,
+// and the function passed to string.dump comes last. Each one stores:
+//     [ u32 parent ordinal ] [ u8 hasVariadicArguments ] [ u32 numFixedArguments ] [ u32 stackFrameNumSlots ]
+//     [ u32 #upvalues ] [ UpvalueMetadata ] * #upvalues
+//     [ u32 bytecode length ] [ bytecode ]
+//     [ u32 bytecode metadata length ] [ u16 bytecode metadata use count ] * x_num_bytecode_metadata_struct_kinds_
+//     [ u32 #constants ] [ constant ] * #constants
+//
+// Strings and TDUP template tables in the constant table are stored by content and re-created on load,
+// and the UnlinkedCodeBlock pointers used by NewClosure are stored as the ordinal of the child.
+//
+// Unlike Lua 5.1, which runs a bytecode verifier (luaG_checkcode) on every loaded function, the bytecode stream of a binary chunk
+// is not verified at all, so a maliciously crafted binary chunk can crash the VM. Only load binary chunks from trusted sources.
+// (Even in Lua 5.1 the verifier is known to be incomplete, and Lua 5.2 dropped it for that reason.)
+//
+constexpr uint8_t x_binaryChunkSignature[4] = { 0x1b, 'L', 'J', 'R' };
+constexpr uint32_t x_binaryChunkFormatVersion = 2;
+
+// Serialize the function defined by 'ucb' (and all functions nested in it) into a binary chunk.
+// Returns false if the function cannot be dumped (i.e., it has upvalues).
+//
+bool WARN_UNUSED TryDumpUnlinkedCodeBlockTree(VM* vm, UnlinkedCodeBlock* ucb, HeapPtr<HeapString>& result /*out*/);
+
+// Load a binary chunk produced by TryDumpUnlinkedCodeBlockTree
+// Similar to ParseLuaScript, the entry point is the function that was dumped
+//
+ParseResult WARN_UNUSED LoadBinaryChunk(CoroutineRuntimeContext* ctx, const uint8_t* data, size_t length);
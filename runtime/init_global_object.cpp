@@ -71,6 +71,17 @@
   , type                                \
   , write                               \
 
+// The methods of the file handles, e.g., f:read()
+//
+#define LUA_LIB_IO_FILE_METHOD_LIST     \
+    close                               \
+  , flush                               \
+  , lines                               \
+  , read                                \
+  , seek                                \
+  , setvbuf                             \
+  , write                               \
+
 #define LUA_LIB_MATH_FUNCTION_LIST      \
     abs                                 \
   , acos                                \
@@ -148,6 +159,7 @@ PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (base), (LUA_LIB_BASE_FUNCTION_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (coroutine), (LUA_LIB_COROUTINE_FUNCTION_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (debug), (LUA_LIB_DEBUG_FUNCTION_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (io), (LUA_LIB_IO_FUNCTION_LIST))
+PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (io_file), (LUA_LIB_IO_FILE_METHOD_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (math), (LUA_LIB_MATH_FUNCTION_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (os), (LUA_LIB_OS_FUNCTION_LIST))
 PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (package), (LUA_LIB_PACKAGE_FUNCTION_LIST))
@@ -163,6 +175,7 @@ PP_FOR_EACH_CARTESIAN_PRODUCT(macro, (table), (LUA_LIB_TABLE_FUNCTION_LIST))
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_coroutine = 0 PP_FOR_EACH(macro, LUA_LIB_COROUTINE_FUNCTION_LIST);
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_debug = 0 PP_FOR_EACH(macro, LUA_LIB_DEBUG_FUNCTION_LIST);
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_io = 0 PP_FOR_EACH(macro, LUA_LIB_IO_FUNCTION_LIST);
+[[maybe_unused]] constexpr uint32_t x_num_methods_in_lib_io_file = 0 PP_FOR_EACH(macro, LUA_LIB_IO_FILE_METHOD_LIST);
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_math = 0 PP_FOR_EACH(macro, LUA_LIB_MATH_FUNCTION_LIST);
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_os = 0 PP_FOR_EACH(macro, LUA_LIB_OS_FUNCTION_LIST);
 [[maybe_unused]] constexpr uint32_t x_num_functions_in_lib_package = 0 PP_FOR_EACH(macro, LUA_LIB_PACKAGE_FUNCTION_LIST);
@@ -214,6 +227,8 @@ struct CreateGlobalObjectHelper
 DEEGEN_FORWARD_DECLARE_LIB_FUNC(coroutine_wrap_call);
 DEEGEN_FORWARD_DECLARE_LIB_FUNC(base_ipairs_iterator);
 DEEGEN_FORWARD_DECLARE_LIB_FUNC(io_lines_iter);
+DEEGEN_FORWARD_DECLARE_LIB_FUNC(io_file_tostring);
+DEEGEN_FORWARD_DECLARE_LIB_FUNC(string_gmatch_iter);
 
 #define INSERT_LIBFN(libName, fnName)                                               \
     [[maybe_unused]] HeapPtr<FunctionObject> libfn_ ## libName ##_ ## fnName =      \
@@ -264,11 +279,38 @@ UserHeapPointer<TableObject> CreateGlobalObject(VM* vm)
 
     // Initialize io library
     // The io library has 3 non-function fields: stdin, stdout, stderr
-    // TODO: we need to implement these fields.
     //
     HeapPtr<TableObject> libobj_io = h.InsertObject(globalObject, "io", x_num_functions_in_lib_io + 3);
     PP_FOR_EACH_CARTESIAN_PRODUCT(INSERT_LIBFN, (io), (LUA_LIB_IO_FUNCTION_LIST))
 
+    vm->InitializeLibFnProto<VM::LibFnProto::IoFileLinesIter>(ExecutableCode::CreateCFunction(vm, DEEGEN_CODE_POINTER_FOR_LIB_FUNC(io_lines_iter)));
+
+    // As in the reference implementation, the metatable of the file handles holds the methods and has '__index' pointing to itself
+    // It has 2 non-method fields: __index and __tostring
+    //
+    {
+        HeapPtr<TableObject> libobj_io_file = TableObject::CreateEmptyTableObject(vm, x_num_methods_in_lib_io_file + 2 /*inlineCapacity*/, 0 /*initialButterflyArrayPartCapacity*/);
+        PP_FOR_EACH_CARTESIAN_PRODUCT(INSERT_LIBFN, (io_file), (LUA_LIB_IO_FILE_METHOD_LIST))
+        h.InsertField(libobj_io_file, "__index", TValue::Create<tTable>(libobj_io_file));
+        h.InsertCFunc(libobj_io_file, "__tostring", DEEGEN_CODE_POINTER_FOR_LIB_FUNC(io_file_tostring));
+        vm->m_metatableForFileHandle = libobj_io_file;
+    }
+
+    {
+        HeapPtr<HeapCDataObject> ioStdin = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Stdin, STDIN_FILENO);
+        HeapPtr<HeapCDataObject> ioStdout = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Stdout, STDOUT_FILENO);
+        HeapPtr<HeapCDataObject> ioStderr = LuaFileHandle::Create(vm, LuaFileHandle::Kind::Stderr, STDERR_FILENO);
+        h.InsertField(libobj_io, "stdin", TValue::Create<tUserdata>(ioStdin));
+        h.InsertField(libobj_io, "stdout", TValue::Create<tUserdata>(ioStdout));
+        h.InsertField(libobj_io, "stderr", TValue::Create<tUserdata>(ioStderr));
+        vm->m_ioDefaultInputFile = ioStdin;
+        vm->m_ioDefaultOutputFile = ioStdout;
+
+        HeapPtr<FunctionObject> stdinLinesIter = FunctionObject::CreateCFunc(vm, vm->GetLibFnProto<VM::LibFnProto::IoFileLinesIter>(), 1 /*numUpvalues*/).As();
+        TCSet(stdinLinesIter->m_upvalues[0], TValue::Create<tUserdata>(ioStdin));
+        vm->InitializeLibFn<VM::LibFn::IoLinesIter>(TValue::Create<tFunction>(stdinLinesIter));
+    }
+
     // Initialize math library
     // The math library has 2 non-function fields: huge and pi
     // Additionally, it has 1 field for compatibility: math.mod = math.fmod
@@ -298,16 +340,18 @@ UserHeapPointer<TableObject> CreateGlobalObject(VM* vm)
 
     // Initialize string library
     // The string library has no non-function fields
-    // Additionally, it has 1 field for compatibility: string.gfind = string.find
+    // Additionally, it has 1 field for compatibility: string.gfind = string.gmatch
     //
     constexpr bool x_enable_lua_compat_string_gfind = true;
     HeapPtr<TableObject> libobj_string = h.InsertObject(globalObject, "string", x_num_functions_in_lib_string + (x_enable_lua_compat_string_gfind ? 1 : 0));
     PP_FOR_EACH_CARTESIAN_PRODUCT(INSERT_LIBFN, (string), (LUA_LIB_STRING_FUNCTION_LIST))
     if (x_enable_lua_compat_string_gfind)
     {
-        h.InsertField(libobj_string, "gfind", TValue::Create<tFunction>(libfn_string_find));
+        h.InsertField(libobj_string, "gfind", TValue::Create<tFunction>(libfn_string_gmatch));
     }
 
+    vm->InitializeLibFnProto<VM::LibFnProto::StringGmatchIter>(ExecutableCode::CreateCFunction(vm, DEEGEN_CODE_POINTER_FOR_LIB_FUNC(string_gmatch_iter)));
+
     // According to Lua standard, we need to set a metatable for strings where the __index field points to the string table,
     // so that string functions can be used in object-oriented style, e.g., string.byte(s, i) can be written as s:byte(i).
     //
@@ -323,7 +367,6 @@ UserHeapPointer<TableObject> CreateGlobalObject(VM* vm)
     //
     HeapPtr<TableObject> libobj_table = h.InsertObject(globalObject, "table", x_num_functions_in_lib_table);
     PP_FOR_EACH_CARTESIAN_PRODUCT(INSERT_LIBFN, (table), (LUA_LIB_TABLE_FUNCTION_LIST))
-    vm->InitializeLibFn<VM::LibFn::IoLinesIter>(TValue::Create<tFunction>(h.CreateCFunc(DEEGEN_CODE_POINTER_FOR_LIB_FUNC(io_lines_iter))));
 
     return globalObject;
 }
@@ -74,6 +74,7 @@
 #include "lj_strfmt_details.h"
 
 #include "lj_parser_wrapper.h"
+#include "bytecode_serializer.h"
 #include "lj_parse_details.h"
 
 #include "vm.h"
@@ -689,6 +690,26 @@ ParseResult WARN_UNUSED ParseLuaScript(CoroutineRuntimeContext* coroCtx, lua_Rea
     {
         VM* vm = VM::GetActiveVMForCurrentThread();
         lj_lex_setup(coroCtx, &ls);
+        if (ls.c == x_binaryChunkSignature[0])
+        {
+            // This is a binary chunk produced by string.dump, no lexing or parsing needed.
+            // Gather the whole chunk, the reader may reuse its buffer between calls.
+            //
+            std::string chunk;
+            chunk.push_back(static_cast<char>(ls.c));
+            chunk.append(ls.p, ls.pe);
+            while (true)
+            {
+                size_t size;
+                const char* data = rd(coroCtx, ud, &size /*out*/);
+                if (data == nullptr || size == 0)
+                {
+                    break;
+                }
+                chunk.append(data, size);
+            }
+            return LoadBinaryChunk(coroCtx, reinterpret_cast<const uint8_t*>(chunk.data()), chunk.length());
+        }
         UnlinkedCodeBlock* chunkFn = lj_parse(&ls);
         std::unique_ptr<ScriptModule> module = std::make_unique<ScriptModule>();
         module->m_unlinkedCodeBlocks = std::move(ls.ucbList);
@@ -0,0 +1,810 @@
+#include "lualib_pattern_matcher.h"
+
+const char* WARN_UNUSED GetLuaPatternErrorMessage(LuaPatternError err)
+{
+    switch (err)
+    {
+    case LuaPatternError::NoError:
+        assert(false);
+        __builtin_unreachable();
+    case LuaPatternError::EndsWithPercent:
+        return "malformed pattern (ends with '%')";
+    case LuaPatternError::MissingBracket:
+        return "malformed pattern (missing ']')";
+    case LuaPatternError::MissingBracketAfterFrontier:
+        return "missing '[' after '%f' in pattern";
+    case LuaPatternError::UnbalancedPattern:
+        return "unbalanced pattern";
+    case LuaPatternError::TooManyCaptures:
+        return "too many captures";
+    case LuaPatternError::InvalidPatternCapture:
+        return "invalid pattern capture";
+    case LuaPatternError::InvalidCaptureIndex:
+        return "invalid capture index";
+    case LuaPatternError::UnfinishedCapture:
+        return "unfinished capture";
+    }   /* switch err */
+    __builtin_unreachable();
+}
+
+namespace {
+
+// The 'match_class' function in the reference implementation
+//
+bool WARN_UNUSED MatchCharClass(int c, int cl)
+{
+    bool res;
+    switch (tolower(cl))
+    {
+    case 'a': res = isalpha(c); break;
+    case 'c': res = iscntrl(c); break;
+    case 'd': res = isdigit(c); break;
+    case 'l': res = islower(c); break;
+    case 'p': res = ispunct(c); break;
+    case 's': res = isspace(c); break;
+    case 'u': res = isupper(c); break;
+    case 'w': res = isalnum(c); break;
+    case 'x': res = isxdigit(c); break;
+    case 'z': res = (c == 0); break;
+    default: return (cl == c);
+    }
+    if (isupper(cl))
+    {
+        res = !res;
+    }
+    return res;
+}
+
+bool WARN_UNUSED IsCharClassLetter(int cl)
+{
+    switch (tolower(cl))
+    {
+    case 'a': case 'c': case 'd': case 'l': case 'p': case 's': case 'u': case 'w': case 'x': case 'z':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The 'matchbracketclass' function in the reference implementation
+// 'p' points to the '[' and 'ec' points to the closing ']'
+//
+bool WARN_UNUSED MatchBracketClass(int c, const char* p, const char* ec)
+{
+    bool sig = true;
+    if (*(p + 1) == '^')
+    {
+        sig = false;
+        p++;
+    }
+    while (++p < ec)
+    {
+        if (*p == '%')
+        {
+            p++;
+            if (MatchCharClass(c, static_cast<unsigned char>(*p)))
+            {
+                return sig;
+            }
+        }
+        else if (*(p + 1) == '-' && p + 2 < ec)
+        {
+            p += 2;
+            if (static_cast<unsigned char>(*(p - 2)) <= c && c <= static_cast<unsigned char>(*p))
+            {
+                return sig;
+            }
+        }
+        else if (static_cast<unsigned char>(*p) == c)
+        {
+            return sig;
+        }
+    }
+    return !sig;
+}
+
+class LuaPatternCompiler
+{
+public:
+    LuaPatternCompiler(const char* pattern, size_t patternLen, CompiledLuaPattern* result)
+        : m_pattern(pattern)
+        , m_end(pattern + patternLen)
+        , m_result(result)
+    { }
+
+    // Returns the end of the single-character class starting at 'p' (the 'classEnd' function in the reference implementation)
+    //
+    const char* WARN_UNUSED GetClassEnd(const char* p)
+    {
+        assert(p < m_end);
+        char c = *(p++);
+        if (c == '%')
+        {
+            if (p == m_end)
+            {
+                m_error = LuaPatternError::EndsWithPercent;
+                return nullptr;
+            }
+            return p + 1;
+        }
+        if (c == '[')
+        {
+            if (p < m_end && *p == '^')
+            {
+                p++;
+            }
+            // Look for the ']'. Note that the first character of the set is never the closing ']'
+            //
+            do
+            {
+                if (p == m_end)
+                {
+                    m_error = LuaPatternError::MissingBracket;
+                    return nullptr;
+                }
+                if (*(p++) == '%' && p < m_end)
+                {
+                    p++;
+                }
+            }
+            while (p == m_end || *p != ']');
+            return p + 1;
+        }
+        return p;
+    }
+
+    uint32_t WARN_UNUSED AddBracketSet(const char* p, const char* ec)
+    {
+        LuaCharSet set {};
+        for (int c = 0; c < 256; c++)
+        {
+            if (MatchBracketClass(c, p, ec))
+            {
+                set.Add(static_cast<uint8_t>(c));
+            }
+        }
+        m_result->m_sets.push_back(set);
+        return static_cast<uint32_t>(m_result->m_sets.size() - 1);
+    }
+
+    uint32_t WARN_UNUSED AddClassSet(int cl)
+    {
+        LuaCharSet set {};
+        for (int c = 0; c < 256; c++)
+        {
+            if (MatchCharClass(c, cl))
+            {
+                set.Add(static_cast<uint8_t>(c));
+            }
+        }
+        m_result->m_sets.push_back(set);
+        return static_cast<uint32_t>(m_result->m_sets.size() - 1);
+    }
+
+    void AddItem(LuaPatternItem::Kind kind, uint8_t c = 0, uint8_t c2 = 0, uint32_t setOrd = 0)
+    {
+        m_result->m_items.push_back(LuaPatternItem {
+            .m_kind = kind,
+            .m_quantifier = LuaPatternItem::Quantifier::One,
+            .m_char = c,
+            .m_char2 = c2,
+            .m_setOrd = setOrd
+        });
+    }
+
+    LuaPatternError WARN_UNUSED Run(bool caretIsAnchor)
+    {
+        m_error = LuaPatternError::NoError;
+        const char* p = m_pattern;
+        m_result->m_isAnchored = false;
+        if (caretIsAnchor && p < m_end && *p == '^')
+        {
+            m_result->m_isAnchored = true;
+            p++;
+        }
+
+        // The number of '(' not closed yet at the current position
+        // Captures are opened and closed in pattern order no matter how the matcher backtracks, so a ')' without
+        // an open capture before it would fail every time the matcher reaches it
+        //
+        uint32_t numOpenCaptures = 0;
+        while (p < m_end)
+        {
+            char c = *p;
+            if (c == '(')
+            {
+                if (p + 1 < m_end && *(p + 1) == ')')
+                {
+                    AddItem(LuaPatternItem::Kind::OpenPositionCapture);
+                    p += 2;
+                }
+                else
+                {
+                    AddItem(LuaPatternItem::Kind::OpenCapture);
+                    numOpenCaptures++;
+                    p++;
+                }
+                continue;
+            }
+            if (c == ')')
+            {
+                if (numOpenCaptures == 0)
+                {
+                    return LuaPatternError::InvalidPatternCapture;
+                }
+                numOpenCaptures--;
+                AddItem(LuaPatternItem::Kind::CloseCapture);
+                p++;
+                continue;
+            }
+            if (c == '$' && p + 1 == m_end)
+            {
+                AddItem(LuaPatternItem::Kind::EndAnchor);
+                p++;
+                continue;
+            }
+            if (c == '%' && p + 1 < m_end)
+            {
+                char d = *(p + 1);
+                if (d == 'b')
+                {
+                    if (p + 3 >= m_end)
+                    {
+                        return LuaPatternError::UnbalancedPattern;
+                    }
+                    AddItem(LuaPatternItem::Kind::Balance, static_cast<uint8_t>(*(p + 2)), static_cast<uint8_t>(*(p + 3)));
+                    p += 4;
+                    continue;
+                }
+                if (d == 'f')
+                {
+                    p += 2;
+                    if (p == m_end || *p != '[')
+                    {
+                        return LuaPatternError::MissingBracketAfterFrontier;
+                    }
+                    const char* ep = GetClassEnd(p);
+                    if (ep == nullptr)
+                    {
+                        return m_error;
+                    }
+                    AddItem(LuaPatternItem::Kind::Frontier, 0, 0, AddBracketSet(p, ep - 1));
+                    p = ep;
+                    continue;
+                }
+                if (isdigit(static_cast<unsigned char>(d)))
+                {
+                    AddItem(LuaPatternItem::Kind::BackReference, static_cast<uint8_t>(d));
+                    p += 2;
+                    continue;
+                }
+            }
+
+            // A single-character class, optionally followed by a quantifier
+            //
+            const char* ep = GetClassEnd(p);
+            if (ep == nullptr)
+            {
+                return m_error;
+            }
+            if (c == '.')
+            {
+                AddItem(LuaPatternItem::Kind::Any);
+            }
+            else if (c == '%')
+            {
+                int cl = static_cast<unsigned char>(*(p + 1));
+                if (IsCharClassLetter(cl))
+                {
+                    AddItem(LuaPatternItem::Kind::Set, 0, 0, AddClassSet(cl));
+                }
+                else
+                {
+                    AddItem(LuaPatternItem::Kind::Char, static_cast<uint8_t>(cl));
+                }
+            }
+            else if (c == '[')
+            {
+                AddItem(LuaPatternItem::Kind::Set, 0, 0, AddBracketSet(p, ep - 1));
+            }
+            else
+            {
+                AddItem(LuaPatternItem::Kind::Char, static_cast<uint8_t>(c));
+            }
+
+            if (ep < m_end)
+            {
+                LuaPatternItem& item = m_result->m_items.back();
+                switch (*ep)
+                {
+                case '*': item.m_quantifier = LuaPatternItem::Quantifier::ZeroOrMore; ep++; break;
+                case '+': item.m_quantifier = LuaPatternItem::Quantifier::OneOrMore; ep++; break;
+                case '-': item.m_quantifier = LuaPatternItem::Quantifier::LazyZeroOrMore; ep++; break;
+                case '?': item.m_quantifier = LuaPatternItem::Quantifier::Optional; ep++; break;
+                default: break;
+                }
+            }
+            p = ep;
+        }
+        return LuaPatternError::NoError;
+    }
+
+private:
+    const char* m_pattern;
+    const char* m_end;
+    CompiledLuaPattern* m_result;
+    LuaPatternError m_error;
+};
+
+}   // anonymous namespace
+
+CompiledLuaPattern* WARN_UNUSED CompiledLuaPattern::Compile(const char* pattern, size_t patternLen, bool caretIsAnchor)
+{
+    CompiledLuaPattern* r = new CompiledLuaPattern();
+    LuaPatternCompiler compiler(pattern, patternLen, r);
+    r->m_compileError = compiler.Run(caretIsAnchor);
+    r->m_isPlain = false;
+    if (r->m_compileError != LuaPatternError::NoError)
+    {
+        r->m_items.clear();
+        r->m_sets.clear();
+        return r;
+    }
+
+    r->m_isPlain = !r->m_isAnchored;
+    for (const LuaPatternItem& item : r->m_items)
+    {
+        if (item.m_kind != LuaPatternItem::Kind::Char || item.m_quantifier != LuaPatternItem::Quantifier::One)
+        {
+            r->m_isPlain = false;
+            break;
+        }
+    }
+    if (r->m_isPlain)
+    {
+        for (const LuaPatternItem& item : r->m_items)
+        {
+            r->m_literal.push_back(static_cast<char>(item.m_char));
+        }
+    }
+    return r;
+}
+
+LuaPatternCache::LuaPatternCache()
+{
+    for (size_t i = 0; i < x_numEntries; i++)
+    {
+        m_entries[i].m_key = 0;
+        m_entries[i].m_caretIsAnchor = false;
+        m_entries[i].m_pattern = nullptr;
+    }
+}
+
+LuaPatternCache::~LuaPatternCache()
+{
+    for (size_t i = 0; i < x_numEntries; i++)
+    {
+        delete m_entries[i].m_pattern;
+    }
+}
+
+CompiledLuaPattern* WARN_UNUSED LuaPatternCache::Get(VM* vm, HeapPtr<HeapString> pattern, bool caretIsAnchor)
+{
+    LuaPatternCache* cache = vm->m_luaPatternCache;
+    if (unlikely(cache == nullptr))
+    {
+        cache = new LuaPatternCache();
+        vm->m_luaPatternCache = cache;
+    }
+
+    int64_t key = UserHeapPointer<HeapString>(pattern).m_value;
+    size_t slot = (pattern->m_hashLow ^ static_cast<uint32_t>(caretIsAnchor)) % x_numEntries;
+    Entry& entry = cache->m_entries[slot];
+    if (likely(entry.m_key == key && entry.m_caretIsAnchor == caretIsAnchor))
+    {
+        return entry.m_pattern;
+    }
+
+    HeapString* hs = TranslateToRawPointer(vm, pattern);
+    delete entry.m_pattern;
+    entry.m_pattern = CompiledLuaPattern::Compile(reinterpret_cast<const char*>(hs->m_string), hs->m_length, caretIsAnchor);
+    entry.m_key = key;
+    entry.m_caretIsAnchor = caretIsAnchor;
+    return entry.m_pattern;
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::Find(const char* init, const char*& matchEnd /*out*/)
+{
+    assert(m_srcBegin <= init && init <= m_srcEnd);
+    const CompiledLuaPattern* pattern = m_pattern;
+    m_level = 0;
+
+    if (pattern->m_isPlain)
+    {
+        // glibc's memmem uses a vectorized search for short needles and the two-way algorithm for long ones
+        //
+        const void* res = memmem(init, static_cast<size_t>(m_srcEnd - init), pattern->m_literal.data(), pattern->m_literal.length());
+        if (res == nullptr)
+        {
+            return nullptr;
+        }
+        const char* begin = reinterpret_cast<const char*>(res);
+        matchEnd = begin + pattern->m_literal.length();
+        return begin;
+    }
+
+    if (pattern->m_isAnchored)
+    {
+        const char* e = Match(init, 0 /*itemOrd*/);
+        if (e == nullptr)
+        {
+            return nullptr;
+        }
+        matchEnd = e;
+        return init;
+    }
+
+    // If the first item must consume a byte from a known set, skip the positions that cannot start a match
+    //
+    const LuaPatternItem* firstItem = pattern->m_items.empty() ? nullptr : &pattern->m_items[0];
+    bool firstItemMustConsume = firstItem != nullptr &&
+        (firstItem->m_quantifier == LuaPatternItem::Quantifier::One || firstItem->m_quantifier == LuaPatternItem::Quantifier::OneOrMore);
+
+    const char* s = init;
+    while (true)
+    {
+        if (firstItemMustConsume)
+        {
+            if (firstItem->m_kind == LuaPatternItem::Kind::Char)
+            {
+                s = reinterpret_cast<const char*>(memchr(s, firstItem->m_char, static_cast<size_t>(m_srcEnd - s)));
+                if (s == nullptr)
+                {
+                    return nullptr;
+                }
+            }
+            else if (firstItem->m_kind == LuaPatternItem::Kind::Set)
+            {
+                const LuaCharSet& set = pattern->m_sets[firstItem->m_setOrd];
+                while (s < m_srcEnd && !set.Contains(static_cast<uint8_t>(*s)))
+                {
+                    s++;
+                }
+                if (s == m_srcEnd)
+                {
+                    return nullptr;
+                }
+            }
+        }
+
+        m_level = 0;
+        const char* e = Match(s, 0 /*itemOrd*/);
+        if (e != nullptr)
+        {
+            matchEnd = e;
+            return s;
+        }
+        if (unlikely(m_error != LuaPatternError::NoError) || s == m_srcEnd)
+        {
+            return nullptr;
+        }
+        s++;
+    }
+}
+
+bool WARN_UNUSED LuaPatternMatcher::GetCaptureBytes(uint32_t i, const char* matchBegin, const char* matchEnd, const char*& begin /*out*/, size_t& len /*out*/)
+{
+    if (i >= m_level)
+    {
+        if (i == 0)
+        {
+            begin = matchBegin;
+            len = static_cast<size_t>(matchEnd - matchBegin);
+            return true;
+        }
+        m_error = LuaPatternError::InvalidCaptureIndex;
+        return false;
+    }
+    const LuaPatternCapture& capture = m_captures[i];
+    if (capture.m_len == LuaPatternCapture::x_unfinished)
+    {
+        m_error = LuaPatternError::UnfinishedCapture;
+        return false;
+    }
+    if (capture.m_len == LuaPatternCapture::x_position)
+    {
+        begin = nullptr;
+        len = static_cast<size_t>(capture.m_begin - m_srcBegin + 1);
+        return true;
+    }
+    begin = capture.m_begin;
+    len = static_cast<size_t>(capture.m_len);
+    return true;
+}
+
+TValue WARN_UNUSED LuaPatternMatcher::GetCapture(VM* vm, uint32_t i, const char* matchBegin, const char* matchEnd)
+{
+    const char* begin;
+    size_t len;
+    if (!GetCaptureBytes(i, matchBegin, matchEnd, begin /*out*/, len /*out*/))
+    {
+        return TValue::Create<tNil>();
+    }
+    if (begin == nullptr)
+    {
+        return TValue::Create<tDouble>(static_cast<double>(len));
+    }
+    // The string object is created directly from the bytes in the subject string
+    //
+    return TValue::Create<tString>(vm->CreateStringObjectFromRawString(begin, static_cast<uint32_t>(len)).As());
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::Match(const char* s, uint32_t itemOrd)
+{
+    const std::vector<LuaPatternItem>& items = m_pattern->m_items;
+    uint32_t numItems = static_cast<uint32_t>(items.size());
+    while (true)
+    {
+        if (itemOrd == numItems)
+        {
+            return s;
+        }
+        const LuaPatternItem& item = items[itemOrd];
+        switch (item.m_kind)
+        {
+        case LuaPatternItem::Kind::OpenCapture:
+        {
+            return StartCapture(s, itemOrd + 1, LuaPatternCapture::x_unfinished);
+        }
+        case LuaPatternItem::Kind::OpenPositionCapture:
+        {
+            return StartCapture(s, itemOrd + 1, LuaPatternCapture::x_position);
+        }
+        case LuaPatternItem::Kind::CloseCapture:
+        {
+            return EndCapture(s, itemOrd + 1);
+        }
+        case LuaPatternItem::Kind::EndAnchor:
+        {
+            assert(itemOrd + 1 == numItems);
+            return (s == m_srcEnd) ? s : nullptr;
+        }
+        case LuaPatternItem::Kind::Balance:
+        {
+            s = MatchBalance(s, item);
+            if (s == nullptr)
+            {
+                return nullptr;
+            }
+            itemOrd++;
+            continue;
+        }
+        case LuaPatternItem::Kind::Frontier:
+        {
+            // As in the reference implementation, the character before the start and after the end of the subject is '\0'
+            //
+            const LuaCharSet& set = m_pattern->m_sets[item.m_setOrd];
+            uint8_t prev = (s == m_srcBegin) ? 0 : static_cast<uint8_t>(*(s - 1));
+            uint8_t cur = (s == m_srcEnd) ? 0 : static_cast<uint8_t>(*s);
+            if (set.Contains(prev) || !set.Contains(cur))
+            {
+                return nullptr;
+            }
+            itemOrd++;
+            continue;
+        }
+        case LuaPatternItem::Kind::BackReference:
+        {
+            s = MatchBackReference(s, item.m_char);
+            if (s == nullptr)
+            {
+                return nullptr;
+            }
+            itemOrd++;
+            continue;
+        }
+        case LuaPatternItem::Kind::Char:
+        case LuaPatternItem::Kind::Any:
+        case LuaPatternItem::Kind::Set:
+        {
+            bool m = s < m_srcEnd && SingleMatch(static_cast<uint8_t>(*s), item);
+            switch (item.m_quantifier)
+            {
+            case LuaPatternItem::Quantifier::One:
+            {
+                if (!m)
+                {
+                    return nullptr;
+                }
+                s++;
+                itemOrd++;
+                continue;
+            }
+            case LuaPatternItem::Quantifier::Optional:
+            {
+                if (m)
+                {
+                    const char* res = Match(s + 1, itemOrd + 1);
+                    if (res != nullptr || unlikely(m_error != LuaPatternError::NoError))
+                    {
+                        return res;
+                    }
+                }
+                itemOrd++;
+                continue;
+            }
+            case LuaPatternItem::Quantifier::ZeroOrMore:
+            {
+                return MaxExpand(s, itemOrd);
+            }
+            case LuaPatternItem::Quantifier::OneOrMore:
+            {
+                return m ? MaxExpand(s + 1, itemOrd) : nullptr;
+            }
+            case LuaPatternItem::Quantifier::LazyZeroOrMore:
+            {
+                return MinExpand(s, itemOrd);
+            }
+            }   /* switch m_quantifier */
+            __builtin_unreachable();
+        }
+        }   /* switch m_kind */
+        __builtin_unreachable();
+    }
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::MaxExpand(const char* s, uint32_t itemOrd)
+{
+    const LuaPatternItem& item = m_pattern->m_items[itemOrd];
+    size_t i;
+    if (item.m_kind == LuaPatternItem::Kind::Any)
+    {
+        i = static_cast<size_t>(m_srcEnd - s);
+    }
+    else
+    {
+        i = 0;
+        while (s + i < m_srcEnd && SingleMatch(static_cast<uint8_t>(s[i]), item))
+        {
+            i++;
+        }
+    }
+
+    // The item is the last one, so the longest expansion is the match
+    //
+    uint32_t nextOrd = itemOrd + 1;
+    if (nextOrd == m_pattern->m_items.size())
+    {
+        return s + i;
+    }
+
+    // If the rest of the pattern starts with a literal byte, only try the expansions followed by that byte
+    //
+    const LuaPatternItem& nextItem = m_pattern->m_items[nextOrd];
+    bool nextIsLiteral = nextItem.m_kind == LuaPatternItem::Kind::Char &&
+        (nextItem.m_quantifier == LuaPatternItem::Quantifier::One || nextItem.m_quantifier == LuaPatternItem::Quantifier::OneOrMore);
+
+    while (true)
+    {
+        if (!nextIsLiteral || (s + i < m_srcEnd && static_cast<uint8_t>(s[i]) == nextItem.m_char))
+        {
+            const char* res = Match(s + i, nextOrd);
+            if (res != nullptr || unlikely(m_error != LuaPatternError::NoError))
+            {
+                return res;
+            }
+        }
+        if (i == 0)
+        {
+            return nullptr;
+        }
+        i--;
+    }
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::MinExpand(const char* s, uint32_t itemOrd)
+{
+    const LuaPatternItem& item = m_pattern->m_items[itemOrd];
+    while (true)
+    {
+        const char* res = Match(s, itemOrd + 1);
+        if (res != nullptr || unlikely(m_error != LuaPatternError::NoError))
+        {
+            return res;
+        }
+        if (s < m_srcEnd && SingleMatch(static_cast<uint8_t>(*s), item))
+        {
+            s++;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::StartCapture(const char* s, uint32_t itemOrd, int64_t what)
+{
+    if (unlikely(m_level >= x_luaPatternMaxCaptures))
+    {
+        m_error = LuaPatternError::TooManyCaptures;
+        return nullptr;
+    }
+    m_captures[m_level].m_begin = s;
+    m_captures[m_level].m_len = what;
+    m_level++;
+    const char* res = Match(s, itemOrd);
+    if (res == nullptr)
+    {
+        m_level--;
+    }
+    return res;
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::EndCapture(const char* s, uint32_t itemOrd)
+{
+    // Close the innermost unfinished capture
+    //
+    // The compiler has checked that every ')' has a matching '(', so there is always one
+    //
+    uint32_t l = m_level;
+    while (true)
+    {
+        assert(l > 0);
+        l--;
+        if (m_captures[l].m_len == LuaPatternCapture::x_unfinished)
+        {
+            break;
+        }
+    }
+    m_captures[l].m_len = s - m_captures[l].m_begin;
+    const char* res = Match(s, itemOrd);
+    if (res == nullptr)
+    {
+        m_captures[l].m_len = LuaPatternCapture::x_unfinished;
+    }
+    return res;
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::MatchBalance(const char* s, const LuaPatternItem& item)
+{
+    if (s >= m_srcEnd || static_cast<uint8_t>(*s) != item.m_char)
+    {
+        return nullptr;
+    }
+    uint32_t cont = 1;
+    while (++s < m_srcEnd)
+    {
+        uint8_t c = static_cast<uint8_t>(*s);
+        if (c == item.m_char2)
+        {
+            if (--cont == 0)
+            {
+                return s + 1;
+            }
+        }
+        else if (c == item.m_char)
+        {
+            cont++;
+        }
+    }
+    return nullptr;
+}
+
+const char* WARN_UNUSED LuaPatternMatcher::MatchBackReference(const char* s, uint8_t digit)
+{
+    int l = static_cast<int>(digit) - '1';
+    if (l < 0 || l >= static_cast<int>(m_level) || m_captures[l].m_len == LuaPatternCapture::x_unfinished)
+    {
+        m_error = LuaPatternError::InvalidCaptureIndex;
+        return nullptr;
+    }
+    int64_t len = m_captures[l].m_len;
+    // A position capture never matches, as in the reference implementation
+    //
+    if (len < 0 || m_srcEnd - s < len || memcmp(m_captures[l].m_begin, s, static_cast<size_t>(len)) != 0)
+    {
+        return nullptr;
+    }
+    return s + len;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "common_utils.h"
+#include "runtime_utils.h"
+
+// Lua 5.1 patterns, used by string.find, string.match, string.gmatch and string.gsub
+// See https://www.lua.org/manual/5.1/manual.html#5.4.1
+//
+// A pattern is compiled once into a flat list of items. Every single-character class is turned into either a literal byte,
+// "any byte", or a 256-bit set (so '%a' or '[^%d_]' costs one bit test per input byte), with its quantifier attached.
+// A pattern that turns out to consist of literal bytes only is matched by a plain substring search.
+// The matcher is a backtracking matcher over the item list, with the same semantics as the reference implementation.
+//
+// Unlike the reference implementation, a malformed pattern is reported when the pattern is compiled, not when the
+// matcher happens to reach the malformed part. Also, the pattern may contain '\0', which is treated as an ordinary character.
+//
+
+enum class LuaPatternError : uint8_t
+{
+    NoError,
+    EndsWithPercent,
+    MissingBracket,
+    MissingBracketAfterFrontier,
+    UnbalancedPattern,
+    TooManyCaptures,
+    InvalidPatternCapture,
+    InvalidCaptureIndex,
+    UnfinishedCapture
+};
+
+const char* WARN_UNUSED GetLuaPatternErrorMessage(LuaPatternError err);
+
+constexpr uint32_t x_luaPatternMaxCaptures = 32;
+
+struct LuaPatternItem
+{
+    enum class Kind : uint8_t
+    {
+        Char,
+        Any,
+        Set,
+        OpenCapture,
+        OpenPositionCapture,
+        CloseCapture,
+        // '%bxy'
+        //
+        Balance,
+        // '%f[set]'
+        //
+        Frontier,
+        // '%1' to '%9'
+        //
+        BackReference,
+        // A '$' at the end of the pattern
+        //
+        EndAnchor
+    };
+
+    enum class Quantifier : uint8_t
+    {
+        One,
+        // '*'
+        //
+        ZeroOrMore,
+        // '+'
+        //
+        OneOrMore,
+        // '-'
+        //
+        LazyZeroOrMore,
+        // '?'
+        //
+        Optional
+    };
+
+    Kind m_kind;
+    Quantifier m_quantifier;
+    // The byte for Char, the opening byte for Balance, the digit character for BackReference
+    //
+    uint8_t m_char;
+    // The closing byte for Balance
+    //
+    uint8_t m_char2;
+    // The ordinal into the set list for Set and Frontier
+    //
+    uint32_t m_setOrd;
+};
+
+class LuaCharSet
+{
+public:
+    bool Contains(uint8_t c) const
+    {
+        return (m_bits[c / 64] >> (c % 64)) & 1;
+    }
+
+    void Add(uint8_t c)
+    {
+        m_bits[c / 64] |= static_cast<uint64_t>(1) << (c % 64);
+    }
+
+    uint64_t m_bits[4];
+};
+
+class CompiledLuaPattern
+{
+public:
+    // If 'caretIsAnchor' is false, a '^' at the start of the pattern is an ordinary character (this is the case for string.gmatch)
+    //
+    static CompiledLuaPattern* WARN_UNUSED Compile(const char* pattern, size_t patternLen, bool caretIsAnchor);
+
+    // If not NoError, the pattern is malformed and must not be used for matching
+    //
+    LuaPatternError m_compileError;
+    bool m_isAnchored;
+    // The pattern consists of literal bytes only (e.g., "abc" or "a%.b"), so a match is simply an occurrence of 'm_literal'
+    //
+    bool m_isPlain;
+    std::vector<LuaPatternItem> m_items;
+    std::vector<LuaCharSet> m_sets;
+    std::string m_literal;
+};
+
+// Compiled patterns are cached per VM, keyed by the interned pattern string: two strings with the same content are always the
+// same object, and string objects are never freed, so the pointer identifies the pattern content.
+//
+// A returned pattern may be evicted by any later lookup, so it must not be held across a call into the user program.
+//
+class LuaPatternCache
+{
+    MAKE_NONCOPYABLE(LuaPatternCache);
+    MAKE_NONMOVABLE(LuaPatternCache);
+
+public:
+    LuaPatternCache();
+    ~LuaPatternCache();
+
+    static CompiledLuaPattern* WARN_UNUSED Get(VM* vm, HeapPtr<HeapString> pattern, bool caretIsAnchor);
+
+private:
+    static constexpr size_t x_numEntries = 64;
+
+    struct Entry
+    {
+        int64_t m_key;
+        bool m_caretIsAnchor;
+        CompiledLuaPattern* m_pattern;
+    };
+
+    Entry m_entries[x_numEntries];
+};
+
+struct LuaPatternCapture
+{
+    static constexpr int64_t x_unfinished = -1;
+    static constexpr int64_t x_position = -2;
+
+    const char* m_begin;
+    // The length of the capture, or one of the special values above
+    //
+    int64_t m_len;
+};
+
+class LuaPatternMatcher
+{
+public:
+    LuaPatternMatcher(const CompiledLuaPattern* pattern, const char* src, size_t srcLen)
+        : m_pattern(pattern)
+        , m_srcBegin(src)
+        , m_srcEnd(src + srcLen)
+        , m_level(0)
+        , m_error(LuaPatternError::NoError)
+    {
+        assert(pattern->m_compileError == LuaPatternError::NoError);
+    }
+
+    // Find the first match that starts at or after 'init' (only at 'init' if the pattern is anchored).
+    // On success, returns the start of the match, and the end of the match is returned in 'matchEnd'.
+    // Returns nullptr if there is no match or if an error happened (in which case 'm_error' is set).
+    //
+    const char* WARN_UNUSED Find(const char* init, const char*& matchEnd /*out*/);
+
+    // The number of values string.match / string.gmatch produces for the last match: the captures, or the whole match if there is no capture
+    //
+    uint32_t GetNumResultValues()
+    {
+        return (m_level == 0) ? 1 : m_level;
+    }
+
+    // Get the i-th capture of the last match as a Lua value. For i == 0 and a pattern without captures, this is the whole match.
+    // May set 'm_error' and return nil if the capture is not valid.
+    //
+    TValue WARN_UNUSED GetCapture(VM* vm, uint32_t i, const char* matchBegin, const char* matchEnd);
+
+    // Same as above, but returns the bytes of the capture without creating a string object.
+    // For a position capture, 'begin' is nullptr and the (1-based) position is returned in 'len'.
+    // Returns false and sets 'm_error' if the capture is not valid.
+    //
+    bool WARN_UNUSED GetCaptureBytes(uint32_t i, const char* matchBegin, const char* matchEnd, const char*& begin /*out*/, size_t& len /*out*/);
+
+    const CompiledLuaPattern* m_pattern;
+    const char* m_srcBegin;
+    const char* m_srcEnd;
+    uint32_t m_level;
+    LuaPatternError m_error;
+    LuaPatternCapture m_captures[x_luaPatternMaxCaptures];
+
+private:
+    bool SingleMatch(uint8_t c, const LuaPatternItem& item)
+    {
+        switch (item.m_kind)
+        {
+        case LuaPatternItem::Kind::Char:
+            return c == item.m_char;
+        case LuaPatternItem::Kind::Any:
+            return true;
+        default:
+            assert(item.m_kind == LuaPatternItem::Kind::Set);
+            return m_pattern->m_sets[item.m_setOrd].Contains(c);
+        }
+    }
+
+    const char* WARN_UNUSED Match(const char* s, uint32_t itemOrd);
+    const char* WARN_UNUSED MaxExpand(const char* s, uint32_t itemOrd);
+    const char* WARN_UNUSED MinExpand(const char* s, uint32_t itemOrd);
+    const char* WARN_UNUSED StartCapture(const char* s, uint32_t itemOrd, int64_t what);
+    const char* WARN_UNUSED EndCapture(const char* s, uint32_t itemOrd);
+    const char* WARN_UNUSED MatchBalance(const char* s, const LuaPatternItem& item);
+    const char* WARN_UNUSED MatchBackReference(const char* s, uint8_t digit);
+};
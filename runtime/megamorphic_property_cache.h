@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common_utils.h"
+
+// A VM-wide cache of property lookups on Structure-mode tables, keyed by (Structure, property name)
+//
+// The inline cache of a TableGetById or TablePutById site only has room for a few hidden classes
+// (x_maxJitGenericInlineCacheEntries in baseline JIT). Once a site has seen more than that, it is megamorphic:
+// every execution misses the IC and runs the IC body, which has to look up the property in the Structure.
+// The IC body of such a site (ICHandler::IsMegamorphic() returns true) calls TableObject::PrepareGetByIdForMegamorphicSite
+// or PreparePutByIdForMegamorphicSite, which consult this cache first, so it usually pays a single direct-mapped probe
+// instead of a Structure hash table lookup. Sites that can still create IC entries never touch this cache.
+//
+// A Structure never changes its property layout once created, and neither Structures nor interned strings
+// are ever freed, so an entry can never become stale and the cache never needs to be invalidated.
+//
+class MegamorphicPropertyCache
+{
+public:
+    enum class Kind : uint8_t
+    {
+        // The property does not exist in the Structure
+        //
+        Absent,
+        // The property is in the inlined storage in m_slot
+        //
+        InlinedStorage,
+        // The property is in the outlined storage in m_slot (already translated to the butterfly index)
+        //
+        OutlinedStorage
+    };
+
+    struct Entry
+    {
+        // The property name (a UserHeapPointer<HeapString>), 0 if the entry is empty
+        //
+        int64_t m_propertyName;
+        // The Structure (a SystemHeapPointer<Structure>)
+        //
+        uint32_t m_structure;
+        int32_t m_slot;
+        Kind m_kind;
+        bool m_mayHaveMetatable;
+    };
+
+    void Reset()
+    {
+        memset(m_entries, 0, sizeof(Entry) * x_numEntries);
+    }
+
+    // Returns nullptr if the cache has no entry for the (structure, propertyName) pair
+    //
+    Entry* WARN_UNUSED ALWAYS_INLINE Find(uint32_t structure, int64_t propertyName)
+    {
+        assert(structure != 0 && propertyName != 0);
+        Entry* entry = m_entries + GetEntryIndex(structure, propertyName);
+        if (likely(entry->m_structure == structure && entry->m_propertyName == propertyName))
+        {
+            return entry;
+        }
+        return nullptr;
+    }
+
+    // Overwrites whatever entry the pair hashes to
+    //
+    void ALWAYS_INLINE Insert(uint32_t structure, int64_t propertyName, Kind kind, int32_t slot, bool mayHaveMetatable)
+    {
+        assert(structure != 0 && propertyName != 0);
+        Entry* entry = m_entries + GetEntryIndex(structure, propertyName);
+        entry->m_propertyName = propertyName;
+        entry->m_structure = structure;
+        entry->m_slot = slot;
+        entry->m_kind = kind;
+        entry->m_mayHaveMetatable = mayHaveMetatable;
+    }
+
+    static constexpr size_t x_log2NumEntries = 12;
+    static constexpr size_t x_numEntries = static_cast<size_t>(1) << x_log2NumEntries;
+
+private:
+    static size_t ALWAYS_INLINE GetEntryIndex(uint32_t structure, int64_t propertyName)
+    {
+        // Fibonacci hashing: the high bits of the product depend on all bits of the key
+        //
+        uint64_t key = static_cast<uint64_t>(propertyName) ^ (static_cast<uint64_t>(structure) << 20);
+        return static_cast<size_t>((key * 11400714819323198485ULL) >> (64 - x_log2NumEntries));
+    }
+
+    Entry m_entries[x_numEntries];
+};
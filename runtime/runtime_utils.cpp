@@ -1,4 +1,5 @@
 #include "runtime_utils.h"
+#include <signal.h>
 #include "deegen_options.h"
 #include "vm.h"
 #include "table_object.h"
@@ -108,16 +109,7 @@ CodeBlock* WARN_UNUSED CodeBlock::Create(VM* vm, UnlinkedCodeBlock* ucb, UserHea
     cb->m_bytecodeMetadataLength = ucb->m_bytecodeMetadataLength;
     cb->m_baselineCodeBlock = nullptr;
     cb->m_dfgCodeBlock = nullptr;
-    if (vm->InterpreterCanTierUpFurther())
-    {
-        cb->m_interpreterTierUpCounter = x_interpreter_tier_up_threshold_bytecode_length_multiplier * ucb->m_bytecodeLengthIncludingTailPadding;
-    }
-    else
-    {
-        // We increment counter on forward edges, choose 2^62 to avoid overflow.
-        //
-        cb->m_interpreterTierUpCounter = 1LL << 62;
-    }
+    cb->ResetInterpreterTierUpCounter(vm);
     memcpy(cb->GetBytecodeStream(), ucb->m_bytecode, ucb->m_bytecodeLengthIncludingTailPadding);
 
     ForEachBytecodeMetadata(cb, []<typename T>(T* md) ALWAYS_INLINE {
@@ -139,6 +131,20 @@ CodeBlock* WARN_UNUSED CodeBlock::Create(VM* vm, UnlinkedCodeBlock* ucb, UserHea
     return cb;
 }
 
+void CodeBlock::ResetInterpreterTierUpCounter(VM* vm)
+{
+    if (vm->InterpreterCanTierUpFurther())
+    {
+        m_interpreterTierUpCounter = x_interpreter_tier_up_threshold_bytecode_length_multiplier * m_bytecodeLengthIncludingTailPadding;
+    }
+    else
+    {
+        // We increment counter on forward edges, choose 2^62 to avoid overflow.
+        //
+        m_interpreterTierUpCounter = 1LL << 62;
+    }
+}
+
 void CodeBlock::UpdateBestEntryPoint(void* newEntryPoint)
 {
     void* oldBestEntryPoint = m_bestEntryPoint;
@@ -180,7 +186,11 @@ void CodeBlock::UpdateBestEntryPoint(void* newEntryPoint)
 std::pair<TValue* /*retStart*/, uint64_t /*numRet*/> VM::LaunchScript(ScriptModule* module)
 {
     CoroutineRuntimeContext* rc = GetRootCoroutine();
-    return DeegenEnterVMFromC(rc, module->m_defaultEntryPoint.As(), rc->m_stackBegin);
+    std::pair<TValue*, uint64_t> result = DeegenEnterVMFromC(rc, module->m_defaultEntryPoint.As(), rc->m_stackBegin);
+    // The script has finished, so the output it produced should not linger in the stdout buffer
+    //
+    std::ignore = FlushStdout();
+    return result;
 }
 
 UserHeapPointer<FunctionObject> WARN_UNUSED NO_INLINE FunctionObject::CreateAndFillUpvalues(CodeBlock* cb, CoroutineRuntimeContext* rc, TValue* stackFrameBase, HeapPtr<FunctionObject> parent, size_t selfOrdinalInStackFrame)
@@ -225,6 +235,129 @@ UserHeapPointer<FunctionObject> WARN_UNUSED NO_INLINE FunctionObject::CreateAndF
     return r;
 }
 
+static size_t WARN_UNUSED GetCoroutineStackMappingLength(size_t numStackSlots)
+{
+    size_t bytesToAllocate = numStackSlots * sizeof(TValue);
+    bytesToAllocate = RoundUpToMultipleOf<VM::x_pageSize>(bytesToAllocate);
+    return bytesToAllocate + CoroutineRuntimeContext::x_stackOverflowProtectionAreaSize * 2;
+}
+
+static constexpr size_t x_initialCommittedStackBytes = RoundUpToMultipleOf<VM::x_pageSize>(CoroutineRuntimeContext::x_initialCommittedStackSlots * sizeof(TValue));
+
+// Reserve the address range of the stack surrounded by the overflow protection areas,
+// and make the first x_initialCommittedStackBytes of the stack accessible
+//
+// The reservation is aligned to CoroutineStackIndex::x_granuleSize, see CoroutineStackIndex
+//
+static TValue* WARN_UNUSED MapCoroutineStack(size_t numStackSlots)
+{
+    constexpr size_t x_protectionAreaSize = CoroutineRuntimeContext::x_stackOverflowProtectionAreaSize;
+    constexpr size_t x_granuleSize = CoroutineStackIndex::x_granuleSize;
+    size_t mappingLength = GetCoroutineStackMappingLength(numStackSlots);
+    assert(mappingLength >= x_initialCommittedStackBytes + x_protectionAreaSize * 2);
+
+    // Over-reserve by one granule so that an aligned range of 'mappingLength' must exist in it, then give back the unaligned head and tail
+    //
+    size_t overReservedLength = RoundUpToMultipleOf<x_granuleSize>(mappingLength) + x_granuleSize;
+    void* overReserved = mmap(nullptr, overReservedLength, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    VM_FAIL_WITH_ERRNO_IF(overReserved == MAP_FAILED,
+                          "Failed to reserve address range of length %llu",
+                          static_cast<unsigned long long>(overReservedLength));
+
+    uintptr_t overReservedStart = reinterpret_cast<uintptr_t>(overReserved);
+    uintptr_t overReservedEnd = overReservedStart + overReservedLength;
+    uintptr_t mappingStart = RoundUpToMultipleOf<x_granuleSize>(overReservedStart);
+    uintptr_t mappingEnd = mappingStart + mappingLength;
+    assert(mappingEnd <= overReservedEnd);
+    if (mappingStart > overReservedStart)
+    {
+        int r = munmap(overReserved, mappingStart - overReservedStart);
+        VM_FAIL_WITH_ERRNO_IF(r != 0, "Failed to unmap the unaligned head of coroutine stack reservation");
+    }
+    if (overReservedEnd > mappingEnd)
+    {
+        int r = munmap(reinterpret_cast<void*>(mappingEnd), overReservedEnd - mappingEnd);
+        VM_FAIL_WITH_ERRNO_IF(r != 0, "Failed to unmap the unaligned tail of coroutine stack reservation");
+    }
+    VM_FAIL_IF(mappingEnd > (static_cast<uintptr_t>(1) << CoroutineStackIndex::x_log2AddressSpaceSize),
+               "Coroutine stack is mapped at an address that cannot be indexed");
+
+    void* stackArea = mmap(reinterpret_cast<uint8_t*>(mappingStart) + x_protectionAreaSize,
+                           x_initialCommittedStackBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    VM_FAIL_WITH_ERRNO_IF(stackArea == MAP_FAILED,
+                          "Out of Memory: Allocation of length %llu failed", static_cast<unsigned long long>(x_initialCommittedStackBytes));
+    assert(reinterpret_cast<uintptr_t>(stackArea) == mappingStart + x_protectionAreaSize);
+    return reinterpret_cast<TValue*>(stackArea);
+}
+
+// Update the index entries for all the granules covered by the reservation of the stack
+// If 'isMapped' is false, the stack is being unmapped and the entries are cleared.
+//
+static void UpdateCoroutineStackIndex(VM* vm, TValue* stackBegin, size_t numStackSlots, CoroutineRuntimeContext* owner, bool isMapped)
+{
+    constexpr size_t x_log2GranuleSize = CoroutineStackIndex::x_log2GranuleSize;
+    constexpr size_t x_log2NumEntriesPerChunk = CoroutineStackIndex::x_log2NumEntriesPerChunk;
+    CoroutineStackIndex* index = vm->GetCoroutineStackIndex();
+    assert(isMapped || owner == nullptr);
+
+    uintptr_t mappingStart = reinterpret_cast<uintptr_t>(stackBegin) - CoroutineRuntimeContext::x_stackOverflowProtectionAreaSize;
+    uintptr_t mappingEnd = mappingStart + GetCoroutineStackMappingLength(numStackSlots);
+    assert(mappingStart % CoroutineStackIndex::x_granuleSize == 0);
+    for (size_t granuleOrd = mappingStart >> x_log2GranuleSize; granuleOrd <= (mappingEnd - 1) >> x_log2GranuleSize; granuleOrd++)
+    {
+        size_t chunkOrd = granuleOrd >> x_log2NumEntriesPerChunk;
+        assert(chunkOrd < CoroutineStackIndex::x_numChunks);
+        CoroutineStackIndex::Chunk* chunk = index->m_chunks[chunkOrd].load(std::memory_order_relaxed);
+        if (chunk == nullptr)
+        {
+            assert(isMapped);
+            // calloc gives us a zero-filled chunk, which is a chunk of empty entries
+            //
+            chunk = reinterpret_cast<CoroutineStackIndex::Chunk*>(calloc(1, sizeof(CoroutineStackIndex::Chunk)));
+            VM_FAIL_IF(chunk == nullptr, "Out of Memory: Allocation of length %llu failed", static_cast<unsigned long long>(sizeof(CoroutineStackIndex::Chunk)));
+            index->m_chunks[chunkOrd].store(chunk, std::memory_order_release);
+        }
+        CoroutineStackIndex::Entry& entry = chunk->m_entries[granuleOrd & (CoroutineStackIndex::x_numEntriesPerChunk - 1)];
+        assert(isMapped == (entry.m_stackBegin.load(std::memory_order_relaxed) == 0));
+        if (isMapped)
+        {
+            // Publish m_stackBegin before m_owner, since the fault handler only trusts m_stackBegin if it sees an owner
+            //
+            entry.m_stackBegin.store(reinterpret_cast<uintptr_t>(stackBegin), std::memory_order_relaxed);
+            entry.m_owner.store(owner, std::memory_order_release);
+        }
+        else
+        {
+            entry.m_owner.store(nullptr, std::memory_order_relaxed);
+            entry.m_stackBegin.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Set the owner of a mapped stack, used when a pooled stack is reused or recycled
+//
+static void SetCoroutineStackOwner(VM* vm, TValue* stackBegin, size_t numStackSlots, CoroutineRuntimeContext* owner)
+{
+    uintptr_t mappingStart = reinterpret_cast<uintptr_t>(stackBegin) - CoroutineRuntimeContext::x_stackOverflowProtectionAreaSize;
+    uintptr_t mappingEnd = mappingStart + GetCoroutineStackMappingLength(numStackSlots);
+    for (uintptr_t addr = mappingStart; addr < mappingEnd; addr += CoroutineStackIndex::x_granuleSize)
+    {
+        CoroutineStackIndex::Entry* entry = vm->GetCoroutineStackIndex()->TryGetEntry(addr);
+        assert(entry != nullptr && entry->m_stackBegin.load(std::memory_order_relaxed) == reinterpret_cast<uintptr_t>(stackBegin));
+        assert((owner == nullptr) != (entry->m_owner.load(std::memory_order_relaxed) == nullptr));
+        entry->m_owner.store(owner, std::memory_order_release);
+    }
+}
+
+static void UnmapCoroutineStack(VM* vm, TValue* stackBegin, size_t numStackSlots)
+{
+    UpdateCoroutineStackIndex(vm, stackBegin, numStackSlots, nullptr /*owner*/, false /*isMapped*/);
+
+    void* mappingStart = reinterpret_cast<uint8_t*>(stackBegin) - CoroutineRuntimeContext::x_stackOverflowProtectionAreaSize;
+    int r = munmap(mappingStart, GetCoroutineStackMappingLength(numStackSlots));
+    LOG_WARNING_WITH_ERRNO_IF(r != 0, "Cannot unmap coroutine stack");
+}
+
 CoroutineRuntimeContext* CoroutineRuntimeContext::Create(VM* vm, UserHeapPointer<TableObject> globalObject, size_t numStackSlots)
 {
     CoroutineRuntimeContext* r = TranslateToRawPointer(vm, vm->AllocFromUserHeap(static_cast<uint32_t>(sizeof(CoroutineRuntimeContext))).AsNoAssert<CoroutineRuntimeContext>());
@@ -235,37 +368,580 @@ CoroutineRuntimeContext* CoroutineRuntimeContext::Create(VM* vm, UserHeapPointer
     r->m_numVariadicRets = 0;
     r->m_variadicRetSlotBegin = 0;
     r->m_upvalueList.m_value = 0;
-    size_t bytesToAllocate = numStackSlots * sizeof(TValue);
-    bytesToAllocate = RoundUpToMultipleOf<VM::x_pageSize>(bytesToAllocate);
-    void* stackAreaWithOverflowProtection = mmap(nullptr, bytesToAllocate + x_stackOverflowProtectionAreaSize * 2,
-                                                 PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
-    VM_FAIL_WITH_ERRNO_IF(stackAreaWithOverflowProtection == MAP_FAILED,
-                          "Failed to reserve address range of length %llu",
-                          static_cast<unsigned long long>(bytesToAllocate + x_stackOverflowProtectionAreaSize * 2));
+    r->m_numStackSlots = SafeIntegerCast<uint32_t>(numStackSlots);
+    r->m_numCommittedStackSlots = static_cast<uint32_t>(x_initialCommittedStackBytes / sizeof(TValue));
 
-    void* stackArea = mmap(reinterpret_cast<uint8_t*>(stackAreaWithOverflowProtection) + x_stackOverflowProtectionAreaSize,
-                           bytesToAllocate, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
-    VM_FAIL_WITH_ERRNO_IF(stackArea == MAP_FAILED,
-                          "Out of Memory: Allocation of length %llu failed", static_cast<unsigned long long>(bytesToAllocate));
-    assert(stackArea == reinterpret_cast<uint8_t*>(stackAreaWithOverflowProtection) + x_stackOverflowProtectionAreaSize);
-    r->m_stackBegin = reinterpret_cast<TValue*>(stackArea);
+    // Only stacks of the default size are pooled, and a pooled stack has been shrunk to the initial committed size
+    //
+    TValue*& poolHead = vm->GetCoroutineStackPoolHead();
+    if (numStackSlots == x_defaultStackSlots && poolHead != nullptr)
+    {
+        uint32_t& poolSize = vm->GetCoroutineStackPoolSize();
+        assert(poolSize > 0);
+        r->m_stackBegin = poolHead;
+        poolHead = reinterpret_cast<TValue**>(poolHead)[0];
+        poolSize--;
+
+        SetCoroutineStackOwner(vm, r->m_stackBegin, numStackSlots, r /*owner*/);
+    }
+    else
+    {
+        r->m_stackBegin = MapCoroutineStack(numStackSlots);
+        UpdateCoroutineStackIndex(vm, r->m_stackBegin, numStackSlots, r /*owner*/, true /*isMapped*/);
+    }
     return r;
 }
 
+bool WARN_UNUSED CoroutineRuntimeContext::TryCommitStackSlots(size_t numSlots)
+{
+    if (likely(numSlots <= m_numCommittedStackSlots))
+    {
+        return true;
+    }
+    if (numSlots > m_numStackSlots)
+    {
+        return false;
+    }
+
+    // Grow geometrically so that a deeply recursing coroutine only faults a logarithmic number of times
+    //
+    size_t newNumSlots = std::max(numSlots, static_cast<size_t>(m_numCommittedStackSlots) * 2);
+    size_t newBytes = std::min(RoundUpToMultipleOf<VM::x_pageSize>(newNumSlots * sizeof(TValue)),
+                               RoundUpToMultipleOf<VM::x_pageSize>(static_cast<size_t>(m_numStackSlots) * sizeof(TValue)));
+    size_t oldBytes = static_cast<size_t>(m_numCommittedStackSlots) * sizeof(TValue);
+    assert(oldBytes % VM::x_pageSize == 0 && newBytes > oldBytes);
+
+    // mprotect is async-signal-safe, so this is fine to be called from the fault handler
+    //
+    int r = mprotect(reinterpret_cast<uint8_t*>(m_stackBegin) + oldBytes, newBytes - oldBytes, PROT_READ | PROT_WRITE);
+    if (r != 0)
+    {
+        return false;
+    }
+    m_numCommittedStackSlots = static_cast<uint32_t>(newBytes / sizeof(TValue));
+    return true;
+}
+
+void CoroutineRuntimeContext::ReleaseStack(VM* vm)
+{
+    assert(m_coroutineStatus.IsDead());
+    assert(m_stackBegin != nullptr);
+
+    // The upvalues pointing into the stack must not outlive it
+    //
+    CloseUpvalues(m_stackBegin);
+    assert(m_upvalueList.m_value == 0);
+
+    TValue* stack = m_stackBegin;
+    m_stackBegin = nullptr;
+
+    uint32_t& poolSize = vm->GetCoroutineStackPoolSize();
+    if (m_numStackSlots == x_defaultStackSlots && poolSize < x_maxPooledStacks)
+    {
+        // Give the pages beyond the initial committed size back to the OS
+        //
+        size_t committedBytes = static_cast<size_t>(m_numCommittedStackSlots) * sizeof(TValue);
+        if (committedBytes > x_initialCommittedStackBytes)
+        {
+            void* shrinkStart = reinterpret_cast<uint8_t*>(stack) + x_initialCommittedStackBytes;
+            size_t shrinkLength = committedBytes - x_initialCommittedStackBytes;
+            int r = madvise(shrinkStart, shrinkLength, MADV_DONTNEED);
+            LOG_WARNING_WITH_ERRNO_IF(r != 0, "Failed to release the memory of coroutine stack");
+            r = mprotect(shrinkStart, shrinkLength, PROT_NONE);
+            VM_FAIL_WITH_ERRNO_IF(r != 0, "Failed to shrink coroutine stack");
+            m_numCommittedStackSlots = static_cast<uint32_t>(x_initialCommittedStackBytes / sizeof(TValue));
+        }
+
+        SetCoroutineStackOwner(vm, stack, m_numStackSlots, nullptr /*owner*/);
+
+        TValue*& poolHead = vm->GetCoroutineStackPoolHead();
+        reinterpret_cast<TValue**>(stack)[0] = poolHead;
+        poolHead = stack;
+        poolSize++;
+    }
+    else
+    {
+        UnmapCoroutineStack(vm, stack, m_numStackSlots);
+    }
+}
+
+void CoroutineRuntimeContext::DrainStackPool(VM* vm)
+{
+    TValue*& poolHead = vm->GetCoroutineStackPoolHead();
+    while (poolHead != nullptr)
+    {
+        TValue* stack = poolHead;
+        poolHead = reinterpret_cast<TValue**>(stack)[0];
+        UnmapCoroutineStack(vm, stack, x_defaultStackSlots);
+    }
+    vm->GetCoroutineStackPoolSize() = 0;
+}
+
+bool WARN_UNUSED CoroutineRuntimeContext::HandleStackFault(VM* vm, uintptr_t faultAddr)
+{
+    CoroutineStackIndex* index = vm->GetCoroutineStackIndex();
+    if (index == nullptr)
+    {
+        return false;
+    }
+    CoroutineStackIndex::Entry* entry = index->TryGetEntry(faultAddr);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    CoroutineRuntimeContext* coro = entry->m_owner.load(std::memory_order_acquire);
+    if (coro == nullptr)
+    {
+        return false;
+    }
+    uintptr_t stackBegin = entry->m_stackBegin.load(std::memory_order_relaxed);
+    assert(reinterpret_cast<uintptr_t>(coro->m_stackBegin) == stackBegin);
+    // The granule may also contain the protection area below the stack, or an unrelated mapping after the end of the reservation
+    //
+    if (faultAddr < stackBegin)
+    {
+        return false;
+    }
+    size_t offset = faultAddr - stackBegin;
+    size_t slotOrd = offset / sizeof(TValue);
+    if (slotOrd < coro->m_numCommittedStackSlots)
+    {
+        // The fault is not caused by the stack being too small
+        //
+        return false;
+    }
+    // The function entry logic throws a catchable stack overflow error before a frame can reach the last x_stackOverflowReservedSlots slots
+    // of the stack (see DeegenSnippet_CheckStackOverflowOnFunctionEntry), so a fault beyond the reserved range can only come from a library
+    // function that writes far beyond its own frame (e.g., unpack of a huge table), and we let it crash as usual.
+    //
+    return coro->TryCommitStackSlots(slotOrd + 1);
+}
+
+namespace {
+
+thread_local VM* t_vmForStackFaultHandler = nullptr;
+struct sigaction g_previousSigsegvAction;
+
+void CoroutineStackFaultHandler(int sig, siginfo_t* info, void* context)
+{
+    VM* vm = t_vmForStackFaultHandler;
+    if (vm != nullptr && CoroutineRuntimeContext::HandleStackFault(vm, reinterpret_cast<uintptr_t>(info->si_addr)))
+    {
+        // The faulting instruction will be retried and succeed
+        //
+        return;
+    }
+
+    // Not our fault: forward to the previous handler
+    //
+    if (g_previousSigsegvAction.sa_flags & SA_SIGINFO)
+    {
+        g_previousSigsegvAction.sa_sigaction(sig, info, context);
+    }
+    else if (g_previousSigsegvAction.sa_handler != SIG_DFL && g_previousSigsegvAction.sa_handler != SIG_IGN)
+    {
+        g_previousSigsegvAction.sa_handler(sig);
+    }
+    else
+    {
+        // Restore the default action and return, so the faulting instruction faults again and kills the process as usual
+        //
+        signal(SIGSEGV, SIG_DFL);
+    }
+}
+
+}   // anonymous namespace
+
+void CoroutineRuntimeContext::InstallStackFaultHandler(VM* vm)
+{
+    static std::once_flag installed;
+    std::call_once(installed, []()
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = CoroutineStackFaultHandler;
+        sa.sa_flags = SA_SIGINFO;
+        sigemptyset(&sa.sa_mask);
+        int r = sigaction(SIGSEGV, &sa, &g_previousSigsegvAction);
+        VM_FAIL_WITH_ERRNO_IF(r != 0, "Failed to install the SIGSEGV handler for coroutine stack growth");
+    });
+    t_vmForStackFaultHandler = vm;
+}
+
+void CoroutineRuntimeContext::UninstallStackFaultHandler(VM* vm)
+{
+    if (t_vmForStackFaultHandler == vm)
+    {
+        t_vmForStackFaultHandler = nullptr;
+    }
+    CoroutineStackIndex* index = vm->GetCoroutineStackIndex();
+    vm->GetCoroutineStackIndex() = nullptr;
+    if (index != nullptr)
+    {
+        for (size_t i = 0; i < CoroutineStackIndex::x_numChunks; i++)
+        {
+            free(index->m_chunks[i].load(std::memory_order_relaxed));
+        }
+        delete index;
+    }
+}
+
+HeapPtr<HeapCDataObject> WARN_UNUSED LuaFileHandle::Create(VM* vm, Kind kind, int fd)
+{
+    HeapPtr<HeapCDataObject> hp = HeapCDataObject::Create(vm, HeapCDataObject::Kind::LuaFile, vm->m_metatableForFileHandle, static_cast<uint32_t>(sizeof(LuaFileHandle)));
+    LuaFileHandle* r = TranslateToRawPointer(vm, hp)->GetPayload<LuaFileHandle>();
+    ConstructInPlace(r);
+    r->m_fd = fd;
+    r->m_kind = kind;
+    r->m_bufferMode = (kind == Kind::Stderr) ? BufferMode::No : BufferMode::Full;
+    r->m_isClosed = false;
+    r->m_hasPendingOutput = false;
+    r->m_closeAtEof = false;
+    r->m_buffer = nullptr;
+    r->m_bufferCapacity = 0;
+    r->m_bufferBegin = 0;
+    r->m_bufferEnd = 0;
+    r->m_prevOpenFile = nullptr;
+    r->m_nextOpenFile = nullptr;
+    if (kind == Kind::Regular)
+    {
+        r->m_nextOpenFile = vm->m_openFileListHead;
+        if (vm->m_openFileListHead != nullptr)
+        {
+            vm->m_openFileListHead->m_prevOpenFile = r;
+        }
+        vm->m_openFileListHead = r;
+    }
+    return hp;
+}
+
+bool WARN_UNUSED LuaFileHandle::EnsureBufferAllocated()
+{
+    if (likely(m_buffer != nullptr))
+    {
+        return true;
+    }
+    m_buffer = new (std::nothrow) char[x_initialBufferSize];
+    if (m_buffer == nullptr)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+    m_bufferCapacity = x_initialBufferSize;
+    m_bufferBegin = 0;
+    m_bufferEnd = 0;
+    return true;
+}
+
+static bool WARN_UNUSED WriteAllToFileDescriptor(int fd, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t written = write(fd, data, len);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        len -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool WARN_UNUSED LuaFileHandle::WritePendingOutput()
+{
+    assert(m_hasPendingOutput && m_bufferBegin == 0);
+    bool success = WriteAllToFileDescriptor(m_fd, m_buffer, m_bufferEnd);
+    m_bufferEnd = 0;
+    m_hasPendingOutput = false;
+    return success;
+}
+
+void LuaFileHandle::GiveBackBufferedInput()
+{
+    assert(!m_hasPendingOutput);
+    if (m_bufferBegin < m_bufferEnd)
+    {
+        // This fails if the file is not seekable (e.g., a pipe), in which case the unconsumed input is simply lost, as in stdio
+        //
+        std::ignore = lseek(m_fd, -static_cast<off_t>(m_bufferEnd - m_bufferBegin), SEEK_CUR);
+    }
+    m_bufferBegin = 0;
+    m_bufferEnd = 0;
+}
+
+bool WARN_UNUSED LuaFileHandle::PrepareForRead()
+{
+    assert(IsReadable() && !m_isClosed);
+    if (m_hasPendingOutput)
+    {
+        if (!WritePendingOutput())
+        {
+            return false;
+        }
+    }
+    return EnsureBufferAllocated();
+}
+
+ssize_t WARN_UNUSED LuaFileHandle::FillBuffer()
+{
+    assert(m_buffer != nullptr && !m_hasPendingOutput);
+    if (m_bufferBegin > 0)
+    {
+        uint32_t numBytes = m_bufferEnd - m_bufferBegin;
+        memmove(m_buffer, m_buffer + m_bufferBegin, numBytes);
+        m_bufferBegin = 0;
+        m_bufferEnd = numBytes;
+    }
+    if (m_bufferEnd == m_bufferCapacity)
+    {
+        // The unconsumed input fills the whole buffer (e.g., a line longer than the buffer), grow the buffer
+        //
+        if (m_bufferCapacity > std::numeric_limits<uint32_t>::max() / 2)
+        {
+            errno = EFBIG;
+            return -1;
+        }
+        uint32_t newCapacity = m_bufferCapacity * 2;
+        char* newBuffer = new (std::nothrow) char[newCapacity];
+        if (newBuffer == nullptr)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        memcpy(newBuffer, m_buffer, m_bufferEnd);
+        delete [] m_buffer;
+        m_buffer = newBuffer;
+        m_bufferCapacity = newCapacity;
+    }
+    if (m_kind == Kind::Stdin)
+    {
+        // A prompt written to stdout must become visible before we block waiting for the user's input
+        //
+        std::ignore = VM::GetActiveVMForCurrentThread()->FlushStdout();
+    }
+    while (true)
+    {
+        ssize_t numRead = read(m_fd, m_buffer + m_bufferEnd, m_bufferCapacity - m_bufferEnd);
+        if (numRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (numRead > 0)
+        {
+            m_bufferEnd += static_cast<uint32_t>(numRead);
+        }
+        return numRead;
+    }
+}
+
+bool WARN_UNUSED LuaFileHandle::Write(VM* vm, const void* data, size_t len)
+{
+    assert(!m_isClosed);
+    if (m_kind == Kind::Stdout)
+    {
+        return vm->WriteToStdout(data, len);
+    }
+    if (m_kind == Kind::Stderr)
+    {
+        return fwrite(data, 1, len, vm->GetStderr()) == len;
+    }
+    if (m_kind == Kind::Stdin)
+    {
+        errno = EBADF;
+        return false;
+    }
+
+    if (!m_hasPendingOutput)
+    {
+        GiveBackBufferedInput();
+        if (!EnsureBufferAllocated())
+        {
+            return false;
+        }
+        m_hasPendingOutput = true;
+    }
+
+    const char* ptr = reinterpret_cast<const char*>(data);
+    if (len <= m_bufferCapacity - m_bufferEnd)
+    {
+        memcpy(m_buffer + m_bufferEnd, ptr, len);
+        m_bufferEnd += static_cast<uint32_t>(len);
+    }
+    else
+    {
+        if (!WritePendingOutput())
+        {
+            return false;
+        }
+        if (len >= m_bufferCapacity)
+        {
+            return WriteAllToFileDescriptor(m_fd, ptr, len);
+        }
+        memcpy(m_buffer, ptr, len);
+        m_bufferEnd = static_cast<uint32_t>(len);
+        m_hasPendingOutput = true;
+    }
+
+    if (m_bufferMode == BufferMode::No || (m_bufferMode == BufferMode::Line && memchr(ptr, '\n', len) != nullptr))
+    {
+        return WritePendingOutput();
+    }
+    return true;
+}
+
+bool WARN_UNUSED LuaFileHandle::WriteNumber(VM* vm, double value)
+{
+    if (m_kind == Kind::Stdout)
+    {
+        return vm->WriteNumberToStdout(value);
+    }
+    char buf[x_default_tostring_buffersize_double];
+    char* bufEnd = StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, value);
+    return Write(vm, buf, static_cast<size_t>(bufEnd - buf));
+}
+
+bool WARN_UNUSED LuaFileHandle::Flush(VM* vm)
+{
+    assert(!m_isClosed);
+    if (m_kind == Kind::Stdout)
+    {
+        return vm->FlushStdout();
+    }
+    if (m_kind == Kind::Stderr)
+    {
+        return fflush(vm->GetStderr()) == 0;
+    }
+    if (m_hasPendingOutput)
+    {
+        return WritePendingOutput();
+    }
+    return true;
+}
+
+int64_t WARN_UNUSED LuaFileHandle::Seek(VM* vm, int whence, int64_t offset)
+{
+    assert(!m_isClosed);
+    if (m_kind == Kind::Stdout || m_kind == Kind::Stderr)
+    {
+        if (m_kind == Kind::Stdout && !vm->FlushStdout())
+        {
+            return -1;
+        }
+        FILE* fp = (m_kind == Kind::Stdout) ? vm->GetStdout() : vm->GetStderr();
+        if (fseeko(fp, static_cast<off_t>(offset), whence) != 0)
+        {
+            return -1;
+        }
+        return static_cast<int64_t>(ftello(fp));
+    }
+
+    if (m_hasPendingOutput)
+    {
+        if (!WritePendingOutput())
+        {
+            return -1;
+        }
+    }
+    else if (whence == SEEK_CUR)
+    {
+        // The file position is ahead of the position seen by the user program by the amount of unconsumed input
+        //
+        offset -= static_cast<int64_t>(m_bufferEnd - m_bufferBegin);
+    }
+    m_bufferBegin = 0;
+    m_bufferEnd = 0;
+    return static_cast<int64_t>(lseek(m_fd, static_cast<off_t>(offset), whence));
+}
+
+bool WARN_UNUSED LuaFileHandle::Close(VM* vm)
+{
+    assert(m_kind == Kind::Regular && !m_isClosed);
+    bool success = true;
+    if (m_hasPendingOutput)
+    {
+        success = WritePendingOutput();
+    }
+    int savedErrno = errno;
+    if (close(m_fd) != 0)
+    {
+        success = false;
+    }
+    else if (!success)
+    {
+        errno = savedErrno;
+    }
+    m_fd = -1;
+    m_isClosed = true;
+    delete [] m_buffer;
+    m_buffer = nullptr;
+    m_bufferCapacity = 0;
+    m_bufferBegin = 0;
+    m_bufferEnd = 0;
+
+    if (m_prevOpenFile != nullptr)
+    {
+        m_prevOpenFile->m_nextOpenFile = m_nextOpenFile;
+    }
+    else
+    {
+        assert(vm->m_openFileListHead == this);
+        vm->m_openFileListHead = m_nextOpenFile;
+    }
+    if (m_nextOpenFile != nullptr)
+    {
+        m_nextOpenFile->m_prevOpenFile = m_prevOpenFile;
+    }
+    m_prevOpenFile = nullptr;
+    m_nextOpenFile = nullptr;
+    return success;
+}
+
+void LuaFileHandle::CloseAllOpenFiles(VM* vm)
+{
+    while (vm->m_openFileListHead != nullptr)
+    {
+        std::ignore = vm->m_openFileListHead->Close(vm);
+    }
+}
+
 BaselineCodeBlock* WARN_UNUSED BaselineCodeBlock::Create(CodeBlock* cb,
                                                          uint32_t numBytecodes,
                                                          uint32_t slowPathDataStreamLength,
                                                          void* jitCodeEntry,
                                                          void* jitRegionStart,
-                                                         uint32_t jitRegionSize)
+                                                         uint32_t jitRegionSize,
+                                                         void* jitDataSecStart)
 {
     size_t numEntriesInConstantTable = cb->m_owner->m_cstTableLength;
-    static_assert(alignof(BaselineCodeBlock) == 8);         // the computation below relies on this
-    size_t sizeToAllocate = sizeof(TValue) * numEntriesInConstantTable + GetTrailingArrayOffset() + sizeof(SlowPathDataAndBytecodeOffset) * numBytecodes + slowPathDataStreamLength;
-    sizeToAllocate = RoundUpToMultipleOf<8>(sizeToAllocate);
+    uint32_t sizeToAllocate = ComputeAllocationSize(numEntriesInConstantTable, numBytecodes, slowPathDataStreamLength);
 
     VM* vm = VM::GetActiveVMForCurrentThread();
-    uint8_t* addressBegin = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(static_cast<uint32_t>(sizeToAllocate)).AsNoAssert<uint8_t>());
+    uint8_t* addressBegin;
+    auto freeListIt = vm->GetBaselineCodeBlockFreeLists().find(sizeToAllocate);
+    if (freeListIt != vm->GetBaselineCodeBlockFreeLists().end())
+    {
+        // The first 4 bytes of a free allocation is the next allocation in the list
+        //
+        addressBegin = TranslateToRawPointer(vm, SystemHeapPointer<uint8_t>(freeListIt->second).As());
+        uint32_t next = *reinterpret_cast<uint32_t*>(addressBegin);
+        if (next == 0)
+        {
+            vm->GetBaselineCodeBlockFreeLists().erase(freeListIt);
+        }
+        else
+        {
+            freeListIt->second = next;
+        }
+    }
+    else
+    {
+        addressBegin = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(sizeToAllocate).AsNoAssert<uint8_t>());
+    }
     memcpy(addressBegin, cb->m_owner->m_cstTable, sizeof(TValue) * numEntriesInConstantTable);
 
     BaselineCodeBlock* res = reinterpret_cast<BaselineCodeBlock*>(addressBegin + sizeof(TValue) * numEntriesInConstantTable);
@@ -279,13 +955,28 @@ BaselineCodeBlock* WARN_UNUSED BaselineCodeBlock::Create(CodeBlock* cb,
     res->m_slowPathDataStreamLength = slowPathDataStreamLength;
     res->m_jitRegionStart = jitRegionStart;
     res->m_jitRegionSize = jitRegionSize;
+    res->m_jitDataSecStart = jitDataSecStart;
 
-    TestAssert(cb->m_baselineCodeBlock == nullptr);
-    cb->m_baselineCodeBlock = res;
-
+    // Note that the caller is responsible for linking the BaselineCodeBlock to the CodeBlock once the codegen is done
+    //
     return res;
 }
 
+void BaselineCodeBlock::Free(VM* vm)
+{
+    assert(m_owner->m_baselineCodeBlock != this);
+    size_t numEntriesInConstantTable = m_owner->m_owner->m_cstTableLength;
+    uint32_t allocationSize = ComputeAllocationSize(numEntriesInConstantTable, m_numBytecodes, m_slowPathDataStreamLength);
+    uint8_t* addressBegin = reinterpret_cast<uint8_t*>(this) - sizeof(TValue) * numEntriesInConstantTable;
+    uint32_t self = SystemHeapPointer<uint8_t>(addressBegin).m_value;
+
+    // Zero means an empty list, which works since the system heap never hands out offset 0 (the VM struct lives there)
+    //
+    uint32_t& freeList = vm->GetBaselineCodeBlockFreeLists()[allocationSize];
+    *reinterpret_cast<uint32_t*>(addressBegin) = freeList;
+    freeList = self;
+}
+
 JitCallInlineCacheEntry* WARN_UNUSED JitCallInlineCacheEntry::Create(VM* vm,
                                                                      ExecutableCode* targetExecutableCode,
                                                                      SpdsPtr<JitCallInlineCacheEntry> callSiteNextNode,
@@ -311,6 +1002,15 @@ JitCallInlineCacheEntry* WARN_UNUSED JitCallInlineCacheEntry::Create(VM* vm,
     assert(entry->GetJitRegionStart() == regionVoidPtr);
     assert(entry->GetIcTrait() == trait);
 
+    if (trait->m_jitDataAllocationLengthStepping == x_jit_mem_alloc_stepping_none)
+    {
+        entry->m_jitDataSecAddr = nullptr;
+    }
+    else
+    {
+        entry->m_jitDataSecAddr = reinterpret_cast<uint8_t*>(vm->GetJITDataMemoryAlloc()->AllocateGivenStepping(trait->m_jitDataAllocationLengthStepping));
+    }
+
     assert(!entry->IsOnDoublyLinkedList());
     if (targetExecutableCode->IsBytecodeFunction())
     {
@@ -330,10 +1030,14 @@ void JitCallInlineCacheEntry::Destroy(VM* vm)
         RemoveFromDoublyLinkedList();
     }
     vm->GetJITMemoryAlloc()->Free(GetJitRegionStart());
+    if (m_jitDataSecAddr != nullptr)
+    {
+        vm->GetJITDataMemoryAlloc()->Free(m_jitDataSecAddr);
+    }
     vm->DeallocateSpdsRegionObject(this);
 }
 
-void* WARN_UNUSED JitCallInlineCacheSite::InsertInDirectCallMode(uint16_t dcIcTraitKind, TValue tv, uint8_t* transitedToCCMode /*out*/)
+void* WARN_UNUSED JitCallInlineCacheSite::InsertInDirectCallMode(uint16_t dcIcTraitKind, TValue tv, uint8_t* transitedToCCMode /*out*/, void** jitDataSecAddr /*out*/)
 {
     assert(m_numEntries < x_maxEntries);
     assert(m_mode == Mode::DirectCall);
@@ -424,6 +1128,7 @@ void* WARN_UNUSED JitCallInlineCacheSite::InsertInDirectCallMode(uint16_t dcIcTr
         TCSet(m_linkedListHead, SpdsPtr<JitCallInlineCacheEntry> { newEntry });
 
         *transitedToCCMode = 0;
+        *jitDataSecAddr = newEntry->m_jitDataSecAddr;
         return newEntry->GetJitRegionStart();
     }
 
@@ -454,10 +1159,11 @@ void* WARN_UNUSED JitCallInlineCacheSite::InsertInDirectCallMode(uint16_t dcIcTr
     m_bloomFilter = 0;
 
     *transitedToCCMode = 1;
+    *jitDataSecAddr = entry->m_jitDataSecAddr;
     return entry->GetJitRegionStart();
 }
 
-void* WARN_UNUSED JitCallInlineCacheSite::InsertInClosureCallMode(uint16_t dcIcTraitKind, TValue tv)
+void* WARN_UNUSED JitCallInlineCacheSite::InsertInClosureCallMode(uint16_t dcIcTraitKind, TValue tv, void** jitDataSecAddr /*out*/)
 {
     assert(m_numEntries < x_maxEntries);
     assert(m_mode == Mode::ClosureCall || m_mode == Mode::ClosureCallWithMoreThanOneTargetObserved);
@@ -503,5 +1209,21 @@ void* WARN_UNUSED JitCallInlineCacheSite::InsertInClosureCallMode(uint16_t dcIcT
                                                                      dcIcTraitKind + 1 /*icTraitKind*/);
     TCSet(m_linkedListHead, SpdsPtr<JitCallInlineCacheEntry> { entry });
     m_numEntries++;
+    *jitDataSecAddr = entry->m_jitDataSecAddr;
     return entry->GetJitRegionStart();
 }
+
+void JitCallInlineCacheSite::DestroyAllEntries(VM* vm)
+{
+    SpdsPtr<JitCallInlineCacheEntry> node = TCGet(m_linkedListHead);
+    while (!node.IsInvalidPtr())
+    {
+        JitCallInlineCacheEntry* entry = TranslateToRawPointer(vm, node.AsPtr());
+        node = TCGet(entry->m_callSiteNextNode);
+        entry->Destroy(vm);
+    }
+    TCSet(m_linkedListHead, SpdsPtr<JitCallInlineCacheEntry> { 0 });
+    m_numEntries = 0;
+    m_mode = Mode::DirectCall;
+    m_bloomFilter = 0;
+}
@@ -110,17 +110,124 @@ struct CoroutineStatus
 //
 static_assert(sizeof(CoroutineStatus) == 1);
 
+// Maps the address range of every stack mapped by CoroutineRuntimeContext to the stack, so the SIGSEGV handler can find the coroutine from the faulting address
+//
+// Every stack reservation begins at a multiple of x_granuleSize, so a granule (the address range [k * x_granuleSize, (k + 1) * x_granuleSize))
+// overlaps with at most one stack. The index is a two-level radix table keyed by the granule ordinal: the top level is allocated with the VM,
+// and a leaf chunk is allocated the first time a stack is mapped into its address range and is kept until the VM is destroyed.
+// So mapping or unmapping a stack only updates the O(1) entries covering its reservation, and existing entries never move.
+//
+// The SIGSEGV handler may interrupt the VM at any point, so every chunk is zero-filled before it is published with a release store,
+// and every entry is updated by atomic stores. The index is only modified on the VM thread.
+//
+struct CoroutineStackIndex
+{
+    static constexpr size_t x_log2GranuleSize = 24;
+    static constexpr size_t x_granuleSize = static_cast<size_t>(1) << x_log2GranuleSize;
+    // Only user-space addresses of a 4-level page table can be indexed. Linux never returns higher addresses from mmap without an explicit hint.
+    //
+    static constexpr size_t x_log2AddressSpaceSize = 47;
+    static constexpr size_t x_log2NumEntriesPerChunk = 12;
+    static constexpr size_t x_numEntriesPerChunk = static_cast<size_t>(1) << x_log2NumEntriesPerChunk;
+    static constexpr size_t x_numChunks = static_cast<size_t>(1) << (x_log2AddressSpaceSize - x_log2GranuleSize - x_log2NumEntriesPerChunk);
+
+    struct Entry
+    {
+        // 0 if no stack overlaps with the granule
+        //
+        std::atomic<uintptr_t> m_stackBegin;
+        // nullptr if no stack overlaps with the granule or the stack is in the pool
+        //
+        std::atomic<CoroutineRuntimeContext*> m_owner;
+    };
+
+    struct Chunk
+    {
+        Entry m_entries[x_numEntriesPerChunk];
+    };
+
+    // Return nullptr if the address has never been covered by a stack
+    //
+    Entry* WARN_UNUSED TryGetEntry(uintptr_t addr)
+    {
+        size_t granuleOrd = addr >> x_log2GranuleSize;
+        if (granuleOrd >= x_numChunks * x_numEntriesPerChunk)
+        {
+            return nullptr;
+        }
+        Chunk* chunk = m_chunks[granuleOrd >> x_log2NumEntriesPerChunk].load(std::memory_order_acquire);
+        if (chunk == nullptr)
+        {
+            return nullptr;
+        }
+        return &chunk->m_entries[granuleOrd & (x_numEntriesPerChunk - 1)];
+    }
+
+    std::atomic<Chunk*> m_chunks[x_numChunks];
+};
+
 class alignas(8) CoroutineRuntimeContext
 {
 public:
     static constexpr uint32_t x_hiddenClassForCoroutineRuntimeContext = 0x10;
-    static constexpr size_t x_defaultStackSlots = 4096;
-    static constexpr size_t x_rootCoroutineDefaultStackSlots = 16384;
+    // The number of stack slots is the size of the address range reserved for the stack.
+    // Only the first x_initialCommittedStackSlots slots (rounded up to a page) are accessible initially, and the rest is made accessible on demand
+    // by the fault handler (see HandleStackFault), so a coroutine that never recurses deeply costs only a few pages of memory.
+    //
+    // Since the address range never moves, the stack never needs to be relocated, so the raw pointers into the stack
+    // (StackFrameHeader, open upvalues, m_suspendPointStackBase, and the stack base held by the running code) stay valid.
+    //
+    // The reserved size is a tradeoff between the max recursion depth inside a coroutine and the virtual address space
+    // held by every live coroutine. 1M slots reserves 8MB (plus the protection areas) per coroutine, the same as a
+    // default thread stack. Each reservation is aligned to CoroutineStackIndex::x_granuleSize (16MB), which still allows
+    // over eight million live coroutines in a 47-bit address space. The reservation is PROT_NONE and MAP_NORESERVE,
+    // so it costs no memory and is not counted against the overcommit limit.
+    // Note that each stack takes up to 3 kernel VMAs, so vm.max_map_count (65530 by default) is hit long before the address space is
+    // exhausted, and that limit does not depend on the reserved size.
+    //
+    static constexpr size_t x_defaultStackSlots = 1 << 20;
+    static constexpr size_t x_rootCoroutineDefaultStackSlots = 1 << 22;
+    static constexpr size_t x_initialCommittedStackSlots = 256;
     static constexpr size_t x_stackOverflowProtectionAreaSize = 65536;
     static_assert(x_stackOverflowProtectionAreaSize % VM::x_pageSize == 0);
+    static_assert(x_initialCommittedStackSlots <= x_defaultStackSlots && x_defaultStackSlots <= x_rootCoroutineDefaultStackSlots);
+    // The function entry logic throws a "stack overflow" error if the frame of the callee would end within the last
+    // x_stackOverflowReservedSlots slots of the stack. The reserved slots leave room for the error path (e.g., the xpcall message handler).
+    //
+    static constexpr size_t x_stackOverflowReservedSlots = 8192;
+    static_assert(x_stackOverflowReservedSlots < x_defaultStackSlots);
+    // The max number of dead coroutine stacks kept in the VM for reuse. Stacks released when the pool is full are unmapped.
+    //
+    static constexpr uint32_t x_maxPooledStacks = 256;
 
     static CoroutineRuntimeContext* Create(VM* vm, UserHeapPointer<TableObject> globalObject, size_t numStackSlots = x_defaultStackSlots);
 
+    // Must be called once the coroutine becomes dead and its stack is no longer needed (i.e., the return values or
+    // the error object have been moved out of the stack). The stack is recycled for new coroutines.
+    //
+    void ReleaseStack(VM* vm);
+
+    // Unmap all the stacks in the pool, called on VM destruction
+    //
+    static void DrainStackPool(VM* vm);
+
+    // Make the first 'numSlots' slots of the stack accessible
+    // Return false if 'numSlots' exceeds the reserved size of the stack or the mprotect failed.
+    // Only calls mprotect, so it is safe to be called from the fault handler.
+    //
+    bool WARN_UNUSED TryCommitStackSlots(size_t numSlots);
+
+    // Install the SIGSEGV handler that grows the coroutine stacks of 'vm' on demand for the current thread
+    // The handler is process-wide, and faults not caused by an access to the uncommitted part of a stack are forwarded to the previous handler.
+    //
+    static void InstallStackFaultHandler(VM* vm);
+    static void UninstallStackFaultHandler(VM* vm);
+
+    // Called by the SIGSEGV handler. Return true if the fault is resolved by growing the stack.
+    // This must be async-signal-safe: it only reads the CoroutineStackIndex and calls mprotect.
+    //
+    static bool WARN_UNUSED HandleStackFault(VM* vm, uintptr_t faultAddr);
+
     void CloseUpvalues(TValue* base);
 
     uint32_t m_hiddenClass;  // Always x_hiddenClassForCoroutineRuntimeContext
@@ -162,9 +269,17 @@ public:
     //
     UserHeapPointer<TableObject> m_globalObject;
 
-    // The beginning of the stack
+    // The beginning of the stack, nullptr if the coroutine is dead and its stack has been released
     //
     TValue* m_stackBegin;
+
+    // The number of slots in the address range reserved for the stack
+    //
+    uint32_t m_numStackSlots;
+
+    // The number of slots at the beginning of the stack that are accessible, always a multiple of the page size
+    //
+    uint32_t m_numCommittedStackSlots;
 };
 
 UserHeapPointer<TableObject> CreateGlobalObject(VM* vm);
@@ -286,6 +401,10 @@ public:
     //
     uint64_t m_taggedPtr;
 
+    // The data section of the IC, allocated from the (non-executable) JIT data memory. nullptr if the IC has no data section
+    //
+    uint8_t* m_jitDataSecAddr;
+
     // Get the ExecutableCode of the function target cached by this IC
     //
     ExecutableCode* WARN_UNUSED GetTargetExecutableCode(VM* vm);
@@ -326,12 +445,15 @@ public:
     void UpdateTargetFunctionCodePtr(uint64_t diff)
     {
         const JitCallInlineCacheTraits* trait = GetIcTrait();
-        uint8_t* jitBaseAddr = GetJitRegionStart();
+        uint8_t* jitBaseAddr = GetJitWritableAlias(GetJitRegionStart());
+        uint8_t* dataSecBaseAddr = (m_jitDataSecAddr == nullptr) ? nullptr : GetJitWritableAlias(m_jitDataSecAddr);
         size_t numPatches = trait->m_numCodePtrUpdatePatches;
         assert(numPatches > 0);
         size_t i = 0;
         do {
-            uint8_t* addr = jitBaseAddr + trait->m_codePtrPatchRecords[i].m_offset;
+            AssertImp(trait->m_codePtrPatchRecords[i].m_isInDataSection, dataSecBaseAddr != nullptr);
+            uint8_t* baseAddr = trait->m_codePtrPatchRecords[i].m_isInDataSection ? dataSecBaseAddr : jitBaseAddr;
+            uint8_t* addr = baseAddr + trait->m_codePtrPatchRecords[i].m_offset;
             if (trait->m_codePtrPatchRecords[i].m_is64)
             {
                 UnalignedStore<uint64_t>(addr, UnalignedLoad<uint64_t>(addr) + diff);
@@ -344,7 +466,7 @@ public:
         } while (unlikely(i < numPatches));
     }
 };
-static_assert(sizeof(JitCallInlineCacheEntry) == 24);
+static_assert(sizeof(JitCallInlineCacheEntry) == 32);
 
 // Describes one call site in JIT'ed code that employs inline caching
 // Note that this must have a 1-byte alignment since this struct currently lives in the SlowPathData stream
@@ -407,7 +529,7 @@ struct __attribute__((__packed__, __aligned__(1))) JitCallInlineCacheSite
     // May only be called if m_numEntries < x_maxEntries and m_mode == DirectCall
     // This function handles everything except actually JIT'ting code
     //
-    // Returns the address to populate JIT code
+    // Returns the address to populate JIT code, and the address to populate the data section (nullptr if none) in 'jitDataSecAddr'
     //
     // Note that only dcIcTraitKind is passed in, because ccIcTraitKind for one IC site is always dcIcTraitKind + 1
     //
@@ -415,16 +537,21 @@ struct __attribute__((__packed__, __aligned__(1))) JitCallInlineCacheSite
     //
     // Use attribute 'malloc' to teach LLVM that the returned address is noalias, which is very useful due to how our codegen function is written
     //
-    __attribute__((__malloc__)) void* WARN_UNUSED InsertInDirectCallMode(uint16_t dcIcTraitKind, TValue tv, uint8_t* transitedToCCMode /*out*/);
+    __attribute__((__malloc__)) void* WARN_UNUSED InsertInDirectCallMode(uint16_t dcIcTraitKind, TValue tv, uint8_t* transitedToCCMode /*out*/, void** jitDataSecAddr /*out*/);
 
     // May only be called if m_numEntries < x_maxEntries and m_mode != DirectCall
     // This function handles everything except actually JIT'ting code
     //
-    // Returns the address to populate JIT code
+    // Returns the address to populate JIT code, and the address to populate the data section (nullptr if none) in 'jitDataSecAddr'
     //
     // Note that the passed in IcTraitKind is the DC one, not the CC one!
     //
-    __attribute__((__malloc__)) void* WARN_UNUSED InsertInClosureCallMode(uint16_t dcIcTraitKind, TValue tv);
+    __attribute__((__malloc__)) void* WARN_UNUSED InsertInClosureCallMode(uint16_t dcIcTraitKind, TValue tv, void** jitDataSecAddr /*out*/);
+
+    // Destroy all the IC entries owned by this site and reset the site to its initial state
+    // This unlinks each entry from the CodeBlock it caches on, and returns its JIT code to the JIT memory allocator
+    //
+    void DestroyAllEntries(VM* vm);
 };
 static_assert(sizeof(JitCallInlineCacheSite) == 8);
 static_assert(alignof(JitCallInlineCacheSite) == 1);
@@ -472,6 +599,10 @@ public:
 
     void UpdateBestEntryPoint(void* newEntryPoint);
 
+    // Set the interpreter tier-up counter to its initial value, as if the CodeBlock were just created
+    //
+    void ResetInterpreterTierUpCounter(VM* vm);
+
     UserHeapPointer<TableObject> m_globalObject;
 
     uint32_t m_stackFrameNumSlots;
@@ -510,8 +641,18 @@ class UnlinkedCodeBlock : public SystemHeapGcObjectHeader
 public:
     static UnlinkedCodeBlock* WARN_UNUSED Create(VM* vm, HeapPtr<TableObject> globalObject)
     {
-        size_t sizeToAllocate = RoundUpToMultipleOf<8>(GetTrailingArrayOffset() + x_num_bytecode_metadata_struct_kinds_ * sizeof(uint16_t));
-        uint8_t* addressBegin = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(static_cast<uint32_t>(sizeToAllocate)).AsNoAssert<uint8_t>());
+        uint8_t* addressBegin;
+        uint32_t& freeList = vm->GetUnlinkedCodeBlockFreeList();
+        if (freeList != 0)
+        {
+            addressBegin = TranslateToRawPointer(vm, SystemHeapPointer<uint8_t>(freeList).As());
+            freeList = *reinterpret_cast<uint32_t*>(addressBegin);
+        }
+        else
+        {
+            size_t sizeToAllocate = RoundUpToMultipleOf<8>(GetTrailingArrayOffset() + x_num_bytecode_metadata_struct_kinds_ * sizeof(uint16_t));
+            addressBegin = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(static_cast<uint32_t>(sizeToAllocate)).AsNoAssert<uint8_t>());
+        }
         UnlinkedCodeBlock* ucb = reinterpret_cast<UnlinkedCodeBlock*>(addressBegin);
         SystemHeapGcObjectHeader::Populate(ucb);
         ucb->m_uvFixUpCompleted = false;
@@ -519,10 +660,28 @@ public:
         ucb->m_rareGOtoCBMap = nullptr;
         ucb->m_parent = nullptr;
         ucb->m_defaultCodeBlock = nullptr;
+        ucb->m_bytecode = nullptr;
+        ucb->m_upvalueInfo = nullptr;
+        ucb->m_cstTable = nullptr;
         ucb->m_parserUVGetFixupList = nullptr;
         return ucb;
     }
 
+    // Free an UnlinkedCodeBlock that nothing refers to and that has no CodeBlock yet (e.g., one created by a failed binary chunk load).
+    // Its memory is put into a free list in the VM, and reused by the next UnlinkedCodeBlock.
+    //
+    void Free(VM* vm)
+    {
+        assert(m_defaultCodeBlock == nullptr && m_rareGOtoCBMap == nullptr);
+        delete[] m_bytecode;
+        delete[] m_upvalueInfo;
+        delete[] m_cstTable;
+        uint32_t& freeList = vm->GetUnlinkedCodeBlockFreeList();
+        uint32_t self = SystemHeapPointer<UnlinkedCodeBlock>(this).m_value;
+        *reinterpret_cast<uint32_t*>(this) = freeList;
+        freeList = self;
+    }
+
     static constexpr size_t GetTrailingArrayOffset()
     {
         return offsetof_member_v<&UnlinkedCodeBlock::m_bytecodeMetadataUseCounts>;
@@ -614,7 +773,14 @@ public:
                                                  uint32_t slowPathDataStreamLength,
                                                  void* jitCodeEntry,
                                                  void* jitRegionStart,
-                                                 uint32_t jitRegionSize);
+                                                 uint32_t jitRegionSize,
+                                                 void* jitDataSecStart);
+
+    // Put a BaselineCodeBlock that is not referenced by anything (e.g., its codegen job is discarded) to the free list,
+    // so its system heap memory can be reused by a later BaselineCodeBlock of the same allocation size.
+    // This does not free the JIT memory it points to.
+    //
+    void Free(VM* vm);
 
     static constexpr size_t GetTrailingArrayOffset()
     {
@@ -715,7 +881,8 @@ public:
     uint32_t m_maxObservedNumVariadicArgs;
 
     // Currently the JIT code is layouted as follow:
-    //     [ Data Section ] [ FastPath Code ] [ SlowPath Code ]
+    //     [ FastPath Code ] [ SlowPath Code ]
+    // and the data section resides in a separate non-executable allocation
     //
     void* m_jitCodeEntry;
 
@@ -727,7 +894,21 @@ public:
     uint32_t m_jitRegionSize;
     uint32_t m_slowPathDataStreamLength;
 
+    // The data section allocation from the JIT data memory allocator, nullptr if the data section is empty
+    //
+    void* m_jitDataSecStart;
+
     SlowPathDataAndBytecodeOffset m_sbIndex[0];
+
+private:
+    // The allocation is [ constant table ] [ BaselineCodeBlock ] [ m_sbIndex ] [ SlowPathData stream ]
+    //
+    static uint32_t WARN_UNUSED ComputeAllocationSize(size_t numEntriesInConstantTable, uint32_t numBytecodes, uint32_t slowPathDataStreamLength)
+    {
+        static_assert(alignof(BaselineCodeBlock) == 8);         // the computation below relies on this
+        size_t sizeToAllocate = sizeof(TValue) * numEntriesInConstantTable + GetTrailingArrayOffset() + sizeof(SlowPathDataAndBytecodeOffset) * numBytecodes + slowPathDataStreamLength;
+        return SafeIntegerCast<uint32_t>(RoundUpToMultipleOf<8>(sizeToAllocate));
+    }
 };
 
 class FunctionObject;
@@ -1045,6 +1226,131 @@ inline ExecutableCode* WARN_UNUSED JitCallInlineCacheEntry::GetTargetExecutableC
     return ec;
 }
 
+// The payload of the userdata objects that represent the file handles of the io library
+//
+// Files are accessed through the file descriptor directly with a large internal buffer, so that the io library can split lines
+// with memchr and create the strings straight from the buffer, without going through stdio.
+// The buffer holds either buffered input or pending output, never both: switching direction writes out the pending output,
+// or gives back the unconsumed input by seeking backwards.
+//
+// The standard output and standard error are written through the FILE* of the VM instead (so that they can be redirected),
+// and cannot be read from.
+//
+class LuaFileHandle
+{
+public:
+    enum class Kind : uint8_t
+    {
+        Regular,
+        Stdin,
+        Stdout,
+        Stderr
+    };
+
+    enum class BufferMode : uint8_t
+    {
+        Full,
+        Line,
+        No
+    };
+
+    static constexpr uint32_t x_initialBufferSize = 65536;
+
+    // Regular files are closed by the VM on cleanup if the user program did not close them
+    //
+    static HeapPtr<HeapCDataObject> WARN_UNUSED Create(VM* vm, Kind kind, int fd);
+
+    // Return nullptr if 'tv' is not a file handle
+    //
+    static LuaFileHandle* WARN_UNUSED TryGetFromValue(VM* vm, TValue tv)
+    {
+        if (!tv.Is<tUserdata>())
+        {
+            return nullptr;
+        }
+        HeapCDataObject* o = TranslateToRawPointer(vm, tv.As<tUserdata>());
+        if (o->m_kind != HeapCDataObject::Kind::LuaFile)
+        {
+            return nullptr;
+        }
+        return o->GetPayload<LuaFileHandle>();
+    }
+
+    bool IsReadable() { return m_kind == Kind::Regular || m_kind == Kind::Stdin; }
+    bool IsStandardStream() { return m_kind != Kind::Regular; }
+
+    // The number of bytes of buffered input that has not been consumed
+    //
+    uint32_t GetNumBufferedBytes()
+    {
+        assert(!m_hasPendingOutput);
+        return m_bufferEnd - m_bufferBegin;
+    }
+
+    char* GetBufferedBytes() { return m_buffer + m_bufferBegin; }
+
+    void ConsumeBufferedBytes(uint32_t n)
+    {
+        assert(n <= GetNumBufferedBytes());
+        m_bufferBegin += n;
+    }
+
+    // Must be called before reading from the buffer. Writes out the pending output if any.
+    //
+    bool WARN_UNUSED PrepareForRead();
+
+    // Read more input into the buffer, preserving the unconsumed input (which may be moved to the beginning of the buffer).
+    // The buffer is grown if it is full.
+    // Return the number of bytes read, 0 on end of file, and -1 on error.
+    //
+    ssize_t WARN_UNUSED FillBuffer();
+
+    bool WARN_UNUSED Write(VM* vm, const void* data, size_t len);
+    bool WARN_UNUSED WriteNumber(VM* vm, double value);
+    bool WARN_UNUSED Flush(VM* vm);
+
+    // Return the new file position, or -1 on error
+    //
+    int64_t WARN_UNUSED Seek(VM* vm, int whence, int64_t offset);
+
+    // Must not be called on the standard streams
+    //
+    bool WARN_UNUSED Close(VM* vm);
+
+    static void CloseAllOpenFiles(VM* vm);
+
+    int m_fd;
+    Kind m_kind;
+    BufferMode m_bufferMode;
+    bool m_isClosed;
+    // Whether the buffer holds output that has not been written to the file
+    //
+    bool m_hasPendingOutput;
+    // Set for the files opened by io.lines, which are closed when the lines iterator hits the end of file
+    //
+    bool m_closeAtEof;
+
+    // Lazily allocated
+    //
+    char* m_buffer;
+    uint32_t m_bufferCapacity;
+    // For input, the unconsumed data is [m_bufferBegin, m_bufferEnd)
+    // For output, m_bufferBegin is always 0, and the pending data is [0, m_bufferEnd)
+    //
+    uint32_t m_bufferBegin;
+    uint32_t m_bufferEnd;
+
+    // The list of regular files that are not yet closed, so the VM can flush and close them on cleanup
+    //
+    LuaFileHandle* m_prevOpenFile;
+    LuaFileHandle* m_nextOpenFile;
+
+private:
+    bool WARN_UNUSED EnsureBufferAllocated();
+    bool WARN_UNUSED WritePendingOutput();
+    void GiveBackBufferedInput();
+};
+
 // Corresponds to a file
 //
 class ScriptModule
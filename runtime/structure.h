@@ -70,6 +70,12 @@ public:
     //
     static constexpr int32_t x_key_change_array_type_tag = 256;
 
+    // The hash table uses linear probing. Each entry is 8 bytes, so a probe sequence scans adjacent entries in the same cache line,
+    // and since the load factor is kept at most 1/2, a lookup rarely needs to look past the first few entries.
+    //
+    // Note that the probe must start at the slot the key hashes to (not e.g. at the start of the cache line containing that slot),
+    // otherwise all keys hashing into the same cache line would collide with each other.
+    //
     static constexpr uint32_t x_initialHashTableSize = 4;
 
     static uint32_t ComputeAllocationSize(uint32_t hashTableSize)
@@ -79,14 +85,42 @@ public:
         return static_cast<uint32_t>(allocationSize);
     }
 
+    static uint32_t GetSizeClass(uint32_t hashTableSize)
+    {
+        assert(is_power_of_2(hashTableSize) && hashTableSize >= x_initialHashTableSize);
+        uint32_t sizeClass = static_cast<uint32_t>(__builtin_ctz(hashTableSize));
+        assert(sizeClass < x_numStructureTransitionTableSizeClasses);
+        return sizeClass;
+    }
+
     static StructureTransitionTable* AllocateUninitialized(VM* vm, uint32_t hashTableSize)
     {
-        uint32_t allocationSize = ComputeAllocationSize(hashTableSize);
-        StructureTransitionTable* result = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(allocationSize).As<StructureTransitionTable>());
+        StructureTransitionTable* result;
+        uint32_t& freeList = vm->GetStructureTransitionTableFreeLists()[GetSizeClass(hashTableSize)];
+        if (freeList != 0)
+        {
+            result = TranslateToRawPointer(vm, SystemHeapPointer<StructureTransitionTable>(freeList).As());
+            freeList = *reinterpret_cast<uint32_t*>(result);
+        }
+        else
+        {
+            uint32_t allocationSize = ComputeAllocationSize(hashTableSize);
+            result = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(allocationSize).As<StructureTransitionTable>());
+        }
         ConstructInPlace(result);
         return result;
     }
 
+    // Put a table that is no longer referenced to the free list, so its memory can be reused by a later table of the same size
+    //
+    void Free(VM* vm)
+    {
+        uint32_t& freeList = vm->GetStructureTransitionTableFreeLists()[GetSizeClass(m_hashTableMask + 1)];
+        uint32_t self = SystemHeapPointer<StructureTransitionTable>(this).m_value;
+        *reinterpret_cast<uint32_t*>(this) = freeList;
+        freeList = self;
+    }
+
     static StructureTransitionTable* AllocateInitialTable(VM* vm, int32_t key, SystemHeapPointer<Structure> value)
     {
         StructureTransitionTable* r = AllocateUninitialized(vm, x_initialHashTableSize);
@@ -106,12 +140,17 @@ public:
         return m_numElementsInHashTable >= m_hashTableMask / 2 + 1;
     }
 
+    static uint32_t WARN_UNUSED GetFirstProbeSlot(int32_t key, uint32_t hashMask)
+    {
+        return static_cast<uint32_t>(HashPrimitiveTypes(key)) & hashMask;
+    }
+
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, StructureTransitionTable>>>
     static ReinterpretCastPreservingAddressSpaceType<HashTableEntry*, T> WARN_UNUSED Find(T self, int32_t key, bool& found)
     {
         assert(key != x_key_invalid && key != x_key_deleted);
         uint32_t hashMask = self->m_hashTableMask;
-        uint32_t slot = static_cast<uint32_t>(HashPrimitiveTypes(key)) & hashMask;
+        uint32_t slot = GetFirstProbeSlot(key, hashMask);
         while (true)
         {
             int32_t slotKey = self->m_hashTable[slot].m_key;
@@ -129,6 +168,8 @@ public:
         }
     }
 
+    // The old table is freed, so the caller must replace all references to it by the returned table
+    //
     StructureTransitionTable* WARN_UNUSED Expand(VM* vm)
     {
         assert(ShouldResizeForThisInsertion());
@@ -144,7 +185,7 @@ public:
             HashTableEntry entry = m_hashTable[i];
             if (entry.m_key != x_key_invalid && entry.m_key != x_key_deleted)
             {
-                uint32_t slot = static_cast<uint32_t>(HashPrimitiveTypes(entry.m_key)) & newHashMask;
+                uint32_t slot = GetFirstProbeSlot(entry.m_key, newHashMask);
                 while (newTable->m_hashTable[slot].m_key != x_key_invalid)
                 {
                     slot = (slot + 1) & newHashMask;
@@ -152,6 +193,7 @@ public:
                 newTable->m_hashTable[slot] = entry;
             }
         }
+        Free(vm);
         return newTable;
     }
 
@@ -168,6 +210,7 @@ struct StructureKeyHashHelper
     {
         HeapPtr<HeapString> s = stringKey.As<HeapString>();
         assert(s->m_type == HeapEntityType::String);
+        assert(!HeapString::IsLazilyInterned(s) && "the key must be interned by VM_InternIfLazilyInternedString first");
         return s->m_hashLow;
     }
 
@@ -295,9 +338,14 @@ struct ButterflyNamedStorageGrowthPolicy
 {
     static constexpr uint8_t x_initialMinimumButterflyCapacity = 4;
     static constexpr uint8_t x_butterflyCapacityFromInlineCapacityFactor = 2;
-    static constexpr uint32_t x_butterflyNamedStorageCapacityGrowthFactor = 2;
 
-    // TODO: refine growth strategy
+    // Small butterflies double their capacity on growth, so objects built field by field go through few capacity-growing
+    // transitions. Once the butterfly is large, the capacity grows by 1.5x instead to bound the wasted space.
+    //
+    static constexpr uint32_t x_butterflyNamedStorageGeometricGrowthThreshold = 32;
+
+    // The initial capacity is a fraction of the inline capacity: an object that is expected to have many properties
+    // (a large inline capacity) is also likely to overflow by many properties
     //
     static uint8_t WARN_UNUSED ComputeInitialButterflyCapacityForDictionary(uint8_t inlineNamedStorageCapacity)
     {
@@ -309,7 +357,16 @@ struct ButterflyNamedStorageGrowthPolicy
     static uint32_t WARN_UNUSED ComputeNextButterflyCapacityImpl(uint32_t curButterflyCapacity)
     {
         assert(curButterflyCapacity > 0);
-        uint32_t capacity = curButterflyCapacity * x_butterflyNamedStorageCapacityGrowthFactor;
+        uint32_t capacity;
+        if (curButterflyCapacity < x_butterflyNamedStorageGeometricGrowthThreshold)
+        {
+            capacity = curButterflyCapacity * 2;
+        }
+        else
+        {
+            capacity = curButterflyCapacity + curButterflyCapacity / 2;
+        }
+        assert(capacity > curButterflyCapacity);
         return capacity;
     }
 
@@ -893,7 +950,6 @@ public:
                     StructureTransitionTable* newTable = table->Expand(vm);
                     m_transitionTable.Store(SystemHeapPointer<StructureTransitionTable>(newTable));
                     assert(!newTable->ShouldResizeForThisInsertion());
-                    // FIXME: delete old table!
                 }
 
                 return newStructure;
@@ -1599,6 +1655,250 @@ public:
     UserHeapPointer<void> m_metatable;
 };
 
+// A hidden class for tables that are used as hash maps with many or churning keys.
+//
+// Unlike CacheableDictionary, the values are stored directly in the hash table (the inline storage and the butterfly named
+// storage of the object are unused), and no operation on this hidden class is inline-cacheable. This avoids paying for the
+// hidden class bookkeeping on every insertion, and allows the hash table to drop the deleted keys.
+//
+// Setting an existing key to nil does not remove it from the hash table, so that Lua 'next' still works on a deleted key.
+// The hash table is only rehashed (which drops all nil-valued keys, and may shrink the table) upon inserting a new key,
+// which is an undefined behavior if it happens during a traversal, as Lua requires.
+//
+class UncacheableDictionary final : public SystemHeapGcObjectHeader
+{
+public:
+    ~UncacheableDictionary()
+    {
+        if (m_hashTable != nullptr)
+        {
+            delete [] m_hashTable;
+        }
+    }
+
+    struct HashTableEntry
+    {
+        GeneralHeapPointer<void> m_key;
+        TValue m_value;
+    };
+    static_assert(sizeof(HashTableEntry) == 16);
+
+    static constexpr uint32_t x_minHashTableMask = 127;
+
+    static uint32_t WARN_UNUSED ComputeHashTableMaskForNumKeys(uint32_t numKeys)
+    {
+        // Keep the load factor at most 1/4 right after a rehash, so we are not going to rehash again very soon
+        //
+        uint32_t hashTableMask = RoundUpToPowerOfTwo(numKeys + 1) * 4 - 1;
+        return std::max(hashTableMask, x_minHashTableMask);
+    }
+
+    // Create an empty UncacheableDictionary with expected 'anticipatedNumKeys' keys
+    // 'inlineCapacity' and 'butterflyNamedStorageCapacity' must agree with the layout of the object, even though the named storage is unused
+    //
+    static UncacheableDictionary* WARN_UNUSED CreateEmpty(VM* vm, uint32_t anticipatedNumKeys, uint8_t inlineCapacity, uint32_t butterflyNamedStorageCapacity)
+    {
+        UncacheableDictionary* r = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(sizeof(UncacheableDictionary)).AsNoAssert<UncacheableDictionary>());
+        SystemHeapGcObjectHeader::Populate(r);
+        r->m_inlineNamedStorageCapacity = inlineCapacity;
+        r->m_butterflyNamedStorageCapacity = butterflyNamedStorageCapacity;
+        uint32_t hashTableMask = ComputeHashTableMaskForNumKeys(anticipatedNumKeys);
+        r->m_hashTableMask = hashTableMask;
+        r->m_numKeys = 0;
+        r->m_hashTable = AllocateEmptyHashTable(hashTableMask);
+        r->m_metatable.m_value = 0;
+        return r;
+    }
+
+    UncacheableDictionary* WARN_UNUSED Clone(VM* vm)
+    {
+        UncacheableDictionary* r = TranslateToRawPointer(vm, vm->AllocFromSystemHeap(sizeof(UncacheableDictionary)).AsNoAssert<UncacheableDictionary>());
+        SystemHeapGcObjectHeader::Populate(r);
+        r->m_inlineNamedStorageCapacity = m_inlineNamedStorageCapacity;
+        r->m_butterflyNamedStorageCapacity = m_butterflyNamedStorageCapacity;
+        r->m_hashTableMask = m_hashTableMask;
+        r->m_numKeys = m_numKeys;
+        r->m_hashTable = new HashTableEntry[m_hashTableMask + 1];
+        memcpy(r->m_hashTable, m_hashTable, sizeof(HashTableEntry) * (m_hashTableMask + 1));
+        r->m_metatable = m_metatable;
+        return r;
+    }
+
+    static HashTableEntry* WARN_UNUSED AllocateEmptyHashTable(uint32_t hashTableMask)
+    {
+        assert(is_power_of_2(hashTableMask + 1));
+        HashTableEntry* ht = new HashTableEntry[hashTableMask + 1];
+        for (size_t i = 0; i <= hashTableMask; i++)
+        {
+            ht[i].m_key.m_value = 0;
+            ht[i].m_value = TValue::Nil();
+        }
+        return ht;
+    }
+
+    // Only used for initialization and rehash, so this does not check for rehash, and does not update key count!
+    //
+    void InsertNonExistentPropertyForInitOrRehash(UserHeapPointer<void> prop, uint32_t propHash, TValue value)
+    {
+        size_t htMask = m_hashTableMask;
+        size_t slot = propHash & htMask;
+        while (m_hashTable[slot].m_key.m_value != 0)
+        {
+            assert(m_hashTable[slot].m_key.As() != prop.As());
+            slot = (slot + 1) & htMask;
+        }
+        m_hashTable[slot].m_key = prop.As();
+        m_hashTable[slot].m_value = value;
+    }
+
+    // Return the hash table slot for the property, or the empty slot where it should be inserted if it doesn't exist
+    //
+    template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, UncacheableDictionary>>>
+    static size_t WARN_UNUSED ALWAYS_INLINE FindSlotImpl(T self, UserHeapPointer<void> prop, uint32_t propHash, bool& found /*out*/)
+    {
+        size_t hashMask = self->m_hashTableMask;
+        size_t slot = propHash & hashMask;
+        GeneralHeapPointer<void> gprop = prop.As();
+        while (true)
+        {
+            GeneralHeapPointer<void> key = TCGet(self->m_hashTable[slot].m_key);
+            if (key.m_value == 0)
+            {
+                found = false;
+                return slot;
+            }
+            if (key == gprop)
+            {
+                found = true;
+                return slot;
+            }
+            slot = (slot + 1) & hashMask;
+        }
+    }
+
+    template<typename U>
+    static uint32_t WARN_UNUSED ALWAYS_INLINE GetHashValueForProperty(UserHeapPointer<U> prop)
+    {
+        static_assert(std::is_same_v<U, void> || std::is_same_v<U, HeapString>);
+        if constexpr(std::is_same_v<U, HeapString>)
+        {
+            return StructureKeyHashHelper::GetHashValueForStringKey(prop);
+        }
+        else
+        {
+            return StructureKeyHashHelper::GetHashValueForMaybeNonStringKey(prop);
+        }
+    }
+
+    // Return nil if the property doesn't exist
+    //
+    template<typename T, typename U, typename = std::enable_if_t<IsPtrOrHeapPtr<T, UncacheableDictionary>>>
+    static TValue WARN_UNUSED GetValue(T self, UserHeapPointer<U> prop)
+    {
+        bool found;
+        size_t slot = FindSlotImpl(self, prop.template As<void>(), GetHashValueForProperty(prop), found /*out*/);
+        if (!found)
+        {
+            return TValue::Nil();
+        }
+        return TCGet(self->m_hashTable[slot].m_value);
+    }
+
+    // Query the hash table slot for a property
+    // This weird function is only used by the Lua 'next' slow path
+    //
+    static uint32_t WARN_UNUSED GetHashTableSlotNumberForProperty(HeapPtr<UncacheableDictionary> self, UserHeapPointer<void> prop)
+    {
+        bool found;
+        size_t slot = FindSlotImpl(self, prop, StructureKeyHashHelper::GetHashValueForMaybeNonStringKey(prop), found /*out*/);
+        if (!found)
+        {
+            return static_cast<uint32_t>(-1);
+        }
+        return static_cast<uint32_t>(slot);
+    }
+
+    template<typename T, typename U, typename = std::enable_if_t<IsPtrOrHeapPtr<T, UncacheableDictionary>>>
+    static void Put(T self, UserHeapPointer<U> prop, TValue value)
+    {
+        uint32_t propHash = GetHashValueForProperty(prop);
+        bool found;
+        size_t slot = FindSlotImpl(self, prop.template As<void>(), propHash, found /*out*/);
+        if (found)
+        {
+            // Note that if 'value' is nil, we intentionally keep the key in the hash table so 'next' still works on it
+            //
+            TCSet(self->m_hashTable[slot].m_value, value);
+            return;
+        }
+
+        if (value.IsNil())
+        {
+            // Putting nil to a non-existent key is a no-op
+            //
+            return;
+        }
+
+        if (unlikely((self->m_numKeys + 1) * 2 >= self->m_hashTableMask))
+        {
+            TranslateToRawPointer(self)->RehashImpl();
+            slot = FindSlotImpl(self, prop.template As<void>(), propHash, found /*out*/);
+            assert(!found);
+        }
+
+        TCSet(self->m_hashTable[slot].m_key, GeneralHeapPointer<void>(prop.template As<void>()));
+        TCSet(self->m_hashTable[slot].m_value, value);
+        self->m_numKeys++;
+    }
+
+    // Rebuild the hash table with all the nil-valued keys dropped. The hash table may grow or shrink
+    //
+    void NO_INLINE RehashImpl()
+    {
+        uint32_t numLiveKeys = 0;
+        for (size_t i = 0; i <= m_hashTableMask; i++)
+        {
+            if (m_hashTable[i].m_key.m_value != 0 && !m_hashTable[i].m_value.IsNil())
+            {
+                numLiveKeys++;
+            }
+        }
+
+        uint32_t oldMask = m_hashTableMask;
+        uint32_t newMask = ComputeHashTableMaskForNumKeys(numLiveKeys + 1);
+        ReleaseAssert(newMask < std::numeric_limits<uint32_t>::max());
+        HashTableEntry* oldHt = m_hashTable;
+        m_hashTableMask = newMask;
+        m_hashTable = AllocateEmptyHashTable(newMask);
+
+        HashTableEntry* oldHtEnd = oldHt + oldMask + 1;
+        for (HashTableEntry* curEntry = oldHt; curEntry < oldHtEnd; curEntry++)
+        {
+            if (curEntry->m_key.m_value != 0 && !curEntry->m_value.IsNil())
+            {
+                UserHeapPointer<void> key = curEntry->m_key.As();
+                InsertNonExistentPropertyForInitOrRehash(key, StructureKeyHashHelper::GetHashValueForMaybeNonStringKey(key), curEntry->m_value);
+            }
+        }
+        m_numKeys = numLiveKeys;
+
+        delete [] oldHt;
+    }
+
+    uint8_t m_inlineNamedStorageCapacity;
+    // The butterfly named storage is unused, but we still need to know its size to manipulate the butterfly
+    //
+    uint32_t m_butterflyNamedStorageCapacity;
+    uint32_t m_hashTableMask;
+    // The number of keys in the hash table, including the keys with nil value
+    //
+    uint32_t m_numKeys;
+    HashTableEntry* m_hashTable;
+    // Since UncacheableDictionary is not cacheable, the metatable can be changed in place
+    //
+    UserHeapPointer<void> m_metatable;
+};
+
 inline StructureAnchorHashTable* WARN_UNUSED StructureAnchorHashTable::Create(VM* vm, Structure* shc)
 {
     uint8_t numElements = shc->m_numSlots;
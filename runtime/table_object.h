@@ -23,10 +23,80 @@ public:
         double m_key;
         TValue m_value;
     };
+    static_assert(sizeof(HashTableEntry) == 16);
 
     ~ArraySparseMap()
     {
-        delete [] m_hashTable;
+        FreeHashTable(m_hashTable, m_hashMask + 1);
+    }
+
+    // Small hash tables are allocated from the user heap segregated allocator, so the storage freed by a resize
+    // can be reused by the next sparse map of the same size, without going through malloc.
+    // Large hash tables are allocated with the system allocator, so their memory can be returned to the OS when freed.
+    //
+    static HashTableEntry* WARN_UNUSED AllocateEmptyHashTable(uint32_t numEntries)
+    {
+        assert(is_power_of_2(numEntries));
+        uint32_t numSlots = numEntries * static_cast<uint32_t>(sizeof(HashTableEntry) / sizeof(uint64_t));
+        HashTableEntry* ht;
+        if (likely(numSlots <= internal::x_userHeapMaxSizeClassSlots))
+        {
+            VM* vm = VM::GetActiveVMForCurrentThread();
+            ht = reinterpret_cast<HashTableEntry*>(vm->AllocRawFromUserHeap(numSlots * static_cast<uint32_t>(sizeof(uint64_t))));
+        }
+        else
+        {
+            ht = new HashTableEntry[numEntries];
+        }
+        for (size_t i = 0; i < numEntries; i++)
+        {
+            ht[i].m_key = std::numeric_limits<double>::quiet_NaN();
+            ht[i].m_value = TValue::Nil();
+        }
+        return ht;
+    }
+
+    static void FreeHashTable(HashTableEntry* ht, uint32_t numEntries)
+    {
+        uint32_t numSlots = numEntries * static_cast<uint32_t>(sizeof(HashTableEntry) / sizeof(uint64_t));
+        if (likely(numSlots <= internal::x_userHeapMaxSizeClassSlots))
+        {
+            VM* vm = VM::GetActiveVMForCurrentThread();
+            vm->FreeRawToUserHeap(ht, numSlots * static_cast<uint32_t>(sizeof(uint64_t)));
+        }
+        else
+        {
+            delete [] ht;
+        }
+    }
+
+    // The keys are almost always integers (e.g., IDs or timestamps), so we hash the integer value with a multiplicative hash,
+    // which is much cheaper than the general-purpose hash, and spreads consecutive or strided integers evenly.
+    // Other keys are hashed by their bit pattern. Note that -0 is hashed as the integer 0, as desired.
+    //
+    static uint32_t WARN_UNUSED ALWAYS_INLINE HashKey(double key)
+    {
+        assert(!IsNaN(key));
+        uint64_t bits;
+        // The range check avoids the UB of out-of-range float-to-int conversion
+        //
+        if (likely(key >= -9.2e18 && key <= 9.2e18))
+        {
+            int64_t ikey = static_cast<int64_t>(key);
+            if (likely(UnsafeFloatEqual(static_cast<double>(ikey), key)))
+            {
+                bits = static_cast<uint64_t>(ikey);
+            }
+            else
+            {
+                bits = cxx2a_bit_cast<uint64_t>(key);
+            }
+        }
+        else
+        {
+            bits = cxx2a_bit_cast<uint64_t>(key);
+        }
+        return static_cast<uint32_t>((bits * 0x9E3779B97F4A7C15ULL) >> 32);
     }
 
     static ArraySparseMap* WARN_UNUSED AllocateEmptyArraySparseMap(VM* vm)
@@ -36,11 +106,9 @@ public:
         ConstructInPlace(r);
         UserHeapGcObjectHeader::Populate(r);
         r->m_hiddenClass = ArraySparseMap::x_hiddenClassForArraySparseMap;
-        r->m_hashMask = 1;
+        r->m_hashMask = x_initialHashTableSize - 1;
         r->m_elementCount = 0;
-        r->m_hashTable = new HashTableEntry[2];
-        r->m_hashTable[0].m_key = std::numeric_limits<double>::quiet_NaN();
-        r->m_hashTable[1].m_key = std::numeric_limits<double>::quiet_NaN();
+        r->m_hashTable = AllocateEmptyHashTable(x_initialHashTableSize);
         return r;
     }
 
@@ -53,7 +121,7 @@ public:
         r->m_hiddenClass = ArraySparseMap::x_hiddenClassForArraySparseMap;
         r->m_hashMask = m_hashMask;
         r->m_elementCount = m_elementCount;
-        r->m_hashTable = new HashTableEntry[m_hashMask + 1];
+        r->m_hashTable = AllocateEmptyHashTable(m_hashMask + 1);
         memcpy(r->m_hashTable, m_hashTable, sizeof(HashTableEntry) * (m_hashMask + 1));
         return r;
     }
@@ -67,26 +135,38 @@ public:
         ResizeImpl();
     }
 
+    // Rebuild the hash table with the nil-valued entries dropped. The new size is decided by the number of non-nil entries,
+    // so a sparse map with a lot of deleted keys is rehashed in place or shrinks instead of doubling.
+    //
+    // Note that this is only called upon insertion, which is required by the Lua 'next' semantics.
+    //
     void NO_INLINE ResizeImpl()
     {
         assert(is_power_of_2(m_hashMask + 1));
         uint32_t oldMask = m_hashMask;
-        uint32_t newMask = oldMask * 2 + 1;
-        ReleaseAssert(newMask < std::numeric_limits<uint32_t>::max());
-        m_hashMask = newMask;
-
         HashTableEntry* oldHt = m_hashTable;
-        m_hashTable = new HashTableEntry[newMask + 1];
-        for (size_t i = 0; i <= newMask; i++)
+        HashTableEntry* oldHtEnd = oldHt + oldMask + 1;
+
+        uint32_t nonNilElement = 0;
+        for (HashTableEntry* curEntry = oldHt; curEntry < oldHtEnd; curEntry++)
         {
-             m_hashTable[i].m_key = std::numeric_limits<double>::quiet_NaN();
+            if (!IsNaN(curEntry->m_key) && !curEntry->m_value.IsNil())
+            {
+                nonNilElement++;
+            }
         }
 
+        // Keep the load factor at most 1/4 right after the resize
+        //
+        uint64_t newSize = static_cast<uint64_t>(RoundUpToPowerOfTwo(nonNilElement + 1)) * 4;
+        newSize = std::max(newSize, static_cast<uint64_t>(x_initialHashTableSize));
+        ReleaseAssert(newSize <= std::numeric_limits<uint32_t>::max());
+        uint32_t newMask = static_cast<uint32_t>(newSize - 1);
+        m_hashMask = newMask;
+        m_hashTable = AllocateEmptyHashTable(newMask + 1);
+
         DEBUG_ONLY(uint32_t cnt = 0;)
-        uint32_t nonNilElement = 0;
-        HashTableEntry* oldHtEnd = oldHt + oldMask + 1;
-        HashTableEntry* curEntry = oldHt;
-        while (curEntry < oldHtEnd)
+        for (HashTableEntry* curEntry = oldHt; curEntry < oldHtEnd; curEntry++)
         {
             double key = curEntry->m_key;
             if (!IsNaN(key))
@@ -94,7 +174,7 @@ public:
                 TValue value = curEntry->m_value;
                 if (!value.IsNil())
                 {
-                    size_t slot = HashPrimitiveTypes(key) & newMask;
+                    size_t slot = HashKey(key) & newMask;
                     while (!IsNaN(m_hashTable[slot].m_key))
                     {
                         assert(!UnsafeFloatEqual(m_hashTable[slot].m_key, key));
@@ -102,22 +182,20 @@ public:
                     }
                     m_hashTable[slot].m_key = key;
                     m_hashTable[slot].m_value = value;
-                    nonNilElement++;
                 }
                 DEBUG_ONLY(cnt++;)
             }
-            curEntry++;
         }
         assert(cnt == m_elementCount);
         m_elementCount = nonNilElement;
 
-        delete [] oldHt;
+        FreeHashTable(oldHt, oldMask + 1);
     }
 
     TValue GetByVal(double key)
     {
         size_t hashMask = m_hashMask;
-        size_t slot = HashPrimitiveTypes(key) & hashMask;
+        size_t slot = HashKey(key) & hashMask;
         while (true)
         {
             HashTableEntry& entry = m_hashTable[slot];
@@ -139,7 +217,7 @@ public:
     uint32_t GetHashSlotOrdinal(double key)
     {
         size_t hashMask = m_hashMask;
-        size_t slot = HashPrimitiveTypes(key) & hashMask;
+        size_t slot = HashKey(key) & hashMask;
         while (true)
         {
             HashTableEntry& entry = m_hashTable[slot];
@@ -159,7 +237,7 @@ public:
     {
         assert(!IsNaN(key));
         size_t hashMask = m_hashMask;
-        size_t slot = HashPrimitiveTypes(key) & hashMask;
+        size_t slot = HashKey(key) & hashMask;
         while (true)
         {
             HashTableEntry& entry = m_hashTable[slot];
@@ -180,6 +258,10 @@ public:
         }
     }
 
+    // Four entries fill a cache line, so a probe sequence rarely touches more than one cache line
+    //
+    static constexpr uint32_t x_initialHashTableSize = 4;
+
     uint32_t m_hashMask;
     uint32_t m_elementCount;
     HashTableEntry* m_hashTable;
@@ -191,7 +273,7 @@ struct GetByIdICInfo
     //
     enum class ICKind : uint8_t
     {
-        // The hidden class is a UncachableDictionary
+        // The hidden class is a UncachableDictionary, so the property must be looked up in its hash table. Not cacheable
         //
         UncachableDictionary,
         // The GetById must return nil because the property doesn't exist
@@ -258,6 +340,9 @@ struct PutByIdICInfo
         // The PutById transitioned the table from Structure mode to CacheableDictionary mode, not inline cachable
         //
         TransitionedToDictionaryMode,
+        // The hidden class is an UncacheableDictionary, so the property must be put into its hash table, not inline cachable
+        //
+        UncacheableDictionary,
         // The property should be written to the inlined storage in m_slot
         //
         InlinedStorage,
@@ -271,6 +356,9 @@ struct PutByIdICInfo
     // Note that iff m_propertyExists == false, the PutById will transit the current structure to a new structure,
     // and the new structure is stored in m_newStructure
     //
+    // For 'UncacheableDictionary', this means whether the property has a non-nil value, and is only computed if m_mayHaveMetatable is true
+    // (otherwise it is always false), since the caller only needs it to decide whether to check the metatable
+    //
     bool m_propertyExists;
     // Whether or not we will need to grow the butterfly
     // Only possible if m_propertyExists == false
@@ -696,10 +784,10 @@ public:
         }
         else
         {
-            // TODO: support UncacheableDictionary
-            //
-            assert(false && "unimplemented");
-            __builtin_unreachable();
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            HeapPtr<UncacheableDictionary> dict = hiddenClass.As<UncacheableDictionary>();
+            icInfo.m_mayHaveMetatable = (dict->m_metatable.m_value != 0);
+            icInfo.m_icKind = GetByIdICInfo::ICKind::UncachableDictionary;
         }
     }
 
@@ -715,6 +803,65 @@ public:
         return PrepareGetByIdImpl(TCGet(self->m_hiddenClass), propertyName, icInfo /*out*/);
     }
 
+    // Same as PrepareGetById, but for an IC site that has already reached its maximum number of IC entries
+    // Such a site redoes the lookup on every execution, so the Structure lookup goes through the VM-wide megamorphic property cache
+    //
+    static void PrepareGetByIdForMegamorphicSite(HeapPtr<TableObject> self, UserHeapPointer<HeapString> propertyName, GetByIdICInfo& icInfo /*out*/)
+    {
+        SystemHeapPointer<void> hiddenClass = TCGet(self->m_hiddenClass);
+        if (unlikely(hiddenClass.As<SystemHeapGcObjectHeader>()->m_type != HeapEntityType::Structure))
+        {
+            PrepareGetByIdImpl(hiddenClass, propertyName, icInfo /*out*/);
+            return;
+        }
+
+        MegamorphicPropertyCache& cache = VM::GetActiveVMForCurrentThread()->m_megamorphicPropertyCache;
+        MegamorphicPropertyCache::Entry* entry = cache.Find(hiddenClass.m_value, propertyName.m_value);
+        if (likely(entry != nullptr))
+        {
+            icInfo.m_mayHaveMetatable = entry->m_mayHaveMetatable;
+            icInfo.m_slot = entry->m_slot;
+            switch (entry->m_kind)
+            {
+            case MegamorphicPropertyCache::Kind::Absent:
+            {
+                icInfo.m_icKind = GetByIdICInfo::ICKind::MustBeNil;
+                break;
+            }
+            case MegamorphicPropertyCache::Kind::InlinedStorage:
+            {
+                icInfo.m_icKind = GetByIdICInfo::ICKind::InlinedStorage;
+                break;
+            }
+            case MegamorphicPropertyCache::Kind::OutlinedStorage:
+            {
+                icInfo.m_icKind = GetByIdICInfo::ICKind::OutlinedStorage;
+                break;
+            }
+            }   /*switch*/
+            return;
+        }
+
+        PrepareGetByIdImplForStructure(hiddenClass, propertyName, icInfo /*out*/);
+
+        MegamorphicPropertyCache::Kind cacheKind;
+        if (icInfo.m_icKind == GetByIdICInfo::ICKind::InlinedStorage)
+        {
+            cacheKind = MegamorphicPropertyCache::Kind::InlinedStorage;
+        }
+        else if (icInfo.m_icKind == GetByIdICInfo::ICKind::OutlinedStorage)
+        {
+            cacheKind = MegamorphicPropertyCache::Kind::OutlinedStorage;
+        }
+        else
+        {
+            assert(icInfo.m_icKind == GetByIdICInfo::ICKind::MustBeNil);
+            icInfo.m_slot = 0;
+            cacheKind = MegamorphicPropertyCache::Kind::Absent;
+        }
+        cache.Insert(hiddenClass.m_value, propertyName.m_value, cacheKind, icInfo.m_slot, icInfo.m_mayHaveMetatable);
+    }
+
     // Specialized GetById for global object
     // Global object is guaranteed to be a CacheableDictionary so we can remove a branch
     //
@@ -731,7 +878,15 @@ public:
     }
 
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
-    static TValue WARN_UNUSED ALWAYS_INLINE GetById(T self, UserHeapPointer<void> /*propertyName*/, GetByIdICInfo icInfo)
+    static TValue WARN_UNUSED NO_INLINE GetByIdFromUncacheableDictionary(T self, UserHeapPointer<void> propertyName)
+    {
+        SystemHeapPointer<void> hiddenClass = TCGet(self->m_hiddenClass);
+        assert(hiddenClass.As<SystemHeapGcObjectHeader>()->m_type == HeapEntityType::UncacheableDictionary);
+        return UncacheableDictionary::GetValue(hiddenClass.As<UncacheableDictionary>(), propertyName);
+    }
+
+    template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
+    static TValue WARN_UNUSED ALWAYS_INLINE GetById(T self, UserHeapPointer<void> propertyName, GetByIdICInfo icInfo)
     {
         if (icInfo.m_icKind == GetByIdICInfo::ICKind::MustBeNil || icInfo.m_icKind == GetByIdICInfo::ICKind::MustBeNilButUncacheable)
         {
@@ -748,9 +903,8 @@ public:
             return self->m_butterfly->GetNamedProperty(icInfo.m_slot);
         }
 
-        // TODO: support UncacheableDictionary
-        assert(false && "not implemented");
-        __builtin_unreachable();
+        assert(icInfo.m_icKind == GetByIdICInfo::ICKind::UncachableDictionary);
+        return GetByIdFromUncacheableDictionary(self, propertyName);
     }
 
     template<typename T, typename U, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
@@ -780,8 +934,16 @@ public:
 
         if (unlikely(res.m_shouldCheckForTransitionToUncacheableDictionary))
         {
-           // TODO: check for transition to UncacheableDictionary
-           //
+            if (!dict->m_shouldNeverTransitToUncacheableDictionary && ShouldTransitToUncacheableDictionary(self, dict))
+            {
+                // The property we just inserted into the CacheableDictionary has value nil, so it's simply dropped by the transition
+                //
+                VM* vm = VM::GetActiveVMForCurrentThread();
+                TranslateToRawPointer(vm, self)->TransitToUncacheableDictionary(vm);
+                SystemHeapPointer<void> newHiddenClass = TCGet(self->m_hiddenClass);
+                PreparePutByIdForUncacheableDictionary(newHiddenClass.As<UncacheableDictionary>(), propertyName, icInfo /*out*/);
+                return;
+            }
         }
 
         // For Dictionary, since it is 1-on-1 with the object, we always insert the property if it doesn't exist (and this step is idempotent)
@@ -810,6 +972,117 @@ public:
         }
     }
 
+    // A CacheableDictionary transits to UncacheableDictionary if it has too many properties, or if it has a lot of properties but most of them are nil
+    // (which happens if the table is used as a hash map with keys being inserted and deleted)
+    //
+    // This is only checked when the dictionary hash table is resized, so the check cost is amortized
+    //
+    static constexpr uint32_t x_uncacheableDictionaryTransitionMinSlotsForChurnCheck = 64;
+    static constexpr uint32_t x_uncacheableDictionaryTransitionSlotsThreshold = 1024;
+
+    template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
+    static bool WARN_UNUSED ShouldTransitToUncacheableDictionary(T self, HeapPtr<CacheableDictionary> dict)
+    {
+        uint32_t slotCount = dict->m_slotCount;
+        if (slotCount < x_uncacheableDictionaryTransitionMinSlotsForChurnCheck)
+        {
+            return false;
+        }
+        if (slotCount >= x_uncacheableDictionaryTransitionSlotsThreshold)
+        {
+            return true;
+        }
+
+        uint8_t inlineStorageCapacity = dict->m_inlineNamedStorageCapacity;
+        uint32_t numNilSlots = 0;
+        for (uint32_t slotOrd = 0; slotOrd < slotCount; slotOrd++)
+        {
+            if (GetValueForSlot(self, slotOrd, inlineStorageCapacity).IsNil())
+            {
+                numNilSlots++;
+            }
+        }
+        return numNilSlots * 2 >= slotCount;
+    }
+
+    // Transit the hidden class from CacheableDictionary to UncacheableDictionary, only keeping the non-nil properties
+    //
+    void NO_INLINE TransitToUncacheableDictionary(VM* vm)
+    {
+        assert(m_hiddenClass.As<SystemHeapGcObjectHeader>()->m_type == HeapEntityType::CacheableDictionary);
+        CacheableDictionary* cd = TranslateToRawPointer(vm, m_hiddenClass.As<CacheableDictionary>());
+        assert(!cd->m_shouldNeverTransitToUncacheableDictionary);
+
+        uint8_t inlineStorageCapacity = cd->m_inlineNamedStorageCapacity;
+        uint32_t numKeys = 0;
+        for (uint32_t slotOrd = 0; slotOrd < cd->m_slotCount; slotOrd++)
+        {
+            if (!GetValueForSlot(this, slotOrd, inlineStorageCapacity).IsNil())
+            {
+                numKeys++;
+            }
+        }
+
+        UncacheableDictionary* ud = UncacheableDictionary::CreateEmpty(vm, numKeys, inlineStorageCapacity, cd->m_butterflyNamedStorageCapacity);
+        ud->m_metatable = cd->m_metatable;
+
+        CacheableDictionary::HashTableEntry* htEnd = cd->m_hashTable + cd->m_hashTableMask + 1;
+        for (CacheableDictionary::HashTableEntry* entry = cd->m_hashTable; entry < htEnd; entry++)
+        {
+            if (entry->m_key.m_value == 0)
+            {
+                continue;
+            }
+            TValue value = GetValueForSlot(this, entry->m_slot, inlineStorageCapacity);
+            if (value.IsNil())
+            {
+                continue;
+            }
+            UserHeapPointer<void> key = entry->m_key.As();
+            ud->InsertNonExistentPropertyForInitOrRehash(key, StructureKeyHashHelper::GetHashValueForMaybeNonStringKey(key), value);
+        }
+        ud->m_numKeys = numKeys;
+
+        // The named storage is no longer used, clear it so it doesn't keep the old values alive
+        //
+        for (uint32_t slotOrd = 0; slotOrd < cd->m_slotCount; slotOrd++)
+        {
+            if (slotOrd < inlineStorageCapacity)
+            {
+                m_inlineStorage[slotOrd] = TValue::Nil();
+            }
+            else
+            {
+                *m_butterfly->GetNamedPropertyAddr(Butterfly::GetOutlineStorageIndex(slotOrd, inlineStorageCapacity)) = TValue::Nil();
+            }
+        }
+
+        // Since CacheableDictionary and object is 1-on-1, the old dictionary will never be used anymore
+        //
+        delete [] cd->m_hashTable;
+        cd->m_hashTable = nullptr;
+
+        m_hiddenClass = ud;
+        AssertIff(m_arrayType.MayHaveMetatable(), ud->m_metatable.m_value != 0);
+    }
+
+    template<typename U>
+    static void PreparePutByIdForUncacheableDictionary(HeapPtr<UncacheableDictionary> dict, UserHeapPointer<U> propertyName, PutByIdICInfo& icInfo /*out*/)
+    {
+        icInfo.m_icKind = PutByIdICInfo::ICKind::UncacheableDictionary;
+        icInfo.m_isInlineCacheable = false;
+        icInfo.m_shouldGrowButterfly = false;
+        icInfo.m_mayHaveMetatable = (dict->m_metatable.m_value != 0);
+        if (icInfo.m_mayHaveMetatable)
+        {
+            icInfo.m_propertyExists = !UncacheableDictionary::GetValue(dict, propertyName).IsNil();
+        }
+        else
+        {
+            icInfo.m_propertyExists = false;
+        }
+    }
+
     template<typename U>
     static void PreparePutByIdForStructure(HeapPtr<Structure> structure, UserHeapPointer<U> propertyName, PutByIdICInfo& icInfo /*out*/)
     {
@@ -895,10 +1168,61 @@ public:
         }
         else
         {
-            // icInfo.m_isInlineCacheable = false;
-            // TODO: support UncacheableDictionary
-            assert(false && "unimplemented");
-            __builtin_unreachable();
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            HeapPtr<UncacheableDictionary> dict = hiddenClass.As<UncacheableDictionary>();
+            PreparePutByIdForUncacheableDictionary(dict, propertyName, icInfo /*out*/);
+        }
+    }
+
+    // Same as PreparePutById, but for an IC site that has already reached its maximum number of IC entries
+    // The megamorphic property cache can only answer the case where the property exists, since otherwise
+    // the put needs a Structure transition, which still goes through the Structure.
+    //
+    static void PreparePutByIdForMegamorphicSite(HeapPtr<TableObject> self, UserHeapPointer<HeapString> propertyName, PutByIdICInfo& icInfo /*out*/)
+    {
+        SystemHeapPointer<void> hiddenClass = TCGet(self->m_hiddenClass);
+        if (unlikely(hiddenClass.As<SystemHeapGcObjectHeader>()->m_type != HeapEntityType::Structure))
+        {
+            PreparePutById(self, propertyName, icInfo /*out*/);
+            return;
+        }
+
+        MegamorphicPropertyCache& cache = VM::GetActiveVMForCurrentThread()->m_megamorphicPropertyCache;
+        MegamorphicPropertyCache::Entry* entry = cache.Find(hiddenClass.m_value, propertyName.m_value);
+        if (likely(entry != nullptr && entry->m_kind != MegamorphicPropertyCache::Kind::Absent))
+        {
+            icInfo.m_isInlineCacheable = true;
+            icInfo.m_mayHaveMetatable = entry->m_mayHaveMetatable;
+            icInfo.m_propertyExists = true;
+            icInfo.m_shouldGrowButterfly = false;
+            icInfo.m_slot = entry->m_slot;
+            if (entry->m_kind == MegamorphicPropertyCache::Kind::InlinedStorage)
+            {
+                icInfo.m_icKind = PutByIdICInfo::ICKind::InlinedStorage;
+            }
+            else
+            {
+                assert(entry->m_kind == MegamorphicPropertyCache::Kind::OutlinedStorage);
+                icInfo.m_icKind = PutByIdICInfo::ICKind::OutlinedStorage;
+            }
+            return;
+        }
+
+        PreparePutByIdForStructure(hiddenClass.As<Structure>(), propertyName, icInfo /*out*/);
+
+        if (icInfo.m_propertyExists)
+        {
+            MegamorphicPropertyCache::Kind cacheKind;
+            if (icInfo.m_icKind == PutByIdICInfo::ICKind::InlinedStorage)
+            {
+                cacheKind = MegamorphicPropertyCache::Kind::InlinedStorage;
+            }
+            else
+            {
+                assert(icInfo.m_icKind == PutByIdICInfo::ICKind::OutlinedStorage);
+                cacheKind = MegamorphicPropertyCache::Kind::OutlinedStorage;
+            }
+            cache.Insert(hiddenClass.m_value, propertyName.m_value, cacheKind, icInfo.m_slot, icInfo.m_mayHaveMetatable);
         }
     }
 
@@ -930,6 +1254,13 @@ public:
             return true;
         }
 
+        // For UncacheableDictionary, m_propertyExists already tells that the value is not nil
+        //
+        if (icInfo.m_icKind == PutByIdICInfo::ICKind::UncacheableDictionary)
+        {
+            return false;
+        }
+
         // Now we need to determine if the property is nil
         //
         assert(icInfo.m_icKind != PutByIdICInfo::ICKind::TransitionedToDictionaryMode);
@@ -960,6 +1291,37 @@ public:
         }
     }
 
+    // Small butterflies are allocated from the user heap segregated allocator, so storages freed due to butterfly growth
+    // can be reused by subsequent allocations of the same size class.
+    // Butterflies larger than the largest size class are allocated with the system allocator, so their memory can be
+    // returned to the OS when freed.
+    //
+    static uint64_t* WARN_UNUSED AllocateButterflyStorage(uint32_t numSlots)
+    {
+        if (likely(numSlots <= internal::x_userHeapMaxSizeClassSlots))
+        {
+            VM* vm = VM::GetActiveVMForCurrentThread();
+            return reinterpret_cast<uint64_t*>(vm->AllocRawFromUserHeap(numSlots * static_cast<uint32_t>(sizeof(uint64_t))));
+        }
+        else
+        {
+            return new uint64_t[numSlots];
+        }
+    }
+
+    static void FreeButterflyStorage(uint64_t* butterflyStart, uint32_t numSlots)
+    {
+        if (likely(numSlots <= internal::x_userHeapMaxSizeClassSlots))
+        {
+            VM* vm = VM::GetActiveVMForCurrentThread();
+            vm->FreeRawToUserHeap(butterflyStart, numSlots * static_cast<uint32_t>(sizeof(uint64_t)));
+        }
+        else
+        {
+            delete [] butterflyStart;
+        }
+    }
+
     template<bool isGrowNamedStorage>
     void GrowButterflyFromNull(uint32_t newCapacity)
     {
@@ -975,10 +1337,11 @@ public:
         }
         else
         {
-           // TODO: assert for UncacheableDictionary
+            assert(m_hiddenClass.As<SystemHeapGcObjectHeader>()->m_type == HeapEntityType::UncacheableDictionary);
+            assert(m_hiddenClass.As<UncacheableDictionary>()->m_butterflyNamedStorageCapacity == 0);
         }
 #endif
-        uint64_t* butterflyStart = new uint64_t[newCapacity + 1];
+        uint64_t* butterflyStart = AllocateButterflyStorage(newCapacity + 1);
         uint32_t offset;
         if constexpr(isGrowNamedStorage)
         {
@@ -1048,8 +1411,8 @@ public:
             else
             {
                 assert(hiddenClassTy == HeapEntityType::UncacheableDictionary);
-                // TODO: support UncacheableDictionary
-                assert(false && "unimplemented");
+                assert(!isGrowNamedStorage);
+                assert(oldNamedStorageCapacity == m_hiddenClass.As<UncacheableDictionary>()->m_butterflyNamedStorageCapacity);
             }
 #endif
             uint32_t oldButterflySlots = oldArrayStorageCapacity + oldNamedStorageCapacity + 1;
@@ -1074,7 +1437,7 @@ public:
 
             assert(newButterflySlots > oldButterflySlots);
 
-            uint64_t* newButterflyStart = new uint64_t[newButterflySlots];
+            uint64_t* newButterflyStart = AllocateButterflyStorage(newButterflySlots);
             if constexpr(isGrowNamedStorage)
             {
                 uint64_t nilVal = TValue::Nil().m_value;
@@ -1100,7 +1463,7 @@ public:
                 }
             }
 
-            delete [] oldButterflyStart;
+            FreeButterflyStorage(oldButterflyStart, oldButterflySlots);
             uint32_t offset = newButterflyNamedStorageCapacity + static_cast<uint32_t>(1 - ArrayGrowthPolicy::x_arrayBaseOrd);
             Butterfly* butterfly = reinterpret_cast<Butterfly*>(newButterflyStart + offset);
             if constexpr(!isGrowNamedStorage)
@@ -1127,9 +1490,7 @@ public:
         else
         {
             assert(hiddenClassTy == HeapEntityType::UncacheableDictionary);
-            // TODO: support UncacheableDictionary
-            assert(false && "unimplemented");
-            __builtin_unreachable();
+            oldNamedStorageCapacity = m_hiddenClass.As<UncacheableDictionary>()->m_butterflyNamedStorageCapacity;
         }
         GrowButterflyKnowingNamedStorageCapacity<isGrowNamedStorage>(oldNamedStorageCapacity, newCapacity);
     }
@@ -1199,6 +1560,14 @@ public:
         rawSelf->PutByIdTransitionToDictionaryImpl(vm, propertyName, newValue);
     }
 
+    template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
+    static void NO_INLINE PutByIdIntoUncacheableDictionary(T self, UserHeapPointer<void> propertyName, TValue newValue)
+    {
+        SystemHeapPointer<void> hiddenClass = TCGet(self->m_hiddenClass);
+        assert(hiddenClass.As<SystemHeapGcObjectHeader>()->m_type == HeapEntityType::UncacheableDictionary);
+        UncacheableDictionary::Put(hiddenClass.As<UncacheableDictionary>(), propertyName, newValue);
+    }
+
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, TableObject>>>
     static void ALWAYS_INLINE PutById(T self, UserHeapPointer<void> propertyName, TValue newValue, PutByIdICInfo icInfo)
     {
@@ -1208,6 +1577,12 @@ public:
             return;
         }
 
+        if (icInfo.m_icKind == PutByIdICInfo::ICKind::UncacheableDictionary)
+        {
+            PutByIdIntoUncacheableDictionary(self, propertyName, newValue);
+            return;
+        }
+
         if (!icInfo.m_propertyExists)
         {
             if (icInfo.m_shouldGrowButterfly)
@@ -1272,13 +1647,12 @@ public:
                     Structure* newStructure = structure->UpdateArrayType(vm, newArrType);
                     icInfo.m_newHiddenClass = newStructure;
                 }
-                else if (ty == HeapEntityType::CacheableDictionary)
-                {
-                    icInfo.m_newHiddenClass = icInfo.m_hiddenClass;
-                }
                 else
                 {
-                    assert(false && "unimplemented");
+                    // For dictionary, the array type is stored in the object only, so the hidden class is unchanged
+                    //
+                    assert(ty == HeapEntityType::CacheableDictionary || ty == HeapEntityType::UncacheableDictionary);
+                    icInfo.m_newHiddenClass = icInfo.m_hiddenClass;
                 }
                 icInfo.m_newArrayType = newArrType;
             };
@@ -2164,8 +2538,7 @@ public:
         else
         {
             assert(hiddenClassTy == HeapEntityType::UncacheableDictionary);
-            // TODO: support UncacheableDictionary
-            ReleaseAssert(false && "unimplemented");
+            assert(butterflyNamedStorageCapacity == m_hiddenClass.As<UncacheableDictionary>()->m_butterflyNamedStorageCapacity);
         }
 #endif
         uint32_t butterflySlots = arrayStorageCapacity + butterflyNamedStorageCapacity + 1;
@@ -2173,7 +2546,7 @@ public:
         uint32_t butterflyStartOffset = butterflyNamedStorageCapacity + static_cast<uint32_t>(1 - ArrayGrowthPolicy::x_arrayBaseOrd);
         uint64_t* butterflyStart = reinterpret_cast<uint64_t*>(m_butterfly) - butterflyStartOffset;
 
-        uint64_t* butterflyCopy = new uint64_t[butterflySlots];
+        uint64_t* butterflyCopy = AllocateButterflyStorage(butterflySlots);
         memcpy(butterflyCopy, butterflyStart, sizeof(uint64_t) * butterflySlots);
         Butterfly* butterflyPtr = reinterpret_cast<Butterfly*>(butterflyCopy + butterflyStartOffset);
 
@@ -2217,8 +2590,12 @@ public:
         }
         else
         {
-            // TODO: support UncacheableDictionary
-            ReleaseAssert(false && "unimplemented");
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            UncacheableDictionary* ud = TranslateToRawPointer(m_hiddenClass.As<UncacheableDictionary>());
+            UncacheableDictionary* cloneUd = ud->Clone(vm);
+            inlineCapacity = ud->m_inlineNamedStorageCapacity;
+            butterflyNamedStorageCapacity = ud->m_butterflyNamedStorageCapacity;
+            newHiddenClass = cloneUd;
         }
 
         TableObject* r = TranslateToRawPointer(vm, AllocateObjectImpl(vm, inlineCapacity));
@@ -2249,7 +2626,7 @@ public:
         uint32_t butterflySlots = arrayStorageCapacity + 1;
         uint32_t butterflyStartOffset = static_cast<uint32_t>(1 - ArrayGrowthPolicy::x_arrayBaseOrd);
         uint64_t* butterflyStart = reinterpret_cast<uint64_t*>(m_butterfly) - butterflyStartOffset;
-        uint64_t* butterflyCopy = new uint64_t[butterflySlots];
+        uint64_t* butterflyCopy = AllocateButterflyStorage(butterflySlots);
         memcpy(butterflyCopy, butterflyStart, sizeof(uint64_t) * butterflySlots);
         Butterfly* butterflyPtr = reinterpret_cast<Butterfly*>(butterflyCopy + butterflyStartOffset);
         assert(!butterflyPtr->GetHeader()->HasSparseMap());
@@ -2259,8 +2636,10 @@ public:
     // These are just some artificial configuration limits for specialized TableDup opcodes
     // Maybe the config shouldn't be put here, but let's think about that later..
     //
-    static constexpr uint8_t TableDupMaxInlineCapacitySteppingForNoButterflyCase() { return 3; }
-    static constexpr uint8_t TableDupMaxInlineCapacitySteppingForHasButterflyCase() { return 2; }
+    // The limits are chosen so that the specialized opcodes cover inline capacity up to 30 and 14 respectively.
+    //
+    static constexpr uint8_t TableDupMaxInlineCapacitySteppingForNoButterflyCase() { return 10; }
+    static constexpr uint8_t TableDupMaxInlineCapacitySteppingForHasButterflyCase() { return 6; }
 
     // Specialized ShallowCloneTableObject for TableDup, which leverages the statically known information for better code.
     // This function is ALWAYS_INLINE because by design the arguments will be constants after inlining.
@@ -2355,8 +2734,14 @@ public:
         }
         else
         {
-            // TODO: support UncacheableDictionary
-            ReleaseAssert(false && "unimplemented");
+            // The metatable of an UncacheableDictionary is changed in place, so it cannot be cached
+            //
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            HeapPtr<UncacheableDictionary> ud = hc.As<UncacheableDictionary>();
+            return GetMetatableResult {
+                .m_result = TCGet(ud->m_metatable),
+                .m_isCacheable = false
+            };
         }
     }
 
@@ -2413,8 +2798,10 @@ public:
         }
         else
         {
-            // TODO: support UncacheableDictionary
-            ReleaseAssert(false && "unimplemented");
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            UncacheableDictionary* ud = TranslateToRawPointer(vm, hc.As<UncacheableDictionary>());
+            ud->m_metatable = newMetatable;
+            m_arrayType.SetMayHaveMetatable(true);
         }
     }
 
@@ -2465,8 +2852,10 @@ public:
         }
         else
         {
-            // TODO: support UncacheableDictionary
-            ReleaseAssert(false && "unimplemented");
+            assert(ty == HeapEntityType::UncacheableDictionary);
+            UncacheableDictionary* ud = TranslateToRawPointer(vm, hc.As<UncacheableDictionary>());
+            ud->m_metatable.m_value = 0;
+            m_arrayType.SetMayHaveMetatable(false);
         }
     }
 
@@ -2674,6 +3063,53 @@ public:
 };
 static_assert(sizeof(TableObject) == 16);
 
+// The Lua 'userdata' type: an opaque block of memory with a per-object metatable, owned by the C++ side of the VM
+// The payload is interpreted according to 'm_kind'
+//
+class alignas(8) HeapCDataObject final : public UserHeapGcObjectHeader
+{
+public:
+    static constexpr uint32_t x_hiddenClassForCDataObject = 0x28;
+
+    enum class Kind : uint8_t
+    {
+        // The payload is a LuaFileHandle
+        //
+        LuaFile
+    };
+
+    static HeapPtr<HeapCDataObject> WARN_UNUSED Create(VM* vm, Kind kind, UserHeapPointer<void> metatable, uint32_t payloadSize)
+    {
+        size_t allocSize = RoundUpToMultipleOf<8>(sizeof(HeapCDataObject) + payloadSize);
+        HeapPtr<HeapCDataObject> hp = vm->AllocFromUserHeap(static_cast<uint32_t>(allocSize)).AsNoAssert<HeapCDataObject>();
+        HeapCDataObject* r = TranslateToRawPointer(vm, hp);
+        UserHeapGcObjectHeader::Populate(r);
+        r->m_hiddenClass = x_hiddenClassForCDataObject;
+        r->m_opaque = 0;
+        r->m_arrayType = ArrayType::x_invalidArrayType;
+        r->m_kind = kind;
+        r->m_payloadSize = payloadSize;
+        r->m_metatable = metatable;
+        memset(r->m_payload, 0, payloadSize);
+        return hp;
+    }
+
+    template<typename T>
+    T* WARN_UNUSED GetPayload()
+    {
+        assert(sizeof(T) <= m_payloadSize);
+        return reinterpret_cast<T*>(m_payload);
+    }
+
+    Kind m_kind;
+    uint32_t m_payloadSize;
+    // nullptr if the userdata has no metatable
+    //
+    UserHeapPointer<void> m_metatable;
+    alignas(8) uint8_t m_payload[0];
+};
+static_assert(sizeof(HeapCDataObject) == 24);
+
 inline UserHeapPointer<void> GetMetatableForValue(TValue value)
 {
     if (likely(value.IsPointer()))
@@ -2702,8 +3138,8 @@ inline UserHeapPointer<void> GetMetatableForValue(TValue value)
             return VM::GetActiveVMForCurrentThread()->m_metatableForCoroutine;
         }
 
-        // TODO: support USERDATA type
-        ReleaseAssert(false && "unimplemented");
+        assert(ty == HeapEntityType::Userdata);
+        return TCGet(value.AsPointer<HeapCDataObject>().As()->m_metatable);
     }
 
     if (value.IsMIV())
@@ -2780,8 +3216,8 @@ inline HeapPtr<FunctionObject> WARN_UNUSED NO_INLINE GetCallTargetViaMetatable(T
             return GetCallMetamethodFromMetatableImpl(VM::GetActiveVMForCurrentThread()->m_metatableForCoroutine);
         }
 
-        // TODO: support USERDATA type
-        ReleaseAssert(false && "unimplemented");
+        assert(ty == HeapEntityType::Userdata);
+        return GetCallMetamethodFromMetatableImpl(TCGet(value.AsPointer<HeapCDataObject>().As()->m_metatable));
     }
 
     if (value.Is<tNil>())
@@ -2809,9 +3245,9 @@ inline HeapPtr<FunctionObject> WARN_UNUSED NO_INLINE GetCallTargetViaMetatable(T
 // Lua explicitly states that if new keys are added, the behavior for iterator is undefined. So we don't need to worry
 // about correctness when there's a change in hidden class, as long as we don't crash or cause data corruptions in such cases.
 //
-// The story could be more difficult once we support UncacheableDictionary, as Lua explicitly allows deletion of keys during a traversal.
-// Here's the proposal to deal with this issue: transition from CacheableDictionary to UncacheableDictionary, or resizing (including
-// shrinking) of UncacheableDictionary's hash table should be made to only happen upon key insertion, never at other times. Now, if
+// The story is more difficult for UncacheableDictionary, as Lua explicitly allows deletion of keys during a traversal.
+// We deal with this issue as follows: transition from CacheableDictionary to UncacheableDictionary, or resizing (including
+// shrinking) of UncacheableDictionary's hash table only happens upon key insertion, never at other times. Now, if
 // the table transited to UncacheableDictionary or the UncacheableDictionary's hash table gets rehashed during a traversal, it means
 // the user must have already violated the Lua standard by inserted a new key, so we are free to exhibit undefined behavior, so we are good.
 //
@@ -2843,6 +3279,7 @@ struct TableObjectIterator
         HeapEntityType hcType;
         HeapPtr<Structure> structure;
         HeapPtr<CacheableDictionary> cacheableDict;
+        HeapPtr<UncacheableDictionary> uncacheableDict;
         ArraySparseMap* sparseMap;
 
         if (unlikely(m_state == IteratorState::Uninitialized))
@@ -2869,9 +3306,10 @@ struct TableObjectIterator
             }
             else
             {
-                // TODO: support UncacheableDictionary
-                assert(false && "unimplemented");
-                __builtin_unreachable();
+                uncacheableDict = TCGet(obj->m_hiddenClass).As<UncacheableDictionary>();
+                m_state = IteratorState::NamedProperty;
+                m_namedPropertyOrd = 0;
+                goto try_find_and_get_ud_prop;
             }
         }
 
@@ -2953,9 +3391,39 @@ try_find_and_get_cd_prop:
             }
             else
             {
-                // TODO: support UncacheableDictionary
-                assert(false && "unimplemented");
-                __builtin_unreachable();
+                uncacheableDict = TCGet(obj->m_hiddenClass).As<UncacheableDictionary>();
+                m_namedPropertyOrd++;
+
+try_find_and_get_ud_prop:
+                UncacheableDictionary::HashTableEntry* ht = uncacheableDict->m_hashTable;
+                uint32_t htMask = uncacheableDict->m_hashTableMask;
+                while (m_namedPropertyOrd <= htMask)
+                {
+                    UncacheableDictionary::HashTableEntry& entry = ht[m_namedPropertyOrd];
+                    if (entry.m_key.m_value != 0 && !entry.m_value.IsNil())
+                    {
+                        UserHeapPointer<void> key = entry.m_key.As();
+                        TValue tvKey;
+                        if (unlikely(key == VM_GetSpecialKeyForBoolean(false).As<void>()))
+                        {
+                            tvKey = TValue::CreateFalse();
+                        }
+                        else if (unlikely(key == VM_GetSpecialKeyForBoolean(true).As<void>()))
+                        {
+                            tvKey = TValue::CreateTrue();
+                        }
+                        else
+                        {
+                            tvKey = TValue::CreatePointer(key);
+                        }
+                        return KeyValuePair {
+                            .m_key = tvKey,
+                            .m_value = entry.m_value
+                        };
+                    }
+                    m_namedPropertyOrd++;
+                }
+                goto try_start_iterating_vector_storage;
             }
 
 try_start_iterating_vector_storage:
@@ -3101,8 +3569,19 @@ finished_iteration:
             }
             else
             {
-                // TODO: support UncacheableDictionary
-                ReleaseAssert(false && "unimplemented");
+                // The key is never removed from the hash table by assigning nil to it, so this works even if the key has been deleted
+                //
+                HeapPtr<UncacheableDictionary> uncacheableDict = TCGet(obj->m_hiddenClass).As<UncacheableDictionary>();
+                uint32_t hashTableSlot = UncacheableDictionary::GetHashTableSlotNumberForProperty(uncacheableDict, prop);
+                if (hashTableSlot == static_cast<uint32_t>(-1))
+                {
+                    return false;
+                }
+                TableObjectIterator iter;
+                iter.m_state = IteratorState::NamedProperty;
+                iter.m_namedPropertyOrd = hashTableSlot;
+                out = iter.Advance(obj);
+                return true;
             }
         }
 
@@ -1,6 +1,8 @@
 #include "vm.h"
 #include "runtime_utils.h"
+#include "lualib_pattern_matcher.h"
 #include "deegen_options.h"
+#include "baseline_jit_compile_queue.h"
 
 void InitializeDfgAllocationArenaIfNeeded();
 
@@ -120,6 +122,12 @@ bool WARN_UNUSED VM::InitializeVMBase()
     m_userHeapPtrLimit = -static_cast<int64_t>(x_vmBaseOffset - x_vmUserHeapSize);
     m_userHeapCurPtr = -static_cast<int64_t>(x_vmBaseOffset - x_vmUserHeapSize);
 
+    for (size_t i = 0; i < internal::x_numUserHeapSizeClasses; i++)
+    {
+        m_userHeapFreeList[i] = 0;
+    }
+    m_userHeapFreedBytes = 0;
+
     static_assert(sizeof(VM) >= x_minimum_valid_heap_address);
     m_systemHeapPtrLimit = static_cast<uint32_t>(RoundUpToMultipleOf<x_pageSize>(sizeof(VM)));
     m_systemHeapCurPtr = sizeof(VM);
@@ -141,6 +149,12 @@ bool WARN_UNUSED VM::InitializeVMBase()
     }
 
     m_totalBaselineJitCompilations = 0;
+    m_totalBaselineJitJettisons = 0;
+    m_baselineJitCompileQueue = nullptr;
+
+    m_gcPause = x_defaultGcPause;
+    m_gcStepMul = x_defaultGcStepMul;
+    m_gcIsStopped = false;
 
     return true;
 }
@@ -305,8 +319,21 @@ bool WARN_UNUSED VM::InitializeVMGlobalData()
     {
         m_initialStructureForDifferentInlineCapacity[i].m_value = 0;
     }
+    for (size_t i = 0; i < x_numStructureTransitionTableSizeClasses; i++)
+    {
+        m_structureTransitionTableFreeLists[i] = 0;
+    }
+    m_baselineCodeBlockFreeLists = new std::unordered_map<uint32_t, uint32_t>();
+    m_unlinkedCodeBlockFreeList = 0;
+    m_coroutineStackPoolHead = nullptr;
+    m_coroutineStackPoolSize = 0;
+    m_coroutineStackIndex = new CoroutineStackIndex();
+    CoroutineRuntimeContext::InstallStackFaultHandler(this);
     m_filePointerForStdout = stdout;
     m_filePointerForStderr = stderr;
+    m_stdoutBuffer = new char[x_stdoutBufferSize];
+    m_stdoutBufferLen = 0;
+    m_stdoutBufferMode = GetDefaultStdoutBufferMode(stdout);
 
     m_metatableForNil = UserHeapPointer<void>();
     m_metatableForBoolean = UserHeapPointer<void>();
@@ -314,6 +341,12 @@ bool WARN_UNUSED VM::InitializeVMGlobalData()
     m_metatableForString = UserHeapPointer<void>();
     m_metatableForFunction = UserHeapPointer<void>();
     m_metatableForCoroutine = UserHeapPointer<void>();
+    m_metatableForFileHandle = UserHeapPointer<void>();
+    m_ioDefaultInputFile = UserHeapPointer<HeapCDataObject>();
+    m_ioDefaultOutputFile = UserHeapPointer<HeapCDataObject>();
+    m_openFileListHead = nullptr;
+    m_luaPatternCache = nullptr;
+    m_megamorphicPropertyCache.Reset();
 
     m_emptyString = nullptr;
     m_toStringString.m_value = 0;
@@ -329,14 +362,20 @@ bool WARN_UNUSED VM::InitializeVMGlobalData()
 bool WARN_UNUSED VM::InitializeVMStringManager()
 {
     static constexpr uint32_t x_initialSize = 1024;
-    m_hashTable = new (std::nothrow) GeneralHeapPointer<HeapString>[x_initialSize];
-    CHECK_LOG_ERROR(m_hashTable != nullptr, "Failed to allocate space for initial hash table");
+    GeneralHeapPointer<HeapString>* hashTable = new (std::nothrow) GeneralHeapPointer<HeapString>[x_initialSize];
+    CHECK_LOG_ERROR(hashTable != nullptr, "Failed to allocate space for initial hash table");
 
     static_assert(x_stringConserHtNonexistentValue == 0, "required for memset");
-    memset(m_hashTable, 0, sizeof(GeneralHeapPointer<HeapString>) * x_initialSize);
+    memset(hashTable, 0, sizeof(GeneralHeapPointer<HeapString>) * x_initialSize);
 
-    m_hashTableSizeMask = x_initialSize - 1;
+    m_hashTable.store(hashTable, std::memory_order_relaxed);
+    m_hashTableSizeMask.store(x_initialSize - 1, std::memory_order_relaxed);
     m_elementCount = 0;
+    m_oldHashTable.store(nullptr, std::memory_order_relaxed);
+    m_oldHashTableSizeMask.store(0, std::memory_order_relaxed);
+    m_oldHashTableMigrationCursor = 0;
+    m_stringConserTableVersion.store(0, std::memory_order_relaxed);
+    m_stringConserNumConcurrentReaders.store(0, std::memory_order_relaxed);
 
     // Create a special key used as an exotic index into the table
     //
@@ -380,10 +419,22 @@ bool WARN_UNUSED VM::InitializeVMStringManager()
 
 void VM::CleanupVMStringManager()
 {
-    if (m_hashTable != nullptr)
+    assert(m_stringConserNumConcurrentReaders.load() == 0);
+    if (m_hashTable.load() != nullptr)
+    {
+        delete [] m_hashTable.load();
+        m_hashTable.store(nullptr);
+    }
+    if (m_oldHashTable.load() != nullptr)
+    {
+        delete [] m_oldHashTable.load();
+        m_oldHashTable.store(nullptr);
+    }
+    for (GeneralHeapPointer<HeapString>* ht : m_retiredStringConserHashTables)
     {
-        delete [] m_hashTable;
+        delete [] ht;
     }
+    m_retiredStringConserHashTables.clear();
 }
 
 bool WARN_UNUSED VM::Initialize()
@@ -401,9 +452,100 @@ bool WARN_UNUSED VM::Initialize()
 
 void VM::Cleanup()
 {
+    SetBackgroundBaselineJitCompilation(false);
+    LuaFileHandle::CloseAllOpenFiles(this);
+    std::ignore = FlushStdout();
+    delete [] m_stdoutBuffer;
+    m_stdoutBuffer = nullptr;
+    delete m_luaPatternCache;
+    m_luaPatternCache = nullptr;
+    CoroutineRuntimeContext::DrainStackPool(this);
+    CoroutineRuntimeContext::UninstallStackFaultHandler(this);
+    delete m_baselineCodeBlockFreeLists;
+    m_baselineCodeBlockFreeLists = nullptr;
     CleanupVMStringManager();
 }
 
+VM::StdoutBufferMode WARN_UNUSED VM::GetDefaultStdoutBufferMode(FILE* fp)
+{
+    int fd = fileno(fp);
+    if (fd >= 0 && isatty(fd))
+    {
+        return StdoutBufferMode::Line;
+    }
+    return StdoutBufferMode::Full;
+}
+
+bool WARN_UNUSED VM::DrainStdoutBuffer()
+{
+    if (m_stdoutBufferLen == 0)
+    {
+        return true;
+    }
+    size_t len = m_stdoutBufferLen;
+    m_stdoutBufferLen = 0;
+    return fwrite(m_stdoutBuffer, 1, len, m_filePointerForStdout) == len;
+}
+
+bool WARN_UNUSED VM::FlushStdout()
+{
+    bool success = DrainStdoutBuffer();
+    return (fflush(m_filePointerForStdout) == 0) && success;
+}
+
+bool WARN_UNUSED VM::WriteToStdoutSlowPath(const void* data, size_t len)
+{
+    assert(len > x_stdoutBufferSize - m_stdoutBufferLen);
+    if (!DrainStdoutBuffer())
+    {
+        return false;
+    }
+    if (len >= x_stdoutBufferSize)
+    {
+        // Too large to be worth copying, hand it to stdio directly
+        //
+        if (fwrite(data, 1, len, m_filePointerForStdout) != len)
+        {
+            return false;
+        }
+        if (m_stdoutBufferMode != StdoutBufferMode::Full)
+        {
+            return fflush(m_filePointerForStdout) == 0;
+        }
+        return true;
+    }
+    return WriteToStdout(data, len);
+}
+
+bool WARN_UNUSED VM::FlushStdoutIfNotFullyBuffered(const void* data, size_t len)
+{
+    assert(m_stdoutBufferMode != StdoutBufferMode::Full);
+    if (m_stdoutBufferMode == StdoutBufferMode::Line && memchr(data, '\n', len) == nullptr)
+    {
+        return true;
+    }
+    return FlushStdout();
+}
+
+void VM::SetBackgroundBaselineJitCompilation(bool enable)
+{
+    if (enable)
+    {
+        if (m_baselineJitCompileQueue == nullptr)
+        {
+            m_baselineJitCompileQueue = new BaselineJitCompileQueue(this);
+        }
+    }
+    else
+    {
+        if (m_baselineJitCompileQueue != nullptr)
+        {
+            delete m_baselineJitCompileQueue;
+            m_baselineJitCompileQueue = nullptr;
+        }
+    }
+}
+
 namespace {
 
 // Compare if 's' is equal to the abstract multi-piece string represented by 'iterator'
@@ -482,20 +624,30 @@ void VM::ReinsertDueToResize(GeneralHeapPointer<HeapString>* hashTable, uint32_t
     {
         slot = (slot + 1) & hashTableSizeMask;
     }
-    hashTable[slot] = e;
+    StringHtStore(hashTable + slot, e);
 }
 
 void VM::ExpandStringConserHashTableIfNeeded()
 {
-    if (likely(m_elementCount <= (m_hashTableSizeMask >> x_stringht_loadfactor_denominator_shift) * x_stringht_loadfactor_numerator))
+    uint32_t curMask = m_hashTableSizeMask.load(std::memory_order_relaxed);
+    if (likely(m_elementCount <= (curMask >> x_stringht_loadfactor_denominator_shift) * x_stringht_loadfactor_numerator))
     {
         return;
     }
 
-    assert(m_hashTable != nullptr && is_power_of_2(m_hashTableSizeMask + 1));
-    VM_FAIL_IF(m_hashTableSizeMask >= (1U << 29),
+    // The previous migration should have finished long ago (see x_stringConserMigrationSlotsPerInsertion), but be safe
+    //
+    if (unlikely(m_oldHashTable.load(std::memory_order_relaxed) != nullptr))
+    {
+        MigrateStringConserHashTableSlots(static_cast<uint32_t>(-1));
+        assert(m_oldHashTable.load(std::memory_order_relaxed) == nullptr);
+    }
+
+    GeneralHeapPointer<HeapString>* curHt = m_hashTable.load(std::memory_order_relaxed);
+    assert(curHt != nullptr && is_power_of_2(curMask + 1));
+    VM_FAIL_IF(curMask >= (1U << 29),
                "Global string hash table has grown beyond 2^30 slots");
-    uint32_t newSize = (m_hashTableSizeMask + 1) * 2;
+    uint32_t newSize = (curMask + 1) * 2;
     uint32_t newMask = newSize - 1;
     GeneralHeapPointer<HeapString>* newHt = new (std::nothrow) GeneralHeapPointer<HeapString>[newSize];
     VM_FAIL_IF(newHt == nullptr,
@@ -504,93 +656,436 @@ void VM::ExpandStringConserHashTableIfNeeded()
     static_assert(x_stringConserHtNonexistentValue == 0, "we are relying on this to do memset");
     memset(newHt, 0, sizeof(GeneralHeapPointer<HeapString>) * newSize);
 
-    GeneralHeapPointer<HeapString>* cur = m_hashTable;
-    GeneralHeapPointer<HeapString>* end = m_hashTable + m_hashTableSizeMask + 1;
-    while (cur < end)
+    // Publish the new table. The current table becomes the old table, which is migrated incrementally on later insertions.
+    //
+    uint32_t version = m_stringConserTableVersion.load(std::memory_order_relaxed);
+    assert(version % 2 == 0);
+    m_stringConserTableVersion.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_oldHashTable.store(curHt, std::memory_order_relaxed);
+    m_oldHashTableSizeMask.store(curMask, std::memory_order_relaxed);
+    m_hashTable.store(newHt, std::memory_order_relaxed);
+    m_hashTableSizeMask.store(newMask, std::memory_order_relaxed);
+    m_stringConserTableVersion.store(version + 2, std::memory_order_release);
+    m_oldHashTableMigrationCursor = 0;
+}
+
+void VM::MigrateStringConserHashTableSlots(uint32_t maxSlots)
+{
+    GeneralHeapPointer<HeapString>* oldHt = m_oldHashTable.load(std::memory_order_relaxed);
+    assert(oldHt != nullptr);
+    uint32_t oldSize = m_oldHashTableSizeMask.load(std::memory_order_relaxed) + 1;
+    GeneralHeapPointer<HeapString>* newHt = m_hashTable.load(std::memory_order_relaxed);
+    uint32_t newMask = m_hashTableSizeMask.load(std::memory_order_relaxed);
+
+    uint32_t cursor = m_oldHashTableMigrationCursor;
+    uint32_t end = (oldSize - cursor > maxSlots) ? cursor + maxSlots : oldSize;
+    while (cursor < end)
     {
-        if (!StringHtCellValueIsNonExistentOrDeleted(cur->m_value))
+        GeneralHeapPointer<HeapString> e = oldHt[cursor];
+        if (!StringHtCellValueIsNonExistentOrDeleted(e))
         {
-            ReinsertDueToResize(newHt, newMask, *cur);
+            // The entry must become visible in the new table before it disappears from the old table,
+            // since the concurrent readers look up the old table first
+            //
+            ReinsertDueToResize(newHt, newMask, e);
+            StringHtStore(oldHt + cursor, GeneralHeapPointer<HeapString> { x_stringConserHtDeletedValue });
         }
-        cur++;
+        cursor++;
+    }
+    m_oldHashTableMigrationCursor = cursor;
+
+    if (cursor == oldSize)
+    {
+        uint32_t version = m_stringConserTableVersion.load(std::memory_order_relaxed);
+        assert(version % 2 == 0);
+        m_stringConserTableVersion.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_oldHashTable.store(nullptr, std::memory_order_relaxed);
+        m_oldHashTableSizeMask.store(0, std::memory_order_relaxed);
+        m_stringConserTableVersion.store(version + 2, std::memory_order_release);
+        m_oldHashTableMigrationCursor = 0;
+        RetireStringConserHashTable(oldHt);
     }
-    delete [] m_hashTable;
-    m_hashTable = newHt;
-    m_hashTableSizeMask = newMask;
 }
 
-// Insert an abstract multi-piece string into the hash table if it does not exist
-// Return the HeapString
-//
-template<typename Iterator>
-UserHeapPointer<HeapString> WARN_UNUSED VM::InsertMultiPieceString(Iterator iterator)
+void VM::RetireStringConserHashTable(GeneralHeapPointer<HeapString>* hashTable)
 {
-    HeapPtrTranslator translator = GetHeapPtrTranslator();
+    m_retiredStringConserHashTables.push_back(hashTable);
+    // The table has been unlinked before this point, so if no reader is active now, no reader can be using any retired table
+    //
+    // The fence pairs with the fence in TryFindInternedStringConcurrently. Without it, the load of the reader count may be reordered
+    // before the (non-seq_cst) stores that unlinked the table, so a reader could register, see the unlinked table, and have it freed under it.
+    // With both fences, either we see the reader, or the reader sees the table unlinked.
+    //
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_stringConserNumConcurrentReaders.load(std::memory_order_acquire) == 0)
+    {
+        for (GeneralHeapPointer<HeapString>* ht : m_retiredStringConserHashTables)
+        {
+            delete [] ht;
+        }
+        m_retiredStringConserHashTables.clear();
+    }
+}
 
-    StringLengthAndHash lenAndHash = HashMultiPieceString(iterator);
+template<typename Iterator>
+GeneralHeapPointer<HeapString> WARN_UNUSED ALWAYS_INLINE VM::FindMultiPieceStringInHashTable(
+    HeapPtrTranslator translator, GeneralHeapPointer<HeapString>* hashTable, uint32_t hashTableSizeMask,
+    Iterator iterator, StringLengthAndHash lenAndHash, uint32_t* slotForInsertion /*out*/)
+{
     uint64_t hash = lenAndHash.m_hashValue;
     size_t length = lenAndHash.m_length;
     uint8_t expectedHashHigh = static_cast<uint8_t>(hash >> 56);
     uint32_t expectedHashLow = BitwiseTruncateTo<uint32_t>(hash);
 
-    uint32_t slotForInsertion = static_cast<uint32_t>(-1);
-    uint32_t slot = static_cast<uint32_t>(hash) & m_hashTableSizeMask;
+    uint32_t slot = static_cast<uint32_t>(hash) & hashTableSizeMask;
     while (true)
     {
+        GeneralHeapPointer<HeapString> ptr = StringHtLoad(hashTable + slot);
+        if (StringHtCellValueIsNonExistentOrDeleted(ptr))
         {
-            GeneralHeapPointer<HeapString> ptr = m_hashTable[slot];
-            if (StringHtCellValueIsNonExistentOrDeleted(ptr))
+            // If this string turns out to be non-existent, this can be a slot to insert the string
+            //
+            if (slotForInsertion != nullptr && *slotForInsertion == static_cast<uint32_t>(-1))
             {
-                // If this string turns out to be non-existent, this can be a slot to insert the string
-                //
-                if (slotForInsertion == static_cast<uint32_t>(-1))
-                {
-                    slotForInsertion = slot;
-                }
-                if (StringHtCellValueIsNonExistent(ptr))
-                {
-                    break;
-                }
-                else
-                {
-                    goto next_slot;
-                }
+                *slotForInsertion = slot;
             }
-
-            HeapPtr<HeapString> s = ptr.As<HeapString>();
-            if (s->m_hashHigh != expectedHashHigh || s->m_hashLow != expectedHashLow || s->m_length != length)
+            if (StringHtCellValueIsNonExistent(ptr))
             {
-                goto next_slot;
+                return GeneralHeapPointer<HeapString>();
             }
-
-            HeapString* rawPtr = translator.TranslateToRawPtr(s);
-            if (!CompareMultiPieceStringEqual(iterator, rawPtr))
+        }
+        else
+        {
+            HeapString* s = translator.TranslateToRawPtr(ptr.As<HeapString>());
+            if (s->m_hashHigh == expectedHashHigh && s->m_hashLow == expectedHashLow && s->m_length == length)
             {
-                goto next_slot;
+                if (CompareMultiPieceStringEqual(iterator, s))
+                {
+                    return ptr;
+                }
             }
+        }
+        slot = (slot + 1) & hashTableSizeMask;
+    }
+}
+
+// Insert an abstract multi-piece string into the hash table if it does not exist
+// Return the HeapString
+//
+template<typename Iterator>
+UserHeapPointer<HeapString> WARN_UNUSED VM::InsertMultiPieceString(Iterator iterator, HeapString* adoptIfNotFound)
+{
+    HeapPtrTranslator translator = GetHeapPtrTranslator();
+
+    StringLengthAndHash lenAndHash = HashMultiPieceString(iterator);
+
+    // If a migration is in progress, the string may still be in the old table
+    //
+    GeneralHeapPointer<HeapString>* oldHt = m_oldHashTable.load(std::memory_order_relaxed);
+    if (unlikely(oldHt != nullptr))
+    {
+        GeneralHeapPointer<HeapString> ptr = FindMultiPieceStringInHashTable(
+            translator, oldHt, m_oldHashTableSizeMask.load(std::memory_order_relaxed), iterator, lenAndHash, nullptr /*slotForInsertion*/);
+        if (ptr.m_value != x_stringConserHtNonexistentValue)
+        {
+            return translator.TranslateToUserHeapPtr(translator.TranslateToRawPtr(ptr.As<HeapString>()));
+        }
+    }
 
+    GeneralHeapPointer<HeapString>* hashTable = m_hashTable.load(std::memory_order_relaxed);
+    uint32_t slotForInsertion = static_cast<uint32_t>(-1);
+    {
+        GeneralHeapPointer<HeapString> ptr = FindMultiPieceStringInHashTable(
+            translator, hashTable, m_hashTableSizeMask.load(std::memory_order_relaxed), iterator, lenAndHash, &slotForInsertion);
+        if (ptr.m_value != x_stringConserHtNonexistentValue)
+        {
             // We found the string
             //
-            return translator.TranslateToUserHeapPtr(rawPtr);
+            return translator.TranslateToUserHeapPtr(translator.TranslateToRawPtr(ptr.As<HeapString>()));
         }
-next_slot:
-        slot = (slot + 1) & m_hashTableSizeMask;
     }
 
     // The string is not found, insert it into the hash table
     //
     assert(slotForInsertion != static_cast<uint32_t>(-1));
-    assert(StringHtCellValueIsNonExistentOrDeleted(m_hashTable[slotForInsertion]));
+    assert(StringHtCellValueIsNonExistentOrDeleted(hashTable[slotForInsertion]));
 
     m_elementCount++;
-    HeapString* element = MaterializeMultiPieceString(this, iterator, lenAndHash);
-    m_hashTable[slotForInsertion] = translator.TranslateToGeneralHeapPtr(element);
+    HeapString* element;
+    if (adoptIfNotFound != nullptr)
+    {
+        // The content is already materialized, simply turn the lazily interned string into the interned string
+        //
+        assert(HeapString::IsLazilyInterned(adoptIfNotFound) && adoptIfNotFound->m_length == lenAndHash.m_length);
+        element = adoptIfNotFound;
+        element->PopulateHeader(lenAndHash);
+        assert(HashString(element->m_string, element->m_length) == lenAndHash.m_hashValue);
+    }
+    else
+    {
+        element = MaterializeMultiPieceString(this, iterator, lenAndHash);
+    }
+    // The store has release semantics, so a concurrent reader that sees the pointer also sees the string content
+    //
+    StringHtStore(hashTable + slotForInsertion, translator.TranslateToGeneralHeapPtr(element));
 
+    if (unlikely(oldHt != nullptr))
+    {
+        MigrateStringConserHashTableSlots(x_stringConserMigrationSlotsPerInsertion);
+    }
     ExpandStringConserHashTableIfNeeded();
 
     return translator.TranslateToUserHeapPtr(element);
 }
 
+UserHeapPointer<HeapString> WARN_UNUSED VM::TryFindInternedStringConcurrently(const void* str, size_t len)
+{
+    struct Iterator
+    {
+        bool HasMore()
+        {
+            return m_isFirst;
+        }
+
+        std::pair<const void*, uint32_t> GetAndAdvance()
+        {
+            assert(m_isFirst);
+            m_isFirst = false;
+            return std::make_pair(m_str, m_len);
+        }
+
+        const void* m_str;
+        uint32_t m_len;
+        bool m_isFirst;
+    };
+
+    if (!IntegerCanBeRepresentedIn<uint32_t>(len))
+    {
+        return UserHeapPointer<HeapString>();
+    }
+
+    HeapPtrTranslator translator = GetHeapPtrTranslator();
+    StringLengthAndHash lenAndHash {
+        .m_length = len,
+        .m_hashValue = HashString(str, len)
+    };
+    Iterator iterator { .m_str = str, .m_len = static_cast<uint32_t>(len), .m_isFirst = true };
+
+    // Registering as a reader prevents the tables we are looking at from being freed
+    //
+    // The fence orders the registration before the loads of the table pointers, see RetireStringConserHashTable
+    //
+    m_stringConserNumConcurrentReaders.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Auto(m_stringConserNumConcurrentReaders.fetch_sub(1, std::memory_order_release));
+
+    while (true)
+    {
+        uint32_t version = m_stringConserTableVersion.load(std::memory_order_acquire);
+        if (version % 2 == 1)
+        {
+            continue;
+        }
+
+        // The old table must be looked up before the new table: the execution thread moves an entry by
+        // first inserting it into the new table, then removing it from the old table
+        //
+        GeneralHeapPointer<HeapString>* oldHt = m_oldHashTable.load(std::memory_order_relaxed);
+        uint32_t oldMask = m_oldHashTableSizeMask.load(std::memory_order_relaxed);
+        GeneralHeapPointer<HeapString>* hashTable = m_hashTable.load(std::memory_order_relaxed);
+        uint32_t mask = m_hashTableSizeMask.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_stringConserTableVersion.load(std::memory_order_relaxed) != version)
+        {
+            continue;
+        }
+
+        GeneralHeapPointer<HeapString> ptr;
+        if (oldHt != nullptr)
+        {
+            ptr = FindMultiPieceStringInHashTable(translator, oldHt, oldMask, iterator, lenAndHash, nullptr /*slotForInsertion*/);
+        }
+        if (ptr.m_value == x_stringConserHtNonexistentValue)
+        {
+            ptr = FindMultiPieceStringInHashTable(translator, hashTable, mask, iterator, lenAndHash, nullptr /*slotForInsertion*/);
+        }
+        if (ptr.m_value != x_stringConserHtNonexistentValue)
+        {
+            return translator.TranslateToUserHeapPtr(translator.TranslateToRawPtr(ptr.As<HeapString>()));
+        }
+
+        // A miss is only trustworthy if the tables were not switched while we were probing them
+        //
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_stringConserTableVersion.load(std::memory_order_relaxed) == version)
+        {
+            return UserHeapPointer<HeapString>();
+        }
+    }
+}
+
+template<typename Iterator>
+UserHeapPointer<HeapString> WARN_UNUSED VM::CreateLazilyInternedMultiPieceString(Iterator iterator, size_t length)
+{
+    size_t allocationLength = HeapString::ComputeAllocationLengthForString(length);
+    VM_FAIL_IF(!IntegerCanBeRepresentedIn<uint32_t>(allocationLength),
+               "Cannot create a string longer than 4GB (attempted length: %llu bytes).", static_cast<unsigned long long>(allocationLength));
+
+    HeapPtrTranslator translator = GetHeapPtrTranslator();
+    UserHeapPointer<void> uhp = AllocFromUserHeap(static_cast<uint32_t>(allocationLength));
+
+    HeapString* ptr = translator.TranslateToRawPtr(uhp.AsNoAssert<HeapString>());
+    ptr->PopulateHeaderForLazilyInternedString(static_cast<uint32_t>(length));
+
+    uint8_t* curDst = ptr->m_string;
+    while (iterator.HasMore())
+    {
+        const void* curStr;
+        uint32_t curLen;
+        std::tie(curStr, curLen) = iterator.GetAndAdvance();
+
+        SafeMemcpy(curDst, curStr, curLen);
+        curDst += curLen;
+    }
+
+    // Fill in the trailing '\0', as required by Lua
+    //
+    *curDst = 0;
+    assert(curDst - ptr->m_string == static_cast<intptr_t>(length));
+    return translator.TranslateToUserHeapPtr(ptr);
+}
+
+HeapPtr<HeapString> WARN_UNUSED VM::InternLazilyInternedString(HeapPtr<HeapString> str)
+{
+    HeapPtrTranslator translator = GetHeapPtrTranslator();
+    HeapString* s = translator.TranslateToRawPtr(str);
+    assert(HeapString::IsLazilyInterned(s));
+
+    // If the string has been interned before, the interned string is recorded in 'm_hashLow'
+    //
+    if (s->m_hashLow != 0)
+    {
+        return GeneralHeapPointer<HeapString>(static_cast<int32_t>(s->m_hashLow)).As();
+    }
+
+    struct Iterator
+    {
+        bool HasMore()
+        {
+            return m_isFirst;
+        }
+
+        std::pair<const void*, uint32_t> GetAndAdvance()
+        {
+            assert(m_isFirst);
+            m_isFirst = false;
+            return std::make_pair(m_str, m_len);
+        }
+
+        const void* m_str;
+        uint32_t m_len;
+        bool m_isFirst;
+    };
+
+    UserHeapPointer<HeapString> res = InsertMultiPieceString(Iterator { .m_str = s->m_string, .m_len = s->m_length, .m_isFirst = true }, s /*adoptIfNotFound*/);
+    if (res.As() != str)
+    {
+        assert(HeapString::IsLazilyInterned(s));
+        s->m_hashLow = static_cast<uint32_t>(GeneralHeapPointer<HeapString>(res.As()).m_value);
+        assert(s->m_hashLow != 0);
+    }
+    else
+    {
+        assert(!HeapString::IsLazilyInterned(s));
+    }
+    return res.As();
+}
+
+UserHeapPointer<HeapString> WARN_UNUSED VM::CreateMaybeLazilyInternedStringFromConcatenation(TValue* start, size_t len)
+{
+    HeapPtrTranslator translator = GetHeapPtrTranslator();
+    size_t totalLength = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        assert(start[i].IsPointer());
+        assert(start[i].AsPointer().As<UserHeapGcObjectHeader>()->m_type == HeapEntityType::String);
+        totalLength += translator.TranslateToRawPtr(start[i].AsPointer().As<HeapString>())->m_length;
+    }
+
+    if (totalLength < x_minLengthForLazilyInternedString)
+    {
+        return CreateStringObjectFromConcatenation(start, len);
+    }
+
+    struct Iterator
+    {
+        bool HasMore()
+        {
+            return m_cur < m_end;
+        }
+
+        std::pair<const uint8_t*, uint32_t> GetAndAdvance()
+        {
+            assert(m_cur < m_end);
+            HeapString* e = m_translator.TranslateToRawPtr(m_cur->AsPointer().As<HeapString>());
+            m_cur++;
+            return std::make_pair(static_cast<const uint8_t*>(e->m_string), e->m_length);
+        }
+
+        TValue* m_cur;
+        TValue* m_end;
+        HeapPtrTranslator m_translator;
+    };
+
+    return CreateLazilyInternedMultiPieceString(Iterator {
+        .m_cur = start,
+        .m_end = start + len,
+        .m_translator = translator
+    }, totalLength);
+}
+
+UserHeapPointer<HeapString> WARN_UNUSED VM::CreateMaybeLazilyInternedStringFromConcatenation(std::pair<const void*, size_t>* start, size_t len)
+{
+    size_t totalLength = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        totalLength += start[i].second;
+    }
+
+    if (totalLength < x_minLengthForLazilyInternedString)
+    {
+        return CreateStringObjectFromConcatenation(start, len);
+    }
+
+    struct Iterator
+    {
+        bool HasMore()
+        {
+            return m_cur < m_end;
+        }
+
+        std::pair<const uint8_t*, uint32_t> GetAndAdvance()
+        {
+            assert(m_cur < m_end);
+            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(m_cur->first);
+            uint32_t len = static_cast<uint32_t>(m_cur->second);
+            m_cur++;
+            return std::make_pair(ptr, len);
+        }
+
+        std::pair<const void*, size_t>* m_cur;
+        std::pair<const void*, size_t>* m_end;
+    };
+
+    return CreateLazilyInternedMultiPieceString(Iterator {
+        .m_cur = start,
+        .m_end = start + len
+    }, totalLength);
+}
+
 UserHeapPointer<HeapString> WARN_UNUSED VM::CreateStringObjectFromConcatenation(TValue* start, size_t len)
 {
 #ifndef NDEBUG
@@ -4,6 +4,8 @@
 #include "tvalue.h"
 #include "array_type.h"
 #include "jit_memory_allocator.h"
+#include "lj_strfmt_num.h"
+#include "megamorphic_property_cache.h"
 
 enum ThreadKind : uint8_t
 {
@@ -292,11 +294,68 @@ private:
 namespace internal
 {
 
+// The user heap uses a segregated allocator: every allocation up to 'x_userHeapMaxSizeClassSlots' slots is rounded up
+// to one of the size classes below, and each size class has its own free list.
+//
+// The size classes are spaced 2 slots apart up to 16 slots, and then 4 classes evenly spaced between every two
+// consecutive powers of two, so the internal fragmentation is bounded by 25% (instead of 50% for power-of-two classes).
+//
+// Allocations larger than 'x_userHeapMaxSizeClassSlots' are not rounded and do not participate in the free lists.
+//
+constexpr uint32_t x_userHeapMaxSizeClassSlots = 1024;
+
+constexpr size_t ComputeNumUserHeapSizeClasses()
+{
+    size_t r = 0;
+    for (uint32_t slots = 2; slots <= 16; slots += 2) { r++; }
+    for (uint32_t base = 16; base < x_userHeapMaxSizeClassSlots; base *= 2) { r += 4; }
+    return r;
+}
+
+constexpr size_t x_numUserHeapSizeClasses = ComputeNumUserHeapSizeClasses();
+
+constexpr std::array<uint32_t, x_numUserHeapSizeClasses> ComputeUserHeapSizeClassSlotsArray()
+{
+    std::array<uint32_t, x_numUserHeapSizeClasses> r;
+    size_t k = 0;
+    for (uint32_t slots = 2; slots <= 16; slots += 2) { r[k++] = slots; }
+    for (uint32_t base = 16; base < x_userHeapMaxSizeClassSlots; base *= 2)
+    {
+        for (uint32_t i = 1; i <= 4; i++) { r[k++] = base + base / 4 * i; }
+    }
+    assert(k == x_numUserHeapSizeClasses);
+    assert(r[x_numUserHeapSizeClasses - 1] == x_userHeapMaxSizeClassSlots);
+    return r;
+}
+
+// The cell size (in slots) of each size class
+//
+constexpr std::array<uint32_t, x_numUserHeapSizeClasses> x_userHeapSizeClassSlots = ComputeUserHeapSizeClassSlotsArray();
+
+constexpr std::array<uint8_t, x_userHeapMaxSizeClassSlots + 1> ComputeUserHeapSizeClassLookupArray()
+{
+    static_assert(x_numUserHeapSizeClasses <= 255);
+    std::array<uint8_t, x_userHeapMaxSizeClassSlots + 1> r;
+    size_t k = 0;
+    for (uint32_t slots = 0; slots <= x_userHeapMaxSizeClassSlots; slots++)
+    {
+        while (x_userHeapSizeClassSlots[k] < slots) { k++; }
+        r[slots] = static_cast<uint8_t>(k);
+    }
+    return r;
+}
+
+// Maps an allocation length (in slots) to the ordinal of the least-fit size class
+//
+constexpr std::array<uint8_t, x_userHeapMaxSizeClassSlots + 1> x_userHeapSizeClassForSlots = ComputeUserHeapSizeClassLookupArray();
+
 constexpr uint32_t GetLeastFitCellSizeInSlots(uint32_t slotToFit)
 {
-    // TODO: we haven't implemented the segregated allocator yet, so this function is dummy
-    //
-    return RoundUpToPowerOfTwo(slotToFit);
+    if (slotToFit > x_userHeapMaxSizeClassSlots)
+    {
+        return slotToFit;
+    }
+    return x_userHeapSizeClassSlots[x_userHeapSizeClassForSlots[slotToFit]];
 }
 
 constexpr uint32_t x_maxInlineCapacity = 253;
@@ -364,6 +423,10 @@ constexpr std::array<uint8_t, x_maxInlineCapacity + 1> x_optimalInlineCapacitySt
 
 constexpr size_t x_numInlineCapacitySteppings = internal::x_optimalInlineCapacitySteppingArray[internal::x_maxInlineCapacity] + 1;
 
+// Structure transition tables have power-of-two hash table sizes, and the free list for each size is indexed by log2 of the size
+//
+constexpr size_t x_numStructureTransitionTableSizeClasses = 32;
+
 namespace internal
 {
 
@@ -424,6 +487,30 @@ public:
         m_length = SafeIntegerCast<uint32_t>(slah.m_length);
     }
 
+    // A long string created by concatenation is not hashed nor interned when it is created (see VM::CreateMaybeLazilyInternedStringFromConcatenation).
+    // Such a string has this special value in 'm_invalidArrayType', its 'm_hashHigh' is 0,
+    // and its 'm_hashLow' holds the GeneralHeapPointer of the interned string with the same content, or 0 if it is not known yet.
+    //
+    static constexpr uint8_t x_lazilyInternedStringMarker = ArrayType::x_invalidArrayType + 63;
+
+    void PopulateHeaderForLazilyInternedString(uint32_t length)
+    {
+        m_hiddenClass = x_stringStructure;
+        m_type = TypeEnumForHeapObject<HeapString>;
+        m_cellState = x_defaultCellState;
+
+        m_hashHigh = 0;
+        m_invalidArrayType = x_lazilyInternedStringMarker;
+        m_hashLow = 0;
+        m_length = length;
+    }
+
+    template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, HeapString>>>
+    static bool WARN_UNUSED IsLazilyInterned(T self)
+    {
+        return self->m_invalidArrayType == x_lazilyInternedStringMarker;
+    }
+
     // Returns the allocation length to store a string of length 'length'
     //
     static size_t ComputeAllocationLengthForString(size_t length)
@@ -474,7 +561,9 @@ public:
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, HeapString>>>
     static void SetReservedWord(T self, uint8_t reservedId)
     {
-        assert(reservedId + 1 <= 63);
+        // The last value is taken by x_lazilyInternedStringMarker
+        //
+        assert(reservedId + 1 <= 62);
         uint8_t arrTy = ArrayType::x_invalidArrayType + reservedId + 1;
         TCSet(self->m_invalidArrayType, arrTy);
     }
@@ -482,7 +571,7 @@ public:
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, HeapString>>>
     static bool WARN_UNUSED IsReservedWord(T self)
     {
-        return self->m_invalidArrayType != ArrayType::x_invalidArrayType;
+        return self->m_invalidArrayType != ArrayType::x_invalidArrayType && self->m_invalidArrayType != x_lazilyInternedStringMarker;
     }
 
     template<typename T, typename = std::enable_if_t<IsPtrOrHeapPtr<T, HeapString>>>
@@ -491,13 +580,17 @@ public:
         assert(IsReservedWord(self));
         assert(self->m_invalidArrayType > ArrayType::x_invalidArrayType);
         uint8_t ord = static_cast<uint8_t>(self->m_invalidArrayType - ArrayType::x_invalidArrayType - 1);
-        assert(ord + 1 <= 63);
+        assert(ord + 1 <= 62);
         return ord;
     }
 };
 static_assert(sizeof(HeapString) == 16);
 
 class ScriptModule;
+class BaselineJitCompileQueue;
+class LuaFileHandle;
+class LuaPatternCache;
+struct CoroutineStackIndex;
 
 // [ 12GB user heap ] [ 2GB padding ] [ 2GB short-pointer data structures ] [ 2GB system heap ]
 //                                                                          ^
@@ -590,11 +683,26 @@ public:
     // Allocate a chunk of memory from the user heap
     // Only execution thread may do this
     //
+    // The allocation is rounded up to the least-fit size class (see GetLeastFitCellSizeInSlots), and is served from the
+    // size class's free list if possible, otherwise it is bump-allocated.
+    //
     UserHeapPointer<void> WARN_UNUSED AllocFromUserHeap(uint32_t length)
     {
         assert(length > 0 && length % 8 == 0);
-        // TODO: we currently do not have GC, so it's only a bump allocator..
-        //
+        uint32_t slots = length / 8;
+        if (likely(slots <= internal::x_userHeapMaxSizeClassSlots))
+        {
+            uint8_t sizeClass = internal::x_userHeapSizeClassForSlots[slots];
+            int64_t freeCell = m_userHeapFreeList[sizeClass];
+            if (freeCell != 0)
+            {
+                m_userHeapFreeList[sizeClass] = *reinterpret_cast<int64_t*>(VMBaseAddress() + static_cast<uint64_t>(freeCell));
+                assert(m_userHeapFreedBytes >= internal::x_userHeapSizeClassSlots[sizeClass] * 8);
+                m_userHeapFreedBytes -= internal::x_userHeapSizeClassSlots[sizeClass] * 8;
+                return UserHeapPointer<void> { reinterpret_cast<HeapPtr<void>>(freeCell) };
+            }
+            length = internal::x_userHeapSizeClassSlots[sizeClass] * 8;
+        }
         m_userHeapCurPtr -= static_cast<int64_t>(length);
         if (unlikely(m_userHeapCurPtr < m_userHeapPtrLimit))
         {
@@ -603,6 +711,44 @@ public:
         return UserHeapPointer<void> { reinterpret_cast<HeapPtr<void>>(m_userHeapCurPtr) };
     }
 
+    // Return a chunk of memory previously allocated by AllocFromUserHeap with the same 'length' back to its size class's free list
+    // Chunks larger than the largest size class cannot be reused, so they are simply abandoned.
+    // Only execution thread may do this
+    //
+    // TODO: we currently do not have GC, so only storages with explicitly-managed lifetime (e.g., butterflies replaced on growth)
+    // are returned to the allocator.
+    //
+    void FreeToUserHeap(UserHeapPointer<void> ptr, uint32_t length)
+    {
+        assert(length > 0 && length % 8 == 0);
+        uint32_t slots = length / 8;
+        if (slots > internal::x_userHeapMaxSizeClassSlots)
+        {
+            m_userHeapFreedBytes += length;
+            return;
+        }
+        uint8_t sizeClass = internal::x_userHeapSizeClassForSlots[slots];
+        int64_t cell = static_cast<int64_t>(ptr.m_value);
+        assert(m_userHeapCurPtr <= cell && cell < 0);
+        *reinterpret_cast<int64_t*>(VMBaseAddress() + static_cast<uint64_t>(cell)) = m_userHeapFreeList[sizeClass];
+        m_userHeapFreeList[sizeClass] = cell;
+        m_userHeapFreedBytes += internal::x_userHeapSizeClassSlots[sizeClass] * 8;
+    }
+
+    // Same as above, but for storages (e.g., butterflies) that are referenced by raw pointer
+    //
+    void* WARN_UNUSED AllocRawFromUserHeap(uint32_t length)
+    {
+        return TranslateToRawPointer(this, AllocFromUserHeap(length).As());
+    }
+
+    void FreeRawToUserHeap(void* ptr, uint32_t length)
+    {
+        assert(reinterpret_cast<uintptr_t>(ptr) < VMBaseAddress());
+        int64_t offset = static_cast<int64_t>(reinterpret_cast<uintptr_t>(ptr) - VMBaseAddress());
+        FreeToUserHeap(UserHeapPointer<void> { reinterpret_cast<HeapPtr<void>>(offset) }, length);
+    }
+
     // Allocate a chunk of memory from the system heap
     // Only execution thread may do this
     //
@@ -706,11 +852,46 @@ public:
     //
     UserHeapPointer<HeapString> WARN_UNUSED CreateStringObjectFromConcatenationOfSameString(const char* ptr, uint32_t len, size_t n);
 
+    // Strings at least this long that are created by the concat bytecode or table.concat are interned lazily
+    //
+    static constexpr size_t x_minLengthForLazilyInternedString = 1024;
+
+    // Same as CreateStringObjectFromConcatenation, except that if the result is long, it is neither hashed nor interned.
+    // Building a long string by repeated concatenation therefore does not pay for hashing every intermediate result.
+    //
+    // The returned string may not be the unique string object with its content, so it must be interned by
+    // InternLazilyInternedString before anything that relies on string identity (comparison, table key, etc) uses it.
+    //
+    UserHeapPointer<HeapString> WARN_UNUSED CreateMaybeLazilyInternedStringFromConcatenation(TValue* start, size_t len);
+    UserHeapPointer<HeapString> WARN_UNUSED CreateMaybeLazilyInternedStringFromConcatenation(std::pair<const void*, size_t>* start, size_t len);
+
+    // Return the interned string with the same content as the lazily interned string 'str'
+    // This may turn 'str' itself into the interned string, if no string with the same content exists yet
+    //
+    HeapPtr<HeapString> WARN_UNUSED NO_INLINE InternLazilyInternedString(HeapPtr<HeapString> str);
+
     uint32_t GetGlobalStringHashConserCurrentHashTableSize() const
     {
-        return m_hashTableSizeMask + 1;
+        return m_hashTableSizeMask.load(std::memory_order_relaxed) + 1;
     }
 
+    // Whether the global string hash table is being incrementally migrated to a larger table
+    //
+    bool IsGlobalStringHashConserMigrationInProgress() const
+    {
+        return m_oldHashTable.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    // Look up an interned string without creating it. Return a null pointer if the string is not interned.
+    //
+    // Unlike the CreateStringObject functions, this function is safe to be called from a compiler thread
+    // while the execution thread is inserting into the table (including while the table is being incrementally migrated).
+    // A string interned before the call started is always found.
+    //
+    // Only lookup is supported off the execution thread: a compiler thread that misses must leave the interning to the execution thread.
+    //
+    UserHeapPointer<HeapString> WARN_UNUSED TryFindInternedStringConcurrently(const void* str, size_t len);
+
     uint32_t GetGlobalStringHashConserCurrentElementCount() const
     {
         return m_elementCount;
@@ -734,14 +915,131 @@ public:
     FILE* WARN_UNUSED GetStdout() { return m_filePointerForStdout; }
     FILE* WARN_UNUSED GetStderr() { return m_filePointerForStderr; }
 
-    void RedirectStdout(FILE* newStdout) { m_filePointerForStdout = newStdout; }
+    // Any output still sitting in the stdout buffer belongs to the old stream, so it is flushed there before switching
+    //
+    void RedirectStdout(FILE* newStdout)
+    {
+        std::ignore = FlushStdout();
+        m_filePointerForStdout = newStdout;
+        m_stdoutBufferMode = GetDefaultStdoutBufferMode(newStdout);
+    }
     void RedirectStderr(FILE* newStderr) { m_filePointerForStderr = newStderr; }
 
+    // Output produced by 'print' and 'io.write' is accumulated in a VM-owned buffer and only handed to the stdio FILE
+    // when the buffer fills up or at an explicit flush point (io.flush, reading from stdin, an uncaught error, redirecting
+    // stdout, the end of the script and VM teardown), so each small write costs a memcpy instead of a locked stdio call.
+    //
+    static constexpr uint32_t x_stdoutBufferSize = 65536;
+
+    enum class StdoutBufferMode : uint8_t
+    {
+        Full,
+        // Flush whenever the written data contains a newline, which is what stdio does for an interactive terminal
+        //
+        Line,
+        No
+    };
+
+    // Returns false if the buffered output could not be written out
+    //
+    bool WriteToStdout(const void* data, size_t len)
+    {
+        if (likely(len <= x_stdoutBufferSize - m_stdoutBufferLen))
+        {
+            memcpy(m_stdoutBuffer + m_stdoutBufferLen, data, len);
+            m_stdoutBufferLen += static_cast<uint32_t>(len);
+            if (unlikely(m_stdoutBufferMode != StdoutBufferMode::Full))
+            {
+                return FlushStdoutIfNotFullyBuffered(data, len);
+            }
+            return true;
+        }
+        return WriteToStdoutSlowPath(data, len);
+    }
+
+    bool WriteCharToStdout(char c)
+    {
+        return WriteToStdout(&c, 1);
+    }
+
+    // Formats the number directly into the stdout buffer
+    //
+    bool WriteNumberToStdout(double value)
+    {
+        char* buf = ReserveStdoutBuffer(x_default_tostring_buffersize_double);
+        char* bufEnd = StringifyDoubleUsingDefaultLuaFormattingOptions(buf /*out*/, value);
+        return CommitStdoutBuffer(buf, static_cast<size_t>(bufEnd - buf));
+    }
+
+    // Returns a pointer to at least 'len' bytes of free space at the end of the stdout buffer.
+    // The caller should write its output there and then call 'CommitStdoutBuffer' with the number of bytes written.
+    //
+    char* WARN_UNUSED ReserveStdoutBuffer(size_t len)
+    {
+        assert(len <= x_stdoutBufferSize);
+        if (unlikely(len > x_stdoutBufferSize - m_stdoutBufferLen))
+        {
+            std::ignore = DrainStdoutBuffer();
+        }
+        return m_stdoutBuffer + m_stdoutBufferLen;
+    }
+
+    bool CommitStdoutBuffer(char* buf, size_t len)
+    {
+        assert(buf == m_stdoutBuffer + m_stdoutBufferLen && len <= x_stdoutBufferSize - m_stdoutBufferLen);
+        m_stdoutBufferLen += static_cast<uint32_t>(len);
+        if (unlikely(m_stdoutBufferMode != StdoutBufferMode::Full))
+        {
+            return FlushStdoutIfNotFullyBuffered(buf, len);
+        }
+        return true;
+    }
+
+    // Hands the buffered output to the stdio FILE, without flushing the FILE itself
+    //
+    bool WARN_UNUSED DrainStdoutBuffer();
+
+    // Hands the buffered output to the stdio FILE and flushes the FILE
+    //
+    bool WARN_UNUSED FlushStdout();
+
+    void SetStdoutBufferMode(StdoutBufferMode mode) { m_stdoutBufferMode = mode; }
+
     std::array<SystemHeapPointer<Structure>, x_numInlineCapacitySteppings>& GetInitialStructureForDifferentInlineCapacityArray()
     {
         return m_initialStructureForDifferentInlineCapacity;
     }
 
+    std::array<uint32_t, x_numStructureTransitionTableSizeClasses>& GetStructureTransitionTableFreeLists()
+    {
+        return m_structureTransitionTableFreeLists;
+    }
+
+    std::unordered_map<uint32_t, uint32_t>& GetBaselineCodeBlockFreeLists()
+    {
+        return *m_baselineCodeBlockFreeLists;
+    }
+
+    uint32_t& GetUnlinkedCodeBlockFreeList()
+    {
+        return m_unlinkedCodeBlockFreeList;
+    }
+
+    TValue*& GetCoroutineStackPoolHead()
+    {
+        return m_coroutineStackPoolHead;
+    }
+
+    uint32_t& GetCoroutineStackPoolSize()
+    {
+        return m_coroutineStackPoolSize;
+    }
+
+    CoroutineStackIndex*& GetCoroutineStackIndex()
+    {
+        return m_coroutineStackIndex;
+    }
+
     CoroutineRuntimeContext* GetRootCoroutine()
     {
         return m_rootCoroutine;
@@ -768,6 +1066,8 @@ public:
         BaseIPairsIter,
         BaseToString,
         BaseLoad,
+        // The lines iterator of io.stdin
+        //
         IoLinesIter,
         // A special object denoting that the 'is_next' validation of a key-value for-loop has passed
         //
@@ -780,6 +1080,8 @@ public:
     enum class LibFnProto
     {
         CoroutineWrapCall,
+        IoFileLinesIter,
+        StringGmatchIter,
         // must be last member
         //
         X_END_OF_ENUM
@@ -917,14 +1219,79 @@ public:
     //
     bool WARN_UNUSED BaselineJitCanTierUpFurther() { return false; }
 
+    // When enabled, tier-up from the interpreter to baseline JIT does not stall the execution thread for the codegen.
+    // Instead, the codegen happens on a compiler thread, and the function keeps executing in the interpreter until the
+    // codegen completes. Note that OSR entry into baseline JIT still has to wait for the codegen to complete.
+    //
+    // Only affects CodeBlocks tiered-up after this call. Disabling it discards all pending compilations.
+    //
+    void SetBackgroundBaselineJitCompilation(bool enable);
+
+    bool IsBackgroundBaselineJitCompilationEnabled() const { return m_baselineJitCompileQueue != nullptr; }
+
+    // Returns nullptr if background baseline JIT compilation is not enabled
+    //
+    BaselineJitCompileQueue* GetBaselineJitCompileQueue() { return m_baselineJitCompileQueue; }
+
     JitMemoryAllocator* GetJITMemoryAlloc()
     {
         return &m_jitMemoryAllocator;
     }
 
+    // The allocator for JIT data that is never executed (e.g., baseline JIT data sections), which memory is never executable
+    //
+    JitMemoryAllocator* GetJITDataMemoryAlloc()
+    {
+        return &m_jitDataMemoryAllocator;
+    }
+
     uint32_t GetNumTotalBaselineJitCompilations() { return m_totalBaselineJitCompilations; }
     void IncrementNumTotalBaselineJitCompilations() { m_totalBaselineJitCompilations++; }
 
+    uint32_t GetNumTotalBaselineJitJettisons() { return m_totalBaselineJitJettisons; }
+    void IncrementNumTotalBaselineJitJettisons() { m_totalBaselineJitJettisons++; }
+
+    // Number of bytes logically in use in the user heap, that is, the bump-allocated bytes minus the bytes given back by FreeToUserHeap
+    //
+    size_t WARN_UNUSED GetUserHeapUsageInBytes() const
+    {
+        int64_t heapStart = -static_cast<int64_t>(x_vmBaseOffset - x_vmUserHeapSize);
+        assert(m_userHeapCurPtr <= heapStart);
+        size_t allocatedBytes = static_cast<size_t>(heapStart - m_userHeapCurPtr);
+        assert(m_userHeapFreedBytes <= allocatedBytes);
+        return allocatedBytes - m_userHeapFreedBytes;
+    }
+
+    // Number of bytes logically in use in the system heap (excluding the VM struct itself)
+    //
+    size_t WARN_UNUSED GetSystemHeapUsageInBytes() const
+    {
+        assert(m_systemHeapCurPtr >= sizeof(VM));
+        return m_systemHeapCurPtr - sizeof(VM);
+    }
+
+    // The total memory in use by the user program, as reported by 'collectgarbage("count")' and 'gcinfo'
+    //
+    size_t WARN_UNUSED GetTotalHeapUsageInBytes() const
+    {
+        return GetUserHeapUsageInBytes() + GetSystemHeapUsageInBytes();
+    }
+
+    // The garbage collector tuning parameters, see Lua 5.1 manual §2.10
+    //
+    // TODO: we currently do not have GC, so these parameters are only recorded so 'collectgarbage' can report the old value back.
+    // The collector should add the getters it needs: it is expected to use 'm_gcPause' to decide the heap size threshold that
+    // starts a new cycle, 'm_gcStepMul' to decide the amount of work done per allocated byte, and skip automatic cycles while 'm_gcIsStopped'.
+    //
+    static constexpr int32_t x_defaultGcPause = 200;
+    static constexpr int32_t x_defaultGcStepMul = 200;
+
+    // Return the old value
+    //
+    int32_t SetGcPause(int32_t value) { int32_t old = m_gcPause; m_gcPause = value; return old; }
+    int32_t SetGcStepMul(int32_t value) { int32_t old = m_gcStepMul; m_gcStepMul = value; return old; }
+    void SetGcStopped(bool value) { m_gcIsStopped = value; }
+
     static constexpr size_t x_pageSize = 4096;
 
 private:
@@ -1007,17 +1374,63 @@ private:
     static constexpr uint32_t x_stringht_loadfactor_denominator_shift = 1;
     static constexpr uint32_t x_stringht_loadfactor_numerator = 1;
 
+    // The number of slots in the old table migrated to the new table on each insertion, when the table is being expanded
+    // The table grows by 2x when its load factor reaches 1/2, and the migration must be finished before the new table
+    // reaches the max load factor, so this must be at least 2. In practice the migration finishes way before that.
+    //
+    static constexpr uint32_t x_stringConserMigrationSlotsPerInsertion = 64;
+    static_assert(x_stringConserMigrationSlotsPerInsertion >= 2);
+
+    // The table entries may be read concurrently by TryFindInternedStringConcurrently, so they are always written atomically
+    //
+    static GeneralHeapPointer<HeapString> WARN_UNUSED ALWAYS_INLINE StringHtLoad(GeneralHeapPointer<HeapString>* cell)
+    {
+        return GeneralHeapPointer<HeapString> { std::atomic_ref<int32_t>(cell->m_value).load(std::memory_order_acquire) };
+    }
+
+    static void ALWAYS_INLINE StringHtStore(GeneralHeapPointer<HeapString>* cell, GeneralHeapPointer<HeapString> value)
+    {
+        std::atomic_ref<int32_t>(cell->m_value).store(value.m_value, std::memory_order_release);
+    }
+
     static void ReinsertDueToResize(GeneralHeapPointer<HeapString>* hashTable, uint32_t hashTableSizeMask, GeneralHeapPointer<HeapString> e);
 
+    // Find the string in one table, return a null pointer if not found
+    // If 'slotForInsertion' is not nullptr, it is set to the first free slot in the probing sequence, which is the slot to insert the string if it does not exist
+    //
+    template<typename Iterator>
+    static GeneralHeapPointer<HeapString> WARN_UNUSED FindMultiPieceStringInHashTable(
+        HeapPtrTranslator translator, GeneralHeapPointer<HeapString>* hashTable, uint32_t hashTableSizeMask,
+        Iterator iterator, StringLengthAndHash lenAndHash, uint32_t* slotForInsertion /*out*/);
+
+    // Start an incremental migration to a 2x larger table if the load factor is too high
+    // The old table is kept around, and its slots are moved to the new table a few at a time by MigrateStringConserHashTableSlots
+    //
     // TODO: when we have GC thread we need to figure out how this interacts with GC
     //
     void ExpandStringConserHashTableIfNeeded();
 
+    // Move up to 'maxSlots' slots from the old table to the new table, and retire the old table if the migration is done
+    //
+    void MigrateStringConserHashTableSlots(uint32_t maxSlots);
+
+    // Free the table if no concurrent reader may be using it, otherwise defer it to a later call
+    //
+    void RetireStringConserHashTable(GeneralHeapPointer<HeapString>* hashTable);
+
     // Insert an abstract multi-piece string into the hash table if it does not exist
     // Return the HeapString
     //
+    // If 'adoptIfNotFound' is not nullptr, it must be a lazily interned string with the same content,
+    // and it becomes the interned string (instead of a newly created one) if the string does not exist
+    //
     template<typename Iterator>
-    UserHeapPointer<HeapString> WARN_UNUSED InsertMultiPieceString(Iterator iterator);
+    UserHeapPointer<HeapString> WARN_UNUSED InsertMultiPieceString(Iterator iterator, HeapString* adoptIfNotFound = nullptr);
+
+    // Create a lazily interned string by concatenating all the pieces
+    //
+    template<typename Iterator>
+    UserHeapPointer<HeapString> WARN_UNUSED CreateLazilyInternedMultiPieceString(Iterator iterator, size_t length);
 
     static std::mt19937* WARN_UNUSED NO_INLINE GetUserPRNGSlow()
     {
@@ -1056,6 +1469,16 @@ private:
     //
     int64_t m_userHeapCurPtr;
 
+    // The free list for each size class of the user heap segregated allocator
+    // Each entry is the offset of the first free cell (from m_self), or 0 if the free list is empty.
+    // The first 8 bytes of each free cell stores the offset of the next free cell.
+    //
+    int64_t m_userHeapFreeList[internal::x_numUserHeapSizeClasses];
+
+    // The total size of the cells in the free lists above, plus the chunks too large for any size class that were abandoned by FreeToUserHeap
+    //
+    uint64_t m_userHeapFreedBytes;
+
     // system heap region grows from low address to high address
     // lowest physically unmapped address of the system heap region (offsets from m_self)
     //
@@ -1068,8 +1491,16 @@ private:
     SpdsPtr<void> m_spdsExecutionThreadFreeList[x_numSpdsAllocatableClassNotUsingLfFreelist];
 
     JitMemoryAllocator m_jitMemoryAllocator;
+    JitMemoryAllocator m_jitDataMemoryAllocator { false /*isExecutable*/ };
 
     uint32_t m_totalBaselineJitCompilations;
+    uint32_t m_totalBaselineJitJettisons;
+
+    BaselineJitCompileQueue* m_baselineJitCompileQueue;
+
+    int32_t m_gcPause;
+    int32_t m_gcStepMul;
+    bool m_gcIsStopped;
 
     alignas(64) std::mutex m_spdsAllocationMutex;
 
@@ -1082,12 +1513,34 @@ private:
 
     SpdsPtr<void> m_spdsCompilerThreadFreeList[x_numSpdsAllocatableClassNotUsingLfFreelist];
 
-    uint32_t m_hashTableSizeMask;
+    // The table pointers and masks are only written by the execution thread, but they may be read by TryFindInternedStringConcurrently
+    // The execution thread reads them with relaxed loads, which compiles to plain loads
+    //
+    std::atomic<uint32_t> m_hashTableSizeMask;
+    // The number of strings in both the new and the old table
+    //
     uint32_t m_elementCount;
     // use GeneralHeapPointer because it's 4 bytes
     // All pointers are actually always HeapPtr<HeapString>
     //
-    GeneralHeapPointer<HeapString>* m_hashTable;
+    std::atomic<GeneralHeapPointer<HeapString>*> m_hashTable;
+
+    // The table being migrated into m_hashTable, nullptr if no migration is in progress
+    // A migrated slot is replaced by x_stringConserHtDeletedValue, so the probing sequences in the old table stay intact
+    //
+    std::atomic<GeneralHeapPointer<HeapString>*> m_oldHashTable;
+    std::atomic<uint32_t> m_oldHashTableSizeMask;
+    // The slots before this ordinal in the old table have been migrated
+    //
+    uint32_t m_oldHashTableMigrationCursor;
+
+    // Sequence lock protecting the table pointers and masks from concurrent readers: odd while they are being changed
+    //
+    std::atomic<uint32_t> m_stringConserTableVersion;
+    // The number of TryFindInternedStringConcurrently calls in progress. A table replaced while this is non-zero is not freed immediately
+    //
+    std::atomic<uint32_t> m_stringConserNumConcurrentReaders;
+    std::vector<GeneralHeapPointer<HeapString>*> m_retiredStringConserHashTables;
 
     // In PolyMetatable mode, the metatable is stored in a property slot
     // For simplicity, we always assign this special key (which is used exclusively for this purpose) to this slot
@@ -1104,6 +1557,32 @@ private:
 
     std::array<SystemHeapPointer<Structure>, x_numInlineCapacitySteppings> m_initialStructureForDifferentInlineCapacity;
 
+    // The transition tables replaced on growth are recycled through these free lists (see StructureTransitionTable)
+    // Each entry is the system heap pointer of the first free table, or 0 if the free list is empty.
+    //
+    std::array<uint32_t, x_numStructureTransitionTableSizeClasses> m_structureTransitionTableFreeLists;
+
+    // The system heap memory of the BaselineCodeBlocks that were freed (see BaselineCodeBlock::Free)
+    // Maps the allocation size to the system heap pointer of the first free allocation of that size.
+    //
+    std::unordered_map<uint32_t, uint32_t>* m_baselineCodeBlockFreeLists;
+
+    // The system heap memory of the UnlinkedCodeBlocks that were freed (see UnlinkedCodeBlock::Free)
+    // All UnlinkedCodeBlocks have the same allocation size, so this is the system heap pointer of the first free one, or 0 if none.
+    //
+    uint32_t m_unlinkedCodeBlockFreeList;
+
+    // The stacks of dead coroutines are recycled through this free list (see CoroutineRuntimeContext)
+    // The first slot of each stack in the list stores the pointer to the next stack.
+    //
+    TValue* m_coroutineStackPoolHead;
+    uint32_t m_coroutineStackPoolSize;
+
+    // The index of every stack mapped by CoroutineRuntimeContext, used by the fault handler to grow the stack
+    // Entries are never moved once created, so the fault handler can read it lock-free
+    //
+    CoroutineStackIndex* m_coroutineStackIndex;
+
     TValue m_vmLibFunctionObjects[static_cast<size_t>(LibFn::X_END_OF_ENUM)];
     SystemHeapPointer<ExecutableCode> m_vmLibFnProtos[static_cast<size_t>(LibFnProto::X_END_OF_ENUM)];
 
@@ -1116,6 +1595,14 @@ private:
     FILE* m_filePointerForStdout;
     FILE* m_filePointerForStderr;
 
+    char* m_stdoutBuffer;
+    uint32_t m_stdoutBufferLen;
+    StdoutBufferMode m_stdoutBufferMode;
+
+    static StdoutBufferMode WARN_UNUSED GetDefaultStdoutBufferMode(FILE* fp);
+    bool WARN_UNUSED WriteToStdoutSlowPath(const void* data, size_t len);
+    bool WARN_UNUSED FlushStdoutIfNotFullyBuffered(const void* data, size_t len);
+
 public:
     // Per-type Lua metatables
     //
@@ -1126,6 +1613,27 @@ public:
     UserHeapPointer<void> m_metatableForFunction;
     UserHeapPointer<void> m_metatableForCoroutine;
 
+    // The metatable shared by all file handles of the io library
+    //
+    UserHeapPointer<void> m_metatableForFileHandle;
+
+    // The default input and output files of the io library
+    //
+    UserHeapPointer<HeapCDataObject> m_ioDefaultInputFile;
+    UserHeapPointer<HeapCDataObject> m_ioDefaultOutputFile;
+
+    // The list of regular files that are not yet closed
+    //
+    LuaFileHandle* m_openFileListHead;
+
+    // The compiled patterns of the string library, created on first use
+    //
+    LuaPatternCache* m_luaPatternCache;
+
+    // The property lookup cache used by megamorphic GetById / PutById sites
+    //
+    MegamorphicPropertyCache m_megamorphicPropertyCache;
+
     // The string ""
     //
     HeapPtr<HeapString> m_emptyString;
@@ -1158,6 +1666,23 @@ inline UserHeapPointer<HeapString> VM_GetStringNameForMetatableKind(LuaMetametho
     return TCGet(reinterpret_cast<HeapPtr<UserHeapPointer<HeapString>>>(offset)[static_cast<size_t>(kind)]);
 }
 
+// If 'value' is a lazily interned string, return the interned string with the same content. Otherwise return 'value' unchanged.
+// Anything that relies on string identity (equality, table keys) must go through this function.
+//
+inline TValue WARN_UNUSED ALWAYS_INLINE VM_InternIfLazilyInternedString(TValue value)
+{
+    if (likely(!value.Is<tString>()))
+    {
+        return value;
+    }
+    HeapPtr<HeapString> str = value.As<tString>();
+    if (likely(!HeapString::IsLazilyInterned(str)))
+    {
+        return value;
+    }
+    return TValue::Create<tString>(VM::GetActiveVMForCurrentThread()->InternLazilyInternedString(str));
+}
+
 template<VM::LibFn fn>
 inline TValue ALWAYS_INLINE VM_GetLibFunctionObject()
 {
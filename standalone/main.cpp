@@ -1,5 +1,6 @@
 #include "runtime_utils.h"
 #include "lj_parser_wrapper.h"
+#include "baseline_jit_codegen_helper.h"
 
 #define LJR_VERSION_MAJOR_NUMBER 0
 #define LJR_VERSION_MINOR_NUMBER 0
@@ -20,6 +21,61 @@ static void PrintLJRUsage()
 {
     PrintLJRVersion();
     fprintf(stderr, "\nusage: luajitr <script> [args]...\n");
+    fprintf(stderr, "       luajitr --bench-baseline-jit-codegen <script> [iterations]\n");
+}
+
+static ParseResult WARN_UNUSED ParseScriptOrExit(VM* vm, const char* scriptFilename)
+{
+    ParseResult pr = ParseLuaScriptFromFile(vm->GetRootCoroutine(), scriptFilename);
+    if (pr.m_scriptModule.get() == nullptr)
+    {
+        fprintf(stderr, "Failed to parse file '%s'. Error message:\n", scriptFilename);
+        PrintTValue(stderr, pr.errMsg);
+        fprintf(stderr, "\n");
+        exit(1);
+    }
+    return pr;
+}
+
+// Parse the script (without running it), then compile every function in it with the baseline JIT and throw the code away,
+// 'numIterations' times. Only the codegen itself is timed, so the result is not diluted by parsing or by executing the code.
+// The total codegen time is printed in the same format as 'time' (e.g. "1.234s"), so run_bench.sh can log it directly.
+//
+// Run with LJR_JIT_WX=1 to measure the W^X JIT memory mode.
+//
+static void RunBaselineJitCodegenBenchmark(const char* scriptFilename, size_t numIterations)
+{
+    VM* vm = VM::Create();
+    ParseResult pr = ParseScriptOrExit(vm, scriptFilename);
+
+    std::vector<CodeBlock*> codeBlocks;
+    for (UnlinkedCodeBlock* ucb : pr.m_scriptModule->m_unlinkedCodeBlocks)
+    {
+        CodeBlock* cb = ucb->m_defaultCodeBlock;
+        ReleaseAssert(cb != nullptr);
+        // Nothing has run yet, so it is safe to throw away the code if the VM compiled it eagerly
+        //
+        deegen_baseline_jit_jettison_code(cb);
+        codeBlocks.push_back(cb);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration codegenTime { 0 };
+    for (size_t iter = 0; iter < numIterations; iter++)
+    {
+        for (CodeBlock* cb : codeBlocks)
+        {
+            Clock::time_point start = Clock::now();
+            std::ignore = deegen_baseline_jit_do_codegen(cb);
+            codegenTime += Clock::now() - start;
+            deegen_baseline_jit_jettison_code(cb);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(codegenTime).count();
+    fprintf(stderr, "Compiled %llu functions %llu times\n",
+            static_cast<unsigned long long>(codeBlocks.size()), static_cast<unsigned long long>(numIterations));
+    printf("%.6fs\n", seconds);
 }
 
 static void LaunchScript(int argc, char** argv)
@@ -49,16 +105,7 @@ static void LaunchScript(int argc, char** argv)
         TableObject::PutById(globalObj, strArg, TValue::Create<tTable>(arg), info);
     }
 
-    const char* scriptFilename = argv[1];
-    ParseResult pr = ParseLuaScriptFromFile(vm->GetRootCoroutine(), scriptFilename);
-    if (pr.m_scriptModule.get() == nullptr)
-    {
-        fprintf(stderr, "Failed to parse file '%s'. Error message:\n", scriptFilename);
-        PrintTValue(stderr, pr.errMsg);
-        fprintf(stderr, "\n");
-        exit(1);
-    }
-
+    ParseResult pr = ParseScriptOrExit(vm, argv[1] /*scriptFilename*/);
     vm->LaunchScript(pr.m_scriptModule.get());
 }
 
@@ -74,6 +121,17 @@ int main(int argc, char** argv)
         PrintLJRVersion();
         return 0;
     }
+    if (strcmp(argv[1], "--bench-baseline-jit-codegen") == 0)
+    {
+        if (argc < 3)
+        {
+            PrintLJRUsage();
+            return 1;
+        }
+        size_t numIterations = (argc >= 4) ? static_cast<size_t>(strtoull(argv[3], nullptr, 10)) : 1000;
+        RunBaselineJitCodegenBenchmark(argv[2], numIterations);
+        return 0;
+    }
     LaunchScript(argc, argv);
     return 0;
 }
@@ -8,6 +8,7 @@
 #include "dfg_ir_validator.h"
 #include "dfg_speculative_inliner.h"
 #include "dfg_phantom_insertion.h"
+#include "dfg_local_cse.h"
 
 using namespace dfg;
 
@@ -479,6 +480,129 @@ TEST(DfgFrontend, Parser_Stress_1)
     }
 }
 
+TEST(DfgLocalCse, Sanity)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    vm->SetEngineStartingTier(VM::EngineStartingTier::BaselineJIT);
+    vm->SetEngineMaxTier(VM::EngineMaxTier::BaselineJIT);
+    std::unique_ptr<ScriptModule> module = ParseLuaScriptOrFail("luatests/opt_jit_frontend_capture_analysis_1.lua", LuaTestOption::ForceBaselineJit);
+    CodeBlock* cb = module->m_unlinkedCodeBlocks.back()->m_defaultCodeBlock;
+    ReleaseAssert(cb != nullptr);
+
+    // Build a single block by hand, and use a Phantom after each load to observe what the load is replaced with
+    //
+    arena_unique_ptr<Graph> graph = Graph::Create(cb);
+    BasicBlock* bb = DfgAlloc()->AllocateObject<BasicBlock>();
+    graph->m_blocks.push_back(bb);
+    bb->m_numSuccessors = 0;
+
+    auto add = [&](Node* node) -> Node*
+    {
+        bb->m_nodes.push_back(node);
+        return node;
+    };
+    auto addUse = [&](Node* node) -> Node*
+    {
+        return add(Node::CreatePhantomNode(Value(node, 0 /*outputOrd*/)));
+    };
+    auto getUsedNode = [](Node* phantom) -> Node*
+    {
+        return phantom->GetInputEdge(0).GetOperand();
+    };
+
+    Value fo = graph->GetRootFunctionObject();
+    Value arg0 = graph->GetArgumentNode(0);
+    Value arg1 = graph->GetArgumentNode(1);
+    Value numVarArgs = graph->GetRootFunctionNumVarArgs();
+
+    // CSE hits
+    //
+    Node* imm1 = add(Node::CreateGetUpvalueNode(fo, 0 /*upvalueOrd*/, true /*isImmutable*/));
+    Node* useImm1 = addUse(imm1);
+    Node* imm2 = add(Node::CreateGetUpvalueNode(fo, 0 /*upvalueOrd*/, true /*isImmutable*/));
+    Node* useImm2 = addUse(imm2);
+    Node* mut1 = add(Node::CreateGetUpvalueNode(fo, 1 /*upvalueOrd*/, false /*isImmutable*/));
+    Node* useMut1 = addUse(mut1);
+    Node* mut2 = add(Node::CreateGetUpvalueNode(fo, 1 /*upvalueOrd*/, false /*isImmutable*/));
+    Node* useMut2 = addUse(mut2);
+    Node* otherOrd = add(Node::CreateGetUpvalueNode(fo, 2 /*upvalueOrd*/, false /*isImmutable*/));
+    Node* useOtherOrd = addUse(otherOrd);
+
+    // The load after an UpvaluePut is forwarded from the stored value
+    //
+    add(Node::CreateSetUpvalueNode(fo, 1 /*upvalueOrd*/, arg0));
+    Node* mut3 = add(Node::CreateGetUpvalueNode(fo, 1 /*upvalueOrd*/, false /*isImmutable*/));
+    Node* useMut3 = addUse(mut3);
+
+    // Captured variables: CSE hit, invalidation by an upvalue store (which may be the same Upvalue object), and forwarding
+    //
+    Node* cv = add(Node::CreateCreateCapturedVarNode(arg0));
+    Node* cv1 = add(Node::CreateGetCapturedVarNode(Value(cv, 0 /*outputOrd*/)));
+    Node* useCv1 = addUse(cv1);
+    Node* cv2 = add(Node::CreateGetCapturedVarNode(Value(cv, 0 /*outputOrd*/)));
+    Node* useCv2 = addUse(cv2);
+    add(Node::CreateSetUpvalueNode(fo, 3 /*upvalueOrd*/, arg1));
+    Node* cv3 = add(Node::CreateGetCapturedVarNode(Value(cv, 0 /*outputOrd*/)));
+    Node* useCv3 = addUse(cv3);
+    add(Node::CreateSetCapturedVarNode(Value(cv, 0 /*outputOrd*/), arg1));
+    Node* cv4 = add(Node::CreateGetCapturedVarNode(Value(cv, 0 /*outputOrd*/)));
+    Node* useCv4 = addUse(cv4);
+
+    // A call may write any upvalue or captured variable, but cannot change an immutable upvalue
+    //
+    Node* call = Node::CreateGuestLanguageNode(BCKind::Call);
+    call->SetNumInputs(0);
+    call->SetNumOutputs(false /*hasDirectOutput*/, 0 /*numExtraOutputs*/);
+    add(call);
+    Node* mut4 = add(Node::CreateGetUpvalueNode(fo, 1 /*upvalueOrd*/, false /*isImmutable*/));
+    Node* useMut4 = addUse(mut4);
+    Node* cv5 = add(Node::CreateGetCapturedVarNode(Value(cv, 0 /*outputOrd*/)));
+    Node* useCv5 = addUse(cv5);
+    Node* imm3 = add(Node::CreateGetUpvalueNode(fo, 0 /*upvalueOrd*/, true /*isImmutable*/));
+    Node* useImm3 = addUse(imm3);
+
+    // Pure nodes and bound checks
+    //
+    Node* sub1 = add(Node::CreateU64SaturateSubNode(numVarArgs, 1 /*valueToSub*/));
+    Node* useSub1 = addUse(sub1);
+    Node* sub2 = add(Node::CreateU64SaturateSubNode(numVarArgs, 1 /*valueToSub*/));
+    Node* useSub2 = addUse(sub2);
+    Node* sub3 = add(Node::CreateU64SaturateSubNode(numVarArgs, 2 /*valueToSub*/));
+    Node* useSub3 = addUse(sub3);
+    Node* check1 = add(Node::CreateCheckU64InBoundNode(numVarArgs, 10 /*bound*/));
+    Node* check2 = add(Node::CreateCheckU64InBoundNode(numVarArgs, 20 /*bound*/));
+    Node* check3 = add(Node::CreateCheckU64InBoundNode(numVarArgs, 5 /*bound*/));
+
+    graph->UpgradeToBlockLocalSSAForm();
+    RunLocalCommonSubexpressionEliminationPass(graph.get());
+
+    ReleaseAssert(!imm1->IsNoopNode() && getUsedNode(useImm1) == imm1);
+    ReleaseAssert(imm2->IsNoopNode() && getUsedNode(useImm2) == imm1);
+    ReleaseAssert(!mut1->IsNoopNode() && getUsedNode(useMut1) == mut1);
+    ReleaseAssert(mut2->IsNoopNode() && getUsedNode(useMut2) == mut1);
+    ReleaseAssert(!otherOrd->IsNoopNode() && getUsedNode(useOtherOrd) == otherOrd);
+
+    ReleaseAssert(mut3->IsNoopNode() && getUsedNode(useMut3) == arg0.GetOperand());
+
+    ReleaseAssert(!cv1->IsNoopNode() && getUsedNode(useCv1) == cv1);
+    ReleaseAssert(cv2->IsNoopNode() && getUsedNode(useCv2) == cv1);
+    ReleaseAssert(!cv3->IsNoopNode() && getUsedNode(useCv3) == cv3);
+    ReleaseAssert(cv4->IsNoopNode() && getUsedNode(useCv4) == arg1.GetOperand());
+
+    ReleaseAssert(!mut4->IsNoopNode() && getUsedNode(useMut4) == mut4);
+    ReleaseAssert(!cv5->IsNoopNode() && getUsedNode(useCv5) == cv5);
+    ReleaseAssert(imm3->IsNoopNode() && getUsedNode(useImm3) == imm1);
+
+    ReleaseAssert(!sub1->IsNoopNode() && getUsedNode(useSub1) == sub1);
+    ReleaseAssert(sub2->IsNoopNode() && getUsedNode(useSub2) == sub1);
+    ReleaseAssert(!sub3->IsNoopNode() && getUsedNode(useSub3) == sub3);
+    ReleaseAssert(!check1->IsNoopNode());
+    ReleaseAssert(check2->IsNoopNode());
+    ReleaseAssert(!check3->IsNoopNode());
+}
+
 // Test DFG frontend with speculative inlining.
 // Call IC info are produced by actually running each test in baseline JIT.
 // Note that this only tests that no internal asserts are fired and that the generated DFG IR pass validation
@@ -668,7 +792,8 @@ static void TestDfgFrontendWithRandomCallIcInfo(VM* vm, std::vector<std::string>
             ReleaseAssert(targetIcSite->m_numEntries == 0);
             CodeBlock* targetCb = allUcbs[static_cast<size_t>(rand()) % allUcbs.size()]->m_defaultCodeBlock;
             TValue fakeFnObj = TValue::CreatePointer(FunctionObject::Create(vm, targetCb));
-            std::ignore = targetIcSite->InsertInClosureCallMode(0 /*fakeDcIcTraitKind*/, fakeFnObj);
+            void* unusedDataSecAddr;
+            std::ignore = targetIcSite->InsertInClosureCallMode(0 /*fakeDcIcTraitKind*/, fakeFnObj, &unusedDataSecAddr /*out*/);
 
             ReleaseAssert(targetIcSite->m_numEntries == 1);
         }
@@ -118,4 +118,186 @@ TEST(GlobalStringHashConser, Stress)
     ReleaseAssert(vec.size() == expectedMap.size());
 }
 
+TEST(GlobalStringHashConser, IncrementalResize)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    std::vector<std::string> strs;
+    std::vector<UserHeapPointer<HeapString>> ptrs;
+    bool sawMigration = false;
+    for (int i = 0; i < 100000; i++)
+    {
+        std::string str = "str_" + std::to_string(i);
+        UserHeapPointer<HeapString> ptr = vm->CreateStringObjectFromRawString(str.c_str(), static_cast<uint32_t>(str.length()));
+        CheckStringObjectIsAsExpected(ptr, str.c_str(), str.length());
+        strs.push_back(str);
+        ptrs.push_back(ptr);
+
+        if (vm->IsGlobalStringHashConserMigrationInProgress())
+        {
+            sawMigration = true;
+            // Strings still in the old table and strings already moved to the new table must both be found
+            //
+            for (int k = 0; k < 10; k++)
+            {
+                size_t ord = static_cast<size_t>(rand()) % strs.size();
+                ReleaseAssert(vm->CreateStringObjectFromRawString(strs[ord].c_str(), static_cast<uint32_t>(strs[ord].length())) == ptrs[ord]);
+                ReleaseAssert(vm->TryFindInternedStringConcurrently(strs[ord].c_str(), strs[ord].length()) == ptrs[ord]);
+            }
+        }
+    }
+    ReleaseAssert(sawMigration);
+
+    uint32_t elementCount = vm->GetGlobalStringHashConserCurrentElementCount();
+    for (size_t i = 0; i < strs.size(); i++)
+    {
+        ReleaseAssert(vm->CreateStringObjectFromRawString(strs[i].c_str(), static_cast<uint32_t>(strs[i].length())) == ptrs[i]);
+    }
+    ReleaseAssert(vm->GetGlobalStringHashConserCurrentElementCount() == elementCount);
+    ReleaseAssert(vm->TryFindInternedStringConcurrently("not_interned", 12).m_value == 0);
+}
+
+TEST(GlobalStringHashConser, ConcurrentReader)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    std::vector<std::string> strs;
+    std::vector<UserHeapPointer<HeapString>> ptrs;
+    for (int i = 0; i < 1000; i++)
+    {
+        std::string str = "pre_" + std::to_string(i);
+        strs.push_back(str);
+        ptrs.push_back(vm->CreateStringObjectFromRawString(str.c_str(), static_cast<uint32_t>(str.length())));
+    }
+
+    // The reader thread keeps looking up the existing strings while the execution thread keeps growing the table
+    //
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> numLookups(0);
+    std::thread reader([&]()
+    {
+        vm->SetUpSegmentationRegister();
+        size_t ord = 0;
+        while (!done.load())
+        {
+            ReleaseAssert(vm->TryFindInternedStringConcurrently(strs[ord].c_str(), strs[ord].length()) == ptrs[ord]);
+            ord = (ord + 1) % strs.size();
+            numLookups.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    for (int i = 0; i < 300000; i++)
+    {
+        std::string str = "new_" + std::to_string(i);
+        std::ignore = vm->CreateStringObjectFromRawString(str.c_str(), static_cast<uint32_t>(str.length()));
+    }
+    done.store(true);
+    reader.join();
+
+    ReleaseAssert(numLookups.load() > 0);
+    for (size_t i = 0; i < strs.size(); i++)
+    {
+        ReleaseAssert(vm->TryFindInternedStringConcurrently(strs[i].c_str(), strs[i].length()) == ptrs[i]);
+    }
+}
+
+TEST(GlobalStringHashConser, LongStrings)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    // Check that the multi-piece hash agrees with the single-piece hash for all kinds of piece boundaries,
+    // and that every byte of a long string contributes to its hash, so crafted strings cannot flood a single hash bucket.
+    //
+    for (size_t len : { static_cast<size_t>(100), static_cast<size_t>(10000), static_cast<size_t>(123457) })
+    {
+        std::string str;
+        for (size_t i = 0; i < len; i++) { str += static_cast<char>('a' + rand() % 26); }
+
+        UserHeapPointer<HeapString> whole = vm->CreateStringObjectFromRawString(str.c_str(), static_cast<uint32_t>(len));
+        CheckStringObjectIsAsExpected(whole, str.c_str(), len);
+
+        for (int testcase = 0; testcase < 20; testcase++)
+        {
+            std::vector<std::pair<const void*, size_t>> pieces;
+            size_t pos = 0;
+            while (pos < len)
+            {
+                size_t pieceLen = std::min(len - pos, static_cast<size_t>(rand() % 3000));
+                pieces.push_back(std::make_pair(str.c_str() + pos, pieceLen));
+                pos += pieceLen;
+            }
+            UserHeapPointer<HeapString> ptr = vm->CreateStringObjectFromConcatenation(pieces.data(), pieces.size());
+            ReleaseAssert(ptr == whole);
+        }
+
+        std::set<int64_t> distinct;
+        distinct.insert(whole.m_value);
+        for (size_t i = 0; i < 50; i++)
+        {
+            std::string other = str;
+            size_t ord = static_cast<size_t>(rand()) % len;
+            other[ord] = static_cast<char>(other[ord] == 'A' ? 'B' : 'A');
+            ReleaseAssert(HashString(other.c_str(), len) != HashString(str.c_str(), len));
+            UserHeapPointer<HeapString> ptr = vm->CreateStringObjectFromRawString(other.c_str(), static_cast<uint32_t>(len));
+            CheckStringObjectIsAsExpected(ptr, other.c_str(), len);
+            ReleaseAssert(vm->CreateStringObjectFromRawString(other.c_str(), static_cast<uint32_t>(len)) == ptr);
+            distinct.insert(ptr.m_value);
+        }
+        ReleaseAssert(distinct.size() > 1);
+        ReleaseAssert(vm->CreateStringObjectFromRawString(str.c_str(), static_cast<uint32_t>(len)) == whole);
+    }
+}
+
+TEST(GlobalStringHashConser, LazilyInternedStrings)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    std::string str;
+    for (size_t i = 0; i < 3000; i++) { str += static_cast<char>('a' + rand() % 26); }
+
+    // Short results are interned right away
+    //
+    {
+        std::pair<const void*, size_t> pieces[2] = { std::make_pair(str.c_str(), 10), std::make_pair(str.c_str() + 10, 20) };
+        UserHeapPointer<HeapString> ptr = vm->CreateMaybeLazilyInternedStringFromConcatenation(pieces, 2);
+        ReleaseAssert(!HeapString::IsLazilyInterned(ptr.As()));
+        CheckStringObjectIsAsExpected(ptr, str.c_str(), 30);
+    }
+
+    auto createLazy = [&](size_t len) -> UserHeapPointer<HeapString>
+    {
+        std::pair<const void*, size_t> pieces[2] = { std::make_pair(str.c_str(), len / 2), std::make_pair(str.c_str() + len / 2, len - len / 2) };
+        UserHeapPointer<HeapString> ptr = vm->CreateMaybeLazilyInternedStringFromConcatenation(pieces, 2);
+        ReleaseAssert(HeapString::IsLazilyInterned(ptr.As()));
+        HeapString* s = vm->GetHeapPtrTranslator().TranslateToRawPtr(ptr.As());
+        ReleaseAssert(s->m_length == len && memcmp(s->m_string, str.c_str(), len) == 0 && s->m_string[len] == 0);
+        return ptr;
+    };
+
+    // If no string with the same content exists, the lazily interned string itself becomes the interned string
+    //
+    UserHeapPointer<HeapString> lazy1 = createLazy(2000);
+    UserHeapPointer<HeapString> lazy2 = createLazy(2000);
+    ReleaseAssert(lazy1 != lazy2);
+    ReleaseAssert(vm->InternLazilyInternedString(lazy1.As()) == lazy1.As());
+    CheckStringObjectIsAsExpected(lazy1, str.c_str(), 2000);
+    ReleaseAssert(vm->CreateStringObjectFromRawString(str.c_str(), 2000) == lazy1);
+
+    // Otherwise, it is forwarded to the existing interned string
+    //
+    ReleaseAssert(vm->InternLazilyInternedString(lazy2.As()) == lazy1.As());
+    ReleaseAssert(HeapString::IsLazilyInterned(lazy2.As()));
+    ReleaseAssert(vm->InternLazilyInternedString(lazy2.As()) == lazy1.As());
+
+    UserHeapPointer<HeapString> whole = vm->CreateStringObjectFromRawString(str.c_str(), 3000);
+    UserHeapPointer<HeapString> lazy3 = createLazy(3000);
+    TValue tv = VM_InternIfLazilyInternedString(TValue::Create<tString>(lazy3.As()));
+    ReleaseAssert(tv.Is<tString>() && tv.As<tString>() == whole.As());
+    ReleaseAssert(VM_InternIfLazilyInternedString(TValue::Create<tString>(whole.As())).m_value == tv.m_value);
+}
+
 }   // anonymous namespace
@@ -60,6 +60,63 @@ TEST(BaselineJitCallIc, Sanity_1_TierUp)
     RunSimpleLuaTest("luatests/baseline_jit_call_ic_sanity_1.lua", LuaTestOption::UpToBaselineJit);
 }
 
+// Jettison the baseline JIT code of every function after the script finishes, check that all executable memory is reclaimed,
+// then run the script again from the interpreter
+//
+TEST(BaselineJitCallIc, Jettison_1)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+    vm->SetEngineStartingTier(GetVMEngineStartingTierFromEngineTestOption(LuaTestOption::ForceBaselineJit));
+    VMOutputInterceptor vmoutput(vm);
+
+    std::unique_ptr<ScriptModule> module = ParseLuaScriptOrFail("luatests/baseline_jit_call_ic_sanity_1.lua", LuaTestOption::ForceBaselineJit);
+    vm->LaunchScript(module.get());
+
+    {
+        std::string out = vmoutput.GetAndResetStdOut();
+        std::string err = vmoutput.GetAndResetStdErr();
+        AssertIsExpectedOutput(out);
+        ReleaseAssert(err == "");
+    }
+
+    ReleaseAssert(vm->GetJITMemoryAlloc()->GetTotalJITCodeSize() > 0);
+
+    for (UnlinkedCodeBlock* ucb : module->m_unlinkedCodeBlocks)
+    {
+        CodeBlock* cb = ucb->m_defaultCodeBlock;
+        ReleaseAssert(cb != nullptr && cb->m_baselineCodeBlock != nullptr);
+        deegen_baseline_jit_jettison_code(cb);
+    }
+
+    // No frame is running any JIT code now, and all the call IC entries are owned by the jettisoned call sites,
+    // so nothing should remain in the JIT memory
+    //
+    ReleaseAssert(vm->GetJITMemoryAlloc()->GetTotalJITCodeSize() == 0);
+    ReleaseAssert(vm->GetNumTotalBaselineJitJettisons() == module->m_unlinkedCodeBlocks.size());
+
+    // The BaselineCodeBlocks should have been put into the free lists
+    //
+    ReleaseAssert(!vm->GetBaselineCodeBlockFreeLists().empty());
+
+    for (UnlinkedCodeBlock* ucb : module->m_unlinkedCodeBlocks)
+    {
+        CodeBlock* cb = ucb->m_defaultCodeBlock;
+        ReleaseAssert(cb->m_baselineCodeBlock == nullptr);
+        ReleaseAssert(cb->m_bestEntryPoint == ucb->GetInterpreterEntryPoint());
+        ReleaseAssert(cb->m_jitCallIcList.IsEmpty());
+    }
+
+    vm->LaunchScript(module.get());
+
+    {
+        std::string out = vmoutput.GetAndResetStdOut();
+        std::string err = vmoutput.GetAndResetStdErr();
+        AssertIsExpectedOutput(out);
+        ReleaseAssert(err == "");
+    }
+}
+
 TEST(BaselineJitCallIc, Sanity_2)
 {
     VM* vm = VM::Create();
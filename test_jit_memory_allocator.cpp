@@ -3,6 +3,8 @@
 #include "drt/jit_memory_allocator.h"
 #include "misc_math_helper.h"
 
+#include <sys/wait.h>
+
 TEST(JITMemoryAllocator, Sanity)
 {
     JitMemoryAllocator alloc;
@@ -59,10 +61,13 @@ TEST(JITMemoryAllocator, Sanity)
         uint8_t* ptr = reinterpret_cast<uint8_t*>(alloc.AllocateGivenSize(desc.size));
         desc.ptr = ptr;
 
+        // The JIT memory must be written through its writable alias
+        //
+        uint8_t* wptr = GetJitWritableAlias(ptr);
         std::array<uint8_t, 8> pattern = desc.pattern;
         for (size_t i = 0; i < desc.size; i++)
         {
-            ptr[i] = pattern[i % 8];
+            wptr[i] = pattern[i % 8];
         }
 
         {
@@ -132,10 +137,11 @@ TEST(JITMemoryAllocator, Sanity)
         uint8_t* ptr = reinterpret_cast<uint8_t*>(alloc.AllocateGivenSize(desc.size));
         desc.ptr = ptr;
 
+        uint8_t* wptr = GetJitWritableAlias(ptr);
         std::array<uint8_t, 8> pattern = desc.pattern;
         for (size_t k = 0; k < desc.size; k++)
         {
-            ptr[k] = pattern[k % 8];
+            wptr[k] = pattern[k % 8];
         }
     }
 
@@ -154,3 +160,106 @@ TEST(JITMemoryAllocator, Sanity)
         }
     }
 }
+
+namespace {
+
+// Returns the permission string (e.g., "r-xs") of the mapping containing 'addr' in /proc/self/maps
+//
+std::string WARN_UNUSED GetMappingPermissions(void* addr)
+{
+    uint64_t addr64 = reinterpret_cast<uint64_t>(addr);
+    FILE* fp = fopen("/proc/self/maps", "r");
+    ReleaseAssert(fp != nullptr);
+    std::string result;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) != nullptr)
+    {
+        unsigned long long start, end;
+        char perms[8];
+        if (sscanf(line, "%llx-%llx %7s", &start, &end, perms) == 3 && start <= addr64 && addr64 < end)
+        {
+            result = perms;
+            break;
+        }
+    }
+    fclose(fp);
+    ReleaseAssert(result != "");
+    return result;
+}
+
+}   // anonymous namespace
+
+// The JIT memory protection mode is decided once per process, so the W^X mode is tested by re-running the JIT-related tests
+// in a child process with LJR_JIT_WX=1. In that child process, this test validates the page protections directly.
+//
+TEST(JITMemoryAllocator, WriteXorExecuteMode)
+{
+    if (GetJitMemoryProtectionMode() != JitMemoryProtectionMode::DualMappedWriteXorExecute)
+    {
+        char selfPath[4096];
+        ssize_t len = readlink("/proc/self/exe", selfPath, sizeof(selfPath) - 1);
+        ReleaseAssert(len > 0 && static_cast<size_t>(len) < sizeof(selfPath) - 1);
+        selfPath[len] = '\0';
+
+        std::string cmd = std::string("LJR_JIT_WX=1 '") + selfPath + "' "
+            "--gtest_filter='JITMemoryAllocator.*:BaselineJitCallIc.*:LuaTestForceBaselineJit.*:LuaLibForceBaselineJit.*'";
+        int ret = system(cmd.c_str());
+        ReleaseAssert(ret != -1 && WIFEXITED(ret) && WEXITSTATUS(ret) == 0);
+        return;
+    }
+
+    JitMemoryAllocator codeAlloc;
+    JitMemoryAllocator dataAlloc { false /*isExecutable*/ };
+
+    uint8_t* code = reinterpret_cast<uint8_t*>(codeAlloc.AllocateGivenSize(100));
+    uint8_t* data = reinterpret_cast<uint8_t*>(dataAlloc.AllocateGivenSize(100));
+    uint8_t* largeCode = reinterpret_cast<uint8_t*>(codeAlloc.AllocateGivenSize(100000));
+
+    // No page is both writable and executable, and the JIT memory is only writable through its alias
+    //
+    ReleaseAssert(GetJitWritableAlias(code) != code);
+    ReleaseAssert(GetMappingPermissions(code) == "r-xs");
+    ReleaseAssert(GetMappingPermissions(GetJitWritableAlias(code)) == "rw-s");
+    ReleaseAssert(GetMappingPermissions(largeCode) == "r-xs");
+    ReleaseAssert(GetMappingPermissions(GetJitWritableAlias(largeCode)) == "rw-s");
+    ReleaseAssert(GetMappingPermissions(data) == "r--s");
+    ReleaseAssert(GetMappingPermissions(GetJitWritableAlias(data)) == "rw-s");
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        GetJitWritableAlias(code)[i] = static_cast<uint8_t>(i);
+        GetJitWritableAlias(data)[i] = static_cast<uint8_t>(i + 1);
+    }
+    for (size_t i = 0; i < 100; i++)
+    {
+        ReleaseAssert(code[i] == static_cast<uint8_t>(i));
+        ReleaseAssert(data[i] == static_cast<uint8_t>(i + 1));
+    }
+
+    // A forked child loses the writable aliases, so it can never modify the JIT memory shared with the parent
+    //
+    pid_t pid = fork();
+    ReleaseAssert(pid != -1);
+    if (pid == 0)
+    {
+        bool ok = GetMappingPermissions(GetJitWritableAlias(code)) == "---p" &&
+                  GetMappingPermissions(GetJitWritableAlias(data)) == "---p" &&
+                  GetMappingPermissions(code) == "r-xs" &&
+                  code[10] == 10;
+        _exit(ok ? 0 : 1);
+    }
+    int status;
+    ReleaseAssert(waitpid(pid, &status, 0) == pid);
+    ReleaseAssert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // The parent still has its writable aliases
+    //
+    GetJitWritableAlias(code)[10] = 123;
+    ReleaseAssert(code[10] == 123);
+
+    codeAlloc.Free(code);
+    codeAlloc.Free(largeCode);
+    dataAlloc.Free(data);
+    ReleaseAssert(codeAlloc.GetTotalJITCodeSize() == 0);
+    ReleaseAssert(dataAlloc.GetTotalJITCodeSize() == 0);
+}
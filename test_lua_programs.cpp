@@ -6,6 +6,7 @@
 #include "test_vm_utils.h"
 #include "lj_parser_wrapper.h"
 #include "drt/baseline_jit_codegen_helper.h"
+#include "drt/baseline_jit_compile_queue.h"
 #include "test_lua_file_utils.h"
 
 namespace {
@@ -39,6 +40,80 @@ TEST(LuaTestTierUpToBaselineJit, Fib)
     RunSimpleLuaTest("luatests/fib.lua", LuaTestOption::UpToBaselineJit);
 }
 
+TEST(LuaTestTierUpToBaselineJit, FibBackgroundCompilation)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+    vm->SetEngineStartingTier(GetVMEngineStartingTierFromEngineTestOption(LuaTestOption::UpToBaselineJit));
+    vm->SetEngineMaxTier(GetVMEngineMaxTierFromEngineTestOption(LuaTestOption::UpToBaselineJit));
+    vm->SetBackgroundBaselineJitCompilation(true);
+    VMOutputInterceptor vmoutput(vm);
+
+    std::unique_ptr<ScriptModule> module = ParseLuaScriptOrFail("luatests/fib.lua", LuaTestOption::UpToBaselineJit);
+    vm->LaunchScript(module.get());
+
+    std::string out = vmoutput.GetAndResetStdOut();
+    std::string err = vmoutput.GetAndResetStdErr();
+    AssertIsExpectedOutput(out);
+    ReleaseAssert(err == "");
+    ReleaseAssert(vm->GetNumTotalBaselineJitCompilations() > 0);
+}
+
+// Turn off background compilation while the jobs are still queued or being compiled.
+// The discarded jobs must give back all the memory they allocated, and the functions can still be compiled later.
+//
+TEST(LuaTestTierUpToBaselineJit, FibDiscardBackgroundCompilationJobs)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+    vm->SetEngineStartingTier(GetVMEngineStartingTierFromEngineTestOption(LuaTestOption::UpToBaselineJit));
+    vm->SetEngineMaxTier(GetVMEngineMaxTierFromEngineTestOption(LuaTestOption::UpToBaselineJit));
+    VMOutputInterceptor vmoutput(vm);
+
+    std::unique_ptr<ScriptModule> module = ParseLuaScriptOrFail("luatests/fib.lua", LuaTestOption::UpToBaselineJit);
+
+    size_t systemHeapUsageAfterFirstRound = 0;
+    for (size_t round = 0; round < 2; round++)
+    {
+        vm->SetBackgroundBaselineJitCompilation(true);
+        BaselineJitCompileQueue* compileQueue = vm->GetBaselineJitCompileQueue();
+        for (UnlinkedCodeBlock* ucb : module->m_unlinkedCodeBlocks)
+        {
+            compileQueue->Enqueue(deegen_baseline_jit_prepare_codegen(ucb->m_defaultCodeBlock, true /*snapshotBytecode*/));
+        }
+        ReleaseAssert(vm->GetJITMemoryAlloc()->GetTotalJITCodeSize() > 0);
+
+        vm->SetBackgroundBaselineJitCompilation(false);
+
+        ReleaseAssert(vm->GetJITMemoryAlloc()->GetTotalJITCodeSize() == 0);
+        ReleaseAssert(vm->GetJITDataMemoryAlloc()->GetTotalJITCodeSize() == 0);
+        for (UnlinkedCodeBlock* ucb : module->m_unlinkedCodeBlocks)
+        {
+            ReleaseAssert(ucb->m_defaultCodeBlock->m_baselineCodeBlock == nullptr);
+        }
+
+        // The bytecode did not change, so the second round allocates BaselineCodeBlocks of the same sizes,
+        // which should all be served by the ones freed in the first round
+        //
+        if (round == 0)
+        {
+            systemHeapUsageAfterFirstRound = vm->GetSystemHeapUsageInBytes();
+        }
+        else
+        {
+            ReleaseAssert(vm->GetSystemHeapUsageInBytes() == systemHeapUsageAfterFirstRound);
+        }
+    }
+
+    vm->LaunchScript(module.get());
+
+    std::string out = vmoutput.GetAndResetStdOut();
+    std::string err = vmoutput.GetAndResetStdErr();
+    AssertIsExpectedOutput(out);
+    ReleaseAssert(err == "");
+    ReleaseAssert(vm->GetNumTotalBaselineJitCompilations() > 2 * module->m_unlinkedCodeBlocks.size());
+}
+
 static void LuaTest_TestPrint_Impl(LuaTestOption testOption)
 {
     VM* vm = VM::Create();
@@ -990,11 +1065,8 @@ static void LuaBenchmark_Ack_Impl(LuaTestOption testOption)
 
     std::unique_ptr<ScriptModule> module = ParseLuaScriptOrFail("luatests/ack.lua", testOption);
 
-    // This benchmark needs a larger stack
+    // This benchmark recurses deeply, and relies on the root coroutine stack growing on demand
     //
-    CoroutineRuntimeContext* rc = vm->GetRootCoroutine();
-    rc->m_stackBegin = new TValue[1000000];
-
     vm->LaunchScript(module.get());
 
     std::string out = vmoutput.GetAndResetStdOut();
@@ -2638,6 +2710,126 @@ TEST(LuaLibTierUpToBaselineJit, coroutine_error_3)
     RunSimpleLuaTest("luatests/coroutine_error_3.lua", LuaTestOption::UpToBaselineJit);
 }
 
+TEST(LuaLib, coroutine_stack_reuse)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_reuse.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, coroutine_stack_reuse)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_reuse.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, coroutine_stack_reuse)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_reuse.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, coroutine_stack_growth)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_growth.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, coroutine_stack_growth)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_growth.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, coroutine_stack_growth)
+{
+    RunSimpleLuaTest("luatests/coroutine_stack_growth.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, long_string_concat)
+{
+    RunSimpleLuaTest("luatests/long_string_concat.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, long_string_concat)
+{
+    RunSimpleLuaTest("luatests/long_string_concat.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, long_string_concat)
+{
+    RunSimpleLuaTest("luatests/long_string_concat.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, io_file_handles)
+{
+    RunSimpleLuaTest("luatests/io_file_handles.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, io_file_handles)
+{
+    RunSimpleLuaTest("luatests/io_file_handles.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, io_file_handles)
+{
+    RunSimpleLuaTest("luatests/io_file_handles.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, io_stdout_buffer)
+{
+    RunSimpleLuaTest("luatests/io_stdout_buffer.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, io_stdout_buffer)
+{
+    RunSimpleLuaTest("luatests/io_stdout_buffer.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, io_stdout_buffer)
+{
+    RunSimpleLuaTest("luatests/io_stdout_buffer.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, string_patterns)
+{
+    RunSimpleLuaTest("luatests/string_patterns.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, string_patterns)
+{
+    RunSimpleLuaTest("luatests/string_patterns.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, string_patterns)
+{
+    RunSimpleLuaTest("luatests/string_patterns.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, table_insert_remove)
+{
+    RunSimpleLuaTest("luatests/table_insert_remove.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, table_insert_remove)
+{
+    RunSimpleLuaTest("luatests/table_insert_remove.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, table_insert_remove)
+{
+    RunSimpleLuaTest("luatests/table_insert_remove.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaLib, table_sort_kernels)
+{
+    RunSimpleLuaTest("luatests/table_sort_kernels.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, table_sort_kernels)
+{
+    RunSimpleLuaTest("luatests/table_sort_kernels.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, table_sort_kernels)
+{
+    RunSimpleLuaTest("luatests/table_sort_kernels.lua", LuaTestOption::UpToBaselineJit);
+}
+
 TEST(LuaLib, base_ipairs)
 {
     RunSimpleLuaTest("luatests/base_lib_ipairs.lua", LuaTestOption::ForceInterpreter);
@@ -2728,6 +2920,21 @@ TEST(LuaLibTierUpToBaselineJit, base_lib_type)
     RunSimpleLuaTest("luatests/base_lib_type.lua", LuaTestOption::UpToBaselineJit);
 }
 
+TEST(LuaLib, base_lib_collectgarbage)
+{
+    RunSimpleLuaTest("luatests/base_lib_collectgarbage.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaLibForceBaselineJit, base_lib_collectgarbage)
+{
+    RunSimpleLuaTest("luatests/base_lib_collectgarbage.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaLibTierUpToBaselineJit, base_lib_collectgarbage)
+{
+    RunSimpleLuaTest("luatests/base_lib_collectgarbage.lua", LuaTestOption::UpToBaselineJit);
+}
+
 TEST(LuaLib, base_lib_next)
 {
     RunSimpleLuaTest("luatests/base_lib_next.lua", LuaTestOption::ForceInterpreter);
@@ -3658,6 +3865,36 @@ TEST(LuaTestTierUpToBaselineJit, comparison_one_side_constant)
     RunSimpleLuaTest("luatests/comparison_one_side_constant.lua", LuaTestOption::UpToBaselineJit);
 }
 
+TEST(LuaTest, megamorphic_property_access)
+{
+    RunSimpleLuaTest("luatests/megamorphic_property_access.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaTestForceBaselineJit, megamorphic_property_access)
+{
+    RunSimpleLuaTest("luatests/megamorphic_property_access.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaTestTierUpToBaselineJit, megamorphic_property_access)
+{
+    RunSimpleLuaTest("luatests/megamorphic_property_access.lua", LuaTestOption::UpToBaselineJit);
+}
+
+TEST(LuaTest, string_dump)
+{
+    RunSimpleLuaTest("luatests/string_dump.lua", LuaTestOption::ForceInterpreter);
+}
+
+TEST(LuaTestForceBaselineJit, string_dump)
+{
+    RunSimpleLuaTest("luatests/string_dump.lua", LuaTestOption::ForceBaselineJit);
+}
+
+TEST(LuaTestTierUpToBaselineJit, string_dump)
+{
+    RunSimpleLuaTest("luatests/string_dump.lua", LuaTestOption::UpToBaselineJit);
+}
+
 TEST(LuaBenchmark, bounce)
 {
     RunSimpleLuaTest("luatests/bounce.lua", LuaTestOption::ForceInterpreter);
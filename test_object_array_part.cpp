@@ -1139,4 +1139,86 @@ TEST(ObjectArrayPart, DensityTest2)
     ObjectArrayPartDensityTest(vm, 2000 /*numProps*/);
 }
 
+// Test that the sparse map works with a lot of key insertions and deletions,
+// and that the hash table does not keep growing if the number of live keys is bounded
+//
+TEST(ObjectArrayPart, SparseMapChurn)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    ArraySparseMap* sparseMap = ArraySparseMap::AllocateEmptyArraySparseMap(vm);
+    std::unordered_map<double, int32_t> expected;
+
+    // Mix in some keys that are not integers, and keys that are too large for int64
+    //
+    auto getRandomKey = [&]() -> double
+    {
+        int dice = rand() % 10;
+        if (dice == 0)
+        {
+            return static_cast<double>(rand() % 1000) + 0.5;
+        }
+        else if (dice == 1)
+        {
+            return static_cast<double>(rand() % 1000) * 1e20;
+        }
+        else
+        {
+            return static_cast<double>(rand() % 1000) * 1000 + 1700000000000.0;
+        }
+    };
+
+    for (uint32_t testOp = 0; testOp < 100000; testOp++)
+    {
+        double key = getRandomKey();
+        if (rand() % 2 == 0)
+        {
+            sparseMap->Insert(key, TValue::Nil());
+            expected.erase(key);
+        }
+        else
+        {
+            int32_t val = rand();
+            sparseMap->Insert(key, TValue::CreateInt32(val));
+            expected[key] = val;
+        }
+
+        double keyToQuery = getRandomKey();
+        TValue result = sparseMap->GetByVal(keyToQuery);
+        if (expected.count(keyToQuery))
+        {
+            ReleaseAssert(result.IsInt32() && result.AsInt32() == expected[keyToQuery]);
+        }
+        else
+        {
+            ReleaseAssert(result.IsNil());
+        }
+    }
+
+    // There are at most 3000 distinct keys, so the load factor rule bounds the hash table size
+    //
+    ReleaseAssert(sparseMap->m_hashMask + 1 <= 16384);
+
+    for (auto& it : expected)
+    {
+        TValue result = sparseMap->GetByVal(it.first);
+        ReleaseAssert(result.IsInt32() && result.AsInt32() == it.second);
+    }
+
+    // -0 and 0 must be the same key
+    //
+    sparseMap->Insert(0.0, TValue::CreateInt32(123));
+    ReleaseAssert(sparseMap->GetByVal(-0.0).AsInt32() == 123);
+    sparseMap->Insert(-0.0, TValue::CreateInt32(456));
+    ReleaseAssert(sparseMap->GetByVal(0.0).AsInt32() == 456);
+
+    // The clone should be independent from the original map
+    //
+    ArraySparseMap* clone = sparseMap->Clone(vm);
+    sparseMap->Insert(0.0, TValue::CreateInt32(789));
+    ReleaseAssert(clone->GetByVal(0.0).AsInt32() == 456);
+    ReleaseAssert(sparseMap->GetByVal(0.0).AsInt32() == 789);
+}
+
 }   // anonymous namespace
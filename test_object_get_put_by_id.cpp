@@ -424,4 +424,171 @@ TEST(ObjectGetPutById, MissedGetByIdIsUncacheableForCacheableDicitonary)
     }
 }
 
+// A table used as a hash map with a lot of key insertions and deletions should transit to UncacheableDictionary
+//
+TEST(ObjectGetPutById, UncacheableDictionary)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+    const uint32_t numStrings = 3000;
+    StringList strings = GetStringList(VM::GetActiveVMForCurrentThread(), numStrings);
+    Structure* initStructure = Structure::CreateInitialStructure(VM::GetActiveVMForCurrentThread(), 8 /*inlineCapacity*/);
+    HeapPtr<TableObject> obj = TableObject::CreateEmptyTableObject(vm, initStructure, 0 /*initArraySize*/);
+
+    auto getHiddenClassType = [&]() -> HeapEntityType
+    {
+        return TCGet(obj->m_hiddenClass).As<SystemHeapGcObjectHeader>()->m_type;
+    };
+
+    auto putById = [&](UserHeapPointer<HeapString> prop, TValue val)
+    {
+        PutByIdICInfo icInfo;
+        TableObject::PreparePutById(obj, prop, icInfo /*out*/);
+        ReleaseAssert(!TableObject::PutByIdNeedToCheckMetatable(obj, icInfo));
+        TableObject::PutById(obj, prop.As<void>(), val, icInfo);
+    };
+
+    auto getById = [&](UserHeapPointer<HeapString> prop) -> TValue
+    {
+        GetByIdICInfo icInfo;
+        TableObject::PrepareGetById(obj, prop, icInfo /*out*/);
+        return TableObject::GetById(obj, prop.As<void>(), icInfo);
+    };
+
+    // Insert a key and delete it right away, so most of the slots in the CacheableDictionary are nil
+    //
+    std::unordered_map<int64_t, int32_t> expected;
+    uint32_t numInserted = 0;
+    while (getHiddenClassType() != HeapEntityType::UncacheableDictionary)
+    {
+        ReleaseAssert(numInserted + 1 < numStrings);
+        putById(strings[numInserted], TValue::CreateInt32(static_cast<int32_t>(numInserted)));
+        putById(strings[numInserted + 1], TValue::CreateInt32(static_cast<int32_t>(numInserted + 1)));
+        putById(strings[numInserted], TValue::Nil());
+        expected[strings[numInserted + 1].m_value] = static_cast<int32_t>(numInserted + 1);
+        numInserted += 2;
+    }
+    ReleaseAssert(numInserted <= 2 * TableObject::x_uncacheableDictionaryTransitionMinSlotsForChurnCheck);
+
+    // Randomly insert, overwrite and delete keys
+    //
+    for (uint32_t testOp = 0; testOp < 20000; testOp++)
+    {
+        uint32_t ord = static_cast<uint32_t>(rand()) % numStrings;
+        UserHeapPointer<HeapString> prop = strings[ord];
+        if (rand() % 3 == 0)
+        {
+            putById(prop, TValue::Nil());
+            expected.erase(prop.m_value);
+        }
+        else
+        {
+            int32_t val = rand();
+            putById(prop, TValue::CreateInt32(val));
+            expected[prop.m_value] = val;
+        }
+
+        UserHeapPointer<HeapString> propToQuery = strings[static_cast<uint32_t>(rand()) % numStrings];
+        GetByIdICInfo icInfo;
+        TableObject::PrepareGetById(obj, propToQuery, icInfo /*out*/);
+        ReleaseAssert(icInfo.m_icKind == GetByIdICInfo::ICKind::UncachableDictionary);
+        ReleaseAssert(!icInfo.m_mayHaveMetatable);
+        TValue result = TableObject::GetById(obj, propToQuery.As<void>(), icInfo);
+        if (expected.count(propToQuery.m_value))
+        {
+            ReleaseAssert(result.IsInt32() && result.AsInt32() == expected[propToQuery.m_value]);
+        }
+        else
+        {
+            ReleaseAssert(result.IsNil());
+        }
+    }
+    ReleaseAssert(getHiddenClassType() == HeapEntityType::UncacheableDictionary);
+
+    // The iterator should see every key exactly once
+    //
+    {
+        std::unordered_set<int64_t> showedUp;
+        TableObjectIterator iter;
+        while (true)
+        {
+            TableObjectIterator::KeyValuePair kv = iter.Advance(obj);
+            if (kv.m_key.IsNil())
+            {
+                break;
+            }
+            ReleaseAssert(kv.m_key.IsPointer());
+            int64_t key = kv.m_key.AsPointer().m_value;
+            ReleaseAssert(expected.count(key) && !showedUp.count(key));
+            showedUp.insert(key);
+            ReleaseAssert(kv.m_value.IsInt32() && kv.m_value.AsInt32() == expected[key]);
+        }
+        ReleaseAssert(showedUp.size() == expected.size());
+    }
+
+    // Deleting keys during a traversal is allowed in Lua
+    //
+    {
+        size_t numVisited = 0;
+        TValue key = TValue::Nil();
+        while (true)
+        {
+            TableObjectIterator::KeyValuePair kv;
+            ReleaseAssert(TableObjectIterator::GetNextFromKey(obj, key, kv /*out*/));
+            if (kv.m_key.IsNil())
+            {
+                break;
+            }
+            numVisited++;
+            key = kv.m_key;
+            putById(UserHeapPointer<HeapString>(key.AsPointer().As<HeapString>()), TValue::Nil());
+        }
+        ReleaseAssert(numVisited == expected.size());
+        expected.clear();
+        for (uint32_t i = 0; i < numStrings; i++)
+        {
+            ReleaseAssert(getById(strings[i]).IsNil());
+        }
+    }
+
+    // Cloning the table should clone the dictionary
+    //
+    {
+        putById(strings[0], TValue::CreateInt32(123));
+        HeapPtr<TableObject> clone = TranslateToRawPointer(obj)->ShallowCloneTableObject(vm);
+        ReleaseAssert(TCGet(clone->m_hiddenClass) != TCGet(obj->m_hiddenClass));
+        putById(strings[0], TValue::CreateInt32(456));
+        GetByIdICInfo icInfo;
+        TableObject::PrepareGetById(clone, strings[0], icInfo /*out*/);
+        TValue result = TableObject::GetById(clone, strings[0].As<void>(), icInfo);
+        ReleaseAssert(result.IsInt32() && result.AsInt32() == 123);
+        ReleaseAssert(getById(strings[0]).AsInt32() == 456);
+    }
+
+    // The metatable is stored in the dictionary and changed in place
+    //
+    {
+        HeapPtr<TableObject> mt = TableObject::CreateEmptyTableObject(vm, initStructure, 0 /*initArraySize*/);
+        SystemHeapPointer<void> hiddenClass = TCGet(obj->m_hiddenClass);
+        TranslateToRawPointer(obj)->SetMetatable(vm, mt);
+        ReleaseAssert(TCGet(obj->m_hiddenClass) == hiddenClass);
+        ReleaseAssert(TCGet(obj->m_arrayType).MayHaveMetatable());
+        TableObject::GetMetatableResult gmr = TableObject::GetMetatable(obj);
+        ReleaseAssert(gmr.m_result.As<TableObject>() == mt && !gmr.m_isCacheable);
+
+        PutByIdICInfo icInfo;
+        TableObject::PreparePutById(obj, strings[0], icInfo /*out*/);
+        ReleaseAssert(icInfo.m_icKind == PutByIdICInfo::ICKind::UncacheableDictionary);
+        ReleaseAssert(icInfo.m_mayHaveMetatable && icInfo.m_propertyExists);
+        ReleaseAssert(!TableObject::PutByIdNeedToCheckMetatable(obj, icInfo));
+        TableObject::PreparePutById(obj, strings[1], icInfo /*out*/);
+        ReleaseAssert(icInfo.m_mayHaveMetatable && !icInfo.m_propertyExists);
+        ReleaseAssert(TableObject::PutByIdNeedToCheckMetatable(obj, icInfo));
+
+        TranslateToRawPointer(obj)->RemoveMetatable(vm);
+        ReleaseAssert(!TCGet(obj->m_arrayType).MayHaveMetatable());
+        ReleaseAssert(TableObject::GetMetatable(obj).m_result.m_value == 0);
+    }
+}
+
 }   // anonymous namespace
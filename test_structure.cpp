@@ -611,4 +611,88 @@ TEST(Structure, ArrayTypeTransition)
     DoArrayTypeTransitionTest(400 /*numStrings*/, 1500 /*numNodes*/, 3 /*degreeParam*/);
 }
 
+TEST(Structure, TransitionTableGrowth)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    // Keys for AddProperty transitions are always negative
+    //
+    auto getKey = [](uint32_t i) -> int32_t { return -static_cast<int32_t>(i + 1) * 8; };
+    auto getValue = [](uint32_t i) -> SystemHeapPointer<Structure> { return SystemHeapPointer<Structure>(static_cast<uint32_t>(i + 1) * 8); };
+
+    constexpr uint32_t numKeys = 1000;
+    StructureTransitionTable* table = StructureTransitionTable::AllocateInitialTable(vm, getKey(0), getValue(0));
+    std::vector<StructureTransitionTable*> freedTables;
+    for (uint32_t i = 1; i < numKeys; i++)
+    {
+        bool found;
+        StructureTransitionTable::HashTableEntry* e = StructureTransitionTable::Find(table, getKey(i), found /*out*/);
+        ReleaseAssert(!found);
+        e->m_key = getKey(i);
+        e->m_value = getValue(i);
+        table->m_numElementsInHashTable++;
+        if (table->ShouldResizeForThisInsertion())
+        {
+            freedTables.push_back(table);
+            table = table->Expand(vm);
+            ReleaseAssert(!table->ShouldResizeForThisInsertion());
+        }
+    }
+
+    uint32_t totalDisplacement = 0;
+    for (uint32_t i = 0; i < numKeys; i++)
+    {
+        bool found;
+        StructureTransitionTable::HashTableEntry* e = StructureTransitionTable::Find(table, getKey(i), found /*out*/);
+        ReleaseAssert(found && e->m_value == getValue(i));
+        uint32_t slot = static_cast<uint32_t>(e - table->m_hashTable);
+        totalDisplacement += (slot - StructureTransitionTable::GetFirstProbeSlot(getKey(i), table->m_hashTableMask)) & table->m_hashTableMask;
+    }
+    ReleaseAssert(table->m_numElementsInHashTable == numKeys);
+
+    // With linear probing and a load factor of at most 1/2, an entry is on average about half a slot away from where its key hashes to.
+    // This would be about 2 slots if the probes of all keys hashing into the same cache line started at the same slot.
+    //
+    ReleaseAssert(totalDisplacement < numKeys);
+    ReleaseAssert(freedTables.size() > 0);
+
+    // A new table of the same size as a freed table should reuse its memory
+    //
+    StructureTransitionTable* newTable = StructureTransitionTable::AllocateInitialTable(vm, getKey(0), getValue(0));
+    ReleaseAssert(newTable == freedTables[0]);
+}
+
+TEST(Structure, ButterflyGrowthPolicy)
+{
+    using Policy = ButterflyNamedStorageGrowthPolicy;
+    for (uint8_t inlineCapacity = 0; inlineCapacity <= 64; inlineCapacity++)
+    {
+        uint8_t maxPropertySlots = Structure::x_maxNumSlots;
+        uint8_t capacity = Policy::ComputeInitialButterflyCapacityForStructure(inlineCapacity, maxPropertySlots);
+        ReleaseAssert(capacity > 0);
+        uint32_t numGrowths = 0;
+        while (inlineCapacity + capacity < maxPropertySlots + 1)
+        {
+            uint8_t newCapacity = Policy::ComputeNextButterflyCapacityForStructure(inlineCapacity, capacity, maxPropertySlots);
+            ReleaseAssert(newCapacity > capacity);
+            ReleaseAssert(inlineCapacity + newCapacity <= maxPropertySlots + 1);
+            capacity = newCapacity;
+            numGrowths++;
+        }
+        ReleaseAssert(numGrowths <= 12);
+    }
+
+    uint32_t capacity = Policy::ComputeInitialButterflyCapacityForDictionary(0 /*inlineCapacity*/);
+    while (capacity < Butterfly::x_maxNamedStorageCapacity)
+    {
+        uint32_t newCapacity = Policy::ComputeNextButterflyCapacityForDictionaryOrFail(capacity);
+        ReleaseAssert(newCapacity > capacity && newCapacity <= Butterfly::x_maxNamedStorageCapacity);
+        // Growth must stay geometric so that adding properties one by one is amortized O(1)
+        //
+        ReleaseAssert(newCapacity == Butterfly::x_maxNamedStorageCapacity || newCapacity * 2 >= capacity * 3);
+        capacity = newCapacity;
+    }
+}
+
 }   // anonymous namespace
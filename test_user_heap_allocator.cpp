@@ -0,0 +1,114 @@
+#include "runtime_utils.h"
+#include "gtest/gtest.h"
+#include "test_vm_utils.h"
+
+namespace {
+
+TEST(UserHeapAllocator, SizeClassSanity)
+{
+    using namespace internal;
+    uint32_t prevCellSize = 0;
+    for (uint32_t slots = 1; slots <= x_userHeapMaxSizeClassSlots + 10; slots++)
+    {
+        uint32_t cellSize = GetLeastFitCellSizeInSlots(slots);
+        ReleaseAssert(cellSize >= slots);
+        ReleaseAssert(cellSize >= prevCellSize);
+        // The cell size must be a fixed point
+        //
+        ReleaseAssert(GetLeastFitCellSizeInSlots(cellSize) == cellSize);
+        // Internal fragmentation should be bounded by 25% for everything except the tiny size classes
+        //
+        if (slots >= 8)
+        {
+            ReleaseAssert(cellSize * 4 <= slots * 5 + 4);
+        }
+        prevCellSize = cellSize;
+    }
+}
+
+TEST(UserHeapAllocator, FreeListReuse)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    for (uint32_t slots : { 2U, 3U, 7U, 17U, 100U, 1000U, 1024U })
+    {
+        uint32_t length = slots * 8;
+        UserHeapPointer<void> p1 = vm->AllocFromUserHeap(length);
+        UserHeapPointer<void> p2 = vm->AllocFromUserHeap(length);
+        ReleaseAssert(p1 != p2);
+
+        // A freed cell should be handed out by the next allocation of the same size class (in LIFO order)
+        //
+        vm->FreeToUserHeap(p1, length);
+        vm->FreeToUserHeap(p2, length);
+        uint32_t sameClassLength = internal::GetLeastFitCellSizeInSlots(slots) * 8;
+        UserHeapPointer<void> q1 = vm->AllocFromUserHeap(sameClassLength);
+        UserHeapPointer<void> q2 = vm->AllocFromUserHeap(length);
+        ReleaseAssert(q1 == p2);
+        ReleaseAssert(q2 == p1);
+
+        // The free list is now empty, so the next allocation must be a fresh cell
+        //
+        UserHeapPointer<void> q3 = vm->AllocFromUserHeap(length);
+        ReleaseAssert(q3 != p1 && q3 != p2);
+    }
+}
+
+// The usage reported to the user program (collectgarbage("count")) must not include the cells sitting in the free lists
+//
+TEST(UserHeapAllocator, UsageExcludesFreedCells)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    for (uint32_t slots : { 2U, 17U, 1000U, internal::x_userHeapMaxSizeClassSlots + 1 })
+    {
+        uint32_t length = slots * 8;
+        size_t usageBefore = vm->GetUserHeapUsageInBytes();
+        UserHeapPointer<void> p = vm->AllocFromUserHeap(length);
+        size_t usageAfterAlloc = vm->GetUserHeapUsageInBytes();
+        ReleaseAssert(usageAfterAlloc >= usageBefore + length);
+
+        vm->FreeToUserHeap(p, length);
+        ReleaseAssert(vm->GetUserHeapUsageInBytes() == usageBefore);
+
+        // Reusing the freed cell counts it as in use again
+        //
+        if (slots <= internal::x_userHeapMaxSizeClassSlots)
+        {
+            UserHeapPointer<void> q = vm->AllocFromUserHeap(length);
+            ReleaseAssert(q == p);
+            ReleaseAssert(vm->GetUserHeapUsageInBytes() == usageAfterAlloc);
+        }
+    }
+}
+
+TEST(UserHeapAllocator, ButterflyReuse)
+{
+    VM* vm = VM::Create();
+    Auto(vm->Destroy());
+
+    // Growing the array part of a table frees the old butterfly, which should be reused by the next table
+    //
+    HeapPtr<TableObject> t1 = TableObject::CreateEmptyTableObject(vm, 0U /*inlineCapacity*/, 4U /*initialButterflyArrayPartCapacity*/);
+    Butterfly* oldButterfly = TranslateToRawPointer(vm, t1)->m_butterfly;
+    for (int64_t i = 1; i <= 16; i++)
+    {
+        TableObject::RawPutByValIntegerIndex(t1, i, TValue::Create<tDouble>(static_cast<double>(i)));
+    }
+    ReleaseAssert(TranslateToRawPointer(vm, t1)->m_butterfly != oldButterfly);
+
+    HeapPtr<TableObject> t2 = TableObject::CreateEmptyTableObject(vm, 0U /*inlineCapacity*/, 4U /*initialButterflyArrayPartCapacity*/);
+    ReleaseAssert(TranslateToRawPointer(vm, t2)->m_butterfly == oldButterfly);
+
+    for (int64_t i = 1; i <= 16; i++)
+    {
+        GetByIntegerIndexICInfo icInfo;
+        TableObject::PrepareGetByIntegerIndex(t1, icInfo /*out*/);
+        TValue val = TableObject::GetByIntegerIndex(t1, i, icInfo);
+        ReleaseAssert(val.Is<tDouble>() && UnsafeFloatEqual(val.As<tDouble>(), static_cast<double>(i)));
+    }
+}
+
+}   // anonymous namespace